@@ -44,18 +44,24 @@ ifeq ($(BR2_PACKAGE_LIBDRM_EXAMPLES_QUIRKS)x,yx)
     LIBDRM_EXAMPLES_CPPFLAGS += -D_QUIRKS
 endif
 
+ifeq ($(BR2_PACKAGE_LIBDRM_EXAMPLES_VALIDATE)x,yx)
+    LIBDRM_EXAMPLES_CPPFLAGS += -D_VALIDATE
+endif
+
 define LIBDRM_EXAMPLES_CONFIGURE_CMDS
 @echo "Nothing to be done"
 endef
 
-define LIBDRM_EXAMPLES_BUILD_DRM_PRIME_MULTI
+LIBDRM_EXAMPLES_PROGRAMS = drm-prime-simple drm-prime-tile drm-prime-multi
+
+define LIBDRM_EXAMPLES_BUILD_PROGRAMS
 pushd $(@D); \
-$(MAKE) -f $(@D)/Makefile CC="$(TARGET_CROSS)cc" CXX="$(TARGET_CROSS)c++" CPPFLAGS="$(LIBDRM_EXAMPLES_CPPFLAGS)" CFLAGS="$(LIBDRM_EXAMPLES_CFLAGS)" CXXFLAGS="$(LIBDRM_EXAMPLES_CXXFLAGS)" LDFLAGS="$(LIBDRM_EXAMPLES_LDFLAGS)" drm-prime-multi; \
+$(MAKE) -f $(@D)/Makefile CC="$(TARGET_CROSS)cc" CXX="$(TARGET_CROSS)c++" CPPFLAGS="$(LIBDRM_EXAMPLES_CPPFLAGS)" CFLAGS="$(LIBDRM_EXAMPLES_CFLAGS)" CXXFLAGS="$(LIBDRM_EXAMPLES_CXXFLAGS)" LDFLAGS="$(LIBDRM_EXAMPLES_LDFLAGS)" $(LIBDRM_EXAMPLES_PROGRAMS); \
 popd;
 endef
 
 define LIBDRM_EXAMPLES_BUILD_CMDS
-$(call LIBDRM_EXAMPLES_BUILD_DRM_PRIME_MULTI)
+$(call LIBDRM_EXAMPLES_BUILD_PROGRAMS)
 endef
 
 define LIBDRM_EXAMPLES_INSTALL_STAGING_CMDS
@@ -63,7 +69,7 @@ define LIBDRM_EXAMPLES_INSTALL_STAGING_CMDS
 endef
 
 define LIBDRM_EXAMPLES_INSTALL_TARGET_CMDS
-[ -f $(@D)/.bin/drm-prime-multi ] && $(INSTALL) -D -m 755 $(@D)/.bin/drm-prime-multi $(TARGET_DIR)/usr/bin/drm-prime-multi
+$(foreach program,$(LIBDRM_EXAMPLES_PROGRAMS),[ -f $(@D)/.bin/$(program) ] && $(INSTALL) -D -m 755 $(@D)/.bin/$(program) $(TARGET_DIR)/usr/bin/$(program);)
 endef
 
 $(eval $(generic-package))
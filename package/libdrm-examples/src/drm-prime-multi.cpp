@@ -42,6 +42,12 @@ There is much room for improvement!
 #include <array>
 #include <functional>
 #include <atomic>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <fstream>
+#include <sstream>
 
 #ifdef __cplusplus
 extern "C" {
@@ -61,11 +67,21 @@ extern "C" {
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <linux/udmabuf.h>
+#include <linux/dma-buf.h>
 
 #ifdef __cplusplus
 }
 #endif
 
+#include "kms.h"
+
 template <class T>
 struct remove_pointer {
     typedef T type;
@@ -142,7 +158,6 @@ class DRM {
 
         using fb_id_t = remove_pointer < decltype (drmModeFB::fb_id) >::type;
         using crtc_id_t = remove_pointer < decltype (drmModeCrtc::crtc_id) >::type;
-        using enc_id_t = remove_pointer < decltype (drmModeEncoder::encoder_id) >::type;
         using conn_id_t = remove_pointer < decltype (drmModeConnector::connector_id) >::type;
 
         using width_t = remove_pointer < decltype (drmModeFB2::width) >::type;
@@ -160,7 +175,12 @@ class DRM {
         using x_t = remove_pointer < decltype (drmModeCrtc::x) >::type;
         using y_t = remove_pointer < decltype (drmModeCrtc::y) >::type;
 
-        using duration_t = remove_pointer < decltype (timespec::tv_sec) >::type;
+        using plane_id_t = remove_pointer < decltype (drmModePlane::plane_id) >::type;
+        using prop_id_t = remove_pointer < decltype (drmModePropertyRes::prop_id) >::type;
+        using blob_id_t = remove_pointer < decltype (drmModePropertyBlobRes::id) >::type;
+
+        // Framebuffer coordinates, origin top left
+        using rect_t = struct drm_mode_rect;
 
         static_assert (is_same < fb_id_t, remove_pointer < decltype (drmModeFB2::fb_id) >::type >::value != false);
 
@@ -174,7 +194,6 @@ class DRM {
 
         fb_id_t _fb;
         crtc_id_t _crtc;
-        enc_id_t _enc;
         conn_id_t _conn;
 
         width_t _width;
@@ -184,10 +203,103 @@ class DRM {
         x_t _x;
         y_t _y;
 
+        drmModeModeInfo _mode;
+
+        // Atomic mode setting is used, if available, to pass additional properties with a flip
+        bool _atomic;
+
+        // Primary plane of _crtc
+        plane_id_t _plane;
+
+        struct props {
+            prop_id_t _fb_id;
+            prop_id_t _crtc_id;
+
+            // Source, 16.16 fixed point
+            prop_id_t _src_x;
+            prop_id_t _src_y;
+            prop_id_t _src_w;
+            prop_id_t _src_h;
+
+            // Destination
+            prop_id_t _crtc_x;
+            prop_id_t _crtc_y;
+            prop_id_t _crtc_w;
+            prop_id_t _crtc_h;
+
+            // Optional
+            prop_id_t _damage;
+            prop_id_t _rotation;
+            prop_id_t _in_formats;
+            prop_id_t _zpos;
+        } _props;
+
+    public :
+
+        using props_t = decltype (_props);
+
+    private :
+
+        // Stacking order of the primary plane
+        uint64_t _zpos;
+
+        // Overlay and cursor planes usable with _crtc, ordered by zpos, bottom to top
+        struct plane {
+            plane_id_t _id;
+            uint64_t _type;
+            uint64_t _zpos;
+            props_t _props;
+
+            // Currently scanned out, and to be scanned out at the next flip
+            fb_id_t _fb;
+            fb_id_t _next;
+
+            // Of _next
+            width_t _width;
+            height_t _height;
+            rect_t _dst;
+            bool _reflect;
+        };
+
+        std::vector <struct plane> _planes;
+
+        // Framebuffer of a prime scanned out as is, with its layout and the outcome of its test commit
+        struct direct {
+            fb_id_t _fb;
+
+            width_t _width;
+            height_t _height;
+            pitch_t _pitch;
+            frmt_t _frmt;
+            modifier_t _modifier;
+
+            bool _reflect;
+            bool _accepted;
+
+            // Recency, the least recently scanned out is removed first
+            uint64_t _used;
+        };
+
+        // By the GEM handle of the prime's buffer on _fd, kept open while cached, a prime of the same buffer imports to the same handle
+        std::map <handle_t, struct direct> _direct;
+
+        uint64_t _scanouts;
+
+        // Of the most recent completed flip, as reported by the kernel
+        KMS::vblank_t _vblank;
+
+        // Of the most recent flip, zero on success, otherwise the errno
+        int _error;
+
         bool const _valid;
 
+        // Framebuffers, and page flips, see kms.h
+        KMS _kms;
+
     public :
 
+        using vblank_t = decltype (_vblank);
+
         using priv_t = decltype (_priv);
         using path_t = decltype (_path);
         using fd_t = decltype (_fd);
@@ -238,9 +350,16 @@ class DRM {
                     frmt_t _frmt;
                     modifier_t _modifier;
 
+                    // Plain memory, a memfd, instead of a dma-buf, for devices without dma-buf export
+                    bool _memory;
+
                     bool operator != (struct prime const & rhs) const { return /*_buf != rhs._buf || */ _fd != rhs._fd /* _width != InvalidWidth () || _height != InvalidHeight () */; }
                 } _prime;
 
+                // Buffer objects of CreatePrime, and whether they are in use, handed out again, in turn, once recycled
+                std::vector <std::pair <struct prime, bool>> _ring;
+                size_t _next;
+
                 width_t const _width;
                 height_t const _height;
                 stride_t _stride;
@@ -314,9 +433,21 @@ class DRM {
                 bool Lock ();
                 bool Unlock ();
 
+                // Falls back to a memfd of the same layout if the buffer cannot be exported as a dma-buf
+                // A buffer object of the ring that has been recycled is reused, only if there is none, one is allocated
                 bool CreatePrime ();
                 bool ImportPrime (prime_t const & prime);
                 bool DestroyPrime ();
+                // The buffer object of a prime of CreatePrime, or a duplicate, is no longer used by anyone
+                bool RecyclePrime (prime_t const & prime);
+
+                // The GEM handle is that of a buffer object of the ring, an import on the same fd shares it
+                bool Owns (uint32_t handle) const;
+
+                // Size of the (page aligned) memory backing a memfd prime
+                static size_t Size (prime_t const & prime);
+                // Wrap the memory of a memfd prime in a dma-buf, udmabuf, for zero-copy import, the caller owns fd
+                static bool DmaBuf (prime_t const & prime, fd_t & fd);
 
             private :
 
@@ -327,18 +458,38 @@ class DRM {
 
                 bool CreateBuffer ();
                 bool DestroyBuffer ();
+
+                bool CreateMemory ();
+        };
+
+        // A (client) buffer presented on a plane of its own
+        struct layer {
+            GBM::prime_t _prime;
+            // Destination on the screen
+            rect_t _dst;
+            // See ScanOut
+            bool _reflect;
         };
 
+        using layer_t = struct layer;
+
         DRM () = delete;
 // TODO: allow more GPUs
-        explicit DRM (bool priv = false) : _priv {priv}, _path {(_priv != true ? "/dev/dri/renderD128" : "/dev/dri/card1")}, _fd {InvalidFd ()}, _valid {Init ()}, _gbm {_fd, (_priv != false ? _width : DefaultWidth ()), (_priv != false ? _height : DefaultHeight ()), ColorFormat ()} {}
+        explicit DRM (bool priv = false, std::string const & path = std::string ()) : _priv {priv}, _path {(path.size () > 0 ? path : (_priv != true ? "/dev/dri/renderD128" : "/dev/dri/card1"))}, _fd {InvalidFd ()}, _scanouts {0}, _valid {Init ()}, _kms {_fd, (_priv != false ? KMS::modeset_t { _crtc, _conn, _mode } : KMS::InvalidModeSet ())}, _gbm {_fd, (_priv != false ? _width : DefaultWidth ()), (_priv != false ? _height : DefaultHeight ()), ColorFormat ()} {
+            // The planes KMS has set up for the CRTC
+            if (_valid != false && _priv != false && InitAtomic () != true) {
+                std::cout << "Atomic mode setting unavailable, using legacy page flips" << std::endl;
+            }
+        }
         ~DRM () { /* bool */ Deinit (); }
 
         static constexpr fd_t InvalidFd () { return GBM::InvalidFd (); }
         static constexpr fb_id_t  InvalidFb () { return  0; }
         static constexpr crtc_id_t InvalidCrtc () { return 0; }
-        static constexpr enc_id_t InvalidEncoder () { return 0; }
         static constexpr conn_id_t InvalidConnector () { return 0; }
+        static constexpr plane_id_t InvalidPlane () { return 0; }
+        static constexpr prop_id_t InvalidProperty () { return 0; }
+        static constexpr blob_id_t InvalidBlob () { return 0; }
 
         static constexpr width_t InvalidWidth () { return 0; }
         static constexpr height_t InvalidHeight () { return 0; }
@@ -357,8 +508,6 @@ class DRM {
         static_assert (_narrowing < decltype (DRM_FORMAT_MOD_LINEAR), frmt_t, true > :: value != false);
         static modifier_t FormatModifier () { return static_cast <modifier_t> (DRM_FORMAT_MOD_LINEAR); }
 
-        static constexpr duration_t FrameDurationMax () { return 1; }
-
         width_t const Width () { return _width; }
         height_t const height () { return _height; }
 // TODO: initialize at construction
@@ -368,10 +517,36 @@ class DRM {
 
         GBM /*const*/ & Get () { return _gbm; }
 
-        // Scan out the internal buffer
-        bool ScanOut ();
+        // Scan out the internal buffer, optionally, with the region that changed since the previous scan out
+        bool ScanOut (std::vector <rect_t> const & damage = std::vector <rect_t> ());
         // Scan out the specified buffer
-        bool ScanOut (GBM::buf_t & buf);
+        bool ScanOut (GBM::buf_t & buf, std::vector <rect_t> const & damage = std::vector <rect_t> ());
+        // Scan out a (client) buffer as is, without any composition, reflect to compensate for GL's bottom up rendering
+        // Only the buffer size is checked, the caller ensures the composited placement would be full screen as well
+        // Fails, without side effects, if the display hardware cannot present it
+        bool ScanOut (GBM::prime_t const & prime, bool reflect);
+
+        // Put the top most layers, last is top, on overlay planes, as far as the hardware accepts, for the next scan out
+        // The returned number of layers, counted from the top, do not need to be composited
+        size_t Assign (std::vector <layer_t> const & layers);
+        // Scan out the previously scanned out primary plane buffer with the current plane assignment
+        bool Present ();
+
+        // When the current scan out became visible, zero before the first flip
+        vblank_t const & VBlank () const { return _vblank; }
+
+        // The most recent flip failed but may succeed if retried, eg, the previous one had not completed yet
+        bool Recoverable () const { return _error == EBUSY || _error == EAGAIN || _error == EINTR; }
+
+        // Achieved intervals between completed flips
+        KMS::pacing_t const & Pacing () const { return _kms.Pacing (); }
+
+        // Of the mode, see KMS
+        KMS::duration_t FrameDuration () const { return _kms.FrameDuration (); }
+
+        // Variable refresh rate, if the sink supports it, a flip is presented as soon as it arrives
+        bool Adaptive (bool enable) { return _kms.Adaptive (enable); }
+        bool Adaptive () const { return _kms.Adaptive (); }
 
     private :
 
@@ -383,12 +558,46 @@ class DRM {
         bool Deinit ();
 
         bool ValidModeSet ();
+
+        bool InitAtomic ();
+
+        // All properties of a plane used with atomic commits, false if a mandatory one is missing
+        bool Properties (plane_id_t plane, props_t & props) const;
+
+        // Can the plane scan out buffers of this format and modifier
+        bool Supported (plane_id_t plane, props_t const & props, frmt_t format, modifier_t modifier) const;
+
+        // Full screen state of a plane
+        bool AddPlane (drmModeAtomicReqPtr req, plane_id_t plane, props_t const & props, fb_id_t fb, width_t width, height_t height, bool reflect) const;
+        // State of a plane with the buffer at a destination
+        bool AddPlane (drmModeAtomicReqPtr req, plane_id_t plane, props_t const & props, fb_id_t fb, width_t width, height_t height, rect_t const & dst, bool reflect) const;
+        // State of all overlay planes, according to the assignment
+        bool AddPlanes (drmModeAtomicReqPtr req) const;
+
+        // Would the primary plane with fb and the assigned overlay planes be accepted
+        bool Test (fb_id_t fb, width_t width, height_t height, bool reflect) const;
+
+        // Wrap a prime in a framebuffer
+        bool Framebuffer (GBM::prime_t const & prime, fb_id_t & fb);
+        // The cached framebuffer of a prime, and whether the primary plane accepts it without overlays, added, and tested, once per buffer and layout
+        bool Framebuffer (GBM::prime_t const & prime, bool reflect, fb_id_t & fb, bool & accepted);
+        // Remove a cached framebuffer, and its GEM handle
+        bool Evict (std::map <handle_t, struct direct>::iterator const & entry);
+        // Is fb owned by KMS, or by the cache of direct scan outs
+        bool Cached (fb_id_t fb) const;
+
+        // Primes of which the framebuffers are kept, eg, clients with triple buffering
+        static constexpr size_t DirectMax () { return 8; }
+
+        // Present fb, atomically if possible, and wait for completion
+        bool Flip (fb_id_t fb, width_t width, height_t height, std::vector <rect_t> const & damage, bool reflect = false);
 };
 
 class EGL {
     public :
 
-        static constexpr uint8_t _max_images = 2;
+        // Images are kept in slots, grown on demand, eg, one for every client
+        using index_t = uint8_t;
 
     private :
 
@@ -411,8 +620,11 @@ class EGL {
 //            static constexpr width_t InvalidWidth () { return DRM::GBM::InvalidWidth (); }
 //            static constexpr height_t InvalidHeight () { return DRM::GBM::InvalidHeight (); }
 
+            // Sibling texture of an image with uploaded content, see UploadBuffer
+            GLuint _tex;
+
             bool operator != (struct img const & rhs) const { return _khr != rhs._khr /*|| _width != rhs._width || _height != rhs._height */;}
-        }; std::array <struct img, _max_images> _img;
+        }; std::vector <struct img> _img;
 
         bool const _valid;
 
@@ -452,19 +664,37 @@ class EGL {
 //        static_assert (is_same <DRM::GBM::valid_t, valid_t>::value != false);
         valid_t Status () const { return _gbm.Status () && _valid; }
 
-        img_t const & Image (decltype (_max_images) index = 0) const { return _img [index]; };
+        img_t Image (index_t index = 0) const { return index < _img.size () ? _img [index] : InvalidImage (); };
 
-        bool ImportBuffer (DRM::GBM::prime_t const & prime, decltype (_max_images) index = 0);
-        bool ImportBuffer (DRM::GBM::buf_t const & buf, decltype (_max_images) index = 0);
+        bool ImportBuffer (DRM::GBM::prime_t const & prime, index_t index = 0);
+        bool ImportBuffer (DRM::GBM::buf_t const & buf, index_t index = 0);
+        // Last resort for memory that cannot be imported, a copy with a single glTexSubImage2D, read only
+        bool UploadBuffer (DRM::GBM::prime_t const & prime, index_t index = 0);
+
+        // Destroy the image of the slot, eg, its client has gone
+        bool ReleaseImage (index_t index);
 
         bool Render ();
 
-        static constexpr uint8_t _max_textures = EGL::_max_images;
+        // Age of the current back buffer, 0 if unknown, EGL_EXT_buffer_age
+        bool BufferAge (EGLint & age) const;
+
+        // Native fence, a sync_file, signaled once all GL commands issued so far have completed, EGL_ANDROID_native_fence_sync
+        // Without support, waits for completion instead, and the fence is invalid
+        bool Fence (DRM::GBM::fd_t & fence) const;
+        // Wait for, and consume, the fence, by the GPU if requested and possible, EGL_KHR_wait_sync, otherwise, by the CPU
+        bool WaitFence (DRM::GBM::fd_t & fence, bool gpu) const;
 
     private :
 
         bool Clear ();
 
+        // Make the slot available
+        bool Reserve (index_t index);
+
+        // Of the destroyed image, if any
+        static void DeleteTexture (struct img & img);
+
         bool Init ();
         bool Deinit ();
 };
@@ -475,14 +705,12 @@ class GLES {
         // x, y, z
         static constexpr uint8_t VerticeDimensions = 3;
 
-        static constexpr decltype (EGL::_max_images) _max_textures = EGL::_max_images;
-
     private:
 
         GLenum const _tgt;
         GLuint _fbo;
-// TODO: possibly same number as number of EGL images
-        std::array <GLuint, _max_textures> _tex;
+        // One for every EGL image slot, grown on demand
+        std::vector <GLuint> _tex;
 
         struct offset {
             using coordinate_t = GLfloat;
@@ -494,7 +722,7 @@ class GLES {
             static_assert (_narrowing <float, coordinate_t, true> :: value != false);
             offset () : offset (0.0f, 0.0f, 0.0f) {}
             offset (coordinate_t x, coordinate_t y, coordinate_t z) : _x {x}, _y {y}, _z {z} {}
-        } _offset;
+        }; std::vector <struct offset> _offset;
 
         struct scale {
             using fraction_t = GLclampf;
@@ -505,7 +733,23 @@ class GLES {
             static_assert (_narrowing <float, fraction_t, true> :: value != false);
             scale () : scale (1.0f, 1.0f) {};
             scale (fraction_t horiz, fraction_t vert) : _horiz {horiz}, _vert {vert} {}
-        } _scale;
+        }; std::vector <struct scale> _scale;
+
+        // Window coordinates, origin bottom left
+        struct rect {
+            GLint _x;
+            GLint _y;
+            GLsizei _width;
+            GLsizei _height;
+        } _damage;
+
+        // Linked programs, keyed by shader sources and driver identity
+        std::map <std::string, GLuint> _programs;
+
+        // Vertex buffer objects, static geometry is uploaded once at Init
+        enum class VBO : uint8_t { TILE = 0, TRIANGLE, DYNAMIC, COUNT };
+
+        std::array <GLuint, static_cast <size_t> (VBO::COUNT)> _vbo;
 
         bool const _valid;
 
@@ -515,8 +759,10 @@ class GLES {
         using fbo_t = decltype (_fbo);
         using tex_t = GLuint;
 
-        using offset_t = decltype (_offset);
-        using scale_t = decltype (_scale);
+        using offset_t = offset;
+        using scale_t = scale;
+
+        using rect_t = decltype (_damage);
 
         using valid_t = decltype (_valid);
 
@@ -533,19 +779,43 @@ class GLES {
 
 //        static constexpr fgt_t InvalidTgt () {...}
         static constexpr fbo_t InvalidFbo () { return 0; }
+        static constexpr GLuint InvalidVbo () { return 0; }
         static constexpr tex_t InvalidTex () { return 0; }
 
         valid_t Status () const { return _valid; }
 
         bool RenderTile ();
         bool RenderTriangle ();
-        bool RenderEGLImage (EGL::img_t const & img, decltype (_max_textures) index = 0);
+        bool RenderEGLImage (EGL::img_t const & img, EGL::index_t index = 0);
+        // All valid images, in order, in as few draw calls as texture units permit, each image at its own offset and scale
+        bool RenderEGLImages (std::vector <EGL::img_t> const & imgs);
+
+        // Delete the texture of the slot, eg, its client has gone
+        bool ReleaseTexture (EGL::index_t index);
         bool RenderColor (bool red = true, bool green = true, bool blue = true);
 
+        static constexpr rect_t InvalidRect () { return { 0, 0, 0, 0 }; }
+
+        static bool Empty (rect_t const & rect) { return rect._width <= 0 || rect._height <= 0; }
+        // Smallest rectangle enclosing both
+        static rect_t Union (rect_t const & lhs, rect_t const & rhs);
+        static rect_t Clip (rect_t const & rect, GLsizei width, GLsizei height);
+
+        // Region on a surface of width by height covered by the given region of the image of index rendered with RenderEGLImages
+        rect_t Project (rect_t const & rect, EGL::img_t const & img, EGL::index_t index, GLsizei width, GLsizei height) const;
+        // Region on a surface of width by height covered by the whole image of index
+        rect_t Placement (EGL::img_t const & img, EGL::index_t index, GLsizei width, GLsizei height) const;
+
+        // Restrict all subsequent drawing, including clears, to the given region
+        bool Scissor (rect_t const & rect);
+
+        // Region touched by the most recent RenderEGLImage
+        rect_t const & Damage () const { return _damage; }
+
         // Valus used at render stages of different objects
         static offset InitialOffset () { return offset (0.0f, 0.0f, 0.0f); }
-        bool UpdateOffset (offset_t const & off);
-        bool UpdateScale (scale_t const & scale);
+        bool UpdateOffset (offset_t const & off, EGL::index_t index = 0);
+        bool UpdateScale (scale_t const & scale, EGL::index_t index = 0);
 
     private:
 
@@ -556,8 +826,34 @@ class GLES {
 
         bool SetupProgram (char const vtx_src [], char const frag_src []);
 
-        template <size_t N>
-        bool RenderPolygon (std::array <GLfloat, N> const & vert);
+        // Dimensions of the current draw surface
+        static bool SurfaceSize (EGLint & width, EGLint & height);
+        // Compositor side, the surface of width by height with the given offset and scale applied
+        bool Viewport (EGLint width, EGLint height, offset_t const & off, scale_t const & scale) const;
+        // Window coordinate of a clip coordinate along a surface dimension of size, with the viewport of RenderEGLImages
+        static GLfloat Window (GLfloat clip, GLsizei size);
+        // The texture coordinates [0, 1] of the image of index span [offset, offset + scale] in clip coordinates, see RenderEGLImages
+        offset_t Offset (EGL::index_t index) const { return index < _offset.size () ? _offset [index] : InitialOffset (); }
+        scale_t Scale (EGL::index_t index) const { return index < _scale.size () ? _scale [index] : scale_t (); }
+        // (Re)attach the image to the texture of index, bound to the active texture unit
+        bool BindEGLImage (EGL::img_t const & img, EGL::index_t index);
+
+        // Make the slot available
+        bool Reserve (EGL::index_t index);
+
+        // Persistent program binaries, GL_OES_get_program_binary, survive restarts
+        static constexpr char const * ProgramCacheDir () { return "/var/cache/drm-prime-multi"; }
+        static std::string ProgramCachePath (std::string const & key);
+
+        bool LoadProgram (std::string const & key, GLuint & prog) const;
+        bool StoreProgram (std::string const & key, GLuint prog) const;
+
+        // Unit quad of RenderTile and triangle of RenderTriangle
+        static std::array <GLfloat, 4 * VerticeDimensions> const & TileVertices ();
+        static std::array <GLfloat, 3 * VerticeDimensions> const & TriangleVertices ();
+
+        // Draw count vertices of the buffer as a triangle strip
+        bool RenderPolygon (VBO vbo, GLsizei count);
 };
 
 class Base {
@@ -571,6 +867,9 @@ class Base {
 
         uint8_t const _id;
 
+        // Non-interactive; the number of frames to produce, 0 for interactive
+        uint32_t const _frames;
+
         bool const _valid;
 
     public :
@@ -579,13 +878,15 @@ class Base {
 
         using id_t = decltype (_id);
 
+        using frames_t = decltype (_frames);
+
         using valid_t = decltype (_valid);
 
     public :
 
         Base () = delete;
         // User responsible for unique id
-        explicit Base (sv_t const & sv, bool priv, id_t id) : _drm {priv}, _sv {sv},_egl {_drm.Get ()}, _id {id}, _valid {Init ()} {}
+        explicit Base (sv_t const & sv, bool priv, id_t id, std::string const & path = std::string (), frames_t frames = 0) : _drm {priv, path}, _sv {sv},_egl {_drm.Get ()}, _id {id}, _frames {frames}, _valid {Init ()} {}
         virtual ~Base () {/* bool */ Deinit ();} ;
 
 //        static_assert (is_same <DRM::GBM::valid_t, valid_t>::value != false);
@@ -597,7 +898,7 @@ class Base {
     protected :
 
 //TODO: enum
-        bool ShareBuffer (bool mode);
+        bool ShareBuffer (bool mode, sv_t sv);
 
         virtual bool Render () = 0;
 
@@ -611,8 +912,38 @@ class Base {
 
         bool ReadKey (std::string const & message, char & key);
 
-        bool Send (std::string const & msg, DRM::GBM::fd_t const & fd);
-        bool Receive (std::string & msg, DRM::GBM::fd_t & fd);
+        // Over the given channel
+        bool Send (sv_t sv, std::string const & msg, DRM::GBM::fd_t const & fd);
+        bool Receive (sv_t sv, std::string & msg, DRM::GBM::fd_t & fd);
+
+        // Region of the shared buffer that has been (re)rendered, sent after each frame, with the fence signaling its completion, if any
+        bool SendDamage (sv_t sv, GLES::rect_t const & damage, DRM::GBM::fd_t const & fence);
+        bool ReceiveDamage (sv_t sv, GLES::rect_t & damage, remove_const <id_t>::type & id, DRM::GBM::fd_t & fence);
+
+        // The frame last submitted by a client has been shown, the client may render its next one, see wl_surface.frame
+        bool SendPresented (sv_t sv, DRM::vblank_t const & vblank);
+        bool ReceivePresented (sv_t sv, DRM::vblank_t & vblank, remove_const <id_t>::type & id);
+
+        // Ownership of a shared buffer, from the client rendering into it, up to the compositor giving it up
+        // A replaced buffer is retired, it may still be on screen, or read by the GPU, until the flip that replaces it has completed
+        enum class OWNER : uint8_t { CLIENT = 0, SUBMITTED, COMPOSITION, SCANOUT, RETIRED, RELEASED, COUNT };
+
+        // Change the owner, with _VALIDATE illegal changes, eg, any use after release, are reported and refused
+        static bool Transition (OWNER & owner, OWNER to, std::string const & what);
+
+        // A client announces itself over the (shared) registration channel, with the end of a private channel of its own
+        bool SendRegistration (DRM::GBM::fd_t const & channel);
+        bool ReceiveRegistration (DRM::GBM::fd_t & channel, remove_const <id_t>::type & id);
+        // An external client, eg, libyxope, announces itself over a connection of its own, that is its channel
+        bool ReceiveRegistration (sv_t sv, remove_const <id_t>::type & id);
+
+        // An external client renders into buffers of its own, each is sent, as ShareBuffer, with a serial to identify it once it is released
+        bool ReceiveBuffer (sv_t sv, DRM::GBM::prime_t & prime, uint32_t & serial, remove_const <id_t>::type & id);
+        // The compositor no longer references the buffer of an external client, it may render into it again once the fence, if any, has signaled
+        bool SendReleased (sv_t sv, uint32_t serial, DRM::GBM::fd_t fence);
+
+        // Resident set size of the calling process in kB, 0 if unknown
+        static size_t Resident ();
 
     private :
 
@@ -629,6 +960,22 @@ class RenderClient : public Base {
 
         GLES _gles;
 
+        // Completed frames
+        uint32_t _count;
+
+        // Private channel to the compositor, the other end is handed over at registration
+        DRM::GBM::fd_t _channel;
+
+        // Of the shared buffer last received
+        OWNER _owner;
+
+        // Of the first and the most recent presented frame
+        DRM::vblank_t _first;
+        DRM::vblank_t _last;
+
+        // Frames the compositor has reported as presented
+        uint32_t _presented;
+
         bool const _valid;
 
     public :
@@ -638,7 +985,7 @@ class RenderClient : public Base {
 
         static_assert (is_same <DRM::priv_t, priv_t>::value != false);
         RenderClient () = delete;
-        explicit RenderClient (Base::sv_t const & sv, DRM::priv_t priv, Base::id_t id) : Base {sv, priv, id}, _priv {priv}, _gles {static_cast <GLES::tgt_t> (priv != true ? GL_TEXTURE_2D : GL_TEXTURE_EXTERNAL_OES)}, _valid{Init ()} {}
+        explicit RenderClient (Base::sv_t const & sv, DRM::priv_t priv, Base::id_t id, std::string const & path = std::string (), Base::frames_t frames = 0) : Base {sv, priv, id, path, frames}, _priv {priv}, _gles {static_cast <GLES::tgt_t> (priv != true ? GL_TEXTURE_2D : GL_TEXTURE_EXTERNAL_OES)}, _valid{Init ()} {}
         virtual ~RenderClient () { /* bool */ Deinit (); };
 
 //        static_assert (is_same <Base::valid_t, valid_t>::value != false);
@@ -654,12 +1001,21 @@ class RenderClient : public Base {
         bool Init ();
         bool Deinit ();
 
+        // Register with the compositor
+        bool Connect ();
+
         bool CreateRemoteBuffer ();
         bool DestroyRemoteBuffer ();
 
         bool ShareBuffer ();
 
         bool Render () override;
+
+        // Into plain memory by the CPU, if it cannot be rendered into by the GPU
+        bool RenderMemory (bool red, bool green, bool blue, GLES::rect_t & damage);
+
+        // Block until the frame just submitted has been shown, there is no point in rendering frames that are never shown
+        bool AwaitPresented ();
 };
 
 // TODO: Only one system wide, within this unit per construction
@@ -667,21 +1023,123 @@ class Compositor: public Base {
     private :
         bool const _priv;
 
+        // Request adaptive sync, ignored if the sink does not support it
+        bool const _adaptive;
+
         GLES _gles;
 
+        // Latest-frame (mailbox) semantics, one per client
+        // A client may submit faster than the display rate, only its newest frame is composited
+        // A shared buffer as submitted by a client
+        struct buffer {
+            // Owns its (duplicated) prime fd
+            DRM::GBM::prime_t _prime;
+            // Signaled once the client has finished rendering, invalid if none, or already waited for
+            DRM::GBM::fd_t _fence;
+
+            OWNER _owner;
+
+            // Of a buffer of an external client, sent back once released
+            uint32_t _serial;
+        };
+
+        static constexpr struct buffer InvalidBuffer () { return { DRM::GBM::InvalidPrime (), DRM::GBM::InvalidFd (), OWNER::RELEASED, 0 }; }
+
+        struct mailbox {
+            // Most recent submission not yet composited
+            struct buffer _pending;
+            // Submission being composited, or scanned out directly
+            struct buffer _current;
+            // Replaced submissions, released once the next flip has completed
+            std::vector <struct buffer> _retired;
+            // Region of the image changed since the last latched frame, image coordinates
+            GLES::rect_t _damage;
+
+            // Number of submissions that never reached the screen
+            uint32_t _superseded;
+            // Number of submissions that have been composited
+            uint32_t _latched;
+        };
+
+        // Clients register at any time, a slot is reused once its client has gone
+        struct slot {
+            // Private channel to the client, invalid for a free slot
+            DRM::GBM::fd_t _channel;
+            remove_const <Base::id_t>::type _id;
+
+            // Shared with, or received from an external, client, its damage has not arrived yet
+            struct buffer _shared;
+
+            struct mailbox _box;
+
+            // Presented on an overlay plane of its own in the previous frame
+            bool _overlay;
+
+            // Connected over the listening socket, it renders into buffers of its own instead of the shared buffer
+            bool _external;
+
+            // Its latest submission has not been on screen after a completed flip yet
+            bool _presenting;
+        };
+
+        // Indices are shared with the EGL images and GLES textures
+        std::vector <struct slot> _slots;
+
         bool const _valid;
 
     public :
 
-        static constexpr uint8_t _max_renderclients = 2;
-
         using priv_t = decltype (_priv);
         using valid_t = decltype (_valid);
 
         static_assert (is_same <DRM::priv_t, priv_t>::value != false);
 
+    private :
+
+        // Number of past frames whose damage is remembered, older back buffers are repainted in full
+        static constexpr uint8_t _max_buffer_age = 4;
+
+        // Damage of the most recent frames on the compositor surface, newest at _history_head
+        std::array <GLES::rect_t, _max_buffer_age> _history;
+        uint8_t _history_head;
+
+        // The previous frame has been scanned out without composition, or a client has gone, the compositor surface is stale
+        bool _bypass;
+
+        // Time spent per stage of a frame, reported for non-interactive runs
+        enum class STAGE : uint8_t { CREATE = 0, SHARE, AWAIT, RENDER, COUNT };
+
+        struct stage {
+            std::chrono::steady_clock::duration _total;
+            std::chrono::steady_clock::duration _max;
+        };
+
+        std::array <struct stage, static_cast <size_t> (STAGE::COUNT)> _stages;
+
+        // Completed frames
+        uint32_t _count;
+
+        // New clients may still register
+        bool _accepting;
+
+        // Resident memory, in kB, before any client has registered
+        size_t _resident;
+
+        // Of the socket external clients connect to, none if empty
+        std::string const _address;
+        DRM::GBM::fd_t _listen;
+
+        // Accepted external connections, non-blocking, that have not registered yet
+        std::vector <DRM::GBM::fd_t> _connecting;
+
+    public :
+
+        using mailbox_t = struct mailbox;
+        using slot_t = struct slot;
+        using index_t = EGL::index_t;
+
         Compositor () = delete;
-        explicit Compositor (Base::sv_t const & sv, bool priv, Base::id_t id = 0) : Base {sv, true, id}, _priv {priv}, _gles {GL_TEXTURE_EXTERNAL_OES}, _valid{Init ()} {}
+        explicit Compositor (Base::sv_t const & sv, bool priv, Base::id_t id = 0, std::string const & path = std::string (), Base::frames_t frames = 0, bool adaptive = false, std::string const & address = std::string ()) : Base {sv, true, id, path, frames}, _priv {priv}, _adaptive {adaptive}, _gles {GL_TEXTURE_EXTERNAL_OES}, _valid{Init ()}, _address {address} {}
         virtual ~Compositor () { /* bool */ Deinit (); }
 
 //        static_assert (is_same <Base::valid_t, valid_t>::value != false);
@@ -700,10 +1158,49 @@ class Compositor: public Base {
         bool CreateSharedBuffer ();
         bool DestroySharedBuffer ();
 
-        bool ShareBuffer ();
+        // The buffer just created to the client of the slot
+        bool ShareBuffer (index_t index);
+        // A new buffer to each client whose previous frame has been presented
+        bool ShareBuffers ();
 
+        // Of each frame, false if the run has ended
         bool AwaitRequestCreateSharingBuffer ();
-        bool AwaitRequestCompleteSharingBuffer ();
+        // Take the next message of a client whose channel is readable, a buffer, or the damage that completes its frame
+        bool AwaitRequestCompleteSharingBuffer (index_t index);
+
+        // Poll all clients, none is waited for on its own, and post what has arrived into their mailboxes
+        // Only waits, at most a frame period, if no frame is pending at all
+        bool Dispatch ();
+        // Any client has a frame that has not yet been composited
+        bool Pending () const;
+        // Any client waits for its frame to be presented
+        bool Presenting () const;
+
+        // Bind the socket external clients connect to, if an address is given
+        bool Listen ();
+        // Take on newly registered clients, possibly, wait for the first
+        bool Accept (bool block);
+        bool Register (DRM::GBM::fd_t channel, Base::id_t id, bool external = false);
+        // Free everything held for the client of the slot, and the slot itself
+        bool Unregister (index_t index);
+        // Number of clients registered
+        size_t Registered () const;
+
+        // Post a frame to the client's mailbox, the previous pending frame, if any, is superseded, the buffer, and its fence, are owned by the mailbox
+        bool Submit (struct buffer & buffer, GLES::rect_t const & damage, index_t index);
+        // Promote the newest pending frame, if any, to the one being composited, damage is empty if nothing changed
+        bool Latch (index_t index, GLES::rect_t & damage);
+        // Take the latched frame into use by GL, waited for by the GPU, or by a plane, waited for by the CPU
+        bool Acquire (index_t index, OWNER owner);
+        // Hand back a buffer that is no longer referenced by the compositor
+        bool Release (struct buffer & buffer, index_t index);
+        // Hand back all buffers replaced before the flip that has just completed
+        bool ReleaseRetired (index_t index);
+
+        // Run and account for a stage of a frame
+        bool Measure (STAGE stage, std::function <bool ()> const & func);
+        // Frame rate and per stage latency
+        void Statistics (std::chrono::steady_clock::duration const & elapsed) const;
 
         bool Render () override;
 };
@@ -722,7 +1219,7 @@ bool Base::Deinit () {
     return _ret;
 }
 
-bool Base::ShareBuffer (bool mode) {
+bool Base::ShareBuffer (bool mode, sv_t sv) {
     bool _ret = false;
 // TODO: define max size
     std::string _msg (255, '\0');
@@ -735,6 +1232,7 @@ bool Base::ShareBuffer (bool mode) {
     constexpr char _stride_tag [] = ";Stride:";
     constexpr char _format_tag [] = ";Format:";
     constexpr char _modifier_tag [] = ";Modifier:";
+    constexpr char _memory_tag [] = ";Memory:";
 
     constexpr uint8_t _id_count = length (_id_tag);
     constexpr uint8_t _width_count = length (_width_tag);
@@ -742,6 +1240,7 @@ bool Base::ShareBuffer (bool mode) {
     constexpr uint8_t _stride_count = length (_stride_tag);
     constexpr uint8_t _format_count = length (_format_tag);
     constexpr uint8_t _modifier_count = length (_modifier_tag);
+    constexpr uint8_t _memory_count = length (_memory_tag);
 
     if (mode != false) {
         // Privileged
@@ -762,11 +1261,12 @@ bool Base::ShareBuffer (bool mode) {
             std::string const _stride_s = std::to_string (_prime._stride);
             std::string const _format_s = std::to_string (_prime._frmt);
             std::string const _modifier_s = std::to_string (_prime._modifier);
+            std::string const _memory_s = std::to_string (_prime._memory != false ? 1 : 0);
 
 // TODO: total message size
 // TODO: more efficient message implementation
 
-            if (_id_s.size () != 0 && _width_s.size () > 0 && _height_s.size () > 0 && _stride_s.size () > 0 && _format_s.size () > 0 && _modifier_s.size () > 0) {
+            if (_id_s.size () != 0 && _width_s.size () > 0 && _height_s.size () > 0 && _stride_s.size () > 0 && _format_s.size () > 0 && _modifier_s.size () > 0 && _memory_s.size () > 0) {
                 // Client / compositor ID
                 _msg.replace (0, _id_count, _id_tag);
                 _msg.replace (_id_count, _id_s.size (), _id_s.c_str ());
@@ -791,7 +1291,11 @@ bool Base::ShareBuffer (bool mode) {
                 _msg.replace ((_id_count + _width_count + _height_count + _stride_count + _format_count) + _id_s.size () + _width_s.size () + _height_s.size () + _stride_s.size () + _format_s.size (), _modifier_count, _modifier_tag);
                 _msg.replace ((_id_count + _width_count + _height_count + _stride_count + _format_count + _modifier_count) + _id_s.size () + _width_s.size () + _height_s.size () + _stride_s.size () + _format_s.size (), _modifier_s.size (), _modifier_s.c_str ());
 
-                _ret = Send (_msg, _prime._fd);
+                // Memory, instead of a dma-buf
+                _msg.replace ((_id_count + _width_count + _height_count + _stride_count + _format_count + _modifier_count) + _id_s.size () + _width_s.size () + _height_s.size () + _stride_s.size () + _format_s.size () + _modifier_s.size (), _memory_count, _memory_tag);
+                _msg.replace ((_id_count + _width_count + _height_count + _stride_count + _format_count + _modifier_count + _memory_count) + _id_s.size () + _width_s.size () + _height_s.size () + _stride_s.size () + _format_s.size () + _modifier_s.size (), _memory_s.size (), _memory_s.c_str ());
+
+                _ret = Send (sv, _msg, _prime._fd);
             }
             else {
                 // Error
@@ -803,7 +1307,7 @@ bool Base::ShareBuffer (bool mode) {
         // Anything not being an invalid FD triggers the sharing of primes
         _prime._fd = ~DRM::GBM::InvalidFd ();
 
-        _ret = Receive (_msg, _prime._fd);
+        _ret = Receive (sv, _msg, _prime._fd);
 
         if (_ret != false) {
             size_t _id_p = _msg.find (_id_tag);
@@ -812,14 +1316,16 @@ bool Base::ShareBuffer (bool mode) {
             size_t _stride_p = _msg.find (_stride_tag);
             size_t _format_p = _msg.find (_format_tag);
             size_t _modifier_p = _msg.find (_modifier_tag);
+            size_t _memory_p = _msg.find (_memory_tag);
 
-            if (_id_p != std::string::npos && _width_p != std::string::npos && _height_p != std::string::npos && _stride_p != std::string::npos && _format_p != std::string::npos && _modifier_p != std::string::npos) {
+            if (_id_p != std::string::npos && _width_p != std::string::npos && _height_p != std::string::npos && _stride_p != std::string::npos && _format_p != std::string::npos && _modifier_p != std::string::npos && _memory_p != std::string::npos) {
                 std::string const _id_s = _msg.substr (_id_p + _id_count, _width_p - _id_p - _id_count);
                 std::string const _width_s = _msg.substr (_width_p + _width_count, _height_p - _width_p - _width_count);
                 std::string const _height_s = _msg.substr (_height_p + _height_count, _stride_p - _height_p - _height_count);
                 std::string const _stride_s = _msg.substr (_stride_p + _stride_count, _format_p - _stride_p - _stride_count );
                 std::string const _format_s = _msg.substr (_format_p + _format_count, _modifier_p - _format_p - _format_count);
-                std::string const _modifier_s = _msg.substr (_modifier_p + _modifier_count, std::string::npos);
+                std::string const _modifier_s = _msg.substr (_modifier_p + _modifier_count, _memory_p - _modifier_p - _modifier_count);
+                std::string const _memory_s = _msg.substr (_memory_p + _memory_count, std::string::npos);
 
                 // Client / compositor ID
                 long _val = std::atol (_id_s.c_str ());
@@ -846,10 +1352,23 @@ bool Base::ShareBuffer (bool mode) {
 // TODO: error condition coincides with DRM::GBM::InvalidFormat ();
                 _prime._modifier = _val;
 
+                /* long */ _val = std::atol (_memory_s.c_str ());
+                _prime._memory = _val != 0;
+
 // TODO: invalid dimensions
 // TODO: narrowing
 
-                _ret = _egl.ImportBuffer (_prime);
+                // Without udmabuf, plain memory is rendered into by the CPU, see RenderClient::Render
+                _ret =    _egl.ImportBuffer (_prime) != false
+                       || (_prime._memory != false && _egl.ReleaseImage (0) != false);
+
+                if (_ret != false) {
+                    // Kept, and closed, with the next one
+                    /* bool */ _drm.Get ().ImportPrime (_prime);
+                }
+                else {
+                    /* int */ close (_prime._fd);
+                }
             }
             else {
                 // Error
@@ -866,508 +1385,408 @@ bool Base::ShareBuffer (bool mode) {
     return _ret;
 }
 
-bool Base::ReadKey (std::string const & message, char& key) {
+bool Base::SendDamage (sv_t sv, GLES::rect_t const & damage, DRM::GBM::fd_t const & fence) {
     bool _ret = false;
 
-    if (message.size () > 0) {
-        std::cout << message << std::endl;
-    }
-    else {
-        std::cout << "Press key" << std::endl;
-    }
+    std::string _msg (Length (), '\0');
 
-    char _str [Length ()];
+    constexpr char _id_tag [] = "ID:";
+    constexpr char _damage_tag [] = ";Damage:";
+    constexpr char _sep = ',';
 
-    std::cin.getline (_str, Length (), Delim ());
+    std::string const _payload =   _id_tag + std::to_string (_id)
+                                 + _damage_tag + std::to_string (damage._x)
+                                 + _sep + std::to_string (damage._y)
+                                 + _sep + std::to_string (damage._width)
+                                 + _sep + std::to_string (damage._height);
 
-    switch (std::cin.rdstate ()) {
-        case        std::ios::goodbit   :
-                                            switch (std::cin.gcount ()) {
-                                                case    2   :
-                                                                key = _str [0];
-                                                                _ret = true;
-                                                                break;
-                                                default     :
-                                                                key = 0xD; // CR
-                                                                _ret = true;
-                                            }
-                                            break;
-        case        std::ios::eofbit    :;
-        case        std::ios::failbit   :;
-        case        std::ios::badbit    :;
-        default                         :
-                                            _ret = false;
-    }
+    // Fixed size messages, the receiving end reads exactly Length () bytes
+    if (_payload.size () < _msg.size ()) {
+        _msg.replace (0, _payload.size (), _payload);
 
-//    std::cin.clear( );
+        // The fence is duplicated in the receiving process
+        _ret = Send (sv, _msg, fence);
+    }
 
     return _ret;
 }
 
-bool Base::Send (std::string const & msg, DRM::GBM::fd_t const & fd) {
-    using fd_t = remove_reference < decltype (fd) >::type;
-
+bool Base::ReceiveDamage (sv_t sv, GLES::rect_t & damage, remove_const <id_t>::type & id, DRM::GBM::fd_t & fence) {
     bool _ret = false;
 
-    // Logical const
-    char * _buf  = const_cast <char *> ( & msg [0] );
-
-    size_t const _bufsize = msg.size ();
-
-    if (_bufsize > 0) {
+    std::string _msg (Length (), '\0');
 
-        // Scatter array for vector I/O
-        struct iovec _iov;
+    constexpr char _id_tag [] = "ID:";
+    constexpr char _damage_tag [] = ";Damage:";
 
-        // Starting address
-        _iov.iov_base = reinterpret_cast <void *> (_buf);
-        // Number of bytes to transfer
-        _iov.iov_len = _bufsize;
+    constexpr uint8_t _damage_count = length (_damage_tag);
 
-        // Actual message
-        struct msghdr _msgh = {0};
+    // Optional ancillary data
+    fence = ~DRM::GBM::InvalidFd ();
 
-        // Optional address
-        _msgh.msg_name = nullptr;
-        // Size of address
-        _msgh.msg_namelen = 0;
-        // Elements in msg_iov
-        _msgh.msg_iovlen = 1;
-        // Scatter array
-        _msgh.msg_iov = &_iov;
+    damage = GLES::InvalidRect ();
 
+    _ret = Receive (sv, _msg, fence);
 
-        // Ancillary data
-        // The macro returns the number of bytes an ancillary element with payload of the passed in data length, eg size of ancillary data to be sent
-        char _control [CMSG_SPACE (sizeof (fd_t))];
+    if (_ret != false) {
+        size_t _id_p = _msg.find (_id_tag);
+        size_t _damage_p = _msg.find (_damage_tag);
 
-        bool _valid = false;
+        _ret = _id_p != std::string::npos && _damage_p != std::string::npos;
 
-        if (fd != DRM::GBM::InvalidFd ()) {
-            // Contruct ancillary data to be added to the transfer via the control message
+        if (_ret != false) {
+            // Sender
+// TODO: narrowing
+            id = static_cast <remove_const <id_t>::type> (std::atol (_msg.substr (_id_p + length (_id_tag), _damage_p - _id_p - length (_id_tag)).c_str ()));
 
-            // Ancillary data, pointer
-            _msgh.msg_control = _control;
+            char const * _str = _msg.c_str () + _damage_p + _damage_count;
+            char * _end = nullptr;
 
-            // Ancillery data buffer length
-            _msgh.msg_controllen = sizeof ( _control );
+            std::array <long, 4> _val;
 
-            // Ancillary data should be access via cmsg macros
-            // https://linux.die.net/man/2/recvmsg
-            // https://linux.die.net/man/3/cmsg
-            // https://linux.die.net/man/2/setsockopt
-            // https://www.man7.org/linux/man-pages/man7/unix.7.html
+            for (auto & _v : _val) {
+                _v = std::strtol (_str, &_end, 10);
 
-            // Control message
+                _ret = _ret != false && _end != _str;
 
-            // Pointer to the first cmsghdr in the ancillary data buffer associated with the passed msgh
-            struct cmsghdr* _cmsgh = CMSG_FIRSTHDR (&_msgh);
+                // Skip the separator
+                _str = *_end != '\0' ? _end + 1 : _end;
+            }
 
-            if (_cmsgh != nullptr) {
-                // Originating protocol
-                // To manipulate options at the sockets API level
-                _cmsgh->cmsg_level = SOL_SOCKET;
+            if (_ret != false) {
+// TODO: narrowing
+                damage = { static_cast <GLint> (_val [0]), static_cast <GLint> (_val [1]), static_cast <GLsizei> (_val [2]), static_cast <GLsizei> (_val [3]) };
+            }
+        }
+    }
 
-                // Protocol specific type
-                // Option at the API level, send or receive a set of open file descriptors from another process
-                _cmsgh->cmsg_type = SCM_RIGHTS;
+    if (_ret != true && fence != DRM::GBM::InvalidFd ()) {
+        /* int */ close (fence);
 
-                // The value to store in the cmsg_len member of the cmsghdr structure, taking into account any necessary alignmen, eg byte count of control message including header
-                _cmsgh->cmsg_len = CMSG_LEN (sizeof (fd_t));
+        fence = DRM::GBM::InvalidFd ();
+    }
 
-                // Initialize the payload
-                // Pointer to the data portion of a cmsghdr, ie unsigned char []
-                * reinterpret_cast < fd_t * > ( CMSG_DATA (_cmsgh) ) = fd;
+    return _ret;
+}
 
-                _valid = true;
-            }
-            else {
-                // Error
-                _valid = false;
-            }
-        } else {
-            // No extra payload, ie  file descriptor(s), to include
-            _msgh.msg_control = nullptr;
-            _msgh.msg_controllen = 0;
+bool Base::SendPresented (sv_t sv, DRM::vblank_t const & vblank) {
+    bool _ret = false;
 
-            _valid = true;
-        }
+    std::string _msg (Length (), '\0');
 
-        ssize_t _size = -1;
+    constexpr char _id_tag [] = "ID:";
+    constexpr char _presented_tag [] = ";Presented:";
+    constexpr char _sep = ',';
 
-        if (_valid != false) {
-            // https://linux.die.net/man/2/sendmsg
-            // https://linux.die.net/man/2/write
-            // Zero flags is equivalent to write
-            _size = sendmsg (_sv, &_msgh, 0);
+    std::string const _payload =   _id_tag + std::to_string (_id)
+                                 + _presented_tag + std::to_string (vblank._sequence)
+                                 + _sep + std::to_string (vblank._timestamp);
 
-            if (_size < 0) {
-                // Error
-                std::cout << "Error: sendmsg (" << strerror (errno) << ")" << std::endl;
-            }
-        }
+    // Fixed size messages, the receiving end reads exactly Length () bytes
+    if (_payload.size () < _msg.size ()) {
+        _msg.replace (0, _payload.size (), _payload);
 
-        _ret = _size != -1;
+        _ret = Send (sv, _msg, DRM::GBM::InvalidFd ());
     }
 
     return _ret;
 }
 
-bool Base::Receive (std::string & msg, DRM::GBM::fd_t & fd) {
-    using fd_t = remove_reference < decltype (fd) >::type;
-
+bool Base::ReceivePresented (sv_t sv, DRM::vblank_t & vblank, remove_const <id_t>::type & id) {
     bool _ret = false;
 
-    // Logical const
-    char * _buf  = const_cast <char *> ( & msg [0]);
-    size_t const _bufsize = msg.size ();
-
-    if (_bufsize > 0) {
+    std::string _msg (Length (), '\0');
 
-        // Scatter array for vector I/O
-        struct iovec _iov;
+    constexpr char _id_tag [] = "ID:";
+    constexpr char _presented_tag [] = ";Presented:";
 
-        // Starting address
-        _iov.iov_base = reinterpret_cast <void *> (_buf);
-        // Number of bytes to transfer
-        _iov.iov_len = _bufsize;
+    // No ancillary data
+    DRM::GBM::fd_t _fd = DRM::GBM::InvalidFd ();
 
+    _ret = Receive (sv, _msg, _fd);
 
-        // Actual message
-        struct msghdr _msgh = {0};
+    if (_ret != false) {
+        size_t _id_p = _msg.find (_id_tag);
+        size_t _presented_p = _msg.find (_presented_tag);
 
-        // Optional address
-        _msgh.msg_name = nullptr;
-        // Size of address
-        _msgh.msg_namelen = 0;
-        // Elements in msg_iov
-        _msgh.msg_iovlen = 1;
-        // Scatter array
-        _msgh.msg_iov = &_iov;
+        _ret = _id_p != std::string::npos && _presented_p != std::string::npos;
 
-        // Ancillary data
-        // The macro returns the number of bytes an ancillary element with payload of the passed in data length, eg size of ancillary data to be sent
-        char _control [CMSG_SPACE (sizeof (fd_t))];
+        if (_ret != false) {
+            // Sender
+// TODO: narrowing
+            id = static_cast <remove_const <id_t>::type> (std::atol (_msg.substr (_id_p + length (_id_tag), _presented_p - _id_p - length (_id_tag)).c_str ()));
 
-        // Ancillary data, pointer
-        _msgh.msg_control = _control;
+            char const * _str = _msg.c_str () + _presented_p + length (_presented_tag);
+            char * _end = nullptr;
 
-        // Ancillery data buffer length
-        _msgh.msg_controllen = sizeof (_control);
+            unsigned long long const _sequence = std::strtoull (_str, &_end, 10);
 
+            _ret = _end != _str && *_end != '\0';
 
-        ssize_t _size = -1;
+            if (_ret != false) {
+                // Skip the separator
+                _str = _end + 1;
 
-        bool _valid = false;
+                unsigned long long const _timestamp = std::strtoull (_str, &_end, 10);
 
-        if (fd != DRM::GBM::InvalidFd ()) {
-            // Expecting message with extra paylod
+                _ret = _end != _str;
 
-            // No flags set
-            _size = recvmsg (_sv, &_msgh, 0);
+                if (_ret != false) {
+// TODO: narrowing
+                    vblank = { static_cast <uint32_t> (_sequence), static_cast <uint64_t> (_timestamp) };
+                }
+            }
+        }
+    }
 
-            if (_size >= 0) {
+    return _ret;
+}
 
-                // Pointer to the first cmsghdr in the ancillary data buffer associated with the passed msgh
-                struct cmsghdr* _cmsgh = CMSG_FIRSTHDR( &_msgh);
+bool Base::Transition (OWNER & owner, OWNER to, std::string const & what) {
+    bool _ret = true;
 
-                // Check for the expected properties the client should have set
+#ifdef _VALIDATE
+    constexpr size_t _count = static_cast <size_t> (OWNER::COUNT);
+
+    // From (row) to (column); client, submitted, composition, scan out, retired, released
+    constexpr bool _legal [_count][_count] = {
+        // Never submitted, eg, the client has gone
+        /* client */      { false, true,  false, false, false, true  },
+        // Superseded, never used
+        /* submitted */   { true,  false, true,  false, false, true  },
+        // In use, a release has to wait for the next flip
+        /* composition */ { false, false, true,  true,  true,  false },
+        /* scan out */    { false, false, true,  true,  true,  false },
+        /* retired */     { false, false, false, false, false, true  },
+        // Only a new buffer may follow
+        /* released */    { true,  false, false, false, false, false }
+    };
 
-                if (_cmsgh != nullptr) {
-                    _valid = true;
+    constexpr char const * _names [] = { "client", "submitted", "composition", "scan out", "retired", "released" };
 
-                    _valid = _cmsgh->cmsg_len == CMSG_LEN (sizeof (fd_t));
+    static_assert (sizeof (_names) / sizeof (_names [0]) == _count);
 
-                    if (_cmsgh->cmsg_level != SOL_SOCKET) {
-                        _valid = false;
-                    }
+    _ret = _legal [static_cast <size_t> (owner)][static_cast <size_t> (to)];
 
-                    if (_cmsgh->cmsg_type != SCM_RIGHTS) {
-                        _valid = false;
-                    }
+    if (_ret != true) {
+        std::cout << "Validation: " << what << " changes ownership from " << _names [static_cast <size_t> (owner)] << " to " << _names [static_cast <size_t> (to)] << (owner == OWNER::RELEASED ? ", use after release" : "") << std::endl;
+    }
+#else
+    static_cast <void> (what);
+#endif
 
-                    if (_valid != false) {
-                        // The macro returns a pointer to the data portion of a cmsghdr.
-                        fd = * reinterpret_cast < fd_t * > ( CMSG_DATA (_cmsgh) );
+    if (_ret != false) {
+        owner = to;
+    }
 
-                        _valid = true;
-                    }
-                    else {
-                        fd = DRM::GBM::InvalidFd ();
-                        _valid = false;
-                    }
-                }
-                else {
-                    _valid = false;
-                }
-            }
-            else {
-                // Error
-                std::cout << "Error: recvmsg (" << strerror (errno) << ")" << std::endl;
-            }
+    return _ret;
+}
 
-        }
-        else {
-            // Expecting just a regular message wihout payload
+bool Base::SendRegistration (DRM::GBM::fd_t const & channel) {
+    bool _ret = false;
 
-            _size = read (_sv, _buf, _bufsize);
+    std::string _msg (Length (), '\0');
 
-            if (_size < 0) {
-                // Error
-                std::cout << "Error: read (" << strerror (errno) << ")" << std::endl;
-            }
-            else {
-                _valid = true;
-            }
+    constexpr char _id_tag [] = "ID:";
+    constexpr char _register_tag [] = ";Register";
 
-        }
+    std::string const _payload = _id_tag + std::to_string (_id) + _register_tag;
 
-        if (_valid != true) {
-            _size = -1;
-        }
+    // Fixed size messages, the receiving end reads exactly Length () bytes
+    if (_payload.size () < _msg.size () && channel != DRM::GBM::InvalidFd ()) {
+        _msg.replace (0, _payload.size (), _payload);
 
-        _ret = _size != -1;
+        _ret = Send (_sv, _msg, channel);
     }
 
     return _ret;
 }
 
-bool Base::Clear () {
+bool Base::ReceiveRegistration (DRM::GBM::fd_t & channel, remove_const <id_t>::type & id) {
     bool _ret = false;
 
-    const_cast <remove_const <valid_t>::type &> (_valid) = false;
-
-    _ret = Status () != true;
+    std::string _msg (Length (), '\0');
 
-    return _ret;
-}
+    constexpr char _id_tag [] = "ID:";
+    constexpr char _register_tag [] = ";Register";
 
-bool DRM::Init () {
-    bool _ret = Clear () && drmAvailable () > 0;
+    // Anything not being an invalid FD triggers the sharing of the channel
+    channel = ~DRM::GBM::InvalidFd ();
 
-    if (_ret != false) {
-        _fd = (_path.size () > 0 ? open (_path.c_str () , O_RDWR) : InvalidFd ());
-    }
+    _ret = Receive (_sv, _msg, channel) != false && channel != DRM::GBM::InvalidFd ();
 
     if (_ret != false) {
-        _ret = _fd != InvalidFd ();
-    }
+        size_t _id_p = _msg.find (_id_tag);
+        size_t _register_p = _msg.find (_register_tag);
 
-    if (_ret != false) {
-        if (_priv != true) {
-            /* int */ drmDropMaster (_fd);
+        _ret = _id_p != std::string::npos && _register_p != std::string::npos;
 
-            _ret = true;
+        if (_ret != false) {
+// TODO: narrowing
+            id = static_cast <remove_const <id_t>::type> (std::atol (_msg.substr (_id_p + length (_id_tag), _register_p - _id_p - length (_id_tag)).c_str ()));
         }
         else {
-            /* int */ drmSetMaster (_fd);
-
-            _ret = ValidModeSet ();// && _gbm.Status ();;
+            /* int */ close (channel);
         }
     }
 
+    if (_ret != true) {
+        channel = DRM::GBM::InvalidFd ();
+    }
+
     return _ret;
 }
 
-bool DRM::Deinit () {
+bool Base::ReceiveRegistration (sv_t sv, remove_const <id_t>::type & id) {
     bool _ret = false;
 
-    if (_fd == InvalidFd ()) {
-        // Error
-        _ret = false;
-    }
-    else {
-// TODO: restore mode
-        _ret = close (_fd) == 0;
-    }
-
-    _ret = Clear () && _ret;
+    std::string _msg (Length (), '\0');
 
-    return _ret;
-}
+    constexpr char _id_tag [] = "ID:";
+    constexpr char _register_tag [] = ";Register";
 
-bool DRM::ScanOut () {
-    bool _ret = false;
+    // No ancillary data, the connection itself is the channel
+    DRM::GBM::fd_t _fd = DRM::GBM::InvalidFd ();
 
-    _ret = _gbm.Lock ();
+    _ret = Receive (sv, _msg, _fd);
 
     if (_ret != false) {
+        size_t _id_p = _msg.find (_id_tag);
+        size_t _register_p = _msg.find (_register_tag);
 
-        // Logical const
-        DRM::GBM::buf_t & _buf = const_cast <DRM::GBM::buf_t &> (_gbm.Buffer ());
+        _ret = _id_p != std::string::npos && _register_p != std::string::npos;
 
-        _ret = ScanOut (_buf);
-
-        /* bool */ _gbm.Unlock ();
+        if (_ret != false) {
+// TODO: narrowing
+            id = static_cast <remove_const <id_t>::type> (std::atol (_msg.substr (_id_p + length (_id_tag), _register_p - _id_p - length (_id_tag)).c_str ()));
+        }
     }
 
     return _ret;
 }
 
-bool DRM::ScanOut (DRM::GBM::buf_t & buf) {
+bool Base::ReceiveBuffer (sv_t sv, DRM::GBM::prime_t & prime, uint32_t & serial, remove_const <id_t>::type & id) {
     bool _ret = false;
 
-    if (_fd != DRM::InvalidFd () && buf != DRM::GBM::InvalidBuf ()) {
+    std::string _msg (Length (), '\0');
 
-        static_assert (is_same < DRM::width_t, DRM::GBM::width_t > :: value != false);
-        static_assert (is_same < DRM::height_t, DRM::GBM::height_t > :: value != false);
-        static_assert (is_same < DRM::frmt_t, DRM::GBM::frmt_t > :: value != false);
-        static_assert (is_same < DRM::handle_t, DRM::GBM::handle_t > :: value != false);
-        static_assert (is_same < DRM::modifier_t, DRM::GBM::modifier_t > :: value != false);
+    // As ShareBuffer, followed by the serial
+    constexpr std::array <char const *, 8> _tags = { "ID:", ";Width:", ";Height:", ";Stride:", ";Format:", ";Modifier:", ";Memory:", ";Serial:" };
 
-        // Possibly always failing
-        if (_narrowing <DRM::pitch_t, DRM::GBM::stride_t, true> :: value != false) {
-            std::cout << __FILE__ << " : " << __LINE__ << " : Possible narrowing detected." << std::endl;
-        }
+    prime = DRM::GBM::InvalidPrime ();
 
-// TODO correct place?
-        DRM::GBM::width_t _width = gbm_bo_get_width (buf);
-        DRM::GBM::height_t _height = gbm_bo_get_height (buf);
-        DRM::GBM::frmt_t _format = gbm_bo_get_format (buf);
-        DRM::GBM::handle_t _handle = gbm_bo_get_handle (buf).u32;
-        DRM::GBM::stride_t _stride = gbm_bo_get_stride (buf);
-        DRM::GBM::modifier_t _modifier = gbm_bo_get_modifier (buf);
+    // Anything not being an invalid FD triggers the sharing of primes
+    prime._fd = ~DRM::GBM::InvalidFd ();
 
-        if (_fb != DRM::InvalidFb ()) {
-// TODO: Do no remove the current FB before the FLIP otherwise EBUSY
-//            /* void */ drmModeRmFB (_fd, _fb);
-            _fb = DRM::InvalidFb ();
-        }
+    _ret = Receive (sv, _msg, prime._fd) != false && prime._fd != DRM::GBM::InvalidFd ();
 
-        fb_id_t _fb;
+    std::array <unsigned long long, _tags.size ()> _val;
 
-        static_assert (GBM_MAX_PLANES == 4);
-        DRM::handle_t const _handles [GBM_MAX_PLANES] = { static_cast < DRM::handle_t > (_handle), 0, 0, 0 };
-        DRM::pitch_t const _pitches [GBM_MAX_PLANES] = { static_cast < DRM::pitch_t > (_stride), 0, 0, 0 };
-        DRM::offset_t  const _offsets [GBM_MAX_PLANES] = { static_cast < DRM::offset_t > (0), 0, 0, 0 };
-        DRM::modifier_t const _modifiers [GBM_MAX_PLANES] = { static_cast < DRM::modifier_t > (_modifier), 0, 0, 0};
+    for (size_t _i = 0; _i < _tags.size () && _ret != false; _i++) {
+        size_t const _p = _msg.find (_tags [_i]);
 
-        // Possibly always failing
-        if (_narrowing <DRM::pitch_t, DRM::GBM::stride_t, true> :: value != false) {
-            std::cout << __FILE__ << " : " << __LINE__ << " : Possible narrowing detected." << std::endl;
-        }
+        char const * _str = _p != std::string::npos ? _msg.c_str () + _p + strlen (_tags [_i]) : nullptr;
+        char * _end = nullptr;
 
-        if (drmModeAddFB2WithModifiers (_fd, _width, _height, _format, &_handles [0], &_pitches [0], &_offsets [0], &_modifiers [0], &_fb, 0) == 0) {
-            static std::atomic <bool> _callback_data (true);
-            _callback_data = true;
+        _val [_i] = _str != nullptr ? std::strtoull (_str, &_end, 10) : 0;
 
-            int _err = drmModePageFlip (_fd, _crtc, _fb, DRM_MODE_PAGE_FLIP_EVENT, &_callback_data);
+        _ret = _str != nullptr && _end != _str;
+    }
+
+    if (_ret != false) {
+// TODO: narrowing
+        id = static_cast <remove_const <id_t>::type> (_val [0]);
 
-            switch (0 - _err) {
-                case 0      :   {
-                                    // Strictly speaking c++ linkage and not C linkage
-                                    auto handler = +[] (int fd, unsigned int frame, unsigned int sec, unsigned int usec, void* data) {
-                                        if (data != nullptr) {
-                                            decltype (_callback_data) * _data = reinterpret_cast <decltype (_callback_data) *> (data);
-                                            *_data = false;
-                                        }
-                                        else {
-                                            std::cout << "Error: invalid callback data" << std::endl;
-                                        }
-                                    };
+        prime._width = static_cast <DRM::GBM::width_t> (_val [1]);
+        prime._height = static_cast <DRM::GBM::height_t> (_val [2]);
+        prime._stride = static_cast <DRM::GBM::stride_t> (_val [3]);
+        prime._frmt = static_cast <DRM::GBM::frmt_t> (_val [4]);
+        prime._modifier = static_cast <DRM::GBM::modifier_t> (_val [5]);
+        prime._memory = _val [6] != 0;
 
-                                    // Use the magic constant here because the struct is versioned!
-                                    drmEventContext _context = { .version = 2, . vblank_handler = nullptr, .page_flip_handler = handler };
+        serial = static_cast <uint32_t> (_val [7]);
 
-                                    bool _waiting = _callback_data;
+        _ret =    prime._width != DRM::GBM::InvalidWidth ()
+               && prime._height != DRM::GBM::InvalidHeight ()
+               && prime._stride != DRM::GBM::InvalidStride ();
+    }
 
-                                    fd_set _fds;
+    if (_ret != true && prime._fd != DRM::GBM::InvalidFd ()) {
+        /* int */ close (prime._fd);
 
-                                    struct timespec _timeout = { .tv_sec = DRM::FrameDurationMax (), .tv_nsec = 0 };
-//TODO: guarantee at least the EVENTS are processes
-                                    while (_waiting != false) {
-                                        FD_ZERO (&_fds);
-                                        FD_SET (_fd, &_fds);
+        prime = DRM::GBM::InvalidPrime ();
+    }
 
-                                        _err  = pselect (_fd + 1, &_fds, nullptr, nullptr, &_timeout, nullptr);
+    return _ret;
+}
 
-                                        if (_err < 0) {
-                                                break;
-                                        }
-                                        else {
-                                            if (_err == 0) {
-                                                // Timeout; retry
-                                            }
-                                            else { // ret > 0
-                                                if (FD_ISSET (_fd, &_fds) != 0) {
-                                                    if (drmHandleEvent (_fd, &_context) != 0) {
-                                                        _ret = false;
-                                                        break;
-                                                    }
+bool Base::SendReleased (sv_t sv, uint32_t serial, DRM::GBM::fd_t fence) {
+    bool _ret = false;
 
-                                                    _ret = true;
+    std::string _msg (Length (), '\0');
 
-                                                    // Remove the previous frame buffer
+    constexpr char _id_tag [] = "ID:";
+    constexpr char _released_tag [] = ";Released:";
 
-                                                    // Possibly, the underlying buffer has already been removed
-                                                    if (DRM::_fb != DRM::InvalidFb ()) {
-                                                        /* void */ drmModeRmFB (_fd, DRM::_fb);
-                                                        DRM::_fb = DRM::InvalidFb ();
-                                                    }
+    std::string const _payload = _id_tag + std::to_string (_id) + _released_tag + std::to_string (serial);
 
-                                                }
-                                            }
-                                        }
+    // Fixed size messages, the receiving end reads exactly Length () bytes
+    if (_payload.size () < _msg.size ()) {
+        _msg.replace (0, _payload.size (), _payload);
 
-                                        _waiting = _callback_data;
-                                    }
+        // The fence is duplicated in the receiving process
+        _ret = Send (sv, _msg, fence);
+    }
 
-                                    break;
-                                }
-                case EINVAL :
-                                {   // Probably a missing drmModeSetCrtc or an invalid _crtc
-                                    // Likely to happens once or not at all
-                                    drmModeCrtcPtr _ptr = drmModeGetCrtc (_fd, _crtc);
+    return _ret;
+}
 
-                                    if (_ptr != nullptr) {
-                                        constexpr uint32_t _count = 1;
+size_t Base::Resident () {
+    size_t _ret = 0;
 
-                                        _ret = drmModeSetCrtc (_fd, _crtc, _fb, _ptr->x, _ptr->y, &_conn, _count, &_ptr->mode) == 0;
+    // Total program size and resident set size, in pages
+    std::ifstream _statm ("/proc/self/statm");
 
-                                        drmModeFreeCrtc (_ptr);
-                                    }
+    size_t _size = 0, _resident = 0;
 
-                                    break;
-                                }
-                case EBUSY  :
-                default     :
-                                {
-                                    // There is nothing to be done about it
-                                }
-            }
+    if (_statm >> _size >> _resident) {
+        long const _page = sysconf (_SC_PAGESIZE);
 
-            DRM::_fb = _fb;
-        }
-        else {
-            std::cout << "Error: scan out impossible" << std::endl;
-            _ret = false;
-        }
+        _ret = _page > 0 ? _resident * static_cast <size_t> (_page) / 1024 : 0;
     }
 
     return _ret;
 }
 
-bool DRM::Clear () {
-    bool _ret = false;
+bool Base::ReadKey (std::string const & message, char& key) {
+    bool _ret = KMS::ReadKey (message, key);
 
-//    _path.clear ();
+    return _ret;
+}
 
-    if (_priv != false ) {
-        _fd = InvalidFd ();
+bool Base::Send (sv_t sv, std::string const & msg, DRM::GBM::fd_t const & fd) {
+    static_assert (is_same < DRM::GBM::fd_t, KMS::fd_t >::value != false);
 
-        _fb = InvalidFb ();
-        _crtc = InvalidCrtc ();
-        _enc = InvalidEncoder ();
-        _conn = InvalidConnector ();
+    bool _ret =    msg.size () > 0
+                && KMS::SendFd (sv, & msg [0], msg.size (), fd) != -1;
 
-        _width = InvalidWidth ();
-        _height = InvalidHeight ();
-// TODO:
-//        _frmt = InvalidFrmt ();
+    return _ret;
+}
 
-//        _x = InvalidOffset ().X;
-//        _y = InvalidOffset ().Y;
-    }
+bool Base::Receive (sv_t sv, std::string & msg, DRM::GBM::fd_t & fd) {
+    // Logical const
+    char * _buf  = const_cast <char *> ( & msg [0]);
+    size_t const _bufsize = msg.size ();
+
+    // Expecting a message with extra payload only if fd is valid, zero if the peer has closed the channel
+    bool _ret =    _bufsize > 0
+                && KMS::ReceiveFd (sv, _buf, _bufsize, (fd != DRM::GBM::InvalidFd () ? &fd : nullptr)) > 0;
+
+    return _ret;
+}
+
+bool Base::Clear () {
+    bool _ret = false;
 
     const_cast <remove_const <valid_t>::type &> (_valid) = false;
 
@@ -1376,1369 +1795,4024 @@ bool DRM::Clear () {
     return _ret;
 }
 
-bool DRM::ValidModeSet () {
-    bool _ret = true;
+bool DRM::Init () {
+    bool _ret = Clear () && drmAvailable () > 0;
 
-    if (_fd != InvalidFd ()) {
-        drmModeResPtr _pres = drmModeGetResources (_fd);
+    if (_ret != false) {
+        _fd = (_path.size () > 0 ? open (_path.c_str () , O_RDWR) : InvalidFd ());
+    }
 
-        if (_pres != nullptr) {
-            using conn_count_t = remove_pointer < decltype (drmModeRes::count_connectors) >::type;
+    if (_ret != false) {
+        _ret = _fd != InvalidFd ();
+    }
 
-            for (conn_count_t i = 0; i < _pres->count_connectors; i++) {
-                // Do not probe
-                drmModeConnectorPtr _pcon = drmModeGetConnectorCurrent (_fd, _pres->connectors [i]);
+    if (_ret != false) {
+        if (_priv != true) {
+            /* int */ drmDropMaster (_fd);
 
-                if (_pcon != nullptr) {
-                    // Only consider HDMI
-                    if ( (_pcon->connector_type == DRM_MODE_CONNECTOR_HDMIA  || \
-                        _pcon->connector_type == DRM_MODE_CONNECTOR_HDMIB) && \
-                         DRM_MODE_CONNECTED == _pcon->connection) {
+            _ret = true;
+        }
+        else {
+            /* int */ drmSetMaster (_fd);
 
-                        // Encoder currently connected to
-                        drmModeEncoderPtr _penc = drmModeGetEncoder (_fd, _pcon->encoder_id);
+            _ret = ValidModeSet ();// && _gbm.Status ();;
+        }
+    }
 
-                        if (_penc != nullptr) {
-                            _crtc = _penc->crtc_id;
-                            _enc = _penc->encoder_id;
-                            _conn = _pcon->connector_id;
+    return _ret;
+}
 
-                            drmModeFreeEncoder (_penc);
-                        }
-                    }
+bool DRM::Deinit () {
+    bool _ret = false;
 
-                    drmModeFreeConnector (_pcon);
-                }
+    if (_fd == InvalidFd ()) {
+        // Error
+        _ret = false;
+    }
+    else {
+        while (_direct.empty () != true) {
+            _ret = Evict (_direct.begin ());
+        }
 
-                // For now, do not considerer multiple viable options
-                if (_crtc != InvalidCrtc () && _enc != InvalidEncoder () && _conn != InvalidConnector ()) {
+// TODO: restore mode
+        _ret = close (_fd) == 0;
+    }
 
-                    drmModeCrtcPtr _pcrtc = drmModeGetCrtc (_fd, _crtc);
+    _ret = Clear () && _ret;
 
-                    if (_pcrtc != nullptr) {
+    return _ret;
+}
 
-                        _fb = _pcrtc->buffer_id;
-                        _x = _pcrtc->x;
-                        _y = _pcrtc->y;
+bool DRM::ScanOut (std::vector <rect_t> const & damage) {
+    bool _ret = false;
 
-                        if (_fb != InvalidFb ()) {
-                            drmModeFB2Ptr _pfb2 = drmModeGetFB2 (_fd, _fb);
+    _ret = _gbm.Lock ();
 
-                            if (_pfb2 != nullptr) {
-                                _width = _pfb2->width;
-                                _height = _pfb2->height;
+    if (_ret != false) {
 
-                                // It is not guarantueed that pixel format matches DRM_FORMAT_ARGB888 or DRM_FORMAT_XRGB888, which are the only supported formats for GBM
-                                _frmt = _pfb2->pixel_format;
+        // Logical const
+        DRM::GBM::buf_t & _buf = const_cast <DRM::GBM::buf_t &> (_gbm.Buffer ());
 
-                                // Possibly no match with the only two options for GBM
-                                // VC4 supported formats
-                                // https://github.com/raspberrypi/linux/blob/rpi-<version>.y/drivers/gpu/drm/vc4/vc4_firmware_kms.c
-                                //
-                                // static_assert (_frmt != DRM::GBM::ColorFormat ());
+        _ret = ScanOut (_buf, damage);
 
-                                drmModeFreeFB2 (_pfb2);
-                            }
+        /* bool */ _gbm.Unlock ();
+    }
 
-                        }
+    return _ret;
+}
 
-                        drmModeFreeCrtc (_pcrtc);
-                    }
+bool DRM::ScanOut (DRM::GBM::buf_t & buf, std::vector <rect_t> const & damage) {
+    bool _ret = false;
 
-                    _ret = true;
+    if (_fd != DRM::InvalidFd () && buf != DRM::GBM::InvalidBuf ()) {
 
-                    break;
-                }
-            }
+        static_assert (is_same < DRM::width_t, DRM::GBM::width_t > :: value != false);
+        static_assert (is_same < DRM::height_t, DRM::GBM::height_t > :: value != false);
+        static_assert (is_same < DRM::frmt_t, DRM::GBM::frmt_t > :: value != false);
+        static_assert (is_same < DRM::handle_t, DRM::GBM::handle_t > :: value != false);
+        static_assert (is_same < DRM::modifier_t, DRM::GBM::modifier_t > :: value != false);
+
+        // Possibly always failing
+        if (_narrowing <DRM::pitch_t, DRM::GBM::stride_t, true> :: value != false) {
+            std::cout << __FILE__ << " : " << __LINE__ << " : Possible narrowing detected." << std::endl;
+        }
+
+        DRM::GBM::width_t _width = gbm_bo_get_width (buf);
+        DRM::GBM::height_t _height = gbm_bo_get_height (buf);
 
+        fb_id_t _fb = InvalidFb ();
+
+        // Buffer objects of the surface are recycled, their framebuffers are added once and removed with the buffer object
+        if (_kms.Framebuffer (buf, _fb) != false) {
+            _ret = Flip (_fb, _width, _height, damage);
         }
         else {
+            std::cout << "Error: scan out impossible" << std::endl;
             _ret = false;
         }
-
-        drmModeFreeResources (_pres);
     }
 
     return _ret;
 }
 
-bool DRM::GBM::Init () {
-    bool _ret = Clear ();
+bool DRM::ScanOut (DRM::GBM::prime_t const & prime, bool reflect) {
+    // Anything but a 1:1 full screen buffer requires composition
+    bool _ret =    _fd != InvalidFd ()
+                && _atomic != false
+                && prime._fd != DRM::GBM::InvalidFd ()
+                && prime._width == _width
+                && prime._height == _height
+                && Supported (_plane, _props, prime._frmt, prime._modifier) != false;
 
-    if (_ret != false) {
-        _dev = (_fd != DRM:: InvalidFd () ? gbm_create_device (_fd) : InvalidDev ());
+    fb_id_t _fb = InvalidFb ();
 
-        _ret = _dev != InvalidDev ();
-    }
+    bool _accepted = false;
 
     if (_ret != false) {
-        _ret = gbm_device_is_format_supported (_dev, _frmt, _flags) != 0;
+        // Only a new buffer, or layout, is added and tested, the driver decides without any effect on the screen
+        _ret =    Framebuffer (prime, reflect, _fb, _accepted) != false
+               && _accepted != false;
     }
 
     if (_ret != false) {
-        // It might work headless but lets keep clients similar in contructon as compositor
-        modifier_t _modifiers [1] = { DRM::FormatModifier () };
-        _surf = gbm_surface_create_with_modifiers (_dev, Width (), Height (), _frmt, &_modifiers [0], 1);
-
-// TODO: match EGL
-        _ret = _surf != InvalidSurf () && gbm_device_get_format_modifier_plane_count (_dev, _frmt, _modifiers [0]) == 1;
-    }
-
-    if (_ret != true) {
-        /* bool */ Deinit ();
+        // Everything changed
+        _ret = Flip (_fb, prime._width, prime._height, std::vector <rect_t> (), reflect);
     }
 
     return _ret;
 }
 
-bool DRM::GBM::Deinit () {
-    bool _ret = _dev != InvalidDev ();
+size_t DRM::Assign (std::vector <layer_t> const & layers) {
+    size_t _ret = 0;
 
-    if (_ret != false) {
-        if (_buf != InvalidBuf ()) {
-            gbm_bo_destroy (_buf);
+    // Undo any earlier assignment that has not been presented
+    for (auto & _overlay : _planes) {
+        if (_overlay._next != InvalidFb () && _overlay._next != _overlay._fb) {
+            /* int */ drmModeRmFB (_fd, _overlay._next);
         }
 
-        if (_surf != InvalidSurf ()) {
-            gbm_surface_destroy (_surf);
+        _overlay._next = InvalidFb ();
+    }
+
+    // Both are ordered bottom to top, a higher layer requires a higher plane
+    auto _overlay = _planes.rbegin ();
+
+    for (auto _layer = layers.rbegin (); _layer != layers.rend () && _overlay != _planes.rend () && _atomic != false && _fb != InvalidFb (); ++_layer) {
+        bool _placed = false;
+
+        fb_id_t _next = InvalidFb ();
+
+        if (Framebuffer (_layer->_prime, _next) != false) {
+            for (; _overlay != _planes.rend () && _placed != true; ++_overlay) {
+                if (Supported (_overlay->_id, _overlay->_props, _layer->_prime._frmt, _layer->_prime._modifier) != false) {
+                    _overlay->_next = _next;
+                    _overlay->_width = _layer->_prime._width;
+                    _overlay->_height = _layer->_prime._height;
+                    _overlay->_dst = _layer->_dst;
+                    _overlay->_reflect = _layer->_reflect;
+
+                    // All assigned so far on top of the current content of the primary plane
+                    _placed = Test (_fb, _width, _height, false);
+
+                    if (_placed != true) {
+                        _overlay->_next = InvalidFb ();
+                    }
+                }
+            }
+
+            if (_placed != true) {
+                /* int */ drmModeRmFB (_fd, _next);
+            }
         }
 
-        if (_dev != InvalidDev ()) {
-            gbm_device_destroy (_dev);
+        if (_placed != true) {
+            // Anything below has to be composited, too, to keep the stacking order
+            break;
         }
+
+        ++_ret;
     }
 
-    _ret = Clear () && _ret;
+    return _ret;
+}
+
+bool DRM::Present () {
+    // Only the overlay planes change, the primary plane has nothing to add
+    bool _ret = _fb != InvalidFb () && Flip (_fb, _width, _height, std::vector <rect_t> ());
 
     return _ret;
 }
 
-bool DRM::GBM::Lock () {
-    bool _ret = _surf != InvalidSurf () && _buf == InvalidBuf ();
+bool DRM::Framebuffer (DRM::GBM::prime_t const & prime, fb_id_t & fb) {
+    handle_t _handle = 0;
 
-// TODO keep trackk of _buf here so it does not get lost with unlock
+    bool _ret =    _fd != InvalidFd ()
+                && prime._fd != DRM::GBM::InvalidFd ()
+                && drmPrimeFDToHandle (_fd, prime._fd, &_handle) == 0;
 
     if (_ret != false) {
-        _buf = gbm_surface_lock_front_buffer (_surf);
+        DRM::handle_t const _handles [GBM_MAX_PLANES] = { _handle, 0, 0, 0 };
+        DRM::pitch_t const _pitches [GBM_MAX_PLANES] = { static_cast < DRM::pitch_t > (prime._stride), 0, 0, 0 };
+        DRM::offset_t  const _offsets [GBM_MAX_PLANES] = { static_cast < DRM::offset_t > (0), 0, 0, 0 };
+        DRM::modifier_t const _modifiers [GBM_MAX_PLANES] = { static_cast < DRM::modifier_t > (prime._modifier), 0, 0, 0};
 
-        _ret = _buf != InvalidBuf ();
+        bool const _explicit = prime._modifier != InvalidModifier ();
+
+        _ret = drmModeAddFB2WithModifiers (_fd, prime._width, prime._height, prime._frmt, &_handles [0], &_pitches [0], &_offsets [0], _explicit != false ? &_modifiers [0] : nullptr, &fb, _explicit != false ? DRM_MODE_FB_MODIFIERS : 0) == 0;
+
+        // The GEM handle equals that of any existing import on this fd, for example, the GBM buffer object that exported the prime, or a cached direct scan out
+        if (_gbm.Owns (_handle) != true && _direct.find (_handle) == _direct.end ()) {
+            // The framebuffer holds its own reference
+            struct drm_gem_close _close = { _handle, 0 };
+            /* int */ drmIoctl (_fd, DRM_IOCTL_GEM_CLOSE, &_close);
+        }
+    }
+
+    if (_ret != true) {
+        fb = InvalidFb ();
     }
 
     return _ret;
 }
 
-bool DRM::GBM::Unlock () {
-    bool _ret = _surf != InvalidSurf () && _buf != InvalidBuf ();
+bool DRM::Framebuffer (DRM::GBM::prime_t const & prime, bool reflect, fb_id_t & fb, bool & accepted) {
+    handle_t _handle = 0;
 
-    if (_ret != false) {
-        /* void */ gbm_surface_release_buffer (_surf, _buf);
+    bool _ret =    _fd != InvalidFd ()
+                && prime._fd != DRM::GBM::InvalidFd ()
+                && drmPrimeFDToHandle (_fd, prime._fd, &_handle) == 0;
 
-        _buf = InvalidBuf ();
+    auto _it = _ret != false ? _direct.find (_handle) : _direct.end ();
 
-        _ret = _buf != InvalidBuf ();
+    pitch_t const _pitch = static_cast <pitch_t> (prime._stride);
+
+    if (   _it != _direct.end ()
+        && (   _it->second._width != prime._width
+            || _it->second._height != prime._height
+            || _it->second._pitch != _pitch
+            || _it->second._frmt != prime._frmt
+            || _it->second._modifier != prime._modifier
+           )
+       ) {
+        // Same buffer, different layout, the framebuffer is added again, possibly, the old one is still on screen until the next flip
+        if (_it->second._fb != _fb) {
+            /* int */ drmModeRmFB (_fd, _it->second._fb);
+        }
+
+        _it->second._fb = InvalidFb ();
     }
 
-    return _ret;
-}
+    if (_ret != false && (_it == _direct.end () || _it->second._fb == InvalidFb ())) {
+        if (_it == _direct.end () && _direct.size () >= DirectMax ()) {
+            // Make room, never for the framebuffer on screen
+            auto _lru = _direct.end ();
 
-bool DRM::GBM::CreatePrime () {
-    bool _ret = _dev != InvalidDev ();
+            for (auto _entry = _direct.begin (); _entry != _direct.end (); _entry++) {
+                if (_entry->second._fb != _fb && (_lru == _direct.end () || _entry->second._used < _lru->second._used)) {
+                    _lru = _entry;
+                }
+            }
 
-    /* bool */ DestroyPrime ();
+            if (_lru != _direct.end ()) {
+                /* bool */ Evict (_lru);
+            }
+        }
 
-    _ret = CreateBuffer ();
+        handle_t const _handles [GBM_MAX_PLANES] = { _handle, 0, 0, 0 };
+        pitch_t const _pitches [GBM_MAX_PLANES] = { _pitch, 0, 0, 0 };
+        offset_t const _offsets [GBM_MAX_PLANES] = { static_cast < offset_t > (0), 0, 0, 0 };
+        modifier_t const _modifiers [GBM_MAX_PLANES] = { static_cast < modifier_t > (prime._modifier), 0, 0, 0};
 
-    if (_ret != false) {
-        _prime._fd = gbm_bo_get_fd (_prime._buf);
-        _prime._frmt = gbm_bo_get_format (_prime._buf);
-        _prime._modifier = gbm_bo_get_modifier (_prime._buf);
+        bool const _explicit = prime._modifier != InvalidModifier ();
 
-        _ret = _prime != InvalidPrime ();
+        fb_id_t _id = InvalidFb ();
 
-        if (_ret != true) {
-            /* bool */ DestroyBuffer ();
+        _ret = drmModeAddFB2WithModifiers (_fd, prime._width, prime._height, prime._frmt, &_handles [0], &_pitches [0], &_offsets [0], _explicit != false ? &_modifiers [0] : nullptr, &_id, _explicit != false ? DRM_MODE_FB_MODIFIERS : 0) == 0;
+
+        if (_ret != false) {
+            // Let the driver decide, without any effect on the screen, once
+            _direct [_handle] = { _id, prime._width, prime._height, _pitch, prime._frmt, prime._modifier, reflect, Test (_id, prime._width, prime._height, reflect), 0 };
+
+            _it = _direct.find (_handle);
+        }
+        else if (_it != _direct.end ()) {
+            // The stale entry still holds the handle
+            /* bool */ Evict (_it);
         }
+        else if (_gbm.Owns (_handle) != true) {
+            struct drm_gem_close _close = { _handle, 0 };
+            /* int */ drmIoctl (_fd, DRM_IOCTL_GEM_CLOSE, &_close);
+        }
+    }
+    else if (_ret != false && _it->second._reflect != reflect) {
+        // The plane state differs, so might the outcome
+        _it->second._reflect = reflect;
+        _it->second._accepted = Test (_it->second._fb, prime._width, prime._height, reflect);
+    }
+
+    if (_ret != false) {
+        _it->second._used = ++_scanouts;
+
+        fb = _it->second._fb;
+        accepted = _it->second._accepted;
+    }
+    else {
+        fb = InvalidFb ();
+        accepted = false;
     }
 
     return _ret;
 }
 
-bool DRM::GBM::ImportPrime (DRM::GBM::prime_t const & prime) {
-    bool _ret = prime != InvalidPrime ();
-
-    /* bool */ DestroyPrime ();
+bool DRM::Evict (std::map <handle_t, struct direct>::iterator const & entry) {
+    bool _ret = entry != _direct.end ();
 
     if (_ret != false) {
-        _prime = prime;
+        handle_t const _handle = entry->first;
+
+        if (entry->second._fb != InvalidFb ()) {
+            _ret = drmModeRmFB (_fd, entry->second._fb) == 0;
+        }
+
+        /* iterator */ _direct.erase (entry);
+
+        // Possibly, shared with the GBM buffer object that exported the prime
+        if (_gbm.Owns (_handle) != true) {
+            struct drm_gem_close _close = { _handle, 0 };
+            _ret = drmIoctl (_fd, DRM_IOCTL_GEM_CLOSE, &_close) == 0 && _ret;
+        }
     }
 
     return _ret;
 }
 
-bool DRM::GBM::DestroyPrime () {
-    bool _ret = _dev != InvalidDev () && _prime._fd != InvalidFd ();
-
-    if (_ret != false) {
-        _ret = close (_prime._fd) != -1;
-
-        _prime._fd = InvalidFd ();
-
-        /* bool */ DestroyBuffer ();
+bool DRM::Cached (fb_id_t fb) const {
+    bool _ret = _kms.Cached (fb);
 
-        _ret = true;
+    for (auto _it = _direct.begin (); _it != _direct.end () && _ret != true; _it++) {
+        _ret = _it->second._fb == fb;
     }
 
     return _ret;
 }
 
-bool DRM::GBM::Clear () {
-    bool _ret = false;
-
-    _dev = InvalidDev ();
-    _surf = InvalidSurf ();
-    _buf = InvalidBuf ();
-    _prime = InvalidPrime ();
-
-// TODO
-//    _stride = InvalidStride ();
-//    _frmt = InvalidFrtm ();
+bool DRM::Test (fb_id_t fb, width_t width, height_t height, bool reflect) const {
+    drmModeAtomicReqPtr _req = _atomic != false ? drmModeAtomicAlloc () : nullptr;
 
-    const_cast <remove_const <valid_t>::type &> (_valid) = false;
+    bool _ret =    AddPlane (_req, _plane, _props, fb, width, height, reflect) != false
+                && AddPlanes (_req) != false
+                && drmModeAtomicCommit (_fd, _req, DRM_MODE_ATOMIC_TEST_ONLY, nullptr) == 0;
 
-    _ret = Status () != true;
+    if (_req != nullptr) {
+        drmModeAtomicFree (_req);
+    }
 
     return _ret;
 }
 
-bool DRM::GBM::CreateBuffer () {
-    bool _ret = _dev != InvalidDev ();
+bool DRM::Flip (fb_id_t fb, width_t width, height_t height, std::vector <rect_t> const & damage, bool reflect) {
+    bool _ret = false;
 
-    if (_ret != false) {
+    // Committed, and waited for, by KMS, a flip is bounded by a few frames, not seconds
+    int _err = _kms.Flip ([&] (void * data) -> int {
+        int _err = 0;
 
-        modifier_t _modifiers [1] = { DRM::FormatModifier () };
-        _prime._buf = gbm_bo_create_with_modifiers (_dev, Width (), Height (), ColorFormat (), &_modifiers [0], 1);
+        if (_atomic != false) {
+            drmModeAtomicReqPtr _req = drmModeAtomicAlloc ();
 
-        if (_prime._buf != InvalidBuf ()) {
-            _prime._width = Width ();
-            _prime._height = Height ();
-            _prime._stride = Pitch (_prime._buf); 
-        }
+            blob_id_t _blob = InvalidBlob ();
 
-// TODO: match EGL
-        _ret = _prime._buf != InvalidBuf () && gbm_bo_get_plane_count (_prime._buf) == 1;
-    }
+            bool _valid = AddPlane (_req, _plane, _props, fb, width, height, reflect) && AddPlanes (_req);
 
-    return _ret;
-}
+            // Damage is a hint, without it the whole plane is considered updated
+            if (   _valid != false
+                && damage.size () > 0
+                && _props._damage != InvalidProperty ()
+                && drmModeCreatePropertyBlob (_fd, damage.data (), damage.size () * sizeof (rect_t), &_blob) == 0
+               ) {
+                _valid = drmModeAtomicAddProperty (_req, _plane, _props._damage, _blob) >= 0;
+            }
 
-bool DRM::GBM::DestroyBuffer () {
-    bool _ret = _dev != InvalidDev () && _prime._buf != InvalidBuf ();
+            _err = _valid != false ? drmModeAtomicCommit (_fd, _req, DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK, data) : -EINVAL;
 
-    if (_ret != false) {
-        /* void */ gbm_bo_destroy (_prime._buf); 
+            if (_blob != InvalidBlob ()) {
+                // The committed state holds its own reference
+                /* int */ drmModeDestroyPropertyBlob (_fd, _blob);
+            }
 
-        _prime._buf = InvalidBuf ();
+            if (_req != nullptr) {
+                drmModeAtomicFree (_req);
+            }
+        }
+        else {
+            _err = drmModePageFlip (_fd, _crtc, fb, DRM_MODE_PAGE_FLIP_EVENT, data);
+        }
 
-        _ret = true;
-    }
+        // Legacy returns -1 and sets errno
+        return _err == -1 ? -errno : _err;
+    });
 
-    return _ret;
-}
+    _error = 0 - _err;
 
-bool EGL::Init () {
-    bool _ret = Clear ();
+    switch (0 - _err) {
+        case ETIMEDOUT  :
+                        {
+                            // The event got lost, the flip has most likely taken place, KMS has realigned with the most recent vertical blank
+                            std::cout << "Error: flip timed out" << std::endl;
+                            // Fall through
+                        }
+        case 0      :   {
+                            _ret = true;
 
-// TODO: add extentions support
+                            for (auto & _overlay : _planes) {
+                                if (_overlay._fb != DRM::InvalidFb () && _overlay._fb != _overlay._next) {
+                                    /* void */ drmModeRmFB (_fd, _overlay._fb);
+                                }
 
-    if (_ret != false) {
-        if (_gbm.Device () != DRM::GBM::InvalidDev ()) {
-            _dpy = eglGetDisplay (_gbm.Device ());
-        }
+                                _overlay._fb = _overlay._next;
+                            }
 
-        if (_dpy == InvalidDisplay ()) {
-            // Error
-            std::cout << "Error: eglGetDisplay (0x" << std::hex << eglGetError () << ")" << std::endl;
+                            _vblank = _kms.VBlank ();
 
-            _ret = false;
-        }
-        else {
-            EGLint _major, _minor;
-            if (eglInitialize (_dpy, &_major, &_minor) != EGL_TRUE) {
-                // Error
-                std::cout << "Error: eglInitialize (0x" << std::hex << eglGetError () << ")" << std::endl;
-            }
+                            break;
+                        }
+        case EINVAL :
+                        {   // Probably a missing drmModeSetCrtc or an invalid _crtc
+                            // Likely to happens once or not at all
+                            drmModeCrtcPtr _ptr = drmModeGetCrtc (_fd, _crtc);
 
-            if (eglBindAPI (EGL_OPENGL_ES_API) != EGL_TRUE) {
-                // Error
-                std::cout << "Error: eglBindAPI (0x" << std::hex << eglGetError () << ")" << std::endl;
-            }
+                            if (_ptr != nullptr) {
+                                constexpr uint32_t _count = 1;
 
-            EGLint const _ecfg_attr [] = {
-                EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-                EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
-// TODO: obtain these magic constance from the actual pixel format
-                EGL_RED_SIZE, 8,
-                EGL_RED_SIZE, 8,
-                EGL_RED_SIZE, 8,
-                EGL_ALPHA_SIZE, 8,
-                EGL_BUFFER_SIZE, 32,
-                EGL_NONE
-            };
+                                // An inactive CRTC has no mode of its own, see ValidModeSet
+                                drmModeModeInfo _modeinfo = _ptr->mode_valid != 0 ? _ptr->mode : _mode;
 
-            EGLint _count = 1;
-            if (eglChooseConfig (_dpy, _ecfg_attr, &(_cfg), _count, &_count) != EGL_TRUE) {
-                // Error
-                std::cout << "Error: eglChooseConfig (0x" << std::hex << eglGetError () << ")" << std::endl;
-            }
+                                _ret = drmModeSetCrtc (_fd, _crtc, fb, _ptr->x, _ptr->y, &_conn, _count, &_modeinfo) == 0;
 
-            EGLint const _ectx_attr [] = {
-                EGL_CONTEXT_CLIENT_VERSION, 2,
-                EGL_NONE
-            };
+                                _error = _ret != false ? 0 : errno;
 
-            _ctx = eglCreateContext (_dpy, _cfg, EGL_NO_CONTEXT, _ectx_attr);
-            if (_ctx == InvalidContext ()) {
-                // Error
-                std::cout << "Error: eglCreateContex (0x" << std::hex << eglGetError () << ")" << std::endl;
-            }
+                                drmModeFreeCrtc (_ptr);
+                            }
 
-            _surf = eglCreateWindowSurface (_dpy, _cfg, reinterpret_cast <EGLNativeWindowType> (_gbm.Surface ()), nullptr);
-            if (_surf == InvalidSurface ()) {
-                // Error
-                std::cout << "Error: eglCreateWindowSurface (0x" << std::hex << eglGetError () << ")" << std::endl;
-            }
+                            break;
+                        }
+        case EBUSY  :
+        default     :
+                        {
+                            // There is nothing to be done about it
+                        }
+    }
 
-            EGLint _err = EGL_SUCCESS;
+    if (_ret != false) {
+        // Remove the previous frame buffer, possibly, the underlying buffer has already been removed, or is presented again, or is owned by KMS
+        if (_fb != DRM::InvalidFb () && _fb != fb && Cached (_fb) != true) {
+            /* int */ drmModeRmFB (_fd, _fb);
+        }
 
-            if (eglMakeCurrent (_dpy, _surf, _surf, _ctx) != EGL_TRUE) {
-                // Error
-                _err = eglGetError ();
-                std::cout << "Error: eglMakeCurrent (0x" << std::hex << _err << ")" << std::endl;
-            }
+        // Removed at the next completed flip
+        _fb = fb;
+    }
+    else if (fb != _fb && Cached (fb) != true) {
+        // Never scanned out, the previous one remains on screen
+        /* int */ drmModeRmFB (_fd, fb);
+    }
 
-            // Force an early allocation (of resources)
+    return _ret;
+}
 
-            // Fails if previous errors exist
-            if (/* _err == EGL_SUCCESS && */ eglSwapBuffers (_dpy, _surf) != EGL_TRUE) {
-                // Error
-                _err = eglGetError ();
-                std::cout << "Error: eglSwapBuffers (0x" << std::hex << _err << ")" << std::endl;
-            }
+bool DRM::AddPlane (drmModeAtomicReqPtr req, plane_id_t plane, props_t const & props, fb_id_t fb, width_t width, height_t height, bool reflect) const {
+    rect_t const _dst = { 0, 0, static_cast <int32_t> (_width), static_cast <int32_t> (_height) };
 
-            _ret = _err == EGL_SUCCESS;
+    bool _ret = AddPlane (req, plane, props, fb, width, height, _dst, reflect);
 
-        }
+    return _ret;
+}
 
-        if (_ret != true) {
-            /* bool */ Deinit ();
-            
-        }
+bool DRM::AddPlane (drmModeAtomicReqPtr req, plane_id_t plane, props_t const & props, fb_id_t fb, width_t width, height_t height, rect_t const & dst, bool reflect) const {
+    // Source coordinates are in 16.16 fixed point
+    bool _ret =    req != nullptr
+                && dst.x2 > dst.x1
+                && dst.y2 > dst.y1
+                && drmModeAtomicAddProperty (req, plane, props._fb_id, fb) >= 0
+                && drmModeAtomicAddProperty (req, plane, props._crtc_id, _crtc) >= 0
+                && drmModeAtomicAddProperty (req, plane, props._src_x, 0) >= 0
+                && drmModeAtomicAddProperty (req, plane, props._src_y, 0) >= 0
+                && drmModeAtomicAddProperty (req, plane, props._src_w, static_cast <uint64_t> (width) << 16) >= 0
+                && drmModeAtomicAddProperty (req, plane, props._src_h, static_cast <uint64_t> (height) << 16) >= 0
+                && drmModeAtomicAddProperty (req, plane, props._crtc_x, static_cast <uint64_t> (dst.x1)) >= 0
+                && drmModeAtomicAddProperty (req, plane, props._crtc_y, static_cast <uint64_t> (dst.y1)) >= 0
+                && drmModeAtomicAddProperty (req, plane, props._crtc_w, static_cast <uint64_t> (dst.x2 - dst.x1)) >= 0
+                && drmModeAtomicAddProperty (req, plane, props._crtc_h, static_cast <uint64_t> (dst.y2 - dst.y1)) >= 0;
+
+    if (_ret != false && reflect != false) {
+        // Without the property only the default orientation is possible
+        _ret =    props._rotation != InvalidProperty ()
+               && drmModeAtomicAddProperty (req, plane, props._rotation, DRM_MODE_ROTATE_0 | DRM_MODE_REFLECT_Y) >= 0;
+    }
+    else if (_ret != false && props._rotation != InvalidProperty ()) {
+        // Undo any reflection of a previous commit
+        _ret = drmModeAtomicAddProperty (req, plane, props._rotation, DRM_MODE_ROTATE_0) >= 0;
     }
 
     return _ret;
 }
 
-bool EGL::Deinit () {
-    bool _ret = false;
+bool DRM::AddPlanes (drmModeAtomicReqPtr req) const {
+    bool _ret = req != nullptr;
 
-    if (eglMakeCurrent (_dpy, InvalidSurface (), InvalidSurface (), _ctx) != EGL_TRUE) {
-        // Error
-        _ret = false;
-    }
+    for (auto const & _overlay : _planes) {
+        if (_ret != true) {
+            break;
+        }
 
-    if (eglTerminate (_dpy) != EGL_FALSE) {
-        // Error
-        _ret = false;
+        if (_overlay._next != InvalidFb ()) {
+            _ret = AddPlane (req, _overlay._id, _overlay._props, _overlay._next, _overlay._width, _overlay._height, _overlay._dst, _overlay._reflect);
+        }
+        else if (_overlay._fb != InvalidFb ()) {
+            // No longer in use, switch off
+            _ret =    drmModeAtomicAddProperty (req, _overlay._id, _overlay._props._fb_id, InvalidFb ()) >= 0
+                   && drmModeAtomicAddProperty (req, _overlay._id, _overlay._props._crtc_id, InvalidCrtc ()) >= 0;
+        }
     }
 
-    _ret = Clear () && _ret;
-
     return _ret;
 }
 
-bool EGL::ImportBuffer (DRM::GBM::buf_t const & buf, decltype (_max_images) index) {
+bool DRM::Clear () {
     bool _ret = false;
 
-    if (index < _max_images) {
-
-    if (buf != DRM::GBM::InvalidBuf ()) {
+//    _path.clear ();
 
-        using img_t = struct img &; img_t _img = EGL::_img [index];
+    if (_priv != false ) {
+        _fd = InvalidFd ();
 
-        if (_img != EGL::InvalidImage ()) {
-            static EGLBoolean (* _eglDestroyImageKHR) (EGLDisplay, EGLImageKHR) = reinterpret_cast < EGLBoolean (*) (EGLDisplay, EGLImageKHR) > (eglGetProcAddress ("eglDestroyImageKHR"));
+        _fb = InvalidFb ();
+        _crtc = InvalidCrtc ();
+        _conn = InvalidConnector ();
 
-            if (_eglDestroyImageKHR != nullptr) {
-                /*EGLBoolean*/ _eglDestroyImageKHR (_dpy, _img._khr);
-                _img = EGL::InvalidImage ();
-            }
-        }
+        _width = InvalidWidth ();
+        _height = InvalidHeight ();
+// TODO:
+//        _frmt = InvalidFrmt ();
 
-        _img._width = DRM::GBM::Width (buf);
-        _img._height = DRM::GBM::Height (buf);
+        _mode = drmModeModeInfo ();
 
-        // Possible narrowing
-        if (_narrowing < decltype (_img._width), EGLint, true> :: value
-         && _narrowing < decltype (_img._height), EGLint, true> :: value) {
-            // Narrowing detectedd
-            std::cout << __FILE__ << " : " << __LINE__ << " : Possible narrowing detected." << std::endl;
-        }
+        _atomic = false;
+        _plane = InvalidPlane ();
 
-        EGLint _attrs [] = {
-            EGL_WIDTH, static_cast <EGLint> (_img._width),
-            EGL_HEIGHT, static_cast <EGLint> (_img._height),
-            EGL_IMAGE_PRESERVED_KHR, static_cast <EGLint> (EGL_TRUE),
-            EGL_NONE
-        };
+        static_assert (InvalidProperty () == 0);
+        _props = props_t ();
 
-        static EGLImageKHR (* _eglCreateImageKHR) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) = reinterpret_cast < EGLImageKHR (*) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) > (eglGetProcAddress ("eglCreateImageKHR"));
+        _zpos = 0;
 
-        if (_eglCreateImageKHR != nullptr) {
-            _img._khr = _eglCreateImageKHR (_dpy, EGL_NO_CONTEXT, EGL_NATIVE_PIXMAP_KHR, buf, _attrs);
-        }
+        _planes.clear ();
 
-        _ret = _img != EGL::InvalidImage ();
+        // The framebuffers and handles are gone with _fd
+        _direct.clear ();
+        _scanouts = 0;
 
+//        _x = InvalidOffset ().X;
+//        _y = InvalidOffset ().Y;
     }
 
-    }
+    _vblank = { 0, 0 };
+
+    _error = 0;
+
+    const_cast <remove_const <valid_t>::type &> (_valid) = false;
+
+    _ret = Status () != true;
 
     return _ret;
 }
 
-bool EGL::ImportBuffer (DRM::GBM::prime_t const & prime, decltype (_max_images) index) {
-    bool _ret = false;
-
-    if (index < _max_images) {
+bool DRM::ValidModeSet () {
+    KMS::modeset_t _set = KMS::InvalidModeSet ();
 
-// TODO invalid dimension and color formats
+    // The first connected connector, the CRTC of its encoder and its current, or else, preferred mode
+    bool _ret = KMS::FindModeSet (_fd, _set);
 
-    // Destruction also done via ImportPrime
-    if (prime != DRM::GBM::InvalidPrime () /*&& DestroyPrime () */){
+    if (_ret != false) {
+        _crtc = _set._crtc;
+        _conn = _set._conn;
+        _mode = _set._mode;
 
-        using img_t = struct img &; img_t _img = EGL::_img [index];
+        drmModeCrtcPtr _pcrtc = drmModeGetCrtc (_fd, _crtc);
 
-        if (_img != EGL::InvalidImage ()) {
-            static EGLBoolean (* _eglDestroyImageKHR) (EGLDisplay, EGLImageKHR) = reinterpret_cast < EGLBoolean (*) (EGLDisplay, EGLImageKHR) > (eglGetProcAddress ("eglDestroyImageKHR"));
+        if (_pcrtc != nullptr) {
+            _fb = _pcrtc->buffer_id;
+            _x = _pcrtc->x;
+            _y = _pcrtc->y;
 
-            if (_eglDestroyImageKHR != nullptr) {
-                /*EGLBoolean*/ _eglDestroyImageKHR (_dpy, _img._khr);
-                _img = EGL::InvalidImage ();
-            }
+            drmModeFreeCrtc (_pcrtc);
         }
 
-        // Possible narrowing
-        if (_narrowing < decltype (prime._width), EGLint, true> :: value
-         && _narrowing < decltype (prime._height), EGLint, true> :: value
-         && _narrowing < decltype (prime._stride), EGLint, true> :: value
-         && _narrowing < decltype (prime._modifier), EGLuint64KHR, true> :: value
-         ) {
-            // Narrowing detectedd
-            std::cout << __FILE__ << " : " << __LINE__ << " : Possible narrowing detected." << std::endl;
+        if (_fb == InvalidFb () && _mode.hdisplay > 0 && _mode.vdisplay > 0) {
+            // Inactive CRTC, the mode is set at the first scan out
+            _width = _mode.hdisplay;
+            _height = _mode.vdisplay;
+            _frmt = ColorFormat ();
         }
 
-        EGLint _attrs [] = {
-            EGL_WIDTH,  static_cast <EGLint> (prime._width),
-            EGL_HEIGHT, static_cast <EGLint> (prime._height),
-            EGL_LINUX_DRM_FOURCC_EXT, static_cast <EGLint> (prime._frmt),
-            EGL_DMA_BUF_PLANE0_FD_EXT, static_cast <EGLint> (prime._fd),
-// TODO: magic constant ?
-            EGL_DMA_BUF_PLANE0_OFFSET_EXT, 0,
-            EGL_DMA_BUF_PLANE0_PITCH_EXT, static_cast <EGLint> (prime._stride),
-            EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, static_cast <EGLint> (prime._modifier & 0xFFFFFFFF),
-            EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT, static_cast <EGLint> (prime._modifier >> 32),
-            EGL_IMAGE_PRESERVED_KHR, static_cast <EGLint >(EGL_TRUE),
-            EGL_NONE
-        };
+        if (_fb != InvalidFb ()) {
+            drmModeFB2Ptr _pfb2 = drmModeGetFB2 (_fd, _fb);
 
-        static EGLImageKHR (* _eglCreateImageKHR) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) = reinterpret_cast < EGLImageKHR (*) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) > (eglGetProcAddress ("eglCreateImageKHR"));
+            if (_pfb2 != nullptr) {
+                _width = _pfb2->width;
+                _height = _pfb2->height;
 
-        if (_eglCreateImageKHR != nullptr) {
-            _img._khr = _eglCreateImageKHR (_dpy, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, 0, _attrs);
-            _img._width = prime._width;
-            _img._height = prime._height;
-        }
+                // It is not guarantueed that pixel format matches DRM_FORMAT_ARGB888 or DRM_FORMAT_XRGB888, which are the only supported formats for GBM
+                _frmt = _pfb2->pixel_format;
 
-        _ret = _img != EGL::InvalidImage ();
-    }
+                // Possibly no match with the only two options for GBM
+                // VC4 supported formats
+                // https://github.com/raspberrypi/linux/blob/rpi-<version>.y/drivers/gpu/drm/vc4/vc4_firmware_kms.c
+                //
+                // static_assert (_frmt != DRM::GBM::ColorFormat ());
 
+                drmModeFreeFB2 (_pfb2);
+            }
+        }
     }
 
     return _ret;
 }
 
-bool EGL::Render () {
-    bool _ret = false;
+bool DRM::InitAtomic () {
+    // KMS has enabled universal planes and atomic mode setting, and found the primary plane of the CRTC
+    bool _ret = _fd != InvalidFd () && _crtc != InvalidCrtc () && _kms.Atomic () != false && _kms.Plane () != KMS::InvalidPlane ();
+
+    _atomic = false;
+
+    _plane = _ret != false ? _kms.Plane () : InvalidPlane ();
+
+    // Planes refer to CRTCs by index
+    int _index = -1;
+
+    if (_ret != false) {
+        drmModeResPtr _pres = drmModeGetResources (_fd);
+
+        if (_pres != nullptr) {
+            for (int i = 0; i < _pres->count_crtcs; i++) {
+                if (_pres->crtcs [i] == _crtc) {
+                    _index = i;
+                    break;
+                }
+            }
+
+            drmModeFreeResources (_pres);
+        }
+
+        _ret = _index >= 0;
+    }
+
+    if (_ret != false) {
+        drmModePlaneResPtr _pres = drmModeGetPlaneResources (_fd);
+
+        if (_pres != nullptr) {
+            using plane_count_t = remove_pointer < decltype (drmModePlaneRes::count_planes) >::type;
+
+            for (plane_count_t i = 0; i < _pres->count_planes; i++) {
+                drmModePlanePtr _pplane = drmModeGetPlane (_fd, _pres->planes [i]);
+
+                if (_pplane != nullptr) {
+                    prop_id_t _id = InvalidProperty ();
+                    uint64_t _type = 0;
+
+                    if (   (_pplane->possible_crtcs & (1 << _index)) != 0
+                        && _kms.Property (_pplane->plane_id, DRM_MODE_OBJECT_PLANE, "type", _id, _type) != false
+                       ) {
+                        // Without zpos, overlays are above the primary, cursors above all
+                        uint64_t _zpos = _type == DRM_PLANE_TYPE_PRIMARY ? 0 : (_type == DRM_PLANE_TYPE_OVERLAY ? 1 : 2);
+                        uint64_t _value = 0;
+
+                        if (_kms.Property (_pplane->plane_id, DRM_MODE_OBJECT_PLANE, "zpos", _id, _value) != false) {
+                            _zpos = _value;
+                        }
+
+                        if (_pplane->plane_id == _plane) {
+                            DRM::_zpos = _zpos;
+                        }
+                        else if (_type == DRM_PLANE_TYPE_OVERLAY || _type == DRM_PLANE_TYPE_CURSOR) {
+                            struct plane _overlay = { _pplane->plane_id, _type, _zpos, props_t (), InvalidFb (), InvalidFb (), InvalidWidth (), InvalidHeight (), { 0, 0, 0, 0 }, false };
+
+                            if (Properties (_overlay._id, _overlay._props) != false) {
+                                std::cout << "Plane [" << _overlay._id << "] of type " << (_type == DRM_PLANE_TYPE_OVERLAY ? "overlay" : "cursor") << " at zpos " << _zpos << " supports " << _pplane->count_formats << " format(s)" << (_overlay._props._in_formats != InvalidProperty () ? " with modifiers" : "") << std::endl;
+
+                                _planes.push_back (_overlay);
+                            }
+                        }
+                    }
+
+                    drmModeFreePlane (_pplane);
+                }
+            }
+
+            drmModeFreePlaneResources (_pres);
+        }
+    }
+
+    if (_ret != false) {
+        _ret = Properties (_plane, _props);
+    }
+
+    if (_ret != false) {
+        // Anything at or below the primary plane is hidden by it
+        auto _hidden = [this] (struct plane const & plane) { return plane._zpos <= _zpos; };
+
+        _planes.erase (std::remove_if (_planes.begin (), _planes.end (), _hidden), _planes.end ());
+
+        std::stable_sort (_planes.begin (), _planes.end (), [] (struct plane const & lhs, struct plane const & rhs) { return lhs._zpos < rhs._zpos; });
+    }
+    else {
+        _planes.clear ();
+    }
+
+    _atomic = _ret;
+
+    return _ret;
+}
+
+bool DRM::Properties (plane_id_t plane, props_t & props) const {
+    uint64_t _value = 0;
+
+    bool _ret =    _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "FB_ID", props._fb_id, _value) != false
+                && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "CRTC_ID", props._crtc_id, _value) != false
+                && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "SRC_X", props._src_x, _value) != false
+                && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "SRC_Y", props._src_y, _value) != false
+                && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "SRC_W", props._src_w, _value) != false
+                && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "SRC_H", props._src_h, _value) != false
+                && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "CRTC_X", props._crtc_x, _value) != false
+                && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "CRTC_Y", props._crtc_y, _value) != false
+                && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "CRTC_W", props._crtc_w, _value) != false
+                && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "CRTC_H", props._crtc_h, _value) != false;
+
+    if (_kms.Property (plane, DRM_MODE_OBJECT_PLANE, "FB_DAMAGE_CLIPS", props._damage, _value) != true) {
+        props._damage = InvalidProperty ();
+    }
+
+    if (_kms.Property (plane, DRM_MODE_OBJECT_PLANE, "rotation", props._rotation, _value) != true) {
+        props._rotation = InvalidProperty ();
+    }
+
+    if (_kms.Property (plane, DRM_MODE_OBJECT_PLANE, "IN_FORMATS", props._in_formats, _value) != true) {
+        props._in_formats = InvalidProperty ();
+    }
+
+    if (_kms.Property (plane, DRM_MODE_OBJECT_PLANE, "zpos", props._zpos, _value) != true) {
+        props._zpos = InvalidProperty ();
+    }
+
+    return _ret;
+}
+
+bool DRM::Supported (plane_id_t plane, props_t const & props, frmt_t format, modifier_t modifier) const {
+    bool _ret = false;
+
+    drmModePlanePtr _pplane = _fd != InvalidFd () ? drmModeGetPlane (_fd, plane) : nullptr;
+
+    if (_pplane != nullptr) {
+        for (decltype (_pplane->count_formats) i = 0; i < _pplane->count_formats && _ret != true; i++) {
+            _ret = _pplane->formats [i] == format;
+        }
+
+        drmModeFreePlane (_pplane);
+    }
+
+    uint64_t _value = InvalidBlob ();
+    prop_id_t _id = InvalidProperty ();
+
+    if (   _ret != false
+        && props._in_formats != InvalidProperty ()
+        && _kms.Property (plane, DRM_MODE_OBJECT_PLANE, "IN_FORMATS", _id, _value) != false
+       ) {
+        // Format and modifier pairs, https://docs.kernel.org/gpu/drm-kms.html#standard-plane-properties
+        drmModePropertyBlobPtr _pblob = drmModeGetPropertyBlob (_fd, static_cast <blob_id_t> (_value));
+
+        _ret = false;
+
+        if (_pblob != nullptr) {
+            struct drm_format_modifier_blob const * _header = reinterpret_cast <struct drm_format_modifier_blob const *> (_pblob->data);
+
+            uint32_t const * _formats = reinterpret_cast <uint32_t const *> (reinterpret_cast <char const *> (_header) + _header->formats_offset);
+            struct drm_format_modifier const * _modifiers = reinterpret_cast <struct drm_format_modifier const *> (reinterpret_cast <char const *> (_header) + _header->modifiers_offset);
+
+            for (uint32_t i = 0; i < _header->count_formats && _ret != true; i++) {
+                if (_formats [i] == format) {
+                    for (uint32_t j = 0; j < _header->count_modifiers && _ret != true; j++) {
+                        // The bit mask covers 64 formats starting at offset
+                        _ret =    _modifiers [j].modifier == modifier
+                               && i >= _modifiers [j].offset
+                               && i < _modifiers [j].offset + 64
+                               && (_modifiers [j].formats & (static_cast <uint64_t> (1) << (i - _modifiers [j].offset))) != 0;
+                    }
+                }
+            }
+
+            drmModeFreePropertyBlob (_pblob);
+        }
+    }
+    else {
+        // Without IN_FORMATS only implicit or linear layouts can be assumed
+        _ret = _ret != false && (modifier == DRM_FORMAT_MOD_LINEAR || modifier == InvalidModifier ());
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::Init () {
+    bool _ret = Clear ();
+
+    if (_ret != false) {
+        _dev = (_fd != DRM:: InvalidFd () ? gbm_create_device (_fd) : InvalidDev ());
+
+        _ret = _dev != InvalidDev ();
+    }
+
+    if (_ret != false) {
+        _ret = gbm_device_is_format_supported (_dev, _frmt, _flags) != 0;
+    }
+
+    if (_ret != false) {
+        // It might work headless but lets keep clients similar in contructon as compositor
+        modifier_t _modifiers [1] = { DRM::FormatModifier () };
+        _surf = gbm_surface_create_with_modifiers (_dev, Width (), Height (), _frmt, &_modifiers [0], 1);
+
+// TODO: match EGL
+        _ret = _surf != InvalidSurf () && gbm_device_get_format_modifier_plane_count (_dev, _frmt, _modifiers [0]) == 1;
+    }
+
+    if (_ret != true) {
+        /* bool */ Deinit ();
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::Deinit () {
+    bool _ret = _dev != InvalidDev ();
+
+    if (_ret != false) {
+        if (_buf != InvalidBuf ()) {
+            gbm_bo_destroy (_buf);
+        }
+
+        for (auto & _entry : _ring) {
+            /* int */ close (_entry.first._fd);
+
+            gbm_bo_destroy (_entry.first._buf);
+        }
+
+        if (_surf != InvalidSurf ()) {
+            gbm_surface_destroy (_surf);
+        }
+
+        if (_dev != InvalidDev ()) {
+            gbm_device_destroy (_dev);
+        }
+    }
+
+    _ret = Clear () && _ret;
+
+    return _ret;
+}
+
+bool DRM::GBM::Lock () {
+    bool _ret = _surf != InvalidSurf () && _buf == InvalidBuf ();
+
+// TODO keep trackk of _buf here so it does not get lost with unlock
+
+    if (_ret != false) {
+        _buf = gbm_surface_lock_front_buffer (_surf);
+
+        _ret = _buf != InvalidBuf ();
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::Unlock () {
+    bool _ret = _surf != InvalidSurf () && _buf != InvalidBuf ();
+
+    if (_ret != false) {
+        /* void */ gbm_surface_release_buffer (_surf, _buf);
+
+        _buf = InvalidBuf ();
+
+        _ret = _buf != InvalidBuf ();
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::CreatePrime () {
+    bool _ret = _dev != InvalidDev ();
+
+    /* bool */ DestroyPrime ();
+
+    // In turn, the least recently handed out first
+    for (size_t _i = 0; _ret != false && _i < _ring.size () && _prime._fd == InvalidFd (); _i++) {
+        size_t const _index = (_next + _i) % _ring.size ();
+
+        if (_ring [_index].second != true) {
+            _ring [_index].second = true;
+
+            _prime = _ring [_index].first;
+
+            _next = _index + 1;
+        }
+    }
+
+    _ret = _ret != false && (_prime._fd != InvalidFd () || CreateBuffer () != false);
+
+    if (_ret != false && _prime._fd == InvalidFd ()) {
+        _prime._fd = gbm_bo_get_fd (_prime._buf);
+        _prime._frmt = gbm_bo_get_format (_prime._buf);
+        _prime._modifier = gbm_bo_get_modifier (_prime._buf);
+        _prime._memory = false;
+
+        _ret = _prime != InvalidPrime ();
+
+        if (_ret != true) {
+            /* bool */ DestroyBuffer ();
+        }
+        else {
+            // Owned by the ring from now on
+            _ring.push_back (std::make_pair (_prime, true));
+        }
+    }
+
+    if (_ret != true) {
+        // No dma-buf export, eg, a software only driver
+        _ret = CreateMemory ();
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::CreateMemory () {
+    bool _ret = _dev != InvalidDev ();
+
+    static bool _reported = false;
+
+    if (_ret != false && _reported != true) {
+        std::cout << "Warning: no dma-buf export, buffers are shared as plain memory" << std::endl;
+
+        _reported = true;
+    }
+
+    if (_ret != false) {
+        // Same layout as the linear buffer object, 4 bytes per pixel
+        _prime = { InvalidBuf (), InvalidFd (), Width (), Height (), static_cast <stride_t> (Width () * 4), ColorFormat (), DRM::FormatModifier (), true };
+
+        _prime._fd = memfd_create ("drm-prime-multi", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+        _ret = _prime._fd != InvalidFd ();
+    }
+
+    if (_ret != false) {
+        // udmabuf requires the size to be fixed
+        _ret =    ftruncate (_prime._fd, static_cast <off_t> (Size (_prime))) == 0
+               && fcntl (_prime._fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == 0;
+
+        if (_ret != true) {
+            std::cout << "Error: unable to create shared memory (" << strerror (errno) << ")" << std::endl;
+
+            /* int */ close (_prime._fd);
+        }
+    }
+
+    if (_ret != true) {
+        _prime = InvalidPrime ();
+    }
+
+    return _ret;
+}
+
+size_t DRM::GBM::Size (DRM::GBM::prime_t const & prime) {
+    static size_t const _page = static_cast <size_t> (sysconf (_SC_PAGESIZE));
+
+    size_t const _size = static_cast <size_t> (prime._stride) * static_cast <size_t> (prime._height);
+
+    return ((_size + _page - 1) / _page) * _page;
+}
+
+bool DRM::GBM::DmaBuf (DRM::GBM::prime_t const & prime, DRM::GBM::fd_t & fd) {
+    // Opened once, absent on most kernels without CONFIG_UDMABUF
+    static int const _dev = open ("/dev/udmabuf", O_RDWR | O_CLOEXEC);
+
+    bool _ret = _dev != InvalidFd () && prime._memory != false && prime._fd != InvalidFd ();
+
+    fd = InvalidFd ();
+
+    if (_ret != false) {
+        struct udmabuf_create _create = { static_cast <__u32> (prime._fd), UDMABUF_FLAGS_CLOEXEC, 0, static_cast <__u64> (Size (prime)) };
+
+        fd = ioctl (_dev, UDMABUF_CREATE, &_create);
+
+        _ret = fd != InvalidFd ();
+
+        if (_ret != true) {
+            fd = InvalidFd ();
+        }
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::ImportPrime (DRM::GBM::prime_t const & prime) {
+    bool _ret = prime != InvalidPrime ();
+
+    /* bool */ DestroyPrime ();
+
+    if (_ret != false) {
+        _prime = prime;
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::DestroyPrime () {
+    bool _ret = _dev != InvalidDev () && _prime._fd != InvalidFd ();
+
+    if (_ret != false && _prime._buf != InvalidBuf () && std::any_of (_ring.begin (), _ring.end (), [this] (std::pair <prime_t, bool> const & entry) { return entry.first._buf == _prime._buf; }) != false) {
+        // The ring keeps it until it has been recycled
+        _prime = InvalidPrime ();
+    }
+    else if (_ret != false) {
+        _ret = close (_prime._fd) != -1;
+
+        _prime._fd = InvalidFd ();
+        _prime._memory = false;
+
+        /* bool */ DestroyBuffer ();
+
+        _ret = true;
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::RecyclePrime (DRM::GBM::prime_t const & prime) {
+    auto _it = std::find_if (_ring.begin (), _ring.end (), [&prime] (std::pair <prime_t, bool> const & entry) { return prime._buf != InvalidBuf () && entry.first._buf == prime._buf; });
+
+    bool _ret = _it != _ring.end () && _it->second != false;
+
+    if (_ret != false) {
+        _it->second = false;
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::Owns (uint32_t handle) const {
+    bool _ret = std::any_of (_ring.begin (), _ring.end (), [handle] (std::pair <prime_t, bool> const & entry) { return gbm_bo_get_handle (entry.first._buf).u32 == handle; });
+
+    return _ret;
+}
+
+bool DRM::GBM::Clear () {
+    bool _ret = false;
+
+    _dev = InvalidDev ();
+    _surf = InvalidSurf ();
+    _buf = InvalidBuf ();
+    _prime = InvalidPrime ();
+
+    _ring.clear ();
+    _next = 0;
+
+// TODO
+//    _stride = InvalidStride ();
+//    _frmt = InvalidFrtm ();
+
+    const_cast <remove_const <valid_t>::type &> (_valid) = false;
+
+    _ret = Status () != true;
+
+    return _ret;
+}
+
+bool DRM::GBM::CreateBuffer () {
+    bool _ret = _dev != InvalidDev ();
+
+    if (_ret != false) {
+
+        modifier_t _modifiers [1] = { DRM::FormatModifier () };
+        _prime._buf = gbm_bo_create_with_modifiers (_dev, Width (), Height (), ColorFormat (), &_modifiers [0], 1);
+
+        if (_prime._buf != InvalidBuf ()) {
+            _prime._width = Width ();
+            _prime._height = Height ();
+            _prime._stride = Pitch (_prime._buf); 
+        }
+
+// TODO: match EGL
+        _ret = _prime._buf != InvalidBuf () && gbm_bo_get_plane_count (_prime._buf) == 1;
+    }
+
+    return _ret;
+}
+
+bool DRM::GBM::DestroyBuffer () {
+    bool _ret = _dev != InvalidDev () && _prime._buf != InvalidBuf ();
+
+    if (_ret != false) {
+        /* void */ gbm_bo_destroy (_prime._buf); 
+
+        _prime._buf = InvalidBuf ();
+
+        _ret = true;
+    }
+
+    return _ret;
+}
+
+bool EGL::Init () {
+    bool _ret = Clear ();
+
+// TODO: add extentions support
+
+    if (_ret != false) {
+        if (_gbm.Device () != DRM::GBM::InvalidDev ()) {
+            _dpy = eglGetDisplay (_gbm.Device ());
+        }
+
+        if (_dpy == InvalidDisplay ()) {
+            // Error
+            std::cout << "Error: eglGetDisplay (0x" << std::hex << eglGetError () << ")" << std::endl;
+
+            _ret = false;
+        }
+        else {
+            EGLint _major, _minor;
+            if (eglInitialize (_dpy, &_major, &_minor) != EGL_TRUE) {
+                // Error
+                std::cout << "Error: eglInitialize (0x" << std::hex << eglGetError () << ")" << std::endl;
+            }
+
+            if (eglBindAPI (EGL_OPENGL_ES_API) != EGL_TRUE) {
+                // Error
+                std::cout << "Error: eglBindAPI (0x" << std::hex << eglGetError () << ")" << std::endl;
+            }
+
+            EGLint const _ecfg_attr [] = {
+                EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+                EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+// TODO: obtain these magic constance from the actual pixel format
+                EGL_RED_SIZE, 8,
+                EGL_RED_SIZE, 8,
+                EGL_RED_SIZE, 8,
+                EGL_ALPHA_SIZE, 8,
+                EGL_BUFFER_SIZE, 32,
+                EGL_NONE
+            };
+
+            EGLint _count = 1;
+            if (eglChooseConfig (_dpy, _ecfg_attr, &(_cfg), _count, &_count) != EGL_TRUE) {
+                // Error
+                std::cout << "Error: eglChooseConfig (0x" << std::hex << eglGetError () << ")" << std::endl;
+            }
+
+            EGLint const _ectx_attr [] = {
+                EGL_CONTEXT_CLIENT_VERSION, 2,
+                EGL_NONE
+            };
+
+            _ctx = eglCreateContext (_dpy, _cfg, EGL_NO_CONTEXT, _ectx_attr);
+            if (_ctx == InvalidContext ()) {
+                // Error
+                std::cout << "Error: eglCreateContex (0x" << std::hex << eglGetError () << ")" << std::endl;
+            }
+
+            _surf = eglCreateWindowSurface (_dpy, _cfg, reinterpret_cast <EGLNativeWindowType> (_gbm.Surface ()), nullptr);
+            if (_surf == InvalidSurface ()) {
+                // Error
+                std::cout << "Error: eglCreateWindowSurface (0x" << std::hex << eglGetError () << ")" << std::endl;
+            }
+
+            EGLint _err = EGL_SUCCESS;
+
+            if (eglMakeCurrent (_dpy, _surf, _surf, _ctx) != EGL_TRUE) {
+                // Error
+                _err = eglGetError ();
+                std::cout << "Error: eglMakeCurrent (0x" << std::hex << _err << ")" << std::endl;
+            }
+
+            // Force an early allocation (of resources)
+
+            // Fails if previous errors exist
+            if (/* _err == EGL_SUCCESS && */ eglSwapBuffers (_dpy, _surf) != EGL_TRUE) {
+                // Error
+                _err = eglGetError ();
+                std::cout << "Error: eglSwapBuffers (0x" << std::hex << _err << ")" << std::endl;
+            }
+
+            _ret = _err == EGL_SUCCESS;
+
+        }
+
+        if (_ret != true) {
+            /* bool */ Deinit ();
+            
+        }
+    }
+
+    return _ret;
+}
+
+bool EGL::Deinit () {
+    bool _ret = false;
+
+    if (eglMakeCurrent (_dpy, InvalidSurface (), InvalidSurface (), _ctx) != EGL_TRUE) {
+        // Error
+        _ret = false;
+    }
+
+    if (eglTerminate (_dpy) != EGL_FALSE) {
+        // Error
+        _ret = false;
+    }
+
+    _ret = Clear () && _ret;
+
+    return _ret;
+}
+
+bool EGL::ImportBuffer (DRM::GBM::buf_t const & buf, index_t index) {
+    bool _ret = false;
+
+    if (Reserve (index) != false) {
+
+    if (buf != DRM::GBM::InvalidBuf ()) {
+
+        using img_t = struct img &; img_t _img = EGL::_img [index];
+
+        if (_img != EGL::InvalidImage ()) {
+            static EGLBoolean (* _eglDestroyImageKHR) (EGLDisplay, EGLImageKHR) = reinterpret_cast < EGLBoolean (*) (EGLDisplay, EGLImageKHR) > (eglGetProcAddress ("eglDestroyImageKHR"));
+
+            if (_eglDestroyImageKHR != nullptr) {
+                /*EGLBoolean*/ _eglDestroyImageKHR (_dpy, _img._khr);
+                DeleteTexture (_img);
+                _img = EGL::InvalidImage ();
+            }
+        }
+
+        _img._width = DRM::GBM::Width (buf);
+        _img._height = DRM::GBM::Height (buf);
+
+        // Possible narrowing
+        if (_narrowing < decltype (_img._width), EGLint, true> :: value
+         && _narrowing < decltype (_img._height), EGLint, true> :: value) {
+            // Narrowing detectedd
+            std::cout << __FILE__ << " : " << __LINE__ << " : Possible narrowing detected." << std::endl;
+        }
+
+        EGLint _attrs [] = {
+            EGL_WIDTH, static_cast <EGLint> (_img._width),
+            EGL_HEIGHT, static_cast <EGLint> (_img._height),
+            EGL_IMAGE_PRESERVED_KHR, static_cast <EGLint> (EGL_TRUE),
+            EGL_NONE
+        };
+
+        static EGLImageKHR (* _eglCreateImageKHR) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) = reinterpret_cast < EGLImageKHR (*) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) > (eglGetProcAddress ("eglCreateImageKHR"));
+
+        if (_eglCreateImageKHR != nullptr) {
+            _img._khr = _eglCreateImageKHR (_dpy, EGL_NO_CONTEXT, EGL_NATIVE_PIXMAP_KHR, buf, _attrs);
+        }
+
+        _ret = _img != EGL::InvalidImage ();
+
+    }
+
+    }
+
+    return _ret;
+}
+
+bool EGL::ImportBuffer (DRM::GBM::prime_t const & prime, index_t index) {
+    bool _ret = false;
+
+    if (Reserve (index) != false) {
+
+// TODO invalid dimension and color formats
+
+    // Destruction also done via ImportPrime
+    if (prime != DRM::GBM::InvalidPrime () /*&& DestroyPrime () */){
+
+        using img_t = struct img &; img_t _img = EGL::_img [index];
+
+        if (_img != EGL::InvalidImage ()) {
+            static EGLBoolean (* _eglDestroyImageKHR) (EGLDisplay, EGLImageKHR) = reinterpret_cast < EGLBoolean (*) (EGLDisplay, EGLImageKHR) > (eglGetProcAddress ("eglDestroyImageKHR"));
+
+            if (_eglDestroyImageKHR != nullptr) {
+                /*EGLBoolean*/ _eglDestroyImageKHR (_dpy, _img._khr);
+                DeleteTexture (_img);
+                _img = EGL::InvalidImage ();
+            }
+        }
+
+        // Possible narrowing
+        if (_narrowing < decltype (prime._width), EGLint, true> :: value
+         && _narrowing < decltype (prime._height), EGLint, true> :: value
+         && _narrowing < decltype (prime._stride), EGLint, true> :: value
+         && _narrowing < decltype (prime._modifier), EGLuint64KHR, true> :: value
+         ) {
+            // Narrowing detectedd
+            std::cout << __FILE__ << " : " << __LINE__ << " : Possible narrowing detected." << std::endl;
+        }
+
+        // Plain memory is imported through a dma-buf of its own, if possible
+        DRM::GBM::fd_t _fd = prime._fd;
+
+        if (prime._memory != false && DRM::GBM::DmaBuf (prime, _fd) != true) {
+            _fd = DRM::GBM::InvalidFd ();
+        }
+
+        EGLint _attrs [] = {
+            EGL_WIDTH,  static_cast <EGLint> (prime._width),
+            EGL_HEIGHT, static_cast <EGLint> (prime._height),
+            EGL_LINUX_DRM_FOURCC_EXT, static_cast <EGLint> (prime._frmt),
+            EGL_DMA_BUF_PLANE0_FD_EXT, static_cast <EGLint> (_fd),
+// TODO: magic constant ?
+            EGL_DMA_BUF_PLANE0_OFFSET_EXT, 0,
+            EGL_DMA_BUF_PLANE0_PITCH_EXT, static_cast <EGLint> (prime._stride),
+            EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, static_cast <EGLint> (prime._modifier & 0xFFFFFFFF),
+            EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT, static_cast <EGLint> (prime._modifier >> 32),
+            EGL_IMAGE_PRESERVED_KHR, static_cast <EGLint >(EGL_TRUE),
+            EGL_NONE
+        };
+
+        static EGLImageKHR (* _eglCreateImageKHR) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) = reinterpret_cast < EGLImageKHR (*) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) > (eglGetProcAddress ("eglCreateImageKHR"));
+
+        if (_eglCreateImageKHR != nullptr && _fd != DRM::GBM::InvalidFd ()) {
+            _img._khr = _eglCreateImageKHR (_dpy, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, 0, _attrs);
+            _img._width = prime._width;
+            _img._height = prime._height;
+        }
+
+        if (prime._memory != false && _fd != DRM::GBM::InvalidFd ()) {
+            // The image holds its own reference
+            /* int */ close (_fd);
+        }
+
+        _ret = _img != EGL::InvalidImage ();
+    }
+
+    }
+
+    return _ret;
+}
+
+bool EGL::UploadBuffer (DRM::GBM::prime_t const & prime, index_t index) {
+    bool _ret = prime._memory != false && prime._fd != DRM::GBM::InvalidFd () && Reserve (index) != false;
+
+    static EGLImageKHR (* _eglCreateImageKHR) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) = reinterpret_cast < EGLImageKHR (*) (EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, EGLint const * ) > (eglGetProcAddress ("eglCreateImageKHR"));
+    static EGLBoolean (* _eglDestroyImageKHR) (EGLDisplay, EGLImageKHR) = reinterpret_cast < EGLBoolean (*) (EGLDisplay, EGLImageKHR) > (eglGetProcAddress ("eglDestroyImageKHR"));
+
+    // ARGB8888 is stored as B, G, R, A, without GL_EXT_texture_format_BGRA8888 red and blue are swapped
+    static GLenum const _format =    glGetString (GL_EXTENSIONS) != nullptr
+                                  && std::string (reinterpret_cast <char const *> (glGetString (GL_EXTENSIONS))).find ("GL_EXT_texture_format_BGRA8888") != std::string::npos
+                                  ? GL_BGRA_EXT : GL_RGBA;
+
+    _ret = _ret != false && _eglCreateImageKHR != nullptr && _eglDestroyImageKHR != nullptr;
+
+    void * _data = MAP_FAILED;
+
+    if (_ret != false) {
+        _data = mmap (nullptr, DRM::GBM::Size (prime), PROT_READ, MAP_SHARED, prime._fd, 0);
+
+        _ret = _data != MAP_FAILED;
+    }
+
+    if (_ret != false) {
+        using img_t = struct img &; img_t _img = EGL::_img [index];
+
+        // The sibling texture is reused as long as the dimensions do not change
+        if (_img != EGL::InvalidImage () && (_img._tex == 0 || _img._width != static_cast <width_t> (prime._width) || _img._height != static_cast <height_t> (prime._height))) {
+            /*EGLBoolean*/ _eglDestroyImageKHR (_dpy, _img._khr);
+            DeleteTexture (_img);
+            _img = EGL::InvalidImage ();
+        }
+
+        bool const _create = (_img != EGL::InvalidImage ()) != true;
+
+        if (_create != false) {
+            glGenTextures (1, &_img._tex);
+        }
+
+        glBindTexture (GL_TEXTURE_2D, _img._tex);
+
+        if (_create != false) {
+            // Complete without mipmaps
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexImage2D (GL_TEXTURE_2D, 0, _format, static_cast <GLsizei> (prime._width), static_cast <GLsizei> (prime._height), 0, _format, GL_UNSIGNED_BYTE, nullptr);
+        }
+
+        // The stride equals the width, see DRM::GBM::CreateMemory
+        glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, static_cast <GLsizei> (prime._width), static_cast <GLsizei> (prime._height), _format, GL_UNSIGNED_BYTE, _data);
+
+        glBindTexture (GL_TEXTURE_2D, 0);
+
+        _ret = glGetError () == GL_NO_ERROR;
+
+        if (_ret != false && _create != false) {
+            EGLint const _attrs [] = {
+                EGL_GL_TEXTURE_LEVEL_KHR, 0,
+                EGL_IMAGE_PRESERVED_KHR, static_cast <EGLint> (EGL_TRUE),
+                EGL_NONE
+            };
+
+            // https://registry.khronos.org/EGL/extensions/KHR/EGL_KHR_gl_image.txt
+            _img._khr = _eglCreateImageKHR (_dpy, _ctx, EGL_GL_TEXTURE_2D_KHR, reinterpret_cast <EGLClientBuffer> (static_cast <uintptr_t> (_img._tex)), _attrs);
+            _img._width = static_cast <width_t> (prime._width);
+            _img._height = static_cast <height_t> (prime._height);
+
+            _ret = _img != EGL::InvalidImage ();
+        }
+
+        if (_ret != true) {
+            DeleteTexture (_img);
+        }
+    }
+
+    if (_data != MAP_FAILED) {
+        /* int */ munmap (_data, DRM::GBM::Size (prime));
+    }
+
+    return _ret;
+}
+
+void EGL::DeleteTexture (struct img & img) {
+    if (img._tex != 0) {
+        glDeleteTextures (1, &img._tex);
+
+        img._tex = 0;
+    }
+}
+
+bool EGL::Reserve (index_t index) {
+    bool _ret = true;
+
+    if (index >= _img.size ()) {
+        _img.resize (static_cast <size_t> (index) + 1, InvalidImage ());
+    }
+
+    return _ret;
+}
+
+bool EGL::ReleaseImage (index_t index) {
+    bool _ret = index < _img.size ();
+
+    if (_ret != false && _img [index] != EGL::InvalidImage ()) {
+        static EGLBoolean (* _eglDestroyImageKHR) (EGLDisplay, EGLImageKHR) = reinterpret_cast < EGLBoolean (*) (EGLDisplay, EGLImageKHR) > (eglGetProcAddress ("eglDestroyImageKHR"));
+
+        _ret = _eglDestroyImageKHR != nullptr && _eglDestroyImageKHR (_dpy, _img [index]._khr) != EGL_FALSE;
+
+        DeleteTexture (_img [index]);
+
+        _img [index] = EGL::InvalidImage ();
+    }
+
+    // Unused slots at the end are given back
+    while (_img.empty () != true && (_img.back () != EGL::InvalidImage ()) != true) {
+        _img.pop_back ();
+    }
+
+    return _ret;
+}
+
+bool EGL::Render () {
+    bool _ret = false;
 
     // eglMakeCurrent has been called at Init
     _ret = eglSwapBuffers (_dpy, _surf) != EGL_FALSE;
 
-    return _ret;
-}
+    return _ret;
+}
+
+bool EGL::BufferAge (EGLint & age) const {
+    bool _ret = _dpy != InvalidDisplay () && _surf != InvalidSurface ();
+
+    // https://registry.khronos.org/EGL/extensions/EXT/EGL_EXT_buffer_age.txt
+    static bool const _supported = _ret != false
+                                   && eglQueryString (_dpy, EGL_EXTENSIONS) != nullptr
+                                   && std::string (eglQueryString (_dpy, EGL_EXTENSIONS)).find ("EGL_EXT_buffer_age") != std::string::npos;
+
+    age = 0;
+
+    if (_ret != false && _supported != false) {
+        // Only valid after eglMakeCurrent, which has been called at Init
+        _ret = eglQuerySurface (_dpy, _surf, EGL_BUFFER_AGE_EXT, &age) != EGL_FALSE;
+    }
+    else {
+        _ret = false;
+    }
+
+    return _ret;
+}
+
+bool EGL::Fence (DRM::GBM::fd_t & fence) const {
+    bool _ret = _dpy != InvalidDisplay ();
+
+    static PFNEGLCREATESYNCKHRPROC _eglCreateSyncKHR = reinterpret_cast <PFNEGLCREATESYNCKHRPROC> (eglGetProcAddress ("eglCreateSyncKHR"));
+    static PFNEGLDESTROYSYNCKHRPROC _eglDestroySyncKHR = reinterpret_cast <PFNEGLDESTROYSYNCKHRPROC> (eglGetProcAddress ("eglDestroySyncKHR"));
+    static PFNEGLDUPNATIVEFENCEFDANDROIDPROC _eglDupNativeFenceFDANDROID = reinterpret_cast <PFNEGLDUPNATIVEFENCEFDANDROIDPROC> (eglGetProcAddress ("eglDupNativeFenceFDANDROID"));
+
+    // https://registry.khronos.org/EGL/extensions/ANDROID/EGL_ANDROID_native_fence_sync.txt
+    static bool const _supported = _ret != false
+                                   && _eglCreateSyncKHR != nullptr && _eglDestroySyncKHR != nullptr && _eglDupNativeFenceFDANDROID != nullptr
+                                   && eglQueryString (_dpy, EGL_EXTENSIONS) != nullptr
+                                   && std::string (eglQueryString (_dpy, EGL_EXTENSIONS)).find ("EGL_ANDROID_native_fence_sync") != std::string::npos;
+
+    fence = DRM::GBM::InvalidFd ();
+
+    EGLSyncKHR _sync = EGL_NO_SYNC_KHR;
+
+    bool _fenced = _ret != false && _supported != false;
+
+    if (_fenced != false) {
+        EGLint const _attrs [] = { EGL_NONE };
+
+        _sync = _eglCreateSyncKHR (_dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, _attrs);
+        _fenced = _sync != EGL_NO_SYNC_KHR;
+    }
+
+    if (_fenced != false) {
+        // The fd only becomes available once the fence command has been flushed
+        glFlush ();
+
+        fence = _eglDupNativeFenceFDANDROID (_dpy, _sync);
+        _fenced = fence != EGL_NO_NATIVE_FENCE_FD_ANDROID;
+    }
+
+    if (_sync != EGL_NO_SYNC_KHR) {
+        /* EGLBoolean */ _eglDestroySyncKHR (_dpy, _sync);
+    }
+
+    if (_ret != false && _fenced != true) {
+        // Implicit, complete everything
+        glFinish ();
+
+        fence = DRM::GBM::InvalidFd ();
+
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    return _ret;
+}
+
+bool EGL::WaitFence (DRM::GBM::fd_t & fence, bool gpu) const {
+    bool _ret = true;
+
+    static PFNEGLCREATESYNCKHRPROC _eglCreateSyncKHR = reinterpret_cast <PFNEGLCREATESYNCKHRPROC> (eglGetProcAddress ("eglCreateSyncKHR"));
+    static PFNEGLDESTROYSYNCKHRPROC _eglDestroySyncKHR = reinterpret_cast <PFNEGLDESTROYSYNCKHRPROC> (eglGetProcAddress ("eglDestroySyncKHR"));
+    static PFNEGLWAITSYNCKHRPROC _eglWaitSyncKHR = reinterpret_cast <PFNEGLWAITSYNCKHRPROC> (eglGetProcAddress ("eglWaitSyncKHR"));
+
+    // https://registry.khronos.org/EGL/extensions/KHR/EGL_KHR_wait_sync.txt
+    static bool const _supported = _dpy != InvalidDisplay ()
+                                   && _eglCreateSyncKHR != nullptr && _eglDestroySyncKHR != nullptr && _eglWaitSyncKHR != nullptr
+                                   && eglQueryString (_dpy, EGL_EXTENSIONS) != nullptr
+                                   && std::string (eglQueryString (_dpy, EGL_EXTENSIONS)).find ("EGL_ANDROID_native_fence_sync") != std::string::npos
+                                   && std::string (eglQueryString (_dpy, EGL_EXTENSIONS)).find ("EGL_KHR_wait_sync") != std::string::npos;
+
+    // Nothing to wait for, eg, already waited for, or completed implicitly
+    if (fence != DRM::GBM::InvalidFd ()) {
+        bool _waited = false;
+
+        if (gpu != false && _supported != false) {
+            EGLint const _attrs [] = { EGL_SYNC_NATIVE_FENCE_FD_ANDROID, fence, EGL_NONE };
+
+            EGLSyncKHR _sync = _eglCreateSyncKHR (_dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, _attrs);
+
+            if (_sync != EGL_NO_SYNC_KHR) {
+                // The fd is owned by the sync object
+                fence = DRM::GBM::InvalidFd ();
+
+                // Subsequent GL commands wait, the CPU does not
+                _waited = _eglWaitSyncKHR (_dpy, _sync, 0) != EGL_FALSE;
+
+                /* EGLBoolean */ _eglDestroySyncKHR (_dpy, _sync);
+            }
+        }
+
+        if (_waited != true && fence != DRM::GBM::InvalidFd ()) {
+            // A sync_file becomes readable once signaled
+            struct pollfd _fds = { fence, POLLIN, 0 };
+
+            int _err = -1;
+
+            do {
+                _err = poll (&_fds, 1, -1);
+            } while (_err < 0 && (errno == EINTR || errno == EAGAIN));
+
+            _waited = _err > 0;
+        }
+
+        if (fence != DRM::GBM::InvalidFd ()) {
+            /* int */ close (fence);
+        }
+
+        fence = DRM::GBM::InvalidFd ();
+
+        _ret = _waited;
+    }
+
+    return _ret;
+}
+
+bool EGL::Clear () {
+    bool _ret = false;
+
+    _dpy = InvalidDisplay ();;
+//    _cfg = EGL_NO_CONFIG
+    _surf = InvalidSurface ();
+    _ctx = InvalidContext ();;
+
+    _img.clear ();
+
+    const_cast <remove_const <valid_t>::type &> (_valid) = false;
+
+    _ret = Status () != true;
+
+    return _ret;
+}
+
+bool GLES::Init () {
+    bool _ret = Clear ();
+
+    // A context is current, see EGL::Init
+    if (_ret != false) {
+        glGenBuffers (_vbo.size (), _vbo.data ());
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    if (_ret != false) {
+        glBindBuffer (GL_ARRAY_BUFFER, _vbo [static_cast <size_t> (VBO::TILE)]);
+        glBufferData (GL_ARRAY_BUFFER, sizeof (GLfloat) * TileVertices ().size (), TileVertices ().data (), GL_STATIC_DRAW);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    if (_ret != false) {
+        glBindBuffer (GL_ARRAY_BUFFER, _vbo [static_cast <size_t> (VBO::TRIANGLE)]);
+        glBufferData (GL_ARRAY_BUFFER, sizeof (GLfloat) * TriangleVertices ().size (), TriangleVertices ().data (), GL_STATIC_DRAW);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    // Storage of the dynamic one is (re)specified on every use
+
+    glBindBuffer (GL_ARRAY_BUFFER, 0);
+
+    return _ret;
+}
+
+bool GLES::Deinit () {
+    bool _ret = glGetError () == GL_NO_ERROR;
+
+    // Possibly, no (longer a) current context
+    for (auto const & _program : _programs) {
+        glDeleteProgram (_program.second);
+    }
+
+    for (auto const & _texture : _tex) {
+        if (_texture != InvalidTex ()) {
+            glDeleteTextures (1, &_texture);
+        }
+    }
+
+    for (auto const & _buffer : _vbo) {
+        if (_buffer != InvalidVbo ()) {
+            glDeleteBuffers (1, &_buffer);
+        }
+    }
+
+    _ret = Clear () && _ret;
+
+    return _ret;
+}
+
+bool GLES::RenderTile () {
+    constexpr char const _vtx_src [] =
+        "#version 100                               \n"
+        "attribute vec3 position;                   \n"
+        "varying vec2 coordinates;                  \n"
+        "void main () {                             \n"
+            "gl_Position = vec4 (position.xyz, 1);  \n"
+            "coordinates = position.xy;             \n"
+        "}                                          \n"
+        ;
+
+// TODO: For normal rendering no extention
+
+    constexpr char  const _frag_src [] =
+        "#version 100                                                           \n"
+        "#extension GL_OES_EGL_image_external : require                         \n"
+        "precision mediump float;                                               \n"
+        "uniform samplerExternalOES sampler;                                    \n"
+        "varying vec2 coordinates;                                              \n"
+        "void main () {                                                         \n"
+            "gl_FragColor = vec4 (texture2D (sampler, coordinates).rgb, 1.0f);  \n"
+        "}                                                                      \n"
+        ;
+
+    bool _ret = glGetError () == GL_NO_ERROR
+                && RenderColor (true, false, false)
+                && SetupProgram (_vtx_src, _frag_src)
+                && RenderPolygon (VBO::TILE, TileVertices ().size () / VerticeDimensions);
+
+    return _ret;
+}
+
+bool GLES::RenderTriangle () {
+    constexpr char const _vtx_src [] =
+        "#version 100                               \n"
+        "attribute vec3 position;                   \n"
+        "void main () {                             \n"
+            "gl_Position = vec4 (position.xyz, 1);  \n"
+        "}                                          \n"
+        ;
+
+    constexpr char  const _frag_src [] =
+        "#version 100                                                           \n"
+        "precision mediump float;                                               \n"
+        "void main () {                                                         \n"
+            "gl_FragColor = vec4 (0.0f, 1.0f, 0.0f, 1.0f);                      \n"
+        "}                                                                      \n"
+        ;
+
+    bool _ret = glGetError () == GL_NO_ERROR
+                && RenderColor (false, false, true)
+                && SetupProgram (_vtx_src, _frag_src)
+                && RenderPolygon (VBO::TRIANGLE, TriangleVertices ().size () / VerticeDimensions);
+
+    return _ret;
+}
+
+std::array <GLfloat, 4 * GLES::VerticeDimensions> const & GLES::TileVertices () {
+    static_assert (is_same <GLfloat, GLES::offset::coordinate_t>:: value != false);
+    static std::array <GLfloat, 4 * VerticeDimensions> const _vert = {
+        0.0f, 0.0f, 0.0f /* v0 */,
+        1.0f, 0.0f, 0.0f /* v1 */,
+        0.0f, 1.0f, 0.0f /* v2 */,
+        1.0f, 1.0f, 0.0f /* v3 */};
+
+    return _vert;
+}
+
+std::array <GLfloat, 3 * GLES::VerticeDimensions> const & GLES::TriangleVertices () {
+    static_assert (is_same <GLfloat, GLES::offset::coordinate_t>:: value != false);
+    static std::array <GLfloat, 3 * VerticeDimensions> const _vert = {
+        -1.0f, -1.0f, 0.0f /* v0 */,
+        1.0f, -1.0f, 0.0f /* v1 */,
+        -1.0f, 1.0f, 0.0f /* v2 */ };
+
+    return _vert;
+}
+
+bool GLES::RenderPolygon (VBO vbo, GLsizei count) {
+    bool _ret = glGetError () == GL_NO_ERROR && _vbo [static_cast <size_t> (vbo)] != InvalidVbo ();
+
+    if (_ret != false) {
+        GLuint _prog = 0;
+
+        if (_ret != false) {
+            glGetIntegerv (GL_CURRENT_PROGRAM, reinterpret_cast <GLint *> (&_prog));
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        GLint _loc = 0;
+        if (_ret != false) {
+            _loc = glGetAttribLocation (_prog, "position");
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glBindBuffer (GL_ARRAY_BUFFER, _vbo [static_cast <size_t> (vbo)]);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            // Offset into the bound buffer, the data has been uploaded at Init
+            glVertexAttribPointer (_loc, VerticeDimensions, GL_FLOAT, GL_FALSE, 0, nullptr);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glEnableVertexAttribArray (_loc);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glDrawArrays (GL_TRIANGLE_STRIP, 0, count);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glDisableVertexAttribArray (_loc);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        glBindBuffer (GL_ARRAY_BUFFER, 0);
+    }
+
+    return _ret;
+}
+
+bool GLES::RenderEGLImage (EGL::img_t const  & img, EGL::index_t index) {
+    bool _ret = glGetError () == GL_NO_ERROR && img != EGL::InvalidImage ();
+// TODO: add check ?
+//    fbo = _tgt != GL_TEXTURE_EXTERNAL_OES;
+
+    if (Reserve (index) != false) {
+
+        if (_ret != false) {
+            glBindTexture(GL_TEXTURE_2D, 0);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glBindFramebuffer (GL_FRAMEBUFFER, 0);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glActiveTexture (GL_TEXTURE0);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            if (_tex [index] != InvalidTex ()) {
+                glDeleteTextures (1, &_tex [index]);
+                _ret = glGetError () == GL_NO_ERROR;
+            }
+
+            _tex [index] = InvalidTex ();
+
+            if (_ret != false) {
+                glGenTextures (1, &_tex [index]);
+                _ret = glGetError () == GL_NO_ERROR;
+            }
+        }
+
+        if (_ret != false) {
+            glBindTexture (_tgt, _tex [index]);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glTexParameteri (_tgt, GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glTexParameteri (_tgt, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glTexParameteri (_tgt, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glTexParameteri (_tgt, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        // Requires EGL 1.2 and either the EGL_OES_image or EGL_OES_image_base
+        // Use eglGetProcAddress, or dlsym for the function pointer of this GL extenstion
+        // https://www.khronos.org/registry/OpenGL/extensions/OES/OES_EGL_image_external.txt
+        static void (* _EGLImageTargetTexture2DOES) (GLenum, GLeglImageOES) = reinterpret_cast < void (*) (GLenum, GLeglImageOES) > (eglGetProcAddress ("glEGLImageTargetTexture2DOES"));
+
+        if (_ret != false && _EGLImageTargetTexture2DOES != nullptr) {
+            _EGLImageTargetTexture2DOES (_tgt, reinterpret_cast <GLeglImageOES> (img._khr));
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+        else {
+            _ret = false;
+        }
+
+        if (_ret != false) {
+            if (_tgt != GL_TEXTURE_EXTERNAL_OES) {
+                if (_fbo != InvalidFbo ()) {
+                    glDeleteFramebuffers (1, &_fbo);
+                    _ret = glGetError () == GL_NO_ERROR;
+                }
+
+                if (_ret != false) {
+                    glGenFramebuffers(1, &_fbo);
+                    _ret = glGetError () == GL_NO_ERROR;
+                }
+
+                if (_ret != false) {
+                    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+                    _ret = glGetError () == GL_NO_ERROR;
+                }
+
+                if (_ret != false) {
+                    glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, _tgt, _tex [index], 0 /* level */);
+                    _ret = glGetError () == GL_NO_ERROR;
+                }
+            }
+        }
+
+        EGLint _width = 0, _height = 0;
+
+        if (_ret != false) {
+            _ret = SurfaceSize (_width, _height);
+        }
+
+        GLint _dims [2] = {0, 0};
+
+        if (_ret != false) {
+            glGetIntegerv (GL_MAX_VIEWPORT_DIMS, &_dims [0]);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            if (_tgt == GL_TEXTURE_EXTERNAL_OES) {
+                // Compositor side; Image rendered on surface
+
+                _ret = glGetError () == GL_NO_ERROR && Viewport (_width, _height, _offset [index], _scale [index]) != false;
+
+                _ret = _ret != false && RenderTile () != false;
+
+                glFinish ();
+
+                _ret = _ret != false && glGetError () == GL_NO_ERROR;
+            }
+            else {
+                // Client side, EGLImage as color attachment
+
+                // Center in the smallest possible dimensions
+
+                constexpr uint8_t _mult = 2;
+
+                using common_t = std::common_type < decltype (_width), decltype (_height), decltype (_mult), remove_pointer < std::decay < decltype (_dims) > :: type > :: type > :: type;
+
+                common_t _prop_width = static_cast <common_t> (_width) > static_cast <common_t> (_dims [0]) ? static_cast <common_t> (_dims [0]) : static_cast <common_t> (_width);
+                common_t _prop_height = static_cast <common_t> (_height) > static_cast <common_t> (_dims [1]) ? static_cast <common_t> (_dims [1]) : static_cast <common_t> (_height);
+
+                common_t _prop_x = ( static_cast <common_t> (_width) - _prop_width ) / static_cast <common_t> (_mult);
+                common_t _prop_y = ( static_cast <common_t> (_height) - _prop_height ) / static_cast <common_t> (_mult);
+
+                if (   _prop_x > static_cast <common_t> (0)
+                    || _prop_y > static_cast <common_t> (0)
+                ) {
+                    // Clipping
+                    std::cout << "Warning: possible clipping detected. [" << _prop_x << ", " << _prop_y << ", " << _prop_width << ", " << _prop_height << ", " << _width << ", " << _height << "]" << std::endl;
+                }
+
+                // Image scaled to 'full' size
+                glViewport (static_cast <GLint> (_prop_x), static_cast <GLint> (_prop_y), static_cast <GLsizei> (_prop_width), static_cast <GLsizei> (_prop_height));
+
+                _damage = { static_cast <GLint> (_prop_x), static_cast <GLint> (_prop_y), static_cast <GLsizei> (_prop_width), static_cast <GLsizei> (_prop_height) };
+
+                // Anything outside the viewport, including the clear, is left untouched and is not part of the damage
+                _ret = glGetError () == GL_NO_ERROR && Scissor (_damage) && RenderTriangle ();
+
+                // Completion is signaled by a fence, see RenderClient::Render
+
+                _ret = _ret != false && glGetError () == GL_NO_ERROR;
+            }
+        }
+
+    }
+
+    return _ret;
+}
+
+bool GLES::SurfaceSize (EGLint & width, EGLint & height) {
+    bool _ret = glGetError () == GL_NO_ERROR;
+
+    EGLDisplay _dpy = EGL::InvalidDisplay ();
+
+    if (_ret != false) {
+        _dpy = eglGetCurrentDisplay ();
+        _ret = eglGetError () == EGL_SUCCESS
+               && _dpy != EGL::InvalidDisplay ();
+    }
+
+    EGLSurface _surf = EGL::InvalidSurface ();
+
+    if (_ret != false) {
+        _surf = eglGetCurrentSurface (EGL_DRAW);
+        _ret  = eglGetError () == EGL_SUCCESS
+                && _surf != EGL::InvalidSurface ();
+    }
+
+    if (_ret != false) {
+        _ret = eglQuerySurface (_dpy, _surf, EGL_WIDTH, &width) != EGL_FALSE
+               && eglQuerySurface (_dpy, _surf, EGL_HEIGHT, &height) != EGL_FALSE
+               && eglGetError () == EGL_SUCCESS;
+    }
+
+    return _ret;
+}
+
+bool GLES::Viewport (EGLint width, EGLint height, offset_t const & off, scale_t const & scale) const {
+    // Aliases to keep the arithmetic below readable
+    EGLint const & _width = width;
+    EGLint const & _height = height;
+
+    GLint _dims [2] = {0, 0};
+
+    glGetIntegerv (GL_MAX_VIEWPORT_DIMS, &_dims [0]);
+
+    bool _ret = glGetError () == GL_NO_ERROR;
+
+    if (_ret != false) {
+#ifdef _QUIRKS
+        // glViewport (x, y, width, height)
+        //
+        // Applied width = width / 2
+        // Applied height = height / 2
+        // Applied origin's x = width / 2 + x
+        // Applied origin's y = height / 2 + y
+        //
+        // Compensate to origin bottom left and true size by
+        // glViewport (-width, -height, width * 2, height * 2)
+        //
+        // _offset is in the range -1..1 wrt to origin, so the effective value maps to -width to width, -height to height
+
+        constexpr uint8_t _mult = 2;
+
+        using common_t = std::common_type < decltype (_width), decltype (_height), decltype (_mult), decltype (scale._horiz), decltype (scale._vert), decltype (off._x), decltype (off._y), remove_pointer < std::decay < decltype (_dims) > :: type > :: type > :: type;
+
+        common_t _quirk_width = static_cast <common_t> (_width) * static_cast <common_t> (_mult) * static_cast <common_t> (scale._horiz);
+        common_t _quirk_height = static_cast <common_t> (_height) * static_cast <common_t> (_mult) * static_cast <common_t> (scale._vert);
+
+        common_t _quirk_x = ( static_cast <common_t> (-_width) * static_cast <common_t> (scale._horiz) ) + ( static_cast <common_t> (off._x) * static_cast <common_t> (_width) );
+        common_t _quirk_y = ( static_cast <common_t> (-_height) * static_cast <common_t> (scale._vert) ) + ( static_cast <common_t> (off._y) * static_cast <common_t> (_height) );
+
+        if (    _quirk_x < ( -_quirk_width / static_cast <common_t> (_mult) )
+             || _quirk_y < ( -_quirk_height / static_cast <common_t> (_mult) )
+             || _quirk_x  > static_cast <common_t> (0)
+             || _quirk_y  > static_cast <common_t> (0)
+             || _quirk_width > ( static_cast <common_t> (_width) * static_cast <common_t> (_mult) )
+             || _quirk_height > ( static_cast <common_t> (_height) * static_cast <common_t> (_mult) )
+             || static_cast <common_t> (_width) > static_cast <common_t> (_dims [0])
+             || static_cast <common_t> (_height) > static_cast <common_t> (_dims [1])
+        ) {
+            // Clipping, or undefined / unknown behavior
+            std::cout << "Warning: possible clipping or unknown behavior detected. [" << _quirk_x << ", " << _quirk_y << ", " << _quirk_width << ", " << _quirk_height << ", " << _width << ", " << _height << ", " << _dims [0] << ", " << _dims [1] << "]" << std::endl;
+        }
+
+        glViewport (static_cast <GLint> (_quirk_x), static_cast <GLint> (_quirk_y), static_cast <GLsizei> (_quirk_width), static_cast <GLsizei> (_quirk_height));
+#else
+        glViewport (0, 0, _width, _height);
+#endif
+
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+#ifndef _QUIRKS
+    // The offset and scale only apply with the workaround
+    static_cast <void> (off);
+    static_cast <void> (scale);
+#endif
+
+    return _ret;
+}
+
+bool GLES::BindEGLImage (EGL::img_t const & img, EGL::index_t index) {
+    bool _ret = glGetError () == GL_NO_ERROR && img != EGL::InvalidImage () && Reserve (index) != false;
+
+    if (_ret != false && _tex [index] == InvalidTex ()) {
+        glGenTextures (1, &_tex [index]);
+        _ret = glGetError () == GL_NO_ERROR;
+
+        if (_ret != false) {
+            glBindTexture (_tgt, _tex [index]);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        // Parameters are part of the texture object, set once
+        if (_ret != false) {
+            glTexParameteri (_tgt, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri (_tgt, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri (_tgt, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri (_tgt, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+    }
+    else if (_ret != false) {
+        glBindTexture (_tgt, _tex [index]);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    // https://www.khronos.org/registry/OpenGL/extensions/OES/OES_EGL_image_external.txt
+    static void (* _EGLImageTargetTexture2DOES) (GLenum, GLeglImageOES) = reinterpret_cast < void (*) (GLenum, GLeglImageOES) > (eglGetProcAddress ("glEGLImageTargetTexture2DOES"));
+
+    // The image may have been replaced, eg, by a newer frame, always (re)attach
+    if (_ret != false && _EGLImageTargetTexture2DOES != nullptr) {
+        _EGLImageTargetTexture2DOES (_tgt, reinterpret_cast <GLeglImageOES> (img._khr));
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+    else {
+        _ret = false;
+    }
+
+    return _ret;
+}
+
+bool GLES::RenderEGLImages (std::vector <EGL::img_t> const & imgs) {
+    // Compositor side only, sampled as external images
+    bool _ret = glGetError () == GL_NO_ERROR && _tgt == GL_TEXTURE_EXTERNAL_OES;
+
+    GLint _units = 0;
+
+    if (_ret != false) {
+        glGetIntegerv (GL_MAX_TEXTURE_IMAGE_UNITS, &_units);
+        _ret = glGetError () == GL_NO_ERROR && _units > 0;
+    }
+
+    size_t const _count = static_cast <size_t> (std::count_if (imgs.begin (), imgs.end (), [] (EGL::img_t const & img) { return img != EGL::InvalidImage (); }));
+
+    // Images per draw call, a program for each distinct value
+    size_t const _batch = _ret != false ? std::min (static_cast <size_t> (_units), _count) : 0;
+
+    // One sampler per texture unit; GLSL ES 1.00 only allows constant sampler indices, hence the selection by the interpolated unit
+    std::string const _vtx_src =
+        "#version 100                               \n"
+        "attribute vec3 position;                   \n"
+        "attribute vec2 texcoord;                   \n"
+        "attribute float texunit;                   \n"
+        "varying vec2 coordinates;                  \n"
+        "varying float unit;                        \n"
+        "void main () {                             \n"
+            "gl_Position = vec4 (position.xyz, 1);  \n"
+            "coordinates = texcoord;                \n"
+            "unit = texunit;                        \n"
+        "}                                          \n"
+        ;
+
+    std::string _frag_src =
+        "#version 100                                                           \n"
+        "#extension GL_OES_EGL_image_external : require                         \n"
+        "precision mediump float;                                               \n"
+        "varying vec2 coordinates;                                              \n"
+        "varying float unit;                                                    \n"
+        ;
+
+    for (size_t _unit = 0; _unit < _batch; _unit++) {
+        _frag_src += "uniform samplerExternalOES sampler" + std::to_string (_unit) + ";\n";
+    }
+
+    _frag_src += "void main () {\n";
+    _frag_src += "vec3 color = vec3 (0.0, 0.0, 0.0);\n";
+
+    for (size_t _unit = 0; _unit < _batch; _unit++) {
+        _frag_src += ( _unit > 0 ? "else " : "" ) + std::string ("if (unit < ") + std::to_string (_unit) + ".5) color = texture2D (sampler" + std::to_string (_unit) + ", coordinates).rgb;\n";
+    }
+
+    _frag_src += "gl_FragColor = vec4 (color, 1.0);\n";
+    _frag_src += "}\n";
+
+    // x, y, z, s, t, unit
+    constexpr uint8_t _stride = VerticeDimensions + 3;
+
+    // Two triangles per image, see RenderTile for the unit quad
+    constexpr GLfloat _quad [6][2] = { {0.0f, 0.0f}, {1.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} };
+
+    EGLint _width = 0, _height = 0;
+
+    if (_ret != false) {
+        glBindFramebuffer (GL_FRAMEBUFFER, 0);
+        _ret = glGetError () == GL_NO_ERROR && SurfaceSize (_width, _height) != false;
+    }
+
+    if (_ret != false) {
+        // Per image offset and scale are part of the vertices
+        _ret = Viewport (_width, _height, InitialOffset (), scale_t ());
+    }
+
+    if (_ret != false) {
+        // Once, for all images
+        _ret = RenderColor (true, false, false) && SetupProgram (_vtx_src.c_str (), _frag_src.c_str ());
+    }
+
+    GLuint _prog = 0;
+
+    if (_ret != false) {
+        glGetIntegerv (GL_CURRENT_PROGRAM, reinterpret_cast <GLint *> (&_prog));
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    GLint _loc [3] = { -1, -1, -1 };
+
+    if (_ret != false) {
+        _loc [0] = glGetAttribLocation (_prog, "position");
+        _loc [1] = glGetAttribLocation (_prog, "texcoord");
+        _loc [2] = glGetAttribLocation (_prog, "texunit");
+        _ret = glGetError () == GL_NO_ERROR && _loc [0] >= 0 && _loc [1] >= 0 && _loc [2] >= 0;
+    }
+
+    for (size_t _unit = 0; _unit < _batch && _ret != false; _unit++) {
+        glUniform1i (glGetUniformLocation (_prog, ("sampler" + std::to_string (_unit)).c_str ()), static_cast <GLint> (_unit));
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    std::vector <GLfloat> _vert;
+    _vert.reserve (_batch * 6 * _stride);
+
+    for (size_t _index = 0; _index < imgs.size () && _ret != false; ) {
+        _vert.clear ();
+
+        size_t _unit = 0;
+
+        // Gather the next batch, each with its own texture unit
+        for (; _index < imgs.size () && _unit < _batch && _ret != false; _index++) {
+            if (imgs [_index] != EGL::InvalidImage ()) {
+                glActiveTexture (GL_TEXTURE0 + _unit);
+                _ret = glGetError () == GL_NO_ERROR && BindEGLImage (imgs [_index], static_cast <EGL::index_t> (_index));
+
+                for (auto const & _corner : _quad) {
+                    _vert.insert (_vert.end (), {
+                          _corner [0] * _scale [_index]._horiz + _offset [_index]._x
+                        , _corner [1] * _scale [_index]._vert + _offset [_index]._y
+                        , _offset [_index]._z
+                        , _corner [0]
+                        , _corner [1]
+                        , static_cast <GLfloat> (_unit)
+                    });
+                }
+
+                _unit++;
+            }
+        }
+
+        if (_ret != false && _unit > 0) {
+            GLsizeiptr const _size = static_cast <GLsizeiptr> (_vert.size () * sizeof (GLfloat));
+
+            glBindBuffer (GL_ARRAY_BUFFER, _vbo [static_cast <size_t> (VBO::DYNAMIC)]);
+
+            // Orphan the previous storage, the GPU may still read it, then fill the new one, no implicit synchronization
+            glBufferData (GL_ARRAY_BUFFER, _size, nullptr, GL_STREAM_DRAW);
+            glBufferSubData (GL_ARRAY_BUFFER, 0, _size, _vert.data ());
+
+            _ret = glGetError () == GL_NO_ERROR && _vbo [static_cast <size_t> (VBO::DYNAMIC)] != InvalidVbo ();
+        }
+
+        if (_ret != false && _unit > 0) {
+            for (uint8_t _i = 0; _i < 3; _i++) {
+                glEnableVertexAttribArray (_loc [_i]);
+            }
+
+            // Offsets into the bound buffer
+            glVertexAttribPointer (_loc [0], VerticeDimensions, GL_FLOAT, GL_FALSE, _stride * sizeof (GLfloat), reinterpret_cast <void const *> (0));
+            glVertexAttribPointer (_loc [1], 2, GL_FLOAT, GL_FALSE, _stride * sizeof (GLfloat), reinterpret_cast <void const *> (VerticeDimensions * sizeof (GLfloat)));
+            glVertexAttribPointer (_loc [2], 1, GL_FLOAT, GL_FALSE, _stride * sizeof (GLfloat), reinterpret_cast <void const *> ((VerticeDimensions + 2) * sizeof (GLfloat)));
+
+            glDrawArrays (GL_TRIANGLES, 0, _vert.size () / _stride);
+
+            for (uint8_t _i = 0; _i < 3; _i++) {
+                glDisableVertexAttribArray (_loc [_i]);
+            }
+
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        glBindBuffer (GL_ARRAY_BUFFER, 0);
+    }
+
+    glActiveTexture (GL_TEXTURE0);
+
+    // No need to wait, eglSwapBuffers flushes, and the kernel waits for the implicit fence of the buffer before scan out
+
+    _ret = _ret != false && glGetError () == GL_NO_ERROR;
+
+    return _ret;
+}
+
+bool GLES::Clear () {
+    bool _ret = false;
+
+    _fbo = InvalidFbo ();
+
+    _tex.clear ();
+
+    _offset.clear ();
+    _scale.clear ();
+
+    _damage = InvalidRect ();
+
+    _programs.clear ();
+
+    _vbo.fill (InvalidVbo ());
+
+    const_cast <remove_const <valid_t>::type &> (_valid) = false;
+
+    _ret = Status () != true;
+
+    return _ret;
+}
+
+bool GLES::RenderColor (bool red, bool green, bool blue) {
+    bool _ret = false;
+
+    constexpr float OMEGA = 3.14159265 / 180;
+    constexpr uint16_t ROTATION = 360;
+    constexpr uint16_t DELTA = 10;
+
+    static uint16_t _degree = 0;
+
+    _degree = (_degree + DELTA) % ROTATION;
+
+    // Here, for C(++) these type should be identical
+    // Type information: https://www.khronos.org/opengl/wiki/OpenGL_Type
+    static_assert (std::is_same <float, GLfloat>::value);
+
+    static_assert (std::numeric_limits <uint16_t>::max () <= std::numeric_limits <float>::max ());
+
+    // Avoid total darness
+    constexpr GLfloat _delta = 0.25f;
+    constexpr GLfloat _amplitude = 0.75f;
+
+    // Loosing precision
+    // _amplitude * [0..1] + _delta
+
+    GLfloat _rad = static_cast <GLfloat> (_delta + ( _amplitude * cos (_degree * OMEGA) * cos (_degree * OMEGA)));
+
+    // The function clamps the input to [0, 1]
+
+    constexpr GLfloat _default_color = 0.0f;
+
+    /* void */ glClearColor (red != false ? _rad : _default_color, green != false ? _rad : _default_color, blue != false ? _rad : _default_color, 1.0);
+
+    _ret = glGetError () == GL_NO_ERROR;
+
+    if (_ret != false) {
+        /* void */ glClear (GL_COLOR_BUFFER_BIT);
+
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    return _ret;
+}
+
+GLES::rect_t GLES::Union (rect_t const & lhs, rect_t const & rhs) {
+    rect_t _ret = InvalidRect ();
+
+    if (Empty (lhs) != false) {
+        _ret = rhs;
+    }
+    else if (Empty (rhs) != false) {
+        _ret = lhs;
+    }
+    else {
+        GLint const _x0 = std::min (lhs._x, rhs._x);
+        GLint const _y0 = std::min (lhs._y, rhs._y);
+        GLint const _x1 = std::max (lhs._x + lhs._width, rhs._x + rhs._width);
+        GLint const _y1 = std::max (lhs._y + lhs._height, rhs._y + rhs._height);
+
+        _ret = { _x0, _y0, _x1 - _x0, _y1 - _y0 };
+    }
+
+    return _ret;
+}
+
+GLES::rect_t GLES::Clip (rect_t const & rect, GLsizei width, GLsizei height) {
+    rect_t _ret = InvalidRect ();
+
+    GLint const _x0 = std::max (rect._x, 0);
+    GLint const _y0 = std::max (rect._y, 0);
+    GLint const _x1 = std::min (rect._x + rect._width, width);
+    GLint const _y1 = std::min (rect._y + rect._height, height);
+
+    if (_x1 > _x0 && _y1 > _y0) {
+        _ret = { _x0, _y0, _x1 - _x0, _y1 - _y0 };
+    }
+
+    return _ret;
+}
+
+GLES::rect_t GLES::Project (rect_t const & rect, EGL::img_t const & img, EGL::index_t index, GLsizei width, GLsizei height) const {
+    rect_t _ret = InvalidRect ();
+
+    if (Empty (rect) != true && img._width > 0 && img._height > 0) {
+        offset_t const _off = Offset (index);
+        scale_t const _factor = Scale (index);
+
+        // Image to clip coordinates, per image, as the vertices of RenderEGLImages
+        auto _horiz = [&] (GLint x) -> GLfloat { return Window (static_cast <GLfloat> (x) / static_cast <GLfloat> (img._width) * _factor._horiz + _off._x, width); };
+        auto _vert = [&] (GLint y) -> GLfloat { return Window (static_cast <GLfloat> (y) / static_cast <GLfloat> (img._height) * _factor._vert + _off._y, height); };
+
+        GLfloat const _left = _horiz (rect._x);
+        GLfloat const _right = _horiz (rect._x + rect._width);
+        GLfloat const _bottom = _vert (rect._y);
+        GLfloat const _top = _vert (rect._y + rect._height);
+
+        // Round outwards, partially covered pixels are damaged too, a negative scale mirrors
+        GLint const _x0 = static_cast <GLint> (std::floor (std::min (_left, _right)));
+        GLint const _y0 = static_cast <GLint> (std::floor (std::min (_bottom, _top)));
+        GLint const _x1 = static_cast <GLint> (std::ceil (std::max (_left, _right)));
+        GLint const _y1 = static_cast <GLint> (std::ceil (std::max (_bottom, _top)));
+
+        // Linear filtering samples one texel beyond the edges
+        _ret = Clip ({ _x0 - 1, _y0 - 1, _x1 - _x0 + 2, _y1 - _y0 + 2 }, width, height);
+    }
+
+    return _ret;
+}
+
+GLES::rect_t GLES::Placement (EGL::img_t const & img, EGL::index_t index, GLsizei width, GLsizei height) const {
+    rect_t _ret = InvalidRect ();
+
+    if (img != EGL::InvalidImage () && img._width > 0 && img._height > 0) {
+        offset_t const _off = Offset (index);
+        scale_t const _factor = Scale (index);
+
+        // The corners of the quad of RenderEGLImages, to the nearest pixel
+        GLfloat const _left = Window (_off._x, width);
+        GLfloat const _right = Window (_off._x + _factor._horiz, width);
+        GLfloat const _bottom = Window (_off._y, height);
+        GLfloat const _top = Window (_off._y + _factor._vert, height);
+
+        GLint const _x0 = static_cast <GLint> (std::lround (std::min (_left, _right)));
+        GLint const _y0 = static_cast <GLint> (std::lround (std::min (_bottom, _top)));
+        GLint const _x1 = static_cast <GLint> (std::lround (std::max (_left, _right)));
+        GLint const _y1 = static_cast <GLint> (std::lround (std::max (_bottom, _top)));
+
+        _ret = Clip ({ _x0, _y0, _x1 - _x0, _y1 - _y0 }, width, height);
+    }
+
+    return _ret;
+}
+
+GLfloat GLES::Window (GLfloat clip, GLsizei size) {
+#ifdef _QUIRKS
+    // See Viewport, the viewport is twice the surface, offset by minus its size, clip coordinates [0, 1] cover the surface
+    GLfloat const _ret = clip * static_cast <GLfloat> (size);
+#else
+    // Clip coordinates [-1, 1] cover the surface
+    GLfloat const _ret = (clip + 1.0f) * static_cast <GLfloat> (size) / 2.0f;
+#endif
+
+    return _ret;
+}
+
+bool GLES::Scissor (rect_t const & rect) {
+    bool _ret = glGetError () == GL_NO_ERROR;
+
+    if (_ret != false) {
+        glEnable (GL_SCISSOR_TEST);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    if (_ret != false) {
+        glScissor (rect._x, rect._y, rect._width, rect._height);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    return _ret;
+}
+
+bool GLES::UpdateOffset (offset_t const & off, EGL::index_t index) {
+    bool _ret = false;
+
+    // Ramge check without taking into account rounding errors
+    if (    (off._x + 1.0f >= 0.0f)
+         && (off._x - 1.0f <= 0.0f)
+         && (off._y + 1.0f >= 0.0f)
+         && (off._y - 1.0f <= 0.0f)
+         && Reserve (index) != false ) {
+
+        _offset [index] = off;
+
+        _ret = true;
+    }
+
+    return _ret;
+}
+
+bool GLES::UpdateScale (scale_t const & scale, EGL::index_t index) {
+    bool _ret = false;
+
+    // Ramge check without taking into account rounding errors
+
+    if (    (scale._horiz <= 1.0f)
+         && (scale._vert <= 1.0f)
+         && Reserve (index) != false ) {
+
+        _scale [index] = scale;
+
+        _ret = true;
+    }
+
+    return _ret;
+}
+
+bool GLES::Reserve (EGL::index_t index) {
+    bool _ret = true;
+
+    if (index >= _tex.size ()) {
+        size_t const _size = static_cast <size_t> (index) + 1;
+
+        _tex.resize (_size, InvalidTex ());
+        _offset.resize (_size, InitialOffset ());
+        _scale.resize (_size, scale_t ());
+    }
+
+    return _ret;
+}
+
+bool GLES::ReleaseTexture (EGL::index_t index) {
+    bool _ret = glGetError () == GL_NO_ERROR && index < _tex.size ();
+
+    if (_ret != false && _tex [index] != InvalidTex ()) {
+        glDeleteTextures (1, &_tex [index]);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    if (index < _tex.size ()) {
+        _tex [index] = InvalidTex ();
+        _offset [index] = InitialOffset ();
+        _scale [index] = scale_t ();
+    }
+
+    // Unused slots at the end are given back
+    while (_tex.empty () != true && _tex.back () == InvalidTex ()) {
+        _tex.pop_back ();
+        _offset.pop_back ();
+        _scale.pop_back ();
+    }
+
+    return _ret;
+}
+
+bool GLES::SetupProgram (char const vtx_src [], char const frag_src []) {
+    auto LoadShader = [] (GLuint type, GLchar const code []) -> GLuint {
+        bool _ret = glGetError () == GL_NO_ERROR;
+
+        GLuint _shader = 0;
+        if (_ret != false) {
+            _shader = glCreateShader (type);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false && _shader != 0) {
+            glShaderSource (_shader, 1, &code, nullptr);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glCompileShader (_shader);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        return _shader;
+    };
+
+    auto ShadersToProgram = [] (GLuint vertex, GLuint fragment, GLuint & prog) -> bool {
+        bool _ret = glGetError () == GL_NO_ERROR;
+
+        prog = 0;
+
+        if (_ret != false) {
+            prog = glCreateProgram ();
+            _ret = prog != 0;
+        }
+
+        if (_ret != false) {
+            glAttachShader (prog, vertex);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glAttachShader (prog, fragment);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glBindAttribLocation (prog, 0, "position");
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            glLinkProgram (prog);
+            _ret = glGetError () == GL_NO_ERROR;
+        }
+
+        if (_ret != false) {
+            GLint _status = GL_FALSE;
+
+            glGetProgramiv (prog, GL_LINK_STATUS, &_status);
+            _ret = glGetError () == GL_NO_ERROR && _status != GL_FALSE;
+        }
+
+        // The (cached) program no longer requires them
+        if (prog != 0) {
+            glDetachShader (prog, vertex);
+            glDetachShader (prog, fragment);
+        }
+
+        glDeleteShader (vertex);
+        glDeleteShader (fragment);
+
+        if (_ret != true && prog != 0) {
+            glDeleteProgram (prog);
+            prog = 0;
+        }
+
+        return _ret;
+    };
+
+    // A program binary is only valid for the driver that produced it
+    auto Identity = [] () -> std::string {
+        std::string _ret;
+
+        for (GLenum _name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            GLubyte const * _str = glGetString (_name);
+
+            _ret += (_str != nullptr ? reinterpret_cast <char const *> (_str) : "") + std::string (1, '\0');
+        }
+
+        return _ret;
+    };
+
+    bool _ret = glGetError () == GL_NO_ERROR && vtx_src != nullptr && frag_src != nullptr;
+
+    GLuint _prog = 0;
+
+    if (_ret != false) {
+        std::string const _key = std::string (vtx_src) + std::string (1, '\0') + std::string (frag_src) + std::string (1, '\0') + Identity ();
+
+        auto _it = _programs.find (_key);
+
+        if (_it != _programs.end ()) {
+            _prog = _it->second;
+        }
+        else {
+            if (LoadProgram (_key, _prog) != true) {
+                GLuint _vtxShader = LoadShader (GL_VERTEX_SHADER, vtx_src);
+                GLuint _fragShader = LoadShader (GL_FRAGMENT_SHADER, frag_src);
+
+                _ret = ShadersToProgram (_vtxShader, _fragShader, _prog);
+
+                if (_ret != false) {
+                    /* bool */ StoreProgram (_key, _prog);
+                }
+            }
+
+            if (_ret != false) {
+                _programs [_key] = _prog;
+            }
+        }
+    }
+
+    if (_ret != false) {
+        glUseProgram (_prog);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    if (_ret != false) {
+        glEnable (GL_BLEND);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    if (_ret != false) {
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+    // Color on error
+    if (_ret != true) {
+        glClearColor (1.0f, 0.0f, 0.0f, 0.5f);
+        _ret = glGetError () == GL_NO_ERROR;
+    }
+
+     return _ret;
+}
+
+std::string GLES::ProgramCachePath (std::string const & key) {
+    std::ostringstream _name;
+
+    _name << ProgramCacheDir () << "/" << std::hex << std::hash <std::string> () (key) << ".bin";
+
+    return _name.str ();
+}
+
+bool GLES::LoadProgram (std::string const & key, GLuint & prog) const {
+    // https://registry.khronos.org/OpenGL/extensions/OES/OES_get_program_binary.txt
+    static PFNGLPROGRAMBINARYOESPROC _glProgramBinaryOES = reinterpret_cast <PFNGLPROGRAMBINARYOESPROC> (eglGetProcAddress ("glProgramBinaryOES"));
+
+    bool _ret = _glProgramBinaryOES != nullptr;
+
+    std::ifstream _file;
+
+    if (_ret != false) {
+        _file.open (ProgramCachePath (key), std::ios::in | std::ios::binary);
+        _ret = _file.is_open ();
+    }
+
+    // Layout: key size, key, binary format, binary size, binary
+    uint32_t _size = 0;
+
+    if (_ret != false) {
+        _ret = _file.read (reinterpret_cast <char *> (&_size), sizeof (_size)).good () && _size == key.size ();
+    }
+
+    if (_ret != false) {
+        // Guard against hash collisions
+        std::string _key (_size, '\0');
+        _ret = _file.read (&_key [0], _size).good () && _key == key;
+    }
+
+    GLenum _format = 0;
+    GLint _length = 0;
+
+    if (_ret != false) {
+        _ret =    _file.read (reinterpret_cast <char *> (&_format), sizeof (_format)).good ()
+               && _file.read (reinterpret_cast <char *> (&_length), sizeof (_length)).good ()
+               && _length > 0;
+    }
+
+    std::vector <char> _binary;
+
+    if (_ret != false) {
+        _binary.resize (_length);
+        _ret = _file.read (_binary.data (), _length).good ();
+    }
+
+    prog = 0;
+
+    if (_ret != false) {
+        prog = glCreateProgram ();
+        _ret = prog != 0;
+    }
+
+    if (_ret != false) {
+        _glProgramBinaryOES (prog, _format, _binary.data (), _length);
+
+        // The driver is free to reject any binary, eg, after an update
+        GLint _status = GL_FALSE;
+
+        glGetProgramiv (prog, GL_LINK_STATUS, &_status);
+        _ret = glGetError () == GL_NO_ERROR && _status != GL_FALSE;
+
+        if (_ret != true) {
+            glDeleteProgram (prog);
+            prog = 0;
+
+            std::cout << "Program binary rejected, compiling from source" << std::endl;
+        }
+    }
+
+    return _ret;
+}
+
+bool GLES::StoreProgram (std::string const & key, GLuint prog) const {
+    static PFNGLGETPROGRAMBINARYOESPROC _glGetProgramBinaryOES = reinterpret_cast <PFNGLGETPROGRAMBINARYOESPROC> (eglGetProcAddress ("glGetProgramBinaryOES"));
+
+    GLint _formats = 0;
+
+    glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS_OES, &_formats);
+
+    bool _ret = _glGetProgramBinaryOES != nullptr && glGetError () == GL_NO_ERROR && _formats > 0 && prog != 0;
+
+    GLint _length = 0;
+
+    if (_ret != false) {
+        glGetProgramiv (prog, GL_PROGRAM_BINARY_LENGTH_OES, &_length);
+        _ret = glGetError () == GL_NO_ERROR && _length > 0;
+    }
+
+    std::vector <char> _binary;
+    GLenum _format = 0;
+
+    if (_ret != false) {
+        _binary.resize (_length);
+
+        _glGetProgramBinaryOES (prog, _length, &_length, &_format, _binary.data ());
+        _ret = glGetError () == GL_NO_ERROR && _length > 0;
+    }
+
+    if (_ret != false) {
+        // Possibly, it already exists
+        _ret = mkdir (ProgramCacheDir (), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == 0 || errno == EEXIST;
+    }
+
+    std::string const _path = ProgramCachePath (key);
+    std::string const _tmp = _path + ".tmp";
+
+    if (_ret != false) {
+        std::ofstream _file (_tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        uint32_t const _size = static_cast <uint32_t> (key.size ());
+
+        _ret =    _file.is_open ()
+               && _file.write (reinterpret_cast <char const *> (&_size), sizeof (_size)).good ()
+               && _file.write (key.data (), key.size ()).good ()
+               && _file.write (reinterpret_cast <char const *> (&_format), sizeof (_format)).good ()
+               && _file.write (reinterpret_cast <char const *> (&_length), sizeof (_length)).good ()
+               && _file.write (_binary.data (), _length).good ();
+    }
+
+    if (_ret != false) {
+        // Never leave a partial file behind for the next start
+        _ret = rename (_tmp.c_str (), _path.c_str ()) == 0;
+    }
+
+    if (_ret != true) {
+        /* int */ unlink (_tmp.c_str ());
+    }
+
+    return _ret;
+}
+
+bool RenderClient::Init () {
+    bool _ret = Clear () && Base::Status () && _gles.Status ();
+
+    if (_ret != false) {
+        _ret = Connect ();
+    }
+
+    if (_ret != true) {
+        /* bool */ Deinit ();
+    }
+
+    return _ret;
+}
+
+bool RenderClient::Deinit () {
+    // The compositor frees the slot of this client
+    if (_channel != DRM::GBM::InvalidFd ()) {
+        /* int */ close (_channel);
+    }
+
+    bool _ret = Clear ();
+
+    return _ret;
+}
+
+bool RenderClient::Connect () {
+    DRM::GBM::fd_t _pair [2] = { DRM::GBM::InvalidFd (), DRM::GBM::InvalidFd () };
+
+    bool _ret = socketpair (AF_LOCAL, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, _pair) == 0;
+
+    if (_ret != false) {
+        _ret = SendRegistration (_pair [0]);
+
+        // The compositor has received its own duplicate
+        /* int */ close (_pair [0]);
+
+        if (_ret != false) {
+            _channel = _pair [1];
+        }
+        else {
+            /* int */ close (_pair [1]);
+        }
+    }
+
+    if (_ret != false) {
+        std::cout << "Client [" << std::to_string (_id) << "] has registered, idle resident memory " << std::to_string (Resident ()) << " [kB]" << std::endl;
+    }
+    else {
+        std::cout << "Error: client [" << std::to_string (_id) << "] is unable to register (" << strerror (errno) << ")" << std::endl;
+    }
+
+    return _ret;
+}
+
+bool RenderClient::Run () {
+    bool _ret = Status ();
+
+    if (_ret != false) {
+
+        // Breaks on error like a disconnected communication channel
+        while (_ret != false) {
+            // The next frame is rendered once the previous one has been presented
+            _ret = CreateRemoteBuffer () != false && ShareBuffer () != false && Render () != false && AwaitPresented () != false && DestroyRemoteBuffer () != false;
+
+            if (_ret != false) {
+                ++_count;
+
+                std::string const _id_s = std::to_string (_id);
+                std::cout << "Client [" << _id_s << "] completed rendering frame." << std::endl;
+            }
+
+#ifdef DEBUG
+            if (_ret != false && _frames == 0) {
+                // Simulate some (additional) processing
+                constexpr unsigned int _nanoseconds = 1000 * 1000 * 1000;
+
+                struct timespec _timeout {0, _nanoseconds};
+
+                // Simulate some (additional) processing
+                _timeout.tv_nsec = static_cast <int> ( static_cast <double> ( rand () ) / static_cast <double> ( RAND_MAX ) * 1000 * 1000 * 1000 * 2);
+
+                _timeout.tv_sec = _timeout.tv_nsec / (1000 * 1000 * 1000);
+                _timeout.tv_nsec = _timeout.tv_nsec % (1000 * 1000 * 1000);
+
+                struct timespec _remaining = {0, 0};
+                if (nanosleep ( &_timeout, &_remaining ) != 0) {
+                    std::cout << "Error: RenderClient [" << std::to_string (_id) << "] is unable to complete time out of : " << std::to_string (_timeout.tv_nsec) << " [nsec]. Remaining time [nsec] : " << std::to_string (_remaining.tv_nsec) << std::endl;
+                }
+            }
+#endif
+
+// TODO: signal completion
+        }
+
+        if (_frames > 0) {
+            // The compositor ends a non-interactive run by closing the channel
+            std::cout << "Client [" << std::to_string (_id) << "] rendered " << std::to_string (_count) << " frame(s)" << std::endl;
+
+            if (_presented > 1) {
+                uint64_t const _elapsed = _last._timestamp - _first._timestamp;
+
+                std::cout << "Client [" << std::to_string (_id) << "] had " << std::to_string (_presented) << " frame(s) presented over " << std::to_string (_last._sequence - _first._sequence) << " vblank(s), every " << std::to_string (_elapsed / (_presented - 1)) << " [usec] on average" << std::endl;
+            }
+
+            _ret = true;
+        }
+
+    }
+    else {
+        // Error
+        std::cout << "Error: unable to initialize." << std::endl;
+    }
+
+    return _ret;
+}
+
+bool RenderClient::RenderMemory (bool red, bool green, bool blue, GLES::rect_t & damage) {
+    DRM::GBM::prime_t const & _prime = _drm.Get ().Prime ();
+
+    bool _ret = _prime._memory != false && _prime._fd != DRM::GBM::InvalidFd ();
+
+    void * _data = MAP_FAILED;
+
+    if (_ret != false) {
+        _data = mmap (nullptr, DRM::GBM::Size (_prime), PROT_READ | PROT_WRITE, MAP_SHARED, _prime._fd, 0);
+
+        _ret = _data != MAP_FAILED;
+
+        if (_ret != true) {
+            std::cout << "Error: client [" << std::to_string (_id) << "] is unable to map shared memory (" << strerror (errno) << ")" << std::endl;
+        }
+    }
+
+    if (_ret != false) {
+        // ARGB8888, the client's color pulsates with the frame count, similar to GLES::RenderColor
+        constexpr float OMEGA = 3.14159265 / 180;
+        constexpr uint16_t ROTATION = 360;
+        constexpr uint16_t DELTA = 10;
+
+        float const _cos = std::cos (static_cast <float> ((_count * DELTA) % ROTATION) * OMEGA);
+
+        uint32_t const _level = static_cast <uint32_t> (255.0f * (0.25f + 0.75f * _cos * _cos));
+
+        uint32_t const _background = 0xFF000000 | (red != false ? _level << 16 : 0) | (green != false ? _level << 8 : 0) | (blue != false ? _level : 0);
+
+        // The same triangle as GLES::RenderTriangle, rows bottom up as rendered by GL
+        constexpr uint32_t _foreground = 0xFF00FF00;
 
-bool EGL::Clear () {
-    bool _ret = false;
+        size_t const _width = _prime._width;
+        size_t const _height = _prime._height;
 
-    _dpy = InvalidDisplay ();;
-//    _cfg = EGL_NO_CONFIG
-    _surf = InvalidSurface ();
-    _ctx = InvalidContext ();;
+        for (size_t _y = 0; _y < _height; _y++) {
+            uint32_t * _row = reinterpret_cast <uint32_t *> (reinterpret_cast <uint8_t *> (_data) + _y * _prime._stride);
 
-    for (size_t _index = 0; _index < _max_images; _index++) {
-        EGL::_img [_index] = InvalidImage ();
-    }
+            for (size_t _x = 0; _x < _width; _x++) {
+                _row [_x] = _x * _height + _y * _width < _width * _height ? _foreground : _background;
+            }
+        }
 
-    const_cast <remove_const <valid_t>::type &> (_valid) = false;
+        damage = { 0, 0, static_cast <GLsizei> (_width), static_cast <GLsizei> (_height) };
 
-    _ret = Status () != true;
+        // Written back before the compositor is told
+        /* int */ munmap (_data, DRM::GBM::Size (_prime));
+    }
 
     return _ret;
 }
 
-bool GLES::Init () {
-    bool _ret = Clear ();
+bool RenderClient::AwaitPresented () {
+    DRM::vblank_t _vblank = { 0, 0 };
 
-    return _ret;
-}
+    remove_const <Base::id_t>::type _sender = 0;
 
-bool GLES::Deinit () {
-    bool _ret = Clear ();
+    // Only the compositor, with id 0, presents
+    bool _ret = ReceivePresented (_channel, _vblank, _sender) != false && _sender == 0;
+
+    if (_ret != false) {
+        if (_presented == 0) {
+            _first = _vblank;
+        }
+
+        _last = _vblank;
+
+        ++_presented;
+
+        std::cout << "Client [" << std::to_string (_id) << "] frame presented at vblank " << std::to_string (_vblank._sequence) << " (" << std::to_string (_vblank._timestamp) << " [usec])" << std::endl;
+    }
 
     return _ret;
 }
 
-bool GLES::RenderTile () {
-    constexpr char const _vtx_src [] =
-        "#version 100                               \n"
-        "attribute vec3 position;                   \n"
-        "varying vec2 coordinates;                  \n"
-        "void main () {                             \n"
-            "gl_Position = vec4 (position.xyz, 1);  \n"
-            "coordinates = position.xy;             \n"
-        "}                                          \n"
-        ;
+bool RenderClient::CreateRemoteBuffer () {
+    bool _ret = true;
 
-// TODO: For normal rendering no extention
+// TODO: communicate over channel
 
-    constexpr char  const _frag_src [] =
-        "#version 100                                                           \n"
-        "#extension GL_OES_EGL_image_external : require                         \n"
-        "precision mediump float;                                               \n"
-        "uniform samplerExternalOES sampler;                                    \n"
-        "varying vec2 coordinates;                                              \n"
-        "void main () {                                                         \n"
-            "gl_FragColor = vec4 (texture2D (sampler, coordinates).rgb, 1.0f);  \n"
-        "}                                                                      \n"
-        ;
+    std::cout << "RenderClient [" << std::to_string (_id) << "] has requested to create a remote buffer" << std::endl;
 
-    static_assert (is_same <GLfloat, GLES::offset::coordinate_t>:: value != false);
-    std::array <GLfloat, 4 * VerticeDimensions> const _vert = {
-        0.0f, 0.0f, 0.0f /* v0 */,
-        1.0f, 0.0f, 0.0f /* v1 */,
-        0.0f, 1.0f, 0.0f /* v2 */,
-        1.0f, 1.0f, 0.0f /* v3 */};
+    return _ret;
+}
 
-    bool _ret = glGetError () == GL_NO_ERROR
-                && RenderColor (true, false, false)
-                && SetupProgram (_vtx_src, _frag_src)
-                && RenderPolygon (_vert);
+bool RenderClient::DestroyRemoteBuffer () {
+    bool _ret = true;
+
+// TODO: communicate over channel
+
+    std::cout << "RenderClient [" << std::to_string (_id) << "] has requested to destroy a remote buffer" << std::endl;
 
     return _ret;
 }
 
-bool GLES::RenderTriangle () {
-    constexpr char const _vtx_src [] =
-        "#version 100                               \n"
-        "attribute vec3 position;                   \n"
-        "void main () {                             \n"
-            "gl_Position = vec4 (position.xyz, 1);  \n"
-        "}                                          \n"
-        ;
-
-    constexpr char  const _frag_src [] =
-        "#version 100                                                           \n"
-        "precision mediump float;                                               \n"
-        "void main () {                                                         \n"
-            "gl_FragColor = vec4 (0.0f, 1.0f, 0.0f, 1.0f);                      \n"
-        "}                                                                      \n"
-        ;
+bool RenderClient::ShareBuffer () {
+    bool _ret = Base::ShareBuffer (_priv, _channel);
 
-    static_assert (is_same <GLfloat, GLES::offset::coordinate_t>:: value != false);
-    std::array <GLfloat, 3 * VerticeDimensions> const _vert = {
-        -1.0f, -1.0f, 0.0f /* v0 */,
-        1.0f, -1.0f, 0.0f /* v1 */,
-        -1.0f, 1.0f, 0.0f /* v2 */ };
+    if (_ret != false) {
+        // A new buffer
+        _ret = Transition (_owner, OWNER::CLIENT, "Client [" + std::to_string (_id) + "]");
+    }
 
-    bool _ret = glGetError () == GL_NO_ERROR
-                && RenderColor (false, false, true)
-                && SetupProgram (_vtx_src, _frag_src)
-                && RenderPolygon (_vert);
+    if (_ret != false) {
+        std::cout << "RenderClient [" << std::to_string (_id) << "] has received access to the remote buffer" << std::endl;
+    }
 
     return _ret;
 }
 
-// TODO: Code growth if N differs
+bool RenderClient::Render () {
+    // Three color channels for three clients
 
-template <size_t N>
-bool GLES::RenderPolygon (std::array <GLfloat, N> const & vert) {
-    bool _ret = glGetError () == GL_NO_ERROR;
+    bool _red = false, _green = false, _blue = false;
 
-    if (_ret != false) {
-        GLuint _prog = 0;
+    // Different colors help to identify client
+    // Primaries are used elsewhere
+    switch (_id) {
+        case 0  : _red = true;  _green = true;  _blue = false;  break;
+        case 1  : _red = false; _green = true;  _blue = true;   break;
+        case 2  : _red = true;  _green = false; _blue = true;   break;
+        default : _red = true;  _green = true;  _blue = true;   break;
+    }
 
-        if (_ret != false) {
-            glGetIntegerv (GL_CURRENT_PROGRAM, reinterpret_cast <GLint *> (&_prog));
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    constexpr EGL::index_t _index = 0;
 
-        GLint _loc = 0;
-        if (_ret != false) {
-            _loc = glGetAttribLocation (_prog, "position");
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    bool _ret = true;
 
-        if (_ret != false) {
-            glVertexAttribPointer (_loc, VerticeDimensions, GL_FLOAT, GL_FALSE, 0, vert.data ());
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+#ifdef _VALIDATE
+    // The buffer may have been submitted already, the compositor is possibly reading it
+    _ret = _owner == OWNER::CLIENT;
 
-        if (_ret != false) {
-            glEnableVertexAttribArray (_loc);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    if (_ret != true) {
+        std::cout << "Validation: client [" << std::to_string (_id) << "] renders into a buffer it does not own, use after release" << std::endl;
+    }
+#endif
 
-        if (_ret != false) {
-            glDrawArrays (GL_TRIANGLE_STRIP, 0, vert.size () / VerticeDimensions);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    DRM::GBM::fd_t _fence = DRM::GBM::InvalidFd ();
 
-        if (_ret != false) {
-            glDisableVertexAttribArray (_loc);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    if (_egl.Image (_index) != EGL::InvalidImage ()) {
+        _ret =    _ret != false
+               && _gles.RenderEGLImage (_egl.Image (_index)) != false
+               && _egl.Render () != false
+               // No glFinish, the compositor waits for the fence, if any
+               && _egl.Fence (_fence) != false
+               // Tell the compositor what has changed
+               && SendDamage (_channel, _gles.Damage (), _fence) != false;
+    }
+    else {
+        GLES::rect_t _damage = GLES::InvalidRect ();
+
+        // Complete once written, nothing to wait for
+        _ret =    _ret != false
+               && RenderMemory (_red, _green, _blue, _damage) != false
+               && SendDamage (_channel, _damage, _fence) != false;
+    }
+
+    if (_fence != DRM::GBM::InvalidFd ()) {
+        // The compositor has its own duplicate
+        /* int */ close (_fence);
+    }
+
+    if (_ret != false) {
+        // Hands off
+        _ret = Transition (_owner, OWNER::SUBMITTED, "Client [" + std::to_string (_id) + "]");
     }
 
     return _ret;
 }
 
-bool GLES::RenderEGLImage (EGL::img_t const  & img, decltype (_max_textures) index) {
-    bool _ret = glGetError () == GL_NO_ERROR && img != EGL::InvalidImage ();
-// TODO: add check ?
-//    fbo = _tgt != GL_TEXTURE_EXTERNAL_OES;
+bool RenderClient::Clear () {
+    bool _ret = false;
 
-    if (index < _max_textures) {
+    _count = 0;
 
-        if (_ret != false) {
-            glBindTexture(GL_TEXTURE_2D, 0);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    _channel = DRM::GBM::InvalidFd ();
 
-        if (_ret != false) {
-            glBindFramebuffer (GL_FRAMEBUFFER, 0);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    _owner = OWNER::RELEASED;
 
-        if (_ret != false) {
-            glActiveTexture (GL_TEXTURE0);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    _first = { 0, 0 };
+    _last = { 0, 0 };
 
-        if (_ret != false) {
-            if (_tex [index] != InvalidTex ()) {
-                glDeleteTextures (1, &_tex [index]);
-                _ret = glGetError () == GL_NO_ERROR;
-            }
+    _presented = 0;
 
-            _tex [index] = InvalidTex ();
+    const_cast <remove_const <valid_t>::type &> (_valid) = false;
 
-            if (_ret != false) {
-                glGenTextures (1, &_tex [index]);
-                _ret = glGetError () == GL_NO_ERROR;
-            }
-        }
+    _ret = Status () != true;
 
-        if (_ret != false) {
-            glBindTexture (_tgt, _tex [index]);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    return _ret;
+}
 
-        if (_ret != false) {
-            glTexParameteri (_tgt, GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+bool Compositor::Init () {
+    bool _ret = Clear () && Base::Status () && _gles.Status ();
 
-        if (_ret != false) {
-            glTexParameteri (_tgt, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    // The base line for the memory used per client
+    _resident = Resident ();
 
-        if (_ret != false) {
-            glTexParameteri (_tgt, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    if (_ret != false && _adaptive != false && _drm.Adaptive (true) != true) {
+        // Not fatal, flips follow the fixed frame period
+        std::cout << "Adaptive sync is not supported, using the fixed refresh rate" << std::endl;
+    }
 
-        if (_ret != false) {
-            glTexParameteri (_tgt, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    if (_ret != true) {
+        /* bool */ Deinit ();
+    }
 
-        // Requires EGL 1.2 and either the EGL_OES_image or EGL_OES_image_base
-        // Use eglGetProcAddress, or dlsym for the function pointer of this GL extenstion
-        // https://www.khronos.org/registry/OpenGL/extensions/OES/OES_EGL_image_external.txt
-        static void (* _EGLImageTargetTexture2DOES) (GLenum, GLeglImageOES) = reinterpret_cast < void (*) (GLenum, GLeglImageOES) > (eglGetProcAddress ("glEGLImageTargetTexture2DOES"));
+    return _ret;
+}
 
-        if (_ret != false && _EGLImageTargetTexture2DOES != nullptr) {
-            _EGLImageTargetTexture2DOES (_tgt, reinterpret_cast <GLeglImageOES> (img._khr));
-            _ret = glGetError () == GL_NO_ERROR;
-        }
-        else {
-            _ret = false;
+bool Compositor::Deinit () {
+    // Also ends the clients of a non-interactive run
+    for (size_t _index = 0; _index < _slots.size (); _index++) {
+        if (_slots [_index]._channel != DRM::GBM::InvalidFd ()) {
+            /* bool */ Unregister (static_cast <index_t> (_index));
         }
+    }
 
-        if (_ret != false) {
-            if (_tgt != GL_TEXTURE_EXTERNAL_OES) {
-                if (_fbo != InvalidFbo ()) {
-                    glDeleteFramebuffers (1, &_fbo);
-                    _ret = glGetError () == GL_NO_ERROR;
-                }
+    for (auto _connection : _connecting) {
+        /* int */ close (_connection);
+    }
 
-                if (_ret != false) {
-                    glGenFramebuffers(1, &_fbo);
-                    _ret = glGetError () == GL_NO_ERROR;
-                }
+    if (_listen != DRM::GBM::InvalidFd ()) {
+        /* int */ close (_listen);
+
+        /* int */ unlink (_address.c_str ());
+    }
+
+    bool _ret = Clear ();
+
+    return _ret;
+}
+
+bool Compositor::Run () {
+    bool _ret = Status () && Listen ();
+
+    if ( _ret != false) {
+
+        std::chrono::steady_clock::time_point const _start = std::chrono::steady_clock::now ();
+
+        while (AwaitRequestCreateSharingBuffer () != false) {
+
+            // A dropped frame is retried once per frame period, see Dispatch
+            if (Pending () != false || Presenting () != false) {
+                // The newest frame of every client at once, the flip has completed on return, see DRM::ScanOut
+                _ret = Measure (STAGE::RENDER, [this] () { return Render (); });
 
                 if (_ret != false) {
-                    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
-                    _ret = glGetError () == GL_NO_ERROR;
+                    ++_count;
                 }
+                else if (_drm.Recoverable () != false) {
+                    // Eg, the previous flip has not completed, the damage is shown with the next frame
+                    std::cout << "Warning: frame dropped" << std::endl;
 
-                if (_ret != false) {
-                    glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, _tgt, _tex [index], 0 /* level */);
-                    _ret = glGetError () == GL_NO_ERROR;
+                    _ret = true;
                 }
             }
-        }
 
-        EGLDisplay _dpy = EGL::InvalidDisplay ();
+            // Whatever arrives until then is composited with the next frame, a slow client only misses frames of its own
+            _ret =    _ret != false
+                   && ShareBuffers () != false
+                   && Measure (STAGE::AWAIT, [this] () { return Dispatch (); }) != false;
 
-        if (_ret != false) {
-            _dpy = eglGetCurrentDisplay ();
-            _ret = eglGetError () == EGL_SUCCESS
-                   && _dpy != EGL::InvalidDisplay ();
+            if (_ret != true) {
+                std::cout << "Error: cannot render a shared buffer" << std::endl;
+                break;
+            }
         }
 
-        EGLSurface _surf = EGL::InvalidSurface ();
+        if (_frames > 0) {
+            Statistics (std::chrono::steady_clock::now () - _start);
 
-        if (_ret != false) {
-            _surf = eglGetCurrentSurface (EGL_DRAW);
-            _ret  = eglGetError () == EGL_SUCCESS
-                    && _surf != EGL::InvalidSurface ();
+            _ret = _ret != false && _count == _frames;
         }
 
-        EGLint _width = 0, _height = 0;
-
-        if (_ret != false) {
-            _ret = eglQuerySurface (_dpy, _surf, EGL_WIDTH, &_width) != EGL_FALSE
-                   && eglQuerySurface (_dpy, _surf, EGL_HEIGHT, &_height) != EGL_FALSE
-                   && eglGetError () == EGL_SUCCESS;
-        }
+    }
+    else {
+        // Error
+        std::cout << "Error: unable to initialize." << std::endl;
+    }
 
-        GLint _dims [2] = {0, 0};
+    return _ret;
+}
 
-        if (_ret != false) {
-            glGetIntegerv (GL_MAX_VIEWPORT_DIMS, &_dims [0]);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+bool Compositor::CreateSharedBuffer () {
+    // A released buffer is reused, see Release
+    /* bool */ DestroySharedBuffer ();
 
-        if (_ret != false) {
-            if (_tgt == GL_TEXTURE_EXTERNAL_OES) {
-                // Compositor side; Image rendered on surface
+    DRM::GBM & _gbm = _drm.Get ();
 
-#ifdef _QUIRKS
-                // glViewport (x, y, width, height)
-                //
-                // Applied width = width / 2
-                // Applied height = height / 2
-                // Applied origin's x = width / 2 + x
-                // Applied origin's y = height / 2 + y
-                //
-                // Compensate to origin bottom left and true size by
-                // glViewport (-width, -height, width * 2, height * 2)
-                //
-                // _offset is in the range -1..1 wrt to origin, so the effective value maps to -width to width, -height to height
+    bool _ret = _gbm.CreatePrime ();
 
-                constexpr uint8_t _mult = 2;
+    return _ret;
+}
 
-                using common_t = std::common_type < decltype (_width), decltype (_height), decltype (_mult), decltype (_scale._horiz), decltype (_scale._vert), decltype (_offset._x), decltype (_offset._y), remove_pointer < std::decay < decltype (_dims) > :: type > :: type > :: type;
+bool Compositor::DestroySharedBuffer () {
+    DRM::GBM & _gbm = _drm.Get ();
 
-                common_t _quirk_width = static_cast <common_t> (_width) * static_cast <common_t> (_mult) * static_cast <common_t> (_scale._horiz);
-                common_t _quirk_height = static_cast <common_t> (_height) * static_cast <common_t> (_mult) * static_cast <common_t> (_scale._vert);
+    bool _ret = _gbm.DestroyPrime ();
 
-                common_t _quirk_x = ( static_cast <common_t> (-_width) * static_cast <common_t> (_scale._horiz) ) + ( static_cast <common_t> (_offset._x) * static_cast <common_t> (_width) );
-                common_t _quirk_y = ( static_cast <common_t> (-_height) * static_cast <common_t> (_scale._vert) ) + ( static_cast <common_t> (_offset._y) * static_cast <common_t> (_height) );
+    return _ret;
+}
 
-                if (    _quirk_x < ( -_quirk_width / static_cast <common_t> (_mult) )
-                     || _quirk_y < ( -_quirk_height / static_cast <common_t> (_mult) )
-                     || _quirk_x  > static_cast <common_t> (0)
-                     || _quirk_y  > static_cast <common_t> (0)
-                     || _quirk_width > ( static_cast <common_t> (_width) * static_cast <common_t> (_mult) )
-                     || _quirk_height > ( static_cast <common_t> (_height) * static_cast <common_t> (_mult) )
-                     || static_cast <common_t> (_width) > static_cast <common_t> (_dims [0])
-                     || static_cast <common_t> (_height) > static_cast <common_t> (_dims [1])
-                ) {
-                    // Clipping, or undefined / unknown behavior
-                    std::cout << "Warning: possible clipping or unknown behavior detected. [" << _quirk_x << ", " << _quirk_y << ", " << _quirk_width << ", " << _quirk_height << ", " << _width << ", " << _height << ", " << _dims [0] << ", " << _dims [1] << "]" << std::endl;
-                }
+bool Compositor::AwaitRequestCreateSharingBuffer () {
+    bool _ret = _frames == 0 || _count < _frames;
 
-                glViewport (static_cast <GLint> (_quirk_x), static_cast <GLint> (_quirk_y), static_cast <GLsizei> (_quirk_width), static_cast <GLsizei> (_quirk_height));
-#else
-                glViewport (0, 0, _width, _height);
-#endif
+// TODO: communicate over channel
 
-                _ret = glGetError () == GL_NO_ERROR && RenderTile () != false;
+    char _key = '\0';
 
-                glFinish ();
+    // Interactive, each composited frame is confirmed
+    if (_frames == 0 && Pending () != false) {
+        _ret = false;
 
-                _ret = _ret != false && glGetError () == GL_NO_ERROR;
+        while (ReadKey ("Press 'c' to composite the frames received so far, 'Enter' or 'q' to quit", _key) != false && _key != 'q') {
+            switch (_key) {
+                case 'c'    :   {
+                                    _ret = true;
+                                    break;
+                                }
+                default     :   {
+                                    continue;
+                                }
             }
-            else {
-                // Client side, EGLImage as color attachment
 
-                // Center in the smallest possible dimensions
+            break;
+        }
+    }
 
-                constexpr uint8_t _mult = 2;
+    if (_ret != false) {
+        // Without any client there is nothing to composite
+        /* bool */ Accept (Registered () == 0);
 
-                using common_t = std::common_type < decltype (_width), decltype (_height), decltype (_mult), remove_pointer < std::decay < decltype (_dims) > :: type > :: type > :: type;
+        _ret = Registered () > 0;
+    }
 
-                common_t _prop_width = static_cast <common_t> (_width) > static_cast <common_t> (_dims [0]) ? static_cast <common_t> (_dims [0]) : static_cast <common_t> (_width);
-                common_t _prop_height = static_cast <common_t> (_height) > static_cast <common_t> (_dims [1]) ? static_cast <common_t> (_dims [1]) : static_cast <common_t> (_height);
+    return _ret;
+}
 
-                common_t _prop_x = ( static_cast <common_t> (_width) - _prop_width ) / static_cast <common_t> (_mult);
-                common_t _prop_y = ( static_cast <common_t> (_height) - _prop_height ) / static_cast <common_t> (_mult);
+bool Compositor::AwaitRequestCompleteSharingBuffer (index_t index) {
+    bool _ret = index < _slots.size () && _slots [index]._channel != DRM::GBM::InvalidFd ();
 
-                if (   _prop_x > static_cast <common_t> (0)
-                    || _prop_y > static_cast <common_t> (0)
-                ) {
-                    // Clipping
-                    std::cout << "Warning: possible clipping detected. [" << _prop_x << ", " << _prop_y << ", " << _prop_width << ", " << _prop_height << ", " << _width << ", " << _height << "]" << std::endl;
-                }
+    remove_const <Base::id_t>::type _client = 0;
 
-                // Image scaled to 'full' size
-                glViewport (static_cast <GLint> (_prop_x), static_cast <GLint> (_prop_y), static_cast <GLsizei> (_prop_width), static_cast <GLsizei> (_prop_height));
+    if (_ret != false && _slots [index]._external != false && _slots [index]._shared._prime._fd == DRM::GBM::InvalidFd ()) {
+        slot_t & _slot = _slots [index];
 
-                _ret = glGetError () == GL_NO_ERROR && RenderTriangle ();
+        // Its own buffer precedes the damage
+        struct buffer _buffer = InvalidBuffer ();
 
-                glFinish ();
+        _ret =    ReceiveBuffer (_slot._channel, _buffer._prime, _buffer._serial, _client) != false
+               && _client == _slot._id
+               && Transition (_buffer._owner, OWNER::CLIENT, "Client [" + std::to_string (_slot._id) + "] buffer") != false;
 
-                _ret = _ret != false && glGetError () == GL_NO_ERROR;
+        if (_ret != false) {
+            _slot._shared = _buffer;
+        }
+        else {
+            std::cout << "Error: no buffer received from client [" << std::to_string (_slot._id) << "]" << std::endl;
+
+            if (_buffer._prime._fd != DRM::GBM::InvalidFd ()) {
+                /* int */ close (_buffer._prime._fd);
             }
         }
+    }
+    else if (_ret != false && _slots [index]._shared._prime != DRM::GBM::InvalidPrime ()) {
+        slot_t & _slot = _slots [index];
+
+        GLES::rect_t _damage = GLES::InvalidRect ();
+
+        DRM::GBM::fd_t _fence = DRM::GBM::InvalidFd ();
+
+        // Only the client itself can answer on its channel
+        _ret = ReceiveDamage (_slot._channel, _damage, _client, _fence) != false && _client == _slot._id;
+
+        if (_ret != false) {
+            _slot._shared._fence = _fence;
+
+            // Composited at the next render, unless superseded by a newer frame of the same client
+            _ret = Submit (_slot._shared, _damage, index);
+        }
+        else {
+            std::cout << "Error: no damage received from client [" << std::to_string (_slot._id) << "]" << std::endl;
 
+            if (_fence != DRM::GBM::InvalidFd ()) {
+                /* int */ close (_fence);
+            }
+        }
+    }
+    else {
+        // A forked client is silent until it has received its next buffer, it has gone
+        _ret = false;
     }
 
     return _ret;
 }
 
-bool GLES::Clear () {
-    bool _ret = false;
+bool Compositor::Listen () {
+    bool _ret = _address.empty () != false;
 
-    _fbo = InvalidFbo ();
+    struct sockaddr_un _addr;
+    memset (&_addr, 0, sizeof (_addr));
 
-    for (size_t _index = 0; _index < _max_textures; _index++) {
-        _tex [_index] = InvalidTex ();
-    }
+    _addr.sun_family = AF_UNIX;
 
-    _offset = GLES::InitialOffset ();
+    if (_ret != true && _address.size () < sizeof (_addr.sun_path)) {
+        strncpy (_addr.sun_path, _address.c_str (), sizeof (_addr.sun_path) - 1);
 
-    const_cast <remove_const <valid_t>::type &> (_valid) = false;
+        // A stale socket of a previous run
+        /* int */ unlink (_address.c_str ());
 
-    _ret = Status () != true;
+        // Message boundaries are kept, each receive is one complete message
+        _listen = socket (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
 
-    return _ret;
-}
+        _ret =    _listen != DRM::GBM::InvalidFd ()
+               && bind (_listen, reinterpret_cast <struct sockaddr *> (&_addr), sizeof (_addr)) == 0
+               && listen (_listen, SOMAXCONN) == 0;
 
-bool GLES::RenderColor (bool red, bool green, bool blue) {
-    bool _ret = false;
+        if (_ret != true) {
+            std::cout << "Error: unable to listen at " << _address << " (" << strerror (errno) << ")" << std::endl;
 
-    constexpr float OMEGA = 3.14159265 / 180;
-    constexpr uint16_t ROTATION = 360;
-    constexpr uint16_t DELTA = 10;
+            if (_listen != DRM::GBM::InvalidFd ()) {
+                /* int */ close (_listen);
 
-    static uint16_t _degree = 0;
+                _listen = DRM::GBM::InvalidFd ();
+            }
+        }
+        else {
+            std::cout << "External clients may connect at " << _address << std::endl;
+        }
+    }
 
-    _degree = (_degree + DELTA) % ROTATION;
+    return _ret;
+}
 
-    // Here, for C(++) these type should be identical
-    // Type information: https://www.khronos.org/opengl/wiki/OpenGL_Type
-    static_assert (std::is_same <float, GLfloat>::value);
+bool Compositor::Accept (bool block) {
+    bool _ret = false;
 
-    static_assert (std::numeric_limits <uint16_t>::max () <= std::numeric_limits <float>::max ());
+    // Forked clients over the shared channel, external clients over the listening socket, and those connected that have yet to register, a negative descriptor is ignored by poll
+    std::vector <struct pollfd> _fds = { { _accepting != false ? _sv : DRM::GBM::InvalidFd (), POLLIN, 0 }, { _listen, POLLIN, 0 } };
 
-    // Avoid total darness
-    constexpr GLfloat _delta = 0.25f;
-    constexpr GLfloat _amplitude = 0.75f;
+    for (auto _connection : _connecting) {
+        _fds.push_back ({ _connection, POLLIN, 0 });
+    }
 
-    // Loosing precision
-    // _amplitude * [0..1] + _delta
+    // Possibly, several are pending
+    while ((_accepting != false || _listen != DRM::GBM::InvalidFd ()) && poll (_fds.data (), static_cast <nfds_t> (_fds.size ()), block != false ? -1 : 0) > 0) {
+        DRM::GBM::fd_t _channel = DRM::GBM::InvalidFd ();
 
-    GLfloat _rad = static_cast <GLfloat> (_delta + ( _amplitude * cos (_degree * OMEGA) * cos (_degree * OMEGA)));
+        remove_const <Base::id_t>::type _id = 0;
 
-    // The function clamps the input to [0, 1]
+        if ((_fds [0].revents & (POLLIN | POLLHUP)) != 0) {
+            if (ReceiveRegistration (_channel, _id) != false) {
+                _ret = Register (_channel, _id) || _ret;
+            }
+            else {
+                // All (potential) clients have gone
+                _accepting = false;
 
-    constexpr GLfloat _default_color = 0.0f;
+                _fds [0].fd = DRM::GBM::InvalidFd ();
+            }
+        }
 
-    /* void */ glClearColor (red != false ? _rad : _default_color, green != false ? _rad : _default_color, blue != false ? _rad : _default_color, 1.0);
+        // Its registration is received once it has arrived, a slow, or silent, peer never stalls the compositor
+        for (size_t _i = 2; _i < _fds.size (); _i++) {
+            if ((_fds [_i].revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+                _channel = _fds [_i].fd;
 
-    _ret = glGetError () == GL_NO_ERROR;
+                // Only this poll iteration
+                _fds [_i].fd = DRM::GBM::InvalidFd ();
 
-    if (_ret != false) {
-        /* void */ glClear (GL_COLOR_BUFFER_BIT);
+                /* iterator */ _connecting.erase (std::remove (_connecting.begin (), _connecting.end (), _channel), _connecting.end ());
 
-        _ret = glGetError () == GL_NO_ERROR;
-    }
+                int const _flags = fcntl (_channel, F_GETFL);
 
-    return _ret;
-}
+                if (   ReceiveRegistration (_channel, _id) != false
+                    // Registered, it is served as any forked client
+                    && _flags != -1
+                    && fcntl (_channel, F_SETFL, _flags & ~O_NONBLOCK) == 0
+                   ) {
+                    _ret = Register (_channel, _id, true) || _ret;
+                }
+                else {
+                    std::cout << "Error: an external client has not registered" << std::endl;
 
-bool GLES::UpdateOffset (offset_t const & off) {
-    bool _ret = false;
+                    /* int */ close (_channel);
+                }
+            }
+        }
 
-    // Ramge check without taking into account rounding errors
-    if (    (off._x + 1.0f >= 0.0f)
-         && (off._x - 1.0f <= 0.0f)
-         && (off._y + 1.0f >= 0.0f)
-         && (off._y - 1.0f <= 0.0f) ) {
+        if ((_fds [1].revents & POLLIN) != 0) {
+            _channel = accept4 (_listen, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
 
-        _offset = off;
+            if (_channel != DRM::GBM::InvalidFd ()) {
+                // Its registration may not have been sent yet
+                _connecting.push_back (_channel);
 
-        _ret = true;
+                _fds.push_back ({ _channel, POLLIN, 0 });
+            }
+        }
+
+        // Only wait for the first registration
+        block = block != false && _ret != true;
     }
 
     return _ret;
 }
 
-bool GLES::UpdateScale (scale_t const & scale) {
-    bool _ret = false;
+bool Compositor::Register (DRM::GBM::fd_t channel, Base::id_t id, bool external) {
+    // Reuse a free slot, if any
+    auto _it = std::find_if (_slots.begin (), _slots.end (), [] (slot_t const & slot) { return slot._channel == DRM::GBM::InvalidFd (); });
 
-    // Ramge check without taking into account rounding errors
+    // Every slot should be addressable by index_t, including the loop bound
+    bool _ret = _it != _slots.end () || _slots.size () < std::numeric_limits <index_t>::max ();
 
-    if (    (scale._horiz <= 1.0f)
-         && (scale._vert <= 1.0f) ) {
+    if (_ret != false) {
+        slot_t const _slot = { channel, id, InvalidBuffer (), { InvalidBuffer (), InvalidBuffer (), std::vector <struct buffer> (), GLES::InvalidRect (), 0, 0 }, false, external, false };
+
+        if (_it != _slots.end ()) {
+            *_it = _slot;
+        }
+        else {
+            _it = _slots.insert (_slots.end (), _slot);
+        }
 
-        _scale = scale;
+        std::cout << (external != false ? "External client [" : "Client [") << std::to_string (id) << "] has registered at slot [" << std::to_string (std::distance (_slots.begin (), _it)) << "], " << std::to_string (Registered ()) << " client(s)" << std::endl;
+    }
+    else {
+        std::cout << "Error: no slot available for client [" << std::to_string (id) << "]" << std::endl;
 
-        _ret = true;
+        /* int */ close (channel);
     }
 
     return _ret;
 }
 
-bool GLES::SetupProgram (char const vtx_src [], char const frag_src []) {
-    auto LoadShader = [] (GLuint type, GLchar const code []) -> GLuint {
-        bool _ret = glGetError () == GL_NO_ERROR;
-
-        GLuint _shader = 0;
-        if (_ret != false) {
-            _shader = glCreateShader (type);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+bool Compositor::Unregister (index_t index) {
+    bool _ret = index < _slots.size () && _slots [index]._channel != DRM::GBM::InvalidFd ();
 
-        if (_ret != false && _shader != 0) {
-            glShaderSource (_shader, 1, &code, nullptr);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    if (_ret != false) {
+        slot_t & _slot = _slots [index];
 
-        if (_ret != false) {
-            glCompileShader (_shader);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+        std::cout << "Client [" << std::to_string (_slot._id) << "] has " << std::to_string (_slot._box._latched) << " frame(s) composited and " << std::to_string (_slot._box._superseded) << " frame(s) superseded" << std::endl;
 
-        return _shader;
-    };
+        /* bool */ Release (_slot._shared, index);
+        /* bool */ Release (_slot._box._pending, index);
 
-    auto ShadersToProgram = [] (GLuint vertex, GLuint fragment) -> bool {
-        bool _ret = glGetError () == GL_NO_ERROR;
+        // Gone, it cannot render into the buffers anymore, whether or not still on screen
+        if (_slot._box._current._prime != DRM::GBM::InvalidPrime ()) {
+            /* bool */ Transition (_slot._box._current._owner, OWNER::RETIRED, "Client [" + std::to_string (_slot._id) + "] buffer");
 
-        GLuint _prog = 0;
+            _slot._box._retired.push_back (_slot._box._current);
 
-        if (_ret != false) {
-            _prog = glCreateProgram ();
-            _ret = _prog != 0;
+            _slot._box._current = InvalidBuffer ();
         }
 
-        if (_ret != false) {
-            glAttachShader (_prog, vertex);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+        /* bool */ ReleaseRetired (index);
 
-        if (_ret != false) {
-            glAttachShader (_prog, fragment);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+        /* bool */ _egl.ReleaseImage (index);
+        /* bool */ _gles.ReleaseTexture (index);
 
-        if (_ret != false) {
-            glBindAttribLocation (_prog, 0, "position");
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+        _ret = close (_slot._channel) == 0;
 
-        if (_ret != false) {
-            glLinkProgram (_prog);
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+        std::cout << "Client [" << std::to_string (_slot._id) << "] has left slot [" << std::to_string (index) << "]" << std::endl;
 
-        if (_ret != false) {
-            glUseProgram (_prog);
-            _ret = glGetError () == GL_NO_ERROR;
+        _slot = { DRM::GBM::InvalidFd (), 0, InvalidBuffer (), { InvalidBuffer (), InvalidBuffer (), std::vector <struct buffer> (), GLES::InvalidRect (), 0, 0 }, false, false, false };
+
+        // Unused slots at the end are given back
+        while (_slots.empty () != true && _slots.back ()._channel == DRM::GBM::InvalidFd ()) {
+            _slots.pop_back ();
         }
 
-        return _ret;
-    };
+        // Its last frame is still on screen
+        _bypass = true;
+    }
 
-    auto DeleteCurrentProgram = [] () -> bool {
-        bool _ret = glGetError () == GL_NO_ERROR;
+    return _ret;
+}
 
-        GLuint _prog = 0;
+size_t Compositor::Registered () const {
+    size_t _ret = static_cast <size_t> (std::count_if (_slots.begin (), _slots.end (), [] (slot_t const & slot) { return slot._channel != DRM::GBM::InvalidFd (); }));
 
-        if (_ret != false) {
-            glGetIntegerv (GL_CURRENT_PROGRAM, reinterpret_cast <GLint *> (&_prog));
-            _ret = glGetError () == GL_NO_ERROR;
-        }
+    return _ret;
+}
 
-        if (_ret != false && _prog != 0) {
+bool Compositor::Dispatch () {
+    std::vector <struct pollfd> _fds;
+    std::vector <index_t> _indices;
 
-            GLint _count = 0;
+    for (index_t _index = 0; _index < _slots.size (); _index++) {
+        if (_slots [_index]._channel != DRM::GBM::InvalidFd ()) {
+            _fds.push_back ({ _slots [_index]._channel, POLLIN, 0 });
+            _indices.push_back (_index);
+        }
+    }
 
-            glGetProgramiv (_prog, GL_ATTACHED_SHADERS, &_count);
-            _ret = glGetError () == GL_NO_ERROR && _count > 0;
+    // A frame period, rounded up, newly registered clients are taken on in between
+    int const _timeout = Pending () != false ? 0 : static_cast <int> ((_drm.FrameDuration () + 999999) / 1000000);
 
-            if (_ret != false) {
-                GLuint _shaders [_count];
+    int const _ready = poll (_fds.data (), static_cast <nfds_t> (_fds.size ()), _timeout);
 
-                glGetAttachedShaders (_prog, _count, static_cast <GLsizei *> (&_count), &_shaders [0]);
-                _ret = glGetError () == GL_NO_ERROR;
+    bool _ret = _ready >= 0 || errno == EINTR;
 
-                if (_ret != false) {
-                    for (_count--; _count >= 0; _count--) {
-                        glDetachShader (_prog, _shaders [_count]);
-                        _ret = _ret && glGetError () == GL_NO_ERROR;
-                        glDeleteShader (_shaders [_count]);
-                        _ret = _ret && glGetError () == GL_NO_ERROR;
-                    }
-                }
+    for (size_t _i = 0; _ready > 0 && _i < _fds.size () && _ret != false; _i++) {
+        struct pollfd _fd = _fds [_i];
 
-                if (_ret != false) {
-                    glDeleteProgram (_prog);
-                    _ret = glGetError () == GL_NO_ERROR;
-                }
+        // All messages that have arrived, only the newest frame is kept
+        while ((_fd.revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+            if (AwaitRequestCompleteSharingBuffer (_indices [_i]) != true) {
+                // Gone, or misbehaving, the other clients are not affected
+                _ret = Unregister (_indices [_i]);
+
+                break;
             }
 
+            _fd.revents = 0;
+
+            /* int */ poll (&_fd, 1, 0);
         }
+    }
 
-        return _ret;
-    };
+    return _ret;
+}
 
-    bool _ret = DeleteCurrentProgram ();
+bool Compositor::Pending () const {
+    bool _ret = std::any_of (_slots.begin (), _slots.end (), [] (slot_t const & slot) { return slot._box._pending._prime != DRM::GBM::InvalidPrime (); });
 
-    if (_ret != false) {
-        GLuint _vtxShader = LoadShader (GL_VERTEX_SHADER, vtx_src);
-        GLuint _fragShader = LoadShader (GL_FRAGMENT_SHADER, frag_src);
+    return _ret;
+}
 
-// TODO: inefficient on every call, reuse compiled program
-        _ret = ShadersToProgram(_vtxShader, _fragShader);
-    }
+bool Compositor::Presenting () const {
+    bool _ret = std::any_of (_slots.begin (), _slots.end (), [] (slot_t const & slot) { return slot._presenting; });
+
+    return _ret;
+}
+
+bool Compositor::Submit (struct buffer & buffer, GLES::rect_t const & damage, index_t index) {
+    bool _ret = index < _slots.size () && buffer._prime != DRM::GBM::InvalidPrime ();
 
     if (_ret != false) {
-        glEnable (GL_BLEND);
-        _ret = glGetError () == GL_NO_ERROR;
+        _ret = Transition (buffer._owner, OWNER::SUBMITTED, "Client [" + std::to_string (_slots [index]._id) + "] buffer");
     }
 
     if (_ret != false) {
-        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-        _ret = glGetError () == GL_NO_ERROR;
-    }
+        mailbox_t & _box = _slots [index]._box;
 
-    // Color on error
-    if (_ret != true) {
-        glClearColor (1.0f, 0.0f, 0.0f, 0.5f);
-        _ret = glGetError () == GL_NO_ERROR;
-    }
+        if (_box._pending._prime != DRM::GBM::InvalidPrime ()) {
+            // The client outpaces the display, its previous frame will never be shown
+            ++_box._superseded;
 
-     return _ret;
-}
+            /* bool */ Release (_box._pending, index);
+        }
 
-bool RenderClient::Init () {
-    bool _ret = Clear () && Base::Status () && _gles.Status ();
+        _box._pending = buffer;
 
-    if (_ret != true) {
-        /* bool */ Deinit ();
+        // Whatever the superseded frame changed has not been shown either
+        _box._damage = GLES::Union (_box._damage, damage);
+
+        buffer = InvalidBuffer ();
+    }
+    else {
+        /* bool */ Release (buffer, index);
     }
 
     return _ret;
 }
 
-bool RenderClient::Deinit () {
-    bool _ret = Clear ();
-
-    return _ret;
-}
+bool Compositor::Latch (index_t index, GLES::rect_t & damage) {
+    bool _ret = index < _slots.size ();
 
-bool RenderClient::Run () {
-    bool _ret = Status ();
+    damage = GLES::InvalidRect ();
 
     if (_ret != false) {
+        mailbox_t & _box = _slots [index]._box;
 
-        // Breaks on error like a disconnected communication channel
-        while (_ret != false) {
-            _ret = CreateRemoteBuffer () != false && ShareBuffer () != false && Render () != false && DestroyRemoteBuffer () != false;
+        if (_box._pending._prime != DRM::GBM::InvalidPrime ()) {
+            // Replaces, and thereby retires, the image composited so far
+            _ret = Transition (_box._pending._owner, OWNER::COMPOSITION, "Client [" + std::to_string (_slots [index]._id) + "] buffer");
+
+            if (_ret != false && _egl.ImportBuffer (_box._pending._prime, index) != true) {
+                // Plain memory without udmabuf, copied, hence, the client should have finished
+                _ret =    _box._pending._prime._memory != false
+                       && _egl.WaitFence (_box._pending._fence, false) != false
+                       && _egl.UploadBuffer (_box._pending._prime, index) != false;
+            }
 
             if (_ret != false) {
-                std::string const _id_s = std::to_string (_id);
-                std::cout << "Client [" << _id_s << "] completed rendering frame." << std::endl;
+                ++_box._latched;
 
-#ifdef DEBUG
-                // Simulate some (additional) processing
-                constexpr unsigned int _nanoseconds = 1000 * 1000 * 1000;
+                damage = _box._damage;
+            }
 
-                struct timespec _timeout {0, _nanoseconds};
+            _box._damage = GLES::InvalidRect ();
 
-                // Simulate some (additional) processing
-                _timeout.tv_nsec = static_cast <int> ( static_cast <double> ( rand () ) / static_cast <double> ( RAND_MAX ) * 1000 * 1000 * 1000 * 2);
+            if (_box._current._prime != DRM::GBM::InvalidPrime ()) {
+                // Still on screen, or read by the GPU, until the next flip has completed
+                _ret = Transition (_box._current._owner, OWNER::RETIRED, "Client [" + std::to_string (_slots [index]._id) + "] buffer") && _ret;
 
-                _timeout.tv_sec = _timeout.tv_nsec / (1000 * 1000 * 1000);
-                _timeout.tv_nsec = _timeout.tv_nsec % (1000 * 1000 * 1000);
+                _box._retired.push_back (_box._current);
+            }
 
-                struct timespec _remaining = {0, 0};
-                if (nanosleep ( &_timeout, &_remaining ) != 0) {
-                    std::cout << "Error: RenderClient [" << std::to_string (_id) << "] is unable to complete time out of : " << std::to_string (_timeout.tv_nsec) << " [nsec]. Remaining time [nsec] : " << std::to_string (_remaining.tv_nsec) << std::endl;
-                }
-#endif
+            // Kept for a possible direct scan out
+            _box._current = _box._pending;
 
-// TODO: signal completion
-            }
+            _box._pending = InvalidBuffer ();
         }
+        else {
+            // Kept from a dropped frame, if any
+            damage = _box._damage;
 
-    }
-    else {
-        // Error
-        std::cout << "Error: unable to initialize." << std::endl;
+            _box._damage = GLES::InvalidRect ();
+        }
+
+        // Nothing new, keep compositing the last latched frame, if any
+        _ret = _ret != false && _egl.Image (index) != EGL::InvalidImage ();
     }
 
     return _ret;
 }
 
-bool RenderClient::CreateRemoteBuffer () {
-    bool _ret = true;
+bool Compositor::Acquire (index_t index, OWNER owner) {
+    bool _ret = index < _slots.size ();
 
-// TODO: communicate over channel
+    if (_ret != false) {
+        struct buffer & _buffer = _slots [index]._box._current;
 
-    std::cout << "RenderClient [" << std::to_string (_id) << "] has requested to create a remote buffer" << std::endl;
+        _ret =    Transition (_buffer._owner, owner, "Client [" + std::to_string (_slots [index]._id) + "] buffer")
+               // Only the first use waits, the fence is consumed
+               && _egl.WaitFence (_buffer._fence, owner == OWNER::COMPOSITION);
+    }
 
     return _ret;
 }
 
-bool RenderClient::DestroyRemoteBuffer () {
-    bool _ret = true;
+bool Compositor::Release (struct buffer & buffer, index_t index) {
+    bool _ret = buffer._prime._fd != DRM::GBM::InvalidFd ();
 
-// TODO: communicate over channel
+    if (_ret != false) {
+        _ret = Transition (buffer._owner, OWNER::RELEASED, "Client [" + std::to_string (index < _slots.size () ? _slots [index]._id : 0) + "] buffer");
 
-    std::cout << "RenderClient [" << std::to_string (_id) << "] has requested to destroy a remote buffer" << std::endl;
+        if (index < _slots.size () && _slots [index]._external != false) {
+            // Any access still outstanding, eg, the GPU reading it for the composition, as tracked by the kernel, without it the client relies on implicit synchronization
+            DRM::GBM::fd_t _release = DRM::GBM::InvalidFd ();
+
+#ifdef DMA_BUF_IOCTL_EXPORT_SYNC_FILE
+            struct dma_buf_export_sync_file _export = { DMA_BUF_SYNC_WRITE, DRM::GBM::InvalidFd () };
+
+            if (ioctl (buffer._prime._fd, DMA_BUF_IOCTL_EXPORT_SYNC_FILE, &_export) == 0) {
+                _release = _export.fd;
+            }
+#endif
+
+            // A gone client is noticed, and unregistered, once it is polled next
+            /* bool */ SendReleased (_slots [index]._channel, buffer._serial, _release);
+
+            if (_release != DRM::GBM::InvalidFd ()) {
+                // The client has its own duplicate
+                /* int */ close (_release);
+            }
+        }
+        else {
+            // Neither the client nor the screen uses it anymore, the next client may render into it, see CreateSharedBuffer
+            /* bool */ _drm.Get ().RecyclePrime (buffer._prime);
+        }
+
+        _ret = close (buffer._prime._fd) == 0 && _ret;
+    }
+
+    if (buffer._fence != DRM::GBM::InvalidFd ()) {
+        // Never waited for
+        /* int */ close (buffer._fence);
+    }
+
+    buffer = InvalidBuffer ();
 
     return _ret;
 }
 
-bool RenderClient::ShareBuffer () {
-    bool _ret = Base::ShareBuffer (_priv);
+bool Compositor::ReleaseRetired (index_t index) {
+    bool _ret = index < _slots.size ();
 
     if (_ret != false) {
-        std::cout << "RenderClient [" << std::to_string (_id) << "] has received access to the remote buffer" << std::endl;
+        mailbox_t & _box = _slots [index]._box;
+
+        for (auto & _buffer : _box._retired) {
+            _ret = Release (_buffer, index) && _ret;
+        }
+
+        _box._retired.clear ();
     }
 
     return _ret;
 }
 
-bool RenderClient::Render () {
-    // Three color channels for three clients
+bool Compositor::Measure (STAGE stage, std::function <bool ()> const & func) {
+    std::chrono::steady_clock::time_point const _begin = std::chrono::steady_clock::now ();
 
-    bool _red = false, _green = false, _blue = false;
+    bool _ret = func ();
 
-    // Different colors help to identify client
-    // Primaries are used elsewhere
-    switch (_id) {
-        case 0  : _red = true;  _green = true;  _blue = false;  break;
-        case 1  : _red = false; _green = true;  _blue = true;   break;
-        case 2  : _red = true;  _green = false; _blue = true;   break;
-        default : _red = true;  _green = true;  _blue = true;   break;
-    }
+    std::chrono::steady_clock::duration const _duration = std::chrono::steady_clock::now () - _begin;
 
-    constexpr decltype (EGL::_max_images) _index = 0;
+    struct stage & _stage = _stages [static_cast <size_t> (stage)];
 
-    bool _ret = _gles.RenderEGLImage (_egl.Image (_index)) != false && _egl.Render () != false;
+    _stage._total += _duration;
+    _stage._max = std::max (_stage._max, _duration);
 
     return _ret;
 }
 
-bool RenderClient::Clear () {
-    bool _ret = false;
+void Compositor::Statistics (std::chrono::steady_clock::duration const & elapsed) const {
+    using ms_t = std::chrono::duration <double, std::milli>;
+    using s_t = std::chrono::duration <double>;
 
-    const_cast <remove_const <valid_t>::type &> (_valid) = false;
+    constexpr char const * _names [] = { "create", "share", "await", "render" };
 
-    _ret = Status () != true;
+    static_assert (sizeof (_names) / sizeof (_names [0]) == static_cast <size_t> (STAGE::COUNT));
 
-    return _ret;
-}
+    double const _seconds = std::chrono::duration_cast <s_t> (elapsed).count ();
 
-bool Compositor::Init () {
-    bool _ret = Clear () && Base::Status () && _gles.Status ();
+    std::cout << "Frames : " << std::to_string (_count) << " in " << std::to_string (_seconds) << " [s], " << std::to_string (_seconds > 0 ? static_cast <double> (_count) / _seconds : 0.0) << " [fps]" << std::endl;
 
-    if (_ret != true) {
-        /* bool */ Deinit ();
+    for (size_t _i = 0; _i < _stages.size (); _i++) {
+        double const _average = _count > 0 ? std::chrono::duration_cast <ms_t> (_stages [_i]._total).count () / static_cast <double> (_count) : 0.0;
+        double const _max = std::chrono::duration_cast <ms_t> (_stages [_i]._max).count ();
+
+        std::cout << "Stage " << _names [_i] << " : average " << std::to_string (_average) << " [ms], maximum " << std::to_string (_max) << " [ms]" << std::endl;
     }
 
-    return _ret;
-}
+    KMS::pacing_t const & _pacing = _drm.Pacing ();
 
-bool Compositor::Deinit () {
-    bool _ret = Clear ();
+    // Achieved, with adaptive sync the interval follows the rendering, otherwise a multiple of the frame period
+    std::cout << "Flips : " << std::to_string (_pacing._count) << " interval(s), average " << std::to_string (_pacing._count > 0 ? (_pacing._total / 1000000.0) / _pacing._count : 0.0) << " [ms], minimum " << std::to_string (_pacing._min / 1000000.0) << " [ms], maximum " << std::to_string (_pacing._max / 1000000.0) << " [ms], adaptive sync " << (_drm.Adaptive () != false ? "on" : "off") << std::endl;
 
-    return _ret;
+    size_t const _clients = Registered ();
+    size_t const _now = Resident ();
+
+    // Each client reports its own (idle) resident memory at registration
+    std::cout << "Memory : compositor resident " << std::to_string (_now) << " [kB] with " << std::to_string (_clients) << " client(s), " << std::to_string (_clients > 0 && _now > _resident ? (_now - _resident) / _clients : 0) << " [kB] per client" << std::endl;
 }
 
-bool Compositor::Run () {
-    bool _ret = Status ();
+bool Compositor::ShareBuffer (index_t index) {
+    // An external client renders into buffers of its own, nothing to share
+    bool _ret = index < _slots.size () && _slots [index]._external != true && Base::ShareBuffer (!_priv, _slots [index]._channel) != false;
 
-    if ( _ret != false) {
+    if (_ret != false) {
+        DRM::GBM::prime_t const & _prime = _drm.Get ().Prime ();
 
-        while (AwaitRequestCreateSharingBuffer () != false) {
+        struct buffer & _shared = _slots [index]._shared;
 
-            _ret = CreateSharedBuffer () != false && ShareBuffer () != false && AwaitRequestCompleteSharingBuffer () != false  && Render () != false /* && DestroySharedBuffer () */;
+        _shared = InvalidBuffer ();
+        _shared._prime = _prime;
 
-            if (_ret != true) {
-                std::cout << "Error: cannot render a shared buffer" << std::endl;
-                break;
-            }
+        // The GBM prime is destroyed at the next CreateSharedBuffer, hence, keep a reference of our own
+        _shared._prime._fd = fcntl (_prime._fd, F_DUPFD_CLOEXEC, 0);
 
-        }
+        _ret = _shared._prime._fd != DRM::GBM::InvalidFd ();
 
-    }
-    else {
-        // Error
-        std::cout << "Error: unable to initialize." << std::endl;
+        if (_ret != true) {
+            std::cout << "Error: unable to duplicate the prime fd (" << strerror (errno) << ")" << std::endl;
+        }
+        else {
+            _ret = Transition (_shared._owner, OWNER::CLIENT, "Client [" + std::to_string (_slots [index]._id) + "] buffer");
+        }
     }
 
     return _ret;
 }
 
-bool Compositor::CreateSharedBuffer () {
-    bool _ret = false;
+bool Compositor::ShareBuffers () {
+    bool _ret = true;
 
-// TODO: Re-use an existing buffer to be more efficient
-    /* bool */ DestroySharedBuffer ();
+    for (index_t _index = 0; _index < _slots.size () && _ret != false; _index++) {
+        slot_t const & _slot = _slots [_index];
 
-    DRM::GBM & _gbm = _drm.Get ();
+        // A forked client awaits its next buffer once its previous frame has been presented
+        if (   _slot._channel != DRM::GBM::InvalidFd ()
+            && _slot._external != true
+            && _slot._shared._prime._fd == DRM::GBM::InvalidFd ()
+            && _slot._box._pending._prime._fd == DRM::GBM::InvalidFd ()
+           ) {
+            _ret = Measure (STAGE::CREATE, [this] () { return CreateSharedBuffer (); });
 
-    _ret = _gbm.CreatePrime ();
+            // Fails if the client has gone
+            if (_ret != false && Measure (STAGE::SHARE, [this, _index] () { return ShareBuffer (_index); }) != true) {
+                _ret = Unregister (_index);
+            }
+        }
+    }
 
     return _ret;
 }
 
-bool Compositor::DestroySharedBuffer () {
+bool Compositor::Render () {
+    bool _ret = true;
+
     DRM::GBM & _gbm = _drm.Get ();
 
-    bool _ret = _gbm.DestroyPrime ();
+// TODO: narrowing
+    GLsizei const _width = static_cast <GLsizei> (_gbm.Width ());
+    GLsizei const _height = static_cast <GLsizei> (_gbm.Height ());
 
-    return _ret;
-}
+    // KMS uses an origin at the top left
+    auto _kms = [_height] (GLES::rect_t const & rect) -> DRM::rect_t { return { rect._x, _height - (rect._y + rect._height), rect._x + rect._width, _height - rect._y }; };
 
-bool Compositor::AwaitRequestCreateSharingBuffer () {
-    bool _ret = false;
+    // Only the newest frame of each client is composited; clients without any frame yet are skipped and never stall the output
+    std::vector <bool> _latched (_slots.size (), false);
 
-// TODO: communicate over channel
+    // Only a completed flip changes the screen
+    bool _flipped = false;
 
-    char _key = '\0';
+    // What changed on the surface since the previous frame, per client and in total
+    std::vector <GLES::rect_t> _damage (_slots.size (), GLES::InvalidRect ());
+    GLES::rect_t _frame = GLES::InvalidRect ();
 
-    while (ReadKey ("Press 'c' to create a shared buffer after a client has requested one, 'Enter' or 'q' to quit", _key) != false && _key != 'q') {
-        switch (_key) {
-            case 'c'    :   {
-                                _ret = true;
-                                break;
-                            }
-            default     :   {
-                                continue;
-                            }
-        }
+    // Clients with damage in this frame
+    std::vector <bool> _changed (_slots.size (), false);
+
+    for (index_t _index = 0; _index < _slots.size (); _index++) {
+        // It waits for the next completed flip
+        _slots [_index]._presenting = _slots [_index]._presenting || _slots [_index]._box._pending._prime != DRM::GBM::InvalidPrime ();
 
-        break;
+        _latched [_index] = Latch (_index, _damage [_index]);
+
+        // Shown again, in full, should this frame be dropped
+        _changed [_index] = GLES::Empty (_damage [_index]) != true;
+
+        _damage [_index] = _latched [_index] != false ? _gles.Project (_damage [_index], _egl.Image (_index), _index, _width, _height) : GLES::InvalidRect ();
+
+        _frame = GLES::Union (_frame, _damage [_index]);
     }
 
-    return _ret;
-}
+    // Only one client on screen, with a new frame
+    index_t const _visible = static_cast <index_t> (std::count (_latched.begin (), _latched.end (), true));
+    index_t const _first = static_cast <index_t> (std::distance (_latched.begin (), std::find (_latched.begin (), _latched.end (), true)));
 
-bool Compositor::AwaitRequestCompleteSharingBuffer () {
-    bool _ret = false;
+    // GL renders bottom up in the client's image, KMS scans out top down
+    constexpr bool _reflect = true;
 
-// TODO: communicate over channel
+    // Scanned out as is the buffer covers the screen, composited it is at its placement, only bypass if both agree, offset 0 and unit scale
+    auto _fullscreen = [&] (index_t index) -> bool {
+        EGL::img_t const & _img = _egl.Image (index);
 
-    char _key = '\0';
+        GLES::rect_t const _dst = _gles.Placement (_img, index, _width, _height);
 
-    remove_const <decltype (EGL::_max_images) >::type _index = 0;
+        return    _dst._x == 0 && _dst._y == 0 && _dst._width == _width && _dst._height == _height
+               && _img._width == _width && _img._height == _height;
+    };
 
-    while (ReadKey ("Enter the number (id) of the client that has requested and received the shared buffer, 'Enter' or 'q' to quit", _key) != false && _key != 'q') {
-        switch (_key) {
-           case '0'                        :   /* minimum */
-                                                {
-                                                    continue;
-                                                }
-            case '1'                        :   {
-                                                    _index = 0;
-                                                    break;
-                                                }
-            case '2'                        :   {
-                                                    _index = 1;
-                                                    break;
-                                                }
-            case '0' + EGL::_max_images + 1 :   /* maximum */
-            default                         :   /* somewhere between minimum and maximum but not defined */
-                                                {
-                                                    continue;
-                                                }
-        }
+    // Plain memory cannot be scanned out
+    bool _direct = GLES::Empty (_frame) != true && _visible == 1 && _slots [_first]._box._current._prime._memory != true && _fullscreen (_first) != false;
+
+    if (_direct != false) {
+        // Nothing but the client itself on screen
+        /* size_t */ _drm.Assign (std::vector <DRM::layer_t> ());
+
+        _direct =    Acquire (_first, OWNER::SCANOUT)
+                  && _drm.ScanOut (_slots [_first]._box._current._prime, _reflect);
 
-        break;
+        _flipped = _direct;
     }
 
-    DRM::GBM & _gbm = _drm.Get ();
+    if (_direct != false) {
+        // Presented as is, no GPU composition at all
+        _bypass = true;
 
-    DRM::GBM::prime_t _prime = _gbm.Prime ();
+        for (auto & _slot : _slots) {
+            _slot._overlay = false;
+        }
+    }
+    else if (GLES::Empty (_frame) != true) {
+        // Clients, in drawing order, that may be put on an overlay plane instead
+        std::vector <DRM::layer_t> _layers;
+        std::vector <index_t> _order;
 
-    _ret =_egl.ImportBuffer (_prime, _index);
+        for (index_t _index = 0; _index < _slots.size (); _index++) {
+            GLES::rect_t const _dst = _gles.Placement (_egl.Image (_index), _index, _width, _height);
 
-    return _ret;
-}
+            if (_latched [_index] != false && GLES::Empty (_dst) != true && _slots [_index]._box._current._prime._memory != true) {
+                _layers.push_back ({ _slots [_index]._box._current._prime, _kms (_dst), _reflect });
+                _order.push_back (_index);
+            }
+        }
 
-bool Compositor::ShareBuffer () {
-    bool _ret = false;
+        // The top most layers are assigned
+        size_t const _assigned = _drm.Assign (_layers);
 
-    _ret = Base::ShareBuffer (!_priv);
+        std::vector <bool> _overlay_now (_slots.size (), false);
 
-    return _ret;
-}
+        for (size_t _i = _order.size () - _assigned; _i < _order.size (); _i++) {
+            _overlay_now [_order [_i]] = true;
 
-bool Compositor::Render () {
-    bool _ret = false;
+            // The plane is committed at the next flip, the client should have finished by then
+            _ret = Acquire (_order [_i], OWNER::SCANOUT) && _ret;
+        }
 
-    for (remove_const <decltype (EGL::_max_images)>::type _index = 0; _index < EGL::_max_images; _index++) {
+        // Only the remaining clients are composited
+        GLES::rect_t _composited = GLES::InvalidRect ();
 
-// TODO: Images might be invalid or have undefined content
+        bool _moved = false;
 
-        _ret = _gles.RenderEGLImage (_egl.Image (_index)) || _ret;
+        for (index_t _index = 0; _index < _slots.size (); _index++) {
+            if (_overlay_now [_index] != true) {
+                _composited = GLES::Union (_composited, _damage [_index]);
+            }
 
-        if (_ret != true) {
+            _moved = _moved || _overlay_now [_index] != _slots [_index]._overlay;
 
-            break;
+            _slots [_index]._overlay = _overlay_now [_index];
+        }
+
+        if (_bypass != false || _moved != false) {
+            // The screen shows a client buffer, or clients moved between GL and a plane; the compositor surface is stale
+            _composited = { 0, 0, _width, _height };
+
+            _bypass = false;
+        }
+
+        if (GLES::Empty (_composited) != true) {
+            // The back buffer is 'age' frames old, it misses the damage of all frames in between
+            EGLint _age = 0;
+
+            GLES::rect_t _repaint = _composited;
+
+            if (_egl.BufferAge (_age) != false && _age > 0 && _age <= _max_buffer_age) {
+                for (EGLint _i = 0; _i < _age - 1; _i++) {
+                    _repaint = GLES::Union (_repaint, _history [(_history_head + _max_buffer_age - _i) % _max_buffer_age]);
+                }
+            }
+            else {
+                // Unknown content
+                _repaint = { 0, 0, _width, _height };
+            }
+
+            _history_head = (_history_head + 1) % _max_buffer_age;
+            _history [_history_head] = _composited;
+
+            _ret = _gles.Scissor (_repaint);
+
+            // All composited clients in one pass
+            std::vector <EGL::img_t> _imgs (_slots.size (), EGL::InvalidImage ());
+
+            for (index_t _index = 0; _index < _slots.size () && _ret != false; _index++) {
+                if (_latched [_index] != false && _slots [_index]._overlay != true) {
+                    _imgs [_index] = _egl.Image (_index);
+
+                    // GL commands from here on wait for the client
+                    _ret = Acquire (_index, OWNER::COMPOSITION);
+                }
+            }
+
+            _ret = _ret != false && _gles.RenderEGLImages (_imgs) != false;
+
+            std::vector <DRM::rect_t> const _clips = { _kms (_composited) };
+
+            _ret = _ret != false && _egl.Render () != false && _drm.ScanOut (_clips) != false;
+        }
+        else {
+            // Only clients on overlay planes have changed, the compositor surface is as is
+            _ret = _drm.Present ();
+        }
+
+        _flipped = _ret;
+    }
+    else if (Presenting () != false) {
+        // Nothing new to show, the current scan out remains valid, its flip tells the submitters when their frames are on screen, if it fails, the next frame period retries
+        _flipped = _drm.Present ();
+    }
+    else {
+        // Nothing new to show, the current scan out remains valid
+    }
+
+    if (_flipped != false) {
+        // Every submitted frame is on screen since the completed flip
+        for (index_t _index = 0; _index < _slots.size (); _index++) {
+            // Unchanged content has not replaced anything on screen
+            if (GLES::Empty (_frame) != true) {
+                /* bool */ ReleaseRetired (_index);
+            }
+
+            if (_slots [_index]._presenting != false) {
+                // A gone client is noticed, and unregistered, once it is polled next
+                /* bool */ SendPresented (_slots [_index]._channel, _drm.VBlank ());
+
+                _slots [_index]._presenting = false;
+            }
         }
     }
+    else if (_ret != true) {
+        // Dropped, the next frame repaints the clients that changed
+        for (index_t _index = 0; _index < _slots.size (); _index++) {
+            EGL::img_t const & _img = _egl.Image (_index);
 
-    _ret = _ret != false && _egl.Render () != false && _drm.ScanOut () != false;
+            if (_changed [_index] != false && _img != EGL::InvalidImage ()) {
+                _slots [_index]._box._damage = GLES::Union (_slots [_index]._box._damage, { 0, 0, static_cast <GLsizei> (_img._width), static_cast <GLsizei> (_img._height) });
+            }
+        }
+    }
 
     return _ret;
 }
@@ -2746,6 +5820,30 @@ bool Compositor::Render () {
 bool Compositor::Clear () {
     bool _ret = false;
 
+    _slots.clear ();
+
+    for (auto & _rect : _history) {
+        _rect = GLES::InvalidRect ();
+    }
+
+    _history_head = 0;
+
+    _bypass = false;
+
+    for (auto & _stage : _stages) {
+        _stage = { std::chrono::steady_clock::duration::zero (), std::chrono::steady_clock::duration::zero () };
+    }
+
+    _count = 0;
+
+    _accepting = true;
+
+    _resident = 0;
+
+    _listen = DRM::GBM::InvalidFd ();
+
+    _connecting.clear ();
+
     const_cast <remove_const <valid_t>::type &> (_valid) = false;
 
     _ret = Status () != true;
@@ -2759,9 +5857,65 @@ using main_ret_t = decltype (EXIT_SUCCESS);
 main_ret_t main (int argc, char* argv []) {
     main_ret_t _ret = EXIT_FAILURE;
 
+    // Optional, device node, eg, a virtual KMS device for headless runs
+    std::string _path;
+
+    // Optional, non-interactive, number of frames
+    remove_const <Base::frames_t>::type _frames = 0;
+
+    // Optional, number of clients
+    remove_const <Base::id_t>::type _clients = 2;
+
+    // Optional, adaptive sync, if the sink supports it
+    bool _adaptive = false;
+
+    // Optional, socket external clients, eg, libyxope in client mode, connect to
+    std::string _address;
+
+    bool _usage = false;
+
+    for (int _opt = getopt (argc, argv, "d:n:c:s:ah"); _opt != -1 && _usage != true; _opt = getopt (argc, argv, "d:n:c:s:ah")) {
+        switch (_opt) {
+            case 'a'    :   {
+                                _adaptive = true;
+                                break;
+                            }
+            case 'd'    :   {
+                                _path = optarg;
+                                break;
+                            }
+            case 's'    :   {
+                                _address = optarg;
+                                break;
+                            }
+            case 'n'    :   {
+                                long const _val = std::atol (optarg);
+
+                                _frames = static_cast <remove_const <Base::frames_t>::type> (_val > 0 ? _val : 0);
+                                _usage = _val <= 0;
+                                break;
+                            }
+            case 'c'    :   {
+                                long const _val = std::atol (optarg);
+
+                                // Ids are unique, 0 is the compositor
+                                _usage = _val <= 0 || _val > std::numeric_limits <Base::id_t>::max ();
+                                _clients = static_cast <remove_const <Base::id_t>::type> (_usage != true ? _val : 0);
+                                break;
+                            }
+            case 'h'    :
+            default     :   {
+                                _usage = true;
+                            }
+        }
+    }
+
     remove_reference < Base::sv_t >::type _sv [2];
 
-    if (socketpair (AF_LOCAL, SOCK_STREAM, 0, _sv) < 0) {
+    if (_usage != false) {
+        std::cout << "Usage: " << argv [0] << " [-d <device node>] [-n <number of frames, non-interactive>] [-c <number of clients>] [-s <socket for external clients>] [-a, adaptive sync]" << std::endl;
+    }
+    else if (socketpair (AF_LOCAL, SOCK_SEQPACKET, 0, _sv) < 0) {
         std::cout << "Error: socketpair" << std::endl;
     }
     else {
@@ -2771,7 +5925,8 @@ main_ret_t main (int argc, char* argv []) {
 #endif
 
 // TODO: link with the additional communication bewteen compositor and clients, currently, just abstracted away in Await* and *RemoteBuffer functions
-    constexpr decltype (Compositor::_max_renderclients) _max_childs = Compositor::_max_renderclients;
+    // Each registers over the shared channel, the compositor does not depend on this number
+    decltype (_clients) const _max_childs = _clients;
 
     uint8_t _num_childs = 1;
 
@@ -2790,18 +5945,20 @@ _create_next_child_entry_point:
                         }
             case  0 :   {
 #ifdef DEBUG
-                            bool _flag = true;
+                            // Attach a debugger, and clear the flag, nobody to do so for a non-interactive run
+                            bool _flag = _frames == 0;
                             while ( _flag != false ) { sleep ( TIMEOUT ); };
 #endif
 
                             /* int */ close (_sv [0]);
-                            RenderClient _client (_sv [1], _priv, _num_childs);
+                            RenderClient _client (_sv [1], _priv, _num_childs, _path, _frames);
                             _ret = _client.Run () != false ? EXIT_SUCCESS : EXIT_FAILURE;
                             break;
                         }
             default :   {
 #ifdef DEBUG
-                            bool _flag = true;
+                            // Attach a debugger, and clear the flag, nobody to do so for a non-interactive run
+                            bool _flag = _frames == 0;
                             while ( _flag != false ) { sleep ( TIMEOUT ); };
 #endif
 
@@ -2811,8 +5968,20 @@ _create_next_child_entry_point:
                             }
 
                             /* int */ close (_sv [1]);
-                            Compositor _compositor (_sv [0], _priv, 0);
-                            _ret = _compositor.Run () != false ? EXIT_SUCCESS : EXIT_FAILURE;
+
+                            {
+                                Compositor _compositor (_sv [0], _priv, 0, _path, _frames, _adaptive, _address);
+                                _ret = _compositor.Run () != false ? EXIT_SUCCESS : EXIT_FAILURE;
+                            }
+
+                            if (_frames > 0) {
+                                // End of the run for the clients
+                                /* int */ close (_sv [0]);
+
+                                // Do not leave them behind
+                                while (wait (nullptr) > 0 || errno == EINTR) {}
+                            }
+
                             break;
                         }
         }
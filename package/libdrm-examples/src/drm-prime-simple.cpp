@@ -40,6 +40,7 @@ There is much room for improvement!
 #include <cmath>
 #include <type_traits>
 #include <atomic>
+#include <chrono>
 
 #ifdef __cplusplus
 extern "C" {
@@ -62,13 +63,12 @@ extern "C" {
 }
 #endif
 
+#include "kms.h"
+
 struct configuration {
     struct drm {
         std::string path;
         int32_t fd;
-        uint32_t fb;
-        uint32_t crtc;
-        uint32_t connectors;
     } drm;
 
     struct gbm {
@@ -90,10 +90,6 @@ static constexpr decltype (configuration::drm::fd) InvalidDRMfd () {
     return -1;
 }
 
-static constexpr decltype (configuration::drm::fb) InvalidDRMfb () {
-    return 0;
-}
-
 static constexpr decltype (configuration::gbm::dev) InvalidGBMdev () {
     return nullptr;
 }
@@ -137,215 +133,16 @@ static constexpr uint32_t Height () {
     return 1080;
 }
 
-// Wait until the scan out happens
-static constexpr uint8_t FrameDurationMax () {
-    return 1;
-}
-
 // Message size
 static constexpr uint8_t Length () {
     return 255;
 }
 
-// See ReadKey
-static constexpr char Delim () {
-    return '\n';
-}
-
-// Only for the Parent
-static auto FindModeSet (struct configuration& settings) -> uint32_t {
-    uint32_t _ret = 0; // Available sets
-
-    drmModeResPtr _res = drmModeGetResources (settings.drm.fd);
-
-    if (_res != nullptr) {
-        for (int i = 0; i < _res->count_connectors; i++) {
-            // Do not probe
-            drmModeConnectorPtr _con = drmModeGetConnectorCurrent (settings.drm.fd, _res->connectors[i]);
-
-            if (_con != nullptr) {
-                // Only consider HDMI
-                if ( (_con->connector_type == DRM_MODE_CONNECTOR_HDMIA  || \
-                      _con->connector_type == DRM_MODE_CONNECTOR_HDMIB) && \
-                      DRM_MODE_CONNECTED == _con->connection) {
-
-                    // Encoder currently connected to
-                    drmModeEncoderPtr _enc = drmModeGetEncoder (settings.drm.fd, _con->encoder_id);
-
-                    if (_enc != nullptr) {
-                        settings.drm.crtc = _enc->crtc_id;
-                        settings.drm.connectors = _con->connector_id;
-
-                        ++_ret;
-
-                        drmModeFreeEncoder (_enc);
-                    }
-                }
-
-                drmModeFreeConnector (_con);
-            }
-
-            // For now, do not considerer multiple viable options
-            if (_ret > 0) {
-                break;
-            }
-        }
-
-        drmModeFreeResources (_res);
-    }
-    else {
-        _ret = 0;
-    }
-
-    return _ret;
-}
-
-// Only for the Parent
-static auto ScanOut (struct configuration settings) -> bool {
-    bool _ret = false;
-
-    uint32_t _width = gbm_bo_get_width (settings.gbm.bo);
-    uint32_t _height = gbm_bo_get_height (settings.gbm.bo);
-    uint32_t _format = gbm_bo_get_format (settings.gbm.bo);
-    uint32_t _bpp = gbm_bo_get_bpp (settings.gbm.bo);
-    uint32_t _handle = gbm_bo_get_handle (settings.gbm.bo).u32;
-    uint32_t _stride = gbm_bo_get_stride (settings.gbm.bo);
-
-    if (settings.drm.fb != InvalidDRMfb ()) {
-        /* void */ drmModeRmFB (settings.drm.fd, settings.drm.fb);
-        settings.drm.fb = InvalidDRMfb ();
-    }
-
-    if (drmModeAddFB (settings.drm.fd, _width, _height, _format != ColorFormat () ? _bpp - 8 : _bpp, _bpp, _stride, _handle, &settings.drm.fb) == 0) {
-        static std::atomic <bool> _callback_data (true);
-
-        int _err = drmModePageFlip (settings.drm.fd, settings.drm.crtc, settings.drm.fb, DRM_MODE_PAGE_FLIP_EVENT, &_callback_data);
-
-        switch (0 - _err) {
-            case 0      :   {
-                                // Strictly speaking c++ linkage and not C linkage
-                                auto handler = +[] (int fd, unsigned int frame, unsigned int sec, unsigned int usec, void* data) {
-                                    if (data != nullptr) {
-                                        decltype (_callback_data) * _data = reinterpret_cast <decltype (_callback_data) *> (data);
-                                        *_data = false;
-                                    }
-                                    else {
-                                        std::cout << "Error: invalid callback data" << std::endl;
-                                    }
-                                };
-
-                                // Use the magic constant here because the struct is versioned!
-                                drmEventContext _context = { .version = 2, . vblank_handler = nullptr, .page_flip_handler = handler };
-
-                                bool _waiting = _callback_data;
-
-                                fd_set _fds;
-
-                                struct timespec _timeout = { .tv_sec = FrameDurationMax (), .tv_nsec = 0 };
-
-                                while (_waiting != false) {
-                                    FD_ZERO (&_fds);
-                                    FD_SET (settings.drm.fd, &_fds);
-
-                                    _err  = pselect (settings.drm.fd + 1, &_fds, nullptr, nullptr, &_timeout, nullptr);
-
-                                    if (_err < 0) {
-                                            break;
-                                    }
-                                    else {
-                                        if (_err == 0) {
-                                            // Timeout; retry
-                                        }
-                                        else { // ret > 0
-                                            if (FD_ISSET (settings.drm.fd, &_fds) != 0) {
-                                                if (drmHandleEvent (settings.drm.fd, &_context) != 0) {
-                                                    _ret = false;
-                                                    break;
-                                                }
-
-                                                _ret = true;
-                                            }
-                                        }
-                                    }
-
-                                    _waiting = _callback_data;
-                                }
-
-                                break;
-                            }
-            case EINVAL :
-                            {   // Probably a missing drmModeSetCrtc or an invalid _crtc
-                                drmModeCrtcPtr _ptr = drmModeGetCrtc (settings.drm.fd, settings.drm.crtc);
-
-                                if (_ptr != nullptr) {
-                                    constexpr uint32_t _count = 1;
-
-                                    _ret = drmModeSetCrtc (settings.drm.fd, settings.drm.crtc, settings.drm.fb, _ptr->x, _ptr->y, &settings.drm.connectors, _count, &_ptr->mode) == 0;
-
-                                    drmModeFreeCrtc (_ptr);
-                                }
-
-                                break;
-                            }
-            case EBUSY  :
-            default     :
-                            {
-                                // There is nothing to be done about it
-                            }
-        }
-    }
-    else {
-        _ret = false;
-    }
-
-    return _ret;
-}
-
-bool ReadKey (std::string const & message, char& key) {
-    bool _ret = false;
-
-    if (message.size () > 0) {
-        std::cout << message << std::endl;
-    }
-    else {
-        std::cout << "Press key" << std::endl;
-    }
-
-    char _str [Length ()];
-
-    std::cin.getline (_str, Length (), Delim ());
-
-    switch (std::cin.rdstate ()) {
-        case        std::ios::goodbit   :
-                                            switch (std::cin.gcount ()) {
-                                                case    2   :
-                                                                key = _str [0];
-                                                                _ret = true;
-                                                                break;
-                                                default     :
-                                                                _ret = false;
-                                            }
-                                            break;
-        case        std::ios::eofbit    :;
-        case        std::ios::failbit   :;
-        case        std::ios::badbit    :;
-        default                         :
-                                            _ret = false;
-    }
-
-//    std::cin.clear( );
-
-    return _ret;
-}
-
 bool Clear (struct configuration& settings) {
     bool _ret = true;
 //    settings.drm.path.clear ();
 
     settings.drm.fd = InvalidDRMfd ();
-    settings.drm.fb = InvalidDRMfb ();
-    settings.drm.crtc = 0;
-    settings.drm.connectors = 0;
 
     settings.gbm.dev = InvalidGBMdev ();
     settings.gbm.surf = InvalidGBMsurf ();
@@ -477,211 +274,6 @@ bool Deinit (struct configuration& settings) {
     return _ret && Clear (settings);
 }
 
-// Write data and an optional file descriptor
-// TODO: const
-ssize_t SendFd (int sock, uint8_t /*const*/ buf [], size_t bufsize, int fd) {
-    // Scatter array for vector I/O
-    struct iovec _iov;
-
-    // Starting address
-    _iov.iov_base = reinterpret_cast <void *> (buf);
-    // Number of bytes to transfer
-    _iov.iov_len = bufsize;
-
-    // Actual message
-    struct msghdr _msgh = {0};
-
-    // Optional address
-    _msgh.msg_name = nullptr;
-    // Size of address
-    _msgh.msg_namelen = 0;
-    // Elements in msg_iov
-    _msgh.msg_iovlen = 1;
-    // Scatter array
-    _msgh.msg_iov = &_iov;
-
-
-    // Ancillary data
-    // The macro returns the number of bytes an ancillary element with payload of the passed in data length, eg size of ancillary data to be sent
-    char _control [CMSG_SPACE (sizeof ( decltype (fd) ))];
-
-    bool _valid = false;
-
-    if (fd != InvalidDRMfd ()) {
-        // Contruct ancillary data to be added to the transfer via the control message
-
-        // Ancillary data, pointer
-         _msgh.msg_control = _control;
-
-        // Ancillery data buffer length
-        _msgh.msg_controllen = sizeof ( _control );
-
-        // Ancillary data should be access via cmsg macros
-        // https://linux.die.net/man/2/recvmsg
-        // https://linux.die.net/man/3/cmsg
-        // https://linux.die.net/man/2/setsockopt
-        // https://www.man7.org/linux/man-pages/man7/unix.7.html
-
-        // Control message
-
-        // Pointer to the first cmsghdr in the ancillary data buffer associated with the passed msgh
-        struct cmsghdr* _cmsgh = CMSG_FIRSTHDR (&_msgh);
-
-        if (_cmsgh != nullptr) {
-            // Originating protocol
-            // To manipulate options at the sockets API level
-            _cmsgh->cmsg_level = SOL_SOCKET;
-
-            // Protocol specific type
-            // Option at the API level, send or receive a set of open file descriptors from another process
-            _cmsgh->cmsg_type = SCM_RIGHTS;
-
-            // The value to store in the cmsg_len member of the cmsghdr structure, taking into account any necessary alignmen, eg byte count of control message including header
-            _cmsgh->cmsg_len = CMSG_LEN (sizeof ( decltype (fd) ));
-
-            // Initialize the payload
-            // Pointer to the data portion of a cmsghdr, ie unsigned char []
-            * reinterpret_cast < decltype (fd) * > ( CMSG_DATA (_cmsgh) ) = fd;
-
-            _valid = true;
-        }
-        else {
-            // Error
-            _valid = false;
-        }
-    } else {
-        // No extra payload, ie  file descriptor(s), to include
-        _msgh.msg_control = nullptr;
-        _msgh.msg_controllen = 0;
-
-        _valid = true;
-    }
-
-    ssize_t _size = -1;
-
-    if (_valid != false) {
-        // https://linux.die.net/man/2/sendmsg
-        // https://linux.die.net/man/2/write
-        // Zero flags is equivalent to write
-        _size = sendmsg (sock, &_msgh, 0);
-
-        if (_size < 0) {
-            // Error
-            std::cout << "Error: sendmsg (" << strerror (errno) << ")" << std::endl;
-        }
-    }
-    else {
-        _size = -1;
-    }
-
-    return _size;
-}
-
-// Receive data and an optional file descriptor
-ssize_t ReceiveFd (int sock, uint8_t /*const*/ buf [], size_t bufsize, int* fd) {
-    // Scatter array for vector I/O
-    struct iovec _iov;
-
-    // Starting address
-    _iov.iov_base = reinterpret_cast <void *> (buf);
-    // Number of bytes to transfer
-    _iov.iov_len = bufsize;
-
-
-    // Actual message
-    struct msghdr _msgh = {0};
-
-    // Optional address
-    _msgh.msg_name = nullptr;
-    // Size of address
-    _msgh.msg_namelen = 0;
-    // Elements in msg_iov
-    _msgh.msg_iovlen = 1;
-    // Scatter array
-    _msgh.msg_iov = &_iov;
-
-
-    // Ancillary data
-    // The macro returns the number of bytes an ancillary element with payload of the passed in data length, eg size of ancillary data to be sent
-    char _control [CMSG_SPACE (sizeof ( decltype (* fd) ))];
-
-    // Ancillary data, pointer
-    _msgh.msg_control = _control;
-
-    // Ancillery data buffer length
-    _msgh.msg_controllen = sizeof (_control);
-
-
-    size_t _size = -1;
-
-    bool _valid = false;
-
-    if (fd != nullptr) {
-        // Expecting message with extra paylod
-
-        // No flags set
-        _size = recvmsg (sock, &_msgh, 0);
-
-        if (_size >= 0) {
-
-            // Pointer to the first cmsghdr in the ancillary data buffer associated with the passed msgh
-            struct cmsghdr* _cmsgh = CMSG_FIRSTHDR( &_msgh);
-
-            // Check for the expected properties the client should have set
-
-            if (_cmsgh != nullptr) {
-                _valid = true;
-
-                _valid = _cmsgh->cmsg_len == CMSG_LEN (sizeof (decltype (* fd) ));
-
-                if (_cmsgh->cmsg_level != SOL_SOCKET) {
-                    _valid = false;
-                }
-
-                if (_cmsgh->cmsg_type != SCM_RIGHTS) {
-                    _valid = false;
-                }
-
-                if (_valid != false) {
-                    // The macro returns a pointer to the data portion of a cmsghdr.
-                    * fd  = * reinterpret_cast < decltype (fd) > ( CMSG_DATA (_cmsgh) );
-
-                    _valid = true;
-                }
-                else {
-                    *fd = InvalidDRMfd ();
-                    _valid = false;
-                }
-            }
-            else {
-                _valid = false;
-            }
-        }
-        else {
-            // Error
-            std::cout << "Error: recvmsg (" << strerror (errno) << ")" << std::endl;
-        }
-
-    }
-    else {
-        // Expecting just a regular message wihout payload
-
-        _size = read (sock, buf, bufsize);
-
-        if (_size < 0) {
-            // Error
-            std::cout << "Error: read (" << strerror (errno) << ")" << std::endl;
-        }
-
-    }
-
-    if (_valid != true) {
-        _size = -1;
-    }
-
-    return _size;
-}
-
 bool ImportBOFromFD (struct configuration& settings) {
     bool _ret = false;
 
@@ -697,8 +289,8 @@ bool ImportBOFromFD (struct configuration& settings) {
     return _ret;
 }
 
-// Just the renderer, eg, the client
-void Child (int sock) {
+// Just the renderer, eg, the client, non-interactive if frames is non-zero
+void Child (int sock, std::string const & path, uint32_t frames) {
     // It alsmost could not get simpler
     auto BufferColorFill = [] (float degree) -> bool {
         bool _ret = false;
@@ -733,9 +325,7 @@ void Child (int sock) {
     struct configuration _settings;
 
     // Not all combinations with the Parent's node might be supported
-//    _settings.drm.path = "/dev/dri/card10";
-    _settings.drm.path = "/dev/dri/card1";
-//    _settings.drm.path = "/dev/dri/renderD128";
+    _settings.drm.path = path;
 
 
     if (Init (_settings) != false && _settings.drm.fd != InvalidDRMfd ()) {
@@ -744,13 +334,19 @@ void Child (int sock) {
             std::cout << "Error: unable to drop master" << std::endl;
         }
 
-        char key = ' ';
+        // Non-interactive runs behave as if 'c' is pressed for every frame
+        char key = frames > 0 ? 'c' : ' ';
+
+        uint32_t _frame = 0;
 
         // EGL and GLESv2 use float
         static_assert (std::numeric_limits <uint16_t>::max () <= std::numeric_limits <float>::max ());
         uint16_t _degree = 0;
 
-        while (ReadKey ("Press 'c' to create a buffer to be sent, 'Enter' or 'q' to quit", key) != false && key != 'q') {
+        while (   (frames > 0 ? _frame < frames : KMS::ReadKey ("Press 'c' to create a buffer to be sent, 'Enter' or 'q' to quit", key) != false)
+               && key != 'q'
+               && key != 0xD
+              ) {
 
             if (key != 'c') {
                 continue;
@@ -761,6 +357,8 @@ void Child (int sock) {
 
             _degree = (_degree + DELTA) % ROTATION;
 
+            ++_frame;
+
             if (BufferColorFill (_degree) != true || eglSwapBuffers (_settings.egl.dpy, _settings.egl.surf) != EGL_TRUE) {
                 // Error
                 std::cout << "Error: eglSwapBuffers (0x" << std::hex << eglGetError () << ")" << std::endl;
@@ -804,12 +402,19 @@ void Child (int sock) {
                         std::cout << "Error: cannot create prime (" << strerror (errno) << ")" << std::endl;
                     }
                     else {
-// TODO: uint8_t, vs char
-// last char \0
-                        std::string /*const*/ _message ("FD : "); _message.append (std::to_string (_settings.gbm.prime));
-
-                        // Negative size indicates an error
-                        /* ssize_t */ SendFd (sock, reinterpret_cast <uint8_t /*const*/ *> (&_message [0]), _message.size (), _settings.gbm.prime);
+                        // Fixed size messages, the Parent reads Length () bytes
+                        std::string _message (Length (), '\0');
+
+                        std::string const _text ("FD : " + std::to_string (_settings.gbm.prime));
+                        /* std::string & */ _message.replace (0, _text.size (), _text);
+
+                        // Wait for the Parent to present it, the next frame is not rendered before the previous one is shown
+                        if (   KMS::SendFd (sock, &_message [0], _message.size (), _settings.gbm.prime) <= 0
+                            || KMS::ReceiveFd (sock, &_message [0], _message.size (), nullptr) <= 0
+                           ) {
+                            std::cout << "Error: the Parent has gone" << std::endl;
+                            break;
+                        }
                     }
 
                 }
@@ -831,21 +436,28 @@ void Child (int sock) {
 
 
 // Resposible for mode setting and thus scan out
-void Parent (int sock, pid_t child) {
+void Parent (int sock, pid_t child, std::string const & path) {
     struct configuration _settings;
 
     // KMS should be possible
-//    _settings.drm.path = "/dev/dri/card10";
-    _settings.drm.path = "/dev/dri/card1";
+    _settings.drm.path = path;
 
-    if (Init (_settings) != false && _settings.drm.fd != InvalidDRMfd () && FindModeSet (_settings) > 0) {
+    KMS::modeset_t _set = KMS::InvalidModeSet ();
+
+    if (Init (_settings) != false && _settings.drm.fd != InvalidDRMfd () && KMS::FindModeSet (_settings.drm.fd, _set) != false) {
 
         if (drmIsMaster (_settings.drm.fd) != 1 && drmSetMaster (_settings.drm.fd) != 0) {
             std::cout << "Error: unable to become master" << std::endl;
         }
 
-        while (true) {
-            std::string _message (255, '\0');
+        KMS _kms (_settings.drm.fd, _set);
+
+        uint32_t _frames = 0;
+
+        std::chrono::steady_clock::time_point const _start = std::chrono::steady_clock::now ();
+
+        while (_kms.Status () != false) {
+            std::string _message (Length (), '\0');
 
             if (_settings.gbm.prime != InvalidGBMprime ()) {
                 if (close (_settings.gbm.prime) < 0) {
@@ -856,10 +468,9 @@ void Parent (int sock, pid_t child) {
             }
 
 
-// TODO: size uint_8, char, and mmax 
-            ssize_t _size = ReceiveFd (sock, reinterpret_cast <uint8_t /*const*/ *> (&_message[0]), sizeof (_message.size ()), &_settings.gbm.prime);
+            ssize_t _size = KMS::ReceiveFd (sock, &_message [0], _message.size (), &_settings.gbm.prime);
 
-            if (_size <= 0) {
+            if (_size <= 0 || _settings.gbm.prime == InvalidGBMprime ()) {
                 break;
             }
             else {
@@ -868,23 +479,55 @@ void Parent (int sock, pid_t child) {
 #endif
 
                 if (_settings.drm.fd != InvalidDRMfd ()) {
+                    // Currently scanned out, and in use until the next flip has completed
+                    struct gbm_bo * _bo = _settings.gbm.bo;
+
+                    KMS::fb_id_t _fb = KMS::InvalidFb ();
+
+                    if (   ImportBOFromFD (_settings) != false
+                        && _kms.Framebuffer (_settings.gbm.bo, _fb) != false
+                        && _kms.Flip (_fb) != false
+                       ) {
+                        // Its framebuffer is removed with it
+                        if (_bo != InvalidGBMbo ()) {
+                            /* void */ gbm_bo_destroy (_bo);
+                        }
 
-                    if (_settings.gbm.bo != InvalidGBMbo ()) {
-                        /* void */ gbm_bo_destroy (_settings.gbm.bo);
-
-                        _settings.gbm.bo = InvalidGBMbo ();
-                    }
-
-                    if (ImportBOFromFD (_settings) != true) {
-                        std::cout << "Error: scan out impossible" << std::endl;
+                        ++_frames;
                     }
                     else {
-                        ScanOut (_settings);
+                        std::cout << "Error: scan out impossible" << std::endl;
+
+                        if (_settings.gbm.bo != InvalidGBMbo ()) {
+                            /* void */ gbm_bo_destroy (_settings.gbm.bo);
+                        }
+
+                        _settings.gbm.bo = _bo;
                     }
                 }
             }
+
+            // Presented, or not, the Child may continue
+            if (KMS::SendFd (sock, &_message [0], _message.size (), KMS::InvalidFd ()) <= 0) {
+                break;
+            }
+        }
+
+        if (_settings.gbm.bo != InvalidGBMbo ()) {
+            /* void */ gbm_bo_destroy (_settings.gbm.bo);
+            _settings.gbm.bo = InvalidGBMbo ();
+        }
+
+        std::chrono::milliseconds const _duration = std::chrono::duration_cast <std::chrono::milliseconds> (std::chrono::steady_clock::now () - _start);
+
+        std::cout << "Presented " << _frames << " frames in " << _duration.count () << " [msec]";
+
+        if (_duration.count () > 0) {
+            std::cout << ", " << (_frames * 1000.0f) / _duration.count () << " [fps]";
         }
 
+        std::cout << std::endl;
+
     }
     else {
         // Error
@@ -895,13 +538,42 @@ void Parent (int sock, pid_t child) {
 
 
 int main (int argc, char* argv []) {
-// TODO: present user options for entering nodes
-
     uint8_t _ret = EXIT_FAILURE;
 
+    // Optional, device node, used by both
+    std::string _path ("/dev/dri/card1");
+
+    // Optional, non-interactive, number of frames
+    uint32_t _frames = 0;
+
+    bool _usage = false;
+
+    for (int _opt = getopt (argc, argv, "d:n:h"); _opt != -1 && _usage != true; _opt = getopt (argc, argv, "d:n:h")) {
+        switch (_opt) {
+            case 'd'    :   {
+                                _path = optarg;
+                                break;
+                            }
+            case 'n'    :   {
+                                long const _val = std::atol (optarg);
+
+                                _frames = static_cast <uint32_t> (_val > 0 ? _val : 0);
+                                _usage = _val <= 0;
+                                break;
+                            }
+            case 'h'    :
+            default     :   {
+                                _usage = true;
+                            }
+        }
+    }
+
     int _sv [2];
 
-    if (socketpair (AF_LOCAL, SOCK_STREAM, 0, _sv) < 0) {
+    if (_usage != false) {
+        std::cout << "Usage: " << argv [0] << " [-d <device node>] [-n <number of frames, non-interactive>]" << std::endl;
+    }
+    else if (socketpair (AF_LOCAL, SOCK_STREAM, 0, _sv) < 0) {
         std::cout << "Error: socketpair" << std::endl;
     }
     else {
@@ -918,24 +590,26 @@ int main (int argc, char* argv []) {
                         break;
                      }
             case  0 :{
-                        bool _flag = true;
 #ifdef DEBUG
+                        // Attach a debugger, and clear the flag, nobody to do so for a non-interactive run
+                        bool _flag = _frames == 0;
                         while ( _flag != false ) { sleep ( TIMEOUT ); };
 #endif
 
                         /* int */ close (_sv [0]);
-                        /* void */ Child (_sv [1]);
+                        /* void */ Child (_sv [1], _path, _frames);
                         _ret = EXIT_SUCCESS;
                         break;
                      }
             default :{
-                        bool _flag = true;
 #ifdef DEBUG
+                        // Attach a debugger, and clear the flag, nobody to do so for a non-interactive run
+                        bool _flag = _frames == 0;
                         while ( _flag != false ) { sleep ( TIMEOUT ); };
 #endif
 
                         /* int */ close (_sv [1]);
-                        /* void */ Parent (_sv [0], _pid);
+                        /* void */ Parent (_sv [0], _pid, _path);
                         _ret = EXIT_SUCCESS;
                         break;
                      }
@@ -0,0 +1,806 @@
+/*
+Copyright (C) 2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "kms.h"
+
+#include <cstring>
+#include <ios>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <unistd.h>
+#include <drm/drm_fourcc.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+bool KMS::FindModeSet (fd_t fd, modeset_t & set) {
+    bool _ret = false;
+
+    set = InvalidModeSet ();
+
+    drmModeResPtr _pres = fd != InvalidFd () ? drmModeGetResources (fd) : nullptr;
+
+    if (_pres != nullptr) {
+        for (int i = 0; i < _pres->count_connectors && _ret != true; i++) {
+            // Probe, an output without a console has no current mode
+            drmModeConnectorPtr _pcon = drmModeGetConnector (fd, _pres->connectors [i]);
+
+            if (_pcon != nullptr && _pcon->connection == DRM_MODE_CONNECTED && _pcon->count_modes > 0) {
+                // Encoder currently connected to, or else, the first possible one
+                drmModeEncoderPtr _penc = drmModeGetEncoder (fd, _pcon->encoder_id != 0 ? _pcon->encoder_id : (_pcon->count_encoders > 0 ? _pcon->encoders [0] : 0));
+
+                if (_penc != nullptr) {
+                    set._crtc = _penc->crtc_id;
+
+                    for (int j = 0; j < _pres->count_crtcs && set._crtc == InvalidCrtc (); j++) {
+                        if ((_penc->possible_crtcs & (1 << j)) != 0) {
+                            set._crtc = _pres->crtcs [j];
+                        }
+                    }
+
+                    drmModeFreeEncoder (_penc);
+                }
+
+                if (set._crtc != InvalidCrtc ()) {
+                    set._conn = _pcon->connector_id;
+
+                    set._mode = _pcon->modes [0];
+
+                    for (int j = 0; j < _pcon->count_modes; j++) {
+                        if ((_pcon->modes [j].type & DRM_MODE_TYPE_PREFERRED) != 0) {
+                            set._mode = _pcon->modes [j];
+                            break;
+                        }
+                    }
+
+                    drmModeCrtcPtr _pcrtc = drmModeGetCrtc (fd, set._crtc);
+
+                    if (_pcrtc != nullptr) {
+                        if (_pcrtc->mode_valid != 0) {
+                            // Keep whatever is on screen
+                            set._mode = _pcrtc->mode;
+                        }
+
+                        drmModeFreeCrtc (_pcrtc);
+                    }
+
+                    // For now, do not considerer multiple viable options
+                    _ret = true;
+                }
+            }
+
+            if (_pcon != nullptr) {
+                drmModeFreeConnector (_pcon);
+            }
+        }
+
+        drmModeFreeResources (_pres);
+    }
+
+    if (_ret != true) {
+        set = InvalidModeSet ();
+    }
+
+    return _ret;
+}
+
+ssize_t KMS::SendFd (fd_t sock, void const * buf, size_t bufsize, fd_t fd) {
+    // Scatter array for vector I/O
+    struct iovec _iov;
+
+    // Starting address, logical const
+    _iov.iov_base = const_cast <void *> (buf);
+    // Number of bytes to transfer
+    _iov.iov_len = bufsize;
+
+    // Actual message
+    struct msghdr _msgh = {0};
+
+    // Optional address
+    _msgh.msg_name = nullptr;
+    // Size of address
+    _msgh.msg_namelen = 0;
+    // Elements in msg_iov
+    _msgh.msg_iovlen = 1;
+    // Scatter array
+    _msgh.msg_iov = &_iov;
+
+    // Ancillary data
+    // The macro returns the number of bytes an ancillary element with payload of the passed in data length, eg size of ancillary data to be sent
+    char _control [CMSG_SPACE (sizeof (fd_t))];
+
+    bool _valid = false;
+
+    if (fd != InvalidFd ()) {
+        // Contruct ancillary data to be added to the transfer via the control message
+
+        // Ancillary data, pointer
+        _msgh.msg_control = _control;
+
+        // Ancillery data buffer length
+        _msgh.msg_controllen = sizeof (_control);
+
+        // Ancillary data should be access via cmsg macros
+        // https://linux.die.net/man/2/recvmsg
+        // https://linux.die.net/man/3/cmsg
+        // https://www.man7.org/linux/man-pages/man7/unix.7.html
+
+        // Pointer to the first cmsghdr in the ancillary data buffer associated with the passed msgh
+        struct cmsghdr * _cmsgh = CMSG_FIRSTHDR (&_msgh);
+
+        if (_cmsgh != nullptr) {
+            // Send or receive a set of open file descriptors from another process
+            _cmsgh->cmsg_level = SOL_SOCKET;
+            _cmsgh->cmsg_type = SCM_RIGHTS;
+
+            // Byte count of control message including header
+            _cmsgh->cmsg_len = CMSG_LEN (sizeof (fd_t));
+
+            // Pointer to the data portion of a cmsghdr, ie unsigned char []
+            * reinterpret_cast < fd_t * > ( CMSG_DATA (_cmsgh) ) = fd;
+
+            _valid = true;
+        }
+    }
+    else {
+        // No extra payload, ie  file descriptor(s), to include
+        _msgh.msg_control = nullptr;
+        _msgh.msg_controllen = 0;
+
+        _valid = true;
+    }
+
+    ssize_t _size = -1;
+
+    if (_valid != false) {
+        // Zero flags is equivalent to write, but a peer that has gone should not raise SIGPIPE
+        _size = sendmsg (sock, &_msgh, MSG_NOSIGNAL);
+
+        if (_size < 0) {
+            // Error
+            std::cout << "Error: sendmsg (" << strerror (errno) << ")" << std::endl;
+        }
+    }
+
+    return _size;
+}
+
+ssize_t KMS::ReceiveFd (fd_t sock, void * buf, size_t bufsize, fd_t * fd) {
+    ssize_t _size = -1;
+
+    if (fd != nullptr) {
+        // Scatter array for vector I/O
+        struct iovec _iov;
+
+        // Starting address
+        _iov.iov_base = buf;
+        // Number of bytes to transfer
+        _iov.iov_len = bufsize;
+
+        // Actual message
+        struct msghdr _msgh = {0};
+
+        // Optional address
+        _msgh.msg_name = nullptr;
+        // Size of address
+        _msgh.msg_namelen = 0;
+        // Elements in msg_iov
+        _msgh.msg_iovlen = 1;
+        // Scatter array
+        _msgh.msg_iov = &_iov;
+
+        // Ancillary data
+        char _control [CMSG_SPACE (sizeof (fd_t))];
+
+        // Ancillary data, pointer
+        _msgh.msg_control = _control;
+
+        // Ancillery data buffer length
+        _msgh.msg_controllen = sizeof (_control);
+
+        *fd = InvalidFd ();
+
+        // Descriptors are not inherited by children
+        _size = recvmsg (sock, &_msgh, MSG_CMSG_CLOEXEC);
+
+        // Zero, the peer has closed the socket
+        if (_size > 0) {
+            // Pointer to the first cmsghdr in the ancillary data buffer associated with the passed msgh
+            struct cmsghdr * _cmsgh = CMSG_FIRSTHDR (&_msgh);
+
+            // The sender had nothing to share, the caller decides if that is an error
+            if (_cmsgh != nullptr) {
+                // Check for the expected properties the sender should have set
+                if (   _cmsgh->cmsg_len == CMSG_LEN (sizeof (fd_t))
+                    && _cmsgh->cmsg_level == SOL_SOCKET
+                    && _cmsgh->cmsg_type == SCM_RIGHTS
+                   ) {
+                    // The macro returns a pointer to the data portion of a cmsghdr.
+                    *fd = * reinterpret_cast < fd_t * > ( CMSG_DATA (_cmsgh) );
+                }
+                else {
+                    _size = -1;
+                }
+            }
+        }
+        else if (_size < 0) {
+            // Error
+            std::cout << "Error: recvmsg (" << strerror (errno) << ")" << std::endl;
+        }
+    }
+    else {
+        // Expecting just a regular message wihout payload
+        _size = read (sock, buf, bufsize);
+
+        if (_size < 0) {
+            // Error
+            std::cout << "Error: read (" << strerror (errno) << ")" << std::endl;
+        }
+    }
+
+    return _size;
+}
+
+bool KMS::ReadKey (std::string const & message, char & key) {
+    bool _ret = false;
+
+    // Message size, and delimiter
+    constexpr uint8_t _length = 255;
+    constexpr char _delim = '\n';
+
+    if (message.size () > 0) {
+        std::cout << message << std::endl;
+    }
+    else {
+        std::cout << "Press key" << std::endl;
+    }
+
+    char _str [_length];
+
+    std::cin.getline (_str, _length, _delim);
+
+    switch (std::cin.rdstate ()) {
+        case        std::ios::goodbit   :
+                                            switch (std::cin.gcount ()) {
+                                                case    2   :
+                                                                key = _str [0];
+                                                                _ret = true;
+                                                                break;
+                                                default     :
+                                                                key = 0xD; // CR
+                                                                _ret = true;
+                                            }
+                                            break;
+        case        std::ios::eofbit    :;
+        case        std::ios::failbit   :;
+        case        std::ios::badbit    :;
+        default                         :
+                                            _ret = false;
+    }
+
+    return _ret;
+}
+
+KMS::duration_t KMS::FrameDuration () const {
+    duration_t _ret = 1000 * 1000 * 1000 / 60;
+
+    if (_set._mode.clock > 0 && _set._mode.htotal > 0 && _set._mode.vtotal > 0) {
+        // Pixel clock in kHz, more precise than the rounded refresh rate
+        _ret = (static_cast <duration_t> (_set._mode.htotal) * _set._mode.vtotal * 1000 * 1000) / _set._mode.clock;
+    }
+    else if (_set._mode.vrefresh > 0) {
+        _ret = 1000 * 1000 * 1000 / _set._mode.vrefresh;
+    }
+
+    return _ret;
+}
+
+bool KMS::Framebuffer (struct gbm_bo * bo, fb_id_t & fb) {
+    bool _ret = _fd != InvalidFd () && bo != nullptr;
+
+    fb = InvalidFb ();
+
+    if (_ret != false) {
+        auto _it = _cache.find (bo);
+
+        if (_it != _cache.end ()) {
+            // Buffer objects of a surface are recycled, as is their framebuffer
+            fb = _it->second;
+        }
+        else {
+            uint32_t const _handles [GBM_MAX_PLANES] = { gbm_bo_get_handle (bo).u32, 0, 0, 0 };
+            uint32_t const _pitches [GBM_MAX_PLANES] = { gbm_bo_get_stride (bo), 0, 0, 0 };
+            uint32_t const _offsets [GBM_MAX_PLANES] = { 0, 0, 0, 0 };
+            uint64_t const _modifiers [GBM_MAX_PLANES] = { gbm_bo_get_modifier (bo), 0, 0, 0 };
+
+            bool const _explicit = _modifiers [0] != DRM_FORMAT_MOD_INVALID;
+
+            _ret = drmModeAddFB2WithModifiers (_fd, gbm_bo_get_width (bo), gbm_bo_get_height (bo), gbm_bo_get_format (bo), &_handles [0], &_pitches [0], &_offsets [0], _explicit != false ? &_modifiers [0] : nullptr, &fb, _explicit != false ? DRM_MODE_FB_MODIFIERS : 0) == 0;
+
+            if (_ret != false) {
+                _cache [bo] = fb;
+
+                // Strictly speaking c++ linkage and not C linkage
+                auto _destroy = +[] (struct gbm_bo * bo, void * data) {
+                    KMS * _kms = reinterpret_cast <KMS *> (data);
+
+                    if (_kms != nullptr) {
+                        auto _it = _kms->_cache.find (bo);
+
+                        if (_it != _kms->_cache.end ()) {
+                            /* int */ drmModeRmFB (_kms->_fd, _it->second);
+
+                            _kms->_cache.erase (_it);
+                        }
+                    }
+                };
+
+                /* void */ gbm_bo_set_user_data (bo, this, _destroy);
+            }
+            else {
+                std::cout << "Error: unable to add a framebuffer (" << strerror (errno) << ")" << std::endl;
+
+                fb = InvalidFb ();
+            }
+        }
+    }
+
+    return _ret;
+}
+
+bool KMS::Cached (fb_id_t fb) const {
+    bool _ret = false;
+
+    for (auto const & _entry : _cache) {
+        _ret = _ret || _entry.second == fb;
+    }
+
+    return _ret;
+}
+
+bool KMS::Flip (fb_id_t fb) {
+    bool _ret = _fd != InvalidFd () && fb != InvalidFb () && _set._crtc != InvalidCrtc ();
+
+    int _err = -EINVAL;
+
+    if (_ret != false) {
+        _err = Flip ([this, fb] (void * data) -> int {
+            int _err = -EINVAL;
+
+            if (_atomic != false) {
+                drmModeAtomicReqPtr _req = drmModeAtomicAlloc ();
+
+                _err =    _req != nullptr
+                       && drmModeAtomicAddProperty (_req, _plane, _fb_id, fb) >= 0
+                       && drmModeAtomicAddProperty (_req, _plane, _crtc_id, _set._crtc) >= 0
+                       ? drmModeAtomicCommit (_fd, _req, DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK, data) : -EINVAL;
+
+                if (_req != nullptr) {
+                    drmModeAtomicFree (_req);
+                }
+            }
+            else {
+                _err = drmModePageFlip (_fd, _set._crtc, fb, DRM_MODE_PAGE_FLIP_EVENT, data);
+            }
+
+            // Both return -1, and set errno, or -errno
+            return _err == -1 ? -errno : _err;
+        });
+    }
+
+    switch (0 - _err) {
+        case ETIMEDOUT  :   // The event got lost, the flip has most likely taken place, the state has been realigned
+        case 0      :   {
+                            _ret = true;
+                            break;
+                        }
+        case EINVAL :
+                        {   // Probably a missing drmModeSetCrtc, eg, an inactive CRTC
+                            // Likely to happens once or not at all
+                            drmModeModeInfo _mode = _set._mode;
+                            conn_id_t _conn = _set._conn;
+
+                            constexpr int _count = 1;
+
+                            _ret =    _ret != false
+                                   && drmModeSetCrtc (_fd, _set._crtc, fb, 0, 0, &_conn, _count, &_mode) == 0;
+
+                            break;
+                        }
+        case EBUSY  :
+        default     :
+                        {
+                            // There is nothing to be done about it
+                            _ret = false;
+                        }
+    }
+
+    return _ret;
+}
+
+int KMS::Flip (std::function <int (void * data)> const & commit) {
+    int _ret = -EINVAL;
+
+    if (_fd != InvalidFd () && _pending != true) {
+        _pending = true;
+
+        _token = _token < std::numeric_limits <uint32_t>::max () ? _token + 1 : 1;
+
+        duration_t const _submitted = Now ();
+
+        _ret = commit (reinterpret_cast <void *> (static_cast <uintptr_t> (_token)));
+
+        if (_ret == 0) {
+            _ret = Dispatch (_submitted);
+        }
+
+        // An event that arrives later is handled by the next dispatch, but not waited for
+        _pending = false;
+    }
+
+    return _ret;
+}
+
+bool KMS::Clear () {
+    bool _ret = false;
+
+    _atomic = false;
+
+    _plane = InvalidPlane ();
+    _fb_id = InvalidProperty ();
+    _crtc_id = InvalidProperty ();
+
+    _pending = false;
+
+    _vblank = { 0, 0 };
+
+    _timer = InvalidFd ();
+
+    _token = 0;
+
+    _vrr_capable = false;
+    _vrr_enabled = InvalidProperty ();
+    _vrr = false;
+
+    _pacing = { 0, 0, 0, 0 };
+
+    const_cast <std::remove_const <valid_t>::type &> (_valid) = false;
+
+    _ret = Status () != true;
+
+    return _ret;
+}
+
+bool KMS::Init () {
+    bool _ret = Clear () && _fd != InvalidFd ();
+
+    if (_ret != false && _set._crtc != InvalidCrtc ()) {
+        _timer = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+
+        _ret = _timer != InvalidFd ();
+    }
+
+    if (_ret != false && _set._crtc != InvalidCrtc ()) {
+        // Primary planes are only exposed with universal planes
+        _atomic =    drmSetClientCap (_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) == 0
+                  && drmSetClientCap (_fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0;
+
+        // Planes refer to CRTCs by index
+        int _index = -1;
+
+        drmModeResPtr _pres = _atomic != false ? drmModeGetResources (_fd) : nullptr;
+
+        if (_pres != nullptr) {
+            for (int i = 0; i < _pres->count_crtcs && _index < 0; i++) {
+                if (_pres->crtcs [i] == _set._crtc) {
+                    _index = i;
+                }
+            }
+
+            drmModeFreeResources (_pres);
+        }
+
+        drmModePlaneResPtr _pplanes = _index >= 0 ? drmModeGetPlaneResources (_fd) : nullptr;
+
+        if (_pplanes != nullptr) {
+            for (uint32_t i = 0; i < _pplanes->count_planes && _plane == InvalidPlane (); i++) {
+                drmModePlanePtr _pplane = drmModeGetPlane (_fd, _pplanes->planes [i]);
+
+                if (_pplane != nullptr && (_pplane->possible_crtcs & (1 << _index)) != 0) {
+                    drmModeObjectPropertiesPtr _pprops = drmModeObjectGetProperties (_fd, _pplane->plane_id, DRM_MODE_OBJECT_PLANE);
+
+                    for (uint32_t j = 0; _pprops != nullptr && j < _pprops->count_props; j++) {
+                        drmModePropertyPtr _pprop = drmModeGetProperty (_fd, _pprops->props [j]);
+
+                        if (   _pprop != nullptr
+                            && strcmp (_pprop->name, "type") == 0
+                            && _pprops->prop_values [j] == DRM_PLANE_TYPE_PRIMARY
+                           ) {
+                            _plane = _pplane->plane_id;
+                        }
+
+                        if (_pprop != nullptr) {
+                            drmModeFreeProperty (_pprop);
+                        }
+                    }
+
+                    if (_pprops != nullptr) {
+                        drmModeFreeObjectProperties (_pprops);
+                    }
+                }
+
+                if (_pplane != nullptr) {
+                    drmModeFreePlane (_pplane);
+                }
+            }
+
+            drmModeFreePlaneResources (_pplanes);
+        }
+
+        _atomic =    _atomic != false
+                  && _plane != InvalidPlane ()
+                  && Property (_plane, DRM_MODE_OBJECT_PLANE, "FB_ID", _fb_id) != false
+                  && Property (_plane, DRM_MODE_OBJECT_PLANE, "CRTC_ID", _crtc_id) != false;
+
+        // Optional, absent on older kernels and most drivers
+        uint64_t _capable = 0;
+        prop_id_t _id = InvalidProperty ();
+
+        _vrr_capable =    Property (_set._conn, DRM_MODE_OBJECT_CONNECTOR, "vrr_capable", _id, _capable) != false
+                       && _capable != 0;
+
+        /* bool */ Property (_set._crtc, DRM_MODE_OBJECT_CRTC, "VRR_ENABLED", _vrr_enabled);
+    }
+
+    const_cast <std::remove_const <valid_t>::type &> (_valid) = _ret;
+
+    return _ret;
+}
+
+bool KMS::Deinit () {
+    bool _ret = true;
+
+    for (auto const & _entry : _cache) {
+        // The buffer object may outlive this
+        /* void */ gbm_bo_set_user_data (_entry.first, nullptr, nullptr);
+
+        _ret = drmModeRmFB (_fd, _entry.second) == 0 && _ret;
+    }
+
+    _cache.clear ();
+
+    if (_timer != InvalidFd ()) {
+        _ret = close (_timer) == 0 && _ret;
+    }
+
+    _ret = Clear () && _ret;
+
+    return _ret;
+}
+
+bool KMS::Adaptive (bool enable) {
+    bool _ret = AdaptiveCapable () != false || enable != true;
+
+    if (_ret != false && _vrr_enabled != InvalidProperty () && _vrr != enable) {
+        if (_atomic != false) {
+            drmModeAtomicReqPtr _req = drmModeAtomicAlloc ();
+
+            // Blocking, it does not take effect before the next flip anyway
+            _ret =    _req != nullptr
+                   && drmModeAtomicAddProperty (_req, _set._crtc, _vrr_enabled, enable != false ? 1 : 0) >= 0
+                   && drmModeAtomicCommit (_fd, _req, 0, nullptr) == 0;
+
+            if (_req != nullptr) {
+                drmModeAtomicFree (_req);
+            }
+        }
+        else {
+            _ret = drmModeObjectSetProperty (_fd, _set._crtc, DRM_MODE_OBJECT_CRTC, _vrr_enabled, enable != false ? 1 : 0) == 0;
+        }
+    }
+
+    if (_ret != false) {
+        _vrr = enable;
+    }
+    else {
+        std::cout << "Error: unable to " << (enable != false ? "enable" : "disable") << " adaptive sync" << std::endl;
+    }
+
+    return _ret;
+}
+
+bool KMS::Property (uint32_t object, uint32_t type, char const name [], prop_id_t & id) const {
+    uint64_t _value = 0;
+
+    bool _ret = Property (object, type, name, id, _value);
+
+    return _ret;
+}
+
+bool KMS::Property (uint32_t object, uint32_t type, char const name [], prop_id_t & id, uint64_t & value) const {
+    bool _ret = false;
+
+    id = InvalidProperty ();
+    value = 0;
+
+    drmModeObjectPropertiesPtr _pprops = drmModeObjectGetProperties (_fd, object, type);
+
+    if (_pprops != nullptr) {
+        for (uint32_t i = 0; i < _pprops->count_props && _ret != true; i++) {
+            drmModePropertyPtr _pprop = drmModeGetProperty (_fd, _pprops->props [i]);
+
+            if (_pprop != nullptr) {
+                if (strcmp (_pprop->name, name) == 0) {
+                    id = _pprop->prop_id;
+                    value = _pprops->prop_values [i];
+                    _ret = true;
+                }
+
+                drmModeFreeProperty (_pprop);
+            }
+        }
+
+        drmModeFreeObjectProperties (_pprops);
+    }
+
+    return _ret;
+}
+
+int KMS::Dispatch (duration_t submitted) {
+    int _ret = _timer != InvalidFd () ? 0 : -EBADF;
+
+    // The event data is the token of a flip, the handler cannot capture this
+    static thread_local KMS * _self = nullptr;
+
+    _self = this;
+
+    // Strictly speaking c++ linkage and not C linkage
+    auto _handler = +[] (int fd, unsigned int frame, unsigned int sec, unsigned int usec, void * data) {
+        if (data != nullptr && _self != nullptr) {
+            KMS * _kms = _self;
+
+            if (_kms->_pending != true || reinterpret_cast <uintptr_t> (data) != _kms->_token) {
+                // Late event of a flip that has been given up on
+            }
+            else {
+                uint64_t const _timestamp = static_cast <uint64_t> (sec) * 1000 * 1000 + usec;
+
+                if (_kms->_vblank._timestamp > 0 && _timestamp > _kms->_vblank._timestamp) {
+                    duration_t const _interval = (_timestamp - _kms->_vblank._timestamp) * 1000;
+
+                    pacing_t & _pacing = _kms->_pacing;
+
+                    _pacing._min = _pacing._count > 0 ? std::min (_pacing._min, _interval) : _interval;
+                    _pacing._max = std::max (_pacing._max, _interval);
+                    _pacing._total += _interval;
+                    ++_pacing._count;
+                }
+
+                _kms->_vblank = { frame, _timestamp };
+
+                _kms->_pending = false;
+            }
+        }
+        else {
+            std::cout << "Error: invalid callback data" << std::endl;
+        }
+    };
+
+    // Use the magic constant here because the struct is versioned!
+    drmEventContext _context = { .version = 2, .vblank_handler = nullptr, .page_flip_handler = _handler };
+
+    duration_t const _duration = FrameDuration ();
+
+    // Event timestamps are CLOCK_MONOTONIC in microseconds
+    duration_t const _previous = static_cast <duration_t> (_vblank._timestamp) * 1000;
+
+    // The first vertical blank after the submission
+    duration_t _expected = submitted + _duration;
+
+    // With adaptive sync the refresh starts when the flip arrives, there is no fixed vertical blank to align to
+    if (_vrr != true && _previous > 0 && _previous <= submitted) {
+        _expected = _previous + ((submitted - _previous) / _duration + 1) * _duration;
+    }
+
+    // Half a frame of slack for jitter, and for a commit just too late for the expected vertical blank
+    duration_t _deadline = _expected + _duration / 2;
+
+    uint8_t _late = 0;
+
+    while (_pending != false && _ret == 0) {
+        struct itimerspec const _spec = { { 0, 0 }, { static_cast <time_t> (_deadline / (1000 * 1000 * 1000)), static_cast <long> (_deadline % (1000 * 1000 * 1000)) } };
+
+        struct pollfd _fds [2] = { { _fd, POLLIN, 0 }, { _timer, POLLIN, 0 } };
+
+        _ret = timerfd_settime (_timer, TFD_TIMER_ABSTIME, &_spec, nullptr) == 0 ? 0 : -errno;
+
+        int const _err = _ret == 0 ? poll (&_fds [0], 2, -1 /* the timer bounds the wait */) : -1;
+
+        if (_ret != 0) {
+            std::cout << "Error: unable to arm the flip timer (" << strerror (-_ret) << ")" << std::endl;
+        }
+        else if (_err < 0) {
+            // Interrupted, retry
+            _ret = errno == EINTR ? 0 : -errno;
+        }
+        else if ((_fds [0].revents & POLLIN) != 0) {
+            _ret = drmHandleEvent (_fd, &_context) == 0 ? 0 : -EIO;
+        }
+        else if ((_fds [1].revents & POLLIN) != 0) {
+            uint64_t _expirations = 0;
+
+            /* ssize_t */ read (_timer, &_expirations, sizeof (_expirations));
+
+            ++_late;
+
+            if (_late > FrameLateMax ()) {
+                // The event is lost, by now the flip has taken place, or never will, do not stall
+                uint64_t _sequence = 0;
+                uint64_t _ns = 0;
+
+                // Realign with the most recent vertical blank, if possible
+                _vblank = drmCrtcGetSequence (_fd, _set._crtc, &_sequence, &_ns) == 0
+                          ? vblank_t { static_cast <uint32_t> (_sequence), _ns / 1000 }
+                          : vblank_t { 0, 0 };
+
+                _pending = false;
+
+                std::cout << "Error: flip event lost, recovered after " << (Now () - submitted) / 1000 << " us" << std::endl;
+
+                _ret = -ETIMEDOUT;
+            }
+            else {
+                // Possibly one vertical blank later, eg, the expected one was missed
+                _deadline += _duration;
+            }
+        }
+    }
+
+    return _ret;
+}
+
+KMS::duration_t KMS::Now () {
+    struct timespec _now = { 0, 0 };
+
+    /* int */ clock_gettime (CLOCK_MONOTONIC, &_now);
+
+    duration_t _ret = static_cast <duration_t> (_now.tv_sec) * 1000 * 1000 * 1000 + static_cast <duration_t> (_now.tv_nsec);
+
+    return _ret;
+}
@@ -0,0 +1,218 @@
+/*
+Copyright (C) 2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Mode setting, page flips and buffer passing shared by drm-prime-simple,
+drm-prime-tile and drm-prime-multi.
+*/
+
+#ifndef _KMS_H
+#define _KMS_H
+
+#include <string>
+#include <functional>
+#include <type_traits>
+#include <map>
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <gbm.h>
+
+#include <sys/types.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+class KMS {
+    public :
+
+        using fd_t = int;
+
+        using fb_id_t = std::remove_pointer < decltype (drmModeFB::fb_id) >::type;
+        using crtc_id_t = std::remove_pointer < decltype (drmModeCrtc::crtc_id) >::type;
+        using conn_id_t = std::remove_pointer < decltype (drmModeConnector::connector_id) >::type;
+        using plane_id_t = std::remove_pointer < decltype (drmModePlane::plane_id) >::type;
+        using prop_id_t = std::remove_pointer < decltype (drmModePropertyRes::prop_id) >::type;
+
+        // Nanoseconds
+        using duration_t = uint64_t;
+
+        // Of a completed flip, as reported by the kernel
+        struct vblank {
+            // Vertical blank counter of the CRTC
+            uint32_t _sequence;
+            // CLOCK_MONOTONIC, in microseconds
+            uint64_t _timestamp;
+        };
+
+        // What to scan out to
+        struct modeset {
+            crtc_id_t _crtc;
+            conn_id_t _conn;
+            drmModeModeInfo _mode;
+        };
+
+        // Intervals between completed flips, as achieved, with adaptive sync not necessarily a multiple of the frame period
+        struct pacing {
+            uint32_t _count;
+            duration_t _total;
+            duration_t _min;
+            duration_t _max;
+        };
+
+        using vblank_t = struct vblank;
+        using modeset_t = struct modeset;
+        using pacing_t = struct pacing;
+
+    private :
+
+        fd_t const _fd;
+
+        modeset_t const _set;
+
+        // Framebuffers of buffer objects, removed with their buffer object, or at Deinit
+        std::map <struct gbm_bo *, fb_id_t> _cache;
+
+        bool const _valid;
+
+        // Atomic mode setting is used, if available, legacy page flips otherwise
+        bool _atomic;
+
+        // Primary plane of the CRTC and its properties used with full screen flips
+        plane_id_t _plane;
+        prop_id_t _fb_id;
+        prop_id_t _crtc_id;
+
+        // A flip has been committed, its event has not yet been handled
+        bool _pending;
+
+        vblank_t _vblank;
+
+        // CLOCK_MONOTONIC deadlines for flip completion
+        fd_t _timer;
+
+        // Token of the most recent flip, its event data, never 0, a late event of a flip given up on does not match
+        uint32_t _token;
+
+        // Adaptive sync, the sink supports it, the CRTC property to enable it, and whether it is enabled
+        bool _vrr_capable;
+        prop_id_t _vrr_enabled;
+        bool _vrr;
+
+        pacing_t _pacing;
+
+    public :
+
+        using valid_t = decltype (_valid);
+
+        KMS () = delete;
+        explicit KMS (fd_t fd, modeset_t const & set) : _fd {fd}, _set (set), _valid {Init ()} {}
+        ~KMS () { /* bool */ Deinit (); }
+
+        static constexpr fd_t InvalidFd () { return -1; }
+        static constexpr fb_id_t InvalidFb () { return 0; }
+        static constexpr crtc_id_t InvalidCrtc () { return 0; }
+        static constexpr conn_id_t InvalidConnector () { return 0; }
+        static constexpr plane_id_t InvalidPlane () { return 0; }
+        static constexpr prop_id_t InvalidProperty () { return 0; }
+
+        static modeset_t InvalidModeSet () { return { InvalidCrtc (), InvalidConnector (), drmModeModeInfo () }; }
+
+        valid_t Status () const { return _valid; }
+
+        bool Atomic () const { return _atomic; }
+
+        // Primary plane of the CRTC, only with atomic mode setting
+        plane_id_t Plane () const { return _plane; }
+
+        // Look up a property, by name, of a mode object, id and value are invalid, and zero, if it is absent
+        bool Property (uint32_t object, uint32_t type, char const name [], prop_id_t & id) const;
+        bool Property (uint32_t object, uint32_t type, char const name [], prop_id_t & id, uint64_t & value) const;
+
+        // The first connected connector, the CRTC of its encoder and its current, or else, preferred mode
+        static bool FindModeSet (fd_t fd, modeset_t & set);
+
+        // Data, and an optional file descriptor, over a (local) socket, a gone peer does not raise SIGPIPE
+        static ssize_t SendFd (fd_t sock, void const * buf, size_t bufsize, fd_t fd);
+        // Without fd only data is expected, otherwise fd is set to the received descriptor, or invalid if none was sent
+        // Zero if the peer has closed the socket
+        static ssize_t ReceiveFd (fd_t sock, void * buf, size_t bufsize, fd_t * fd);
+
+        // A single key followed by 'Enter', carriage return for 'Enter' only
+        static bool ReadKey (std::string const & message, char & key);
+
+        // Of the mode, 1/60 of a second if unknown
+        duration_t FrameDuration () const;
+
+        // Frame periods past the half frame of slack after the expected flip before its event is considered lost, 1.5 periods in total
+        static constexpr uint8_t FrameLateMax () { return 1; }
+
+        // The framebuffer of a buffer object, added once, and removed when the buffer object is destroyed
+        bool Framebuffer (struct gbm_bo * bo, fb_id_t & fb);
+        // Is fb owned by the cache
+        bool Cached (fb_id_t fb) const;
+
+        // Full screen on the primary plane, sets the mode if required, and wait for completion
+        bool Flip (fb_id_t fb);
+        // With a commit of the caller, eg, atomic with additional state, that receives the event data and returns 0 or -errno
+        // The result of the commit, or of waiting for it, -ETIMEDOUT if its event got lost, by then the flip has taken place, or never will
+        int Flip (std::function <int (void * data)> const & commit);
+
+        // Of the most recent completed flip
+        vblank_t const & VBlank () const { return _vblank; }
+
+        // Of all completed flips so far
+        pacing_t const & Pacing () const { return _pacing; }
+
+        // The connector reports a variable refresh rate capable sink, and the CRTC can drive it
+        bool AdaptiveCapable () const { return _vrr_capable != false && _vrr_enabled != InvalidProperty (); }
+        bool Adaptive () const { return _vrr; }
+        // Flips complete as soon as possible, within the sink's range, instead of at the fixed frame period
+        bool Adaptive (bool enable);
+
+    private :
+
+        bool Clear ();
+
+        bool Init ();
+        bool Deinit ();
+
+        // Handle events until the pending flip has completed, or its event is considered lost
+        // The deadline is the vertical blank following the submission, aligned to the previous flip
+        // 0, -ETIMEDOUT if the event is lost, the state is then realigned with the most recent vertical blank, or -errno
+        int Dispatch (duration_t submitted);
+
+        // CLOCK_MONOTONIC, in nanoseconds
+        static duration_t Now ();
+};
+
+#endif
@@ -38,6 +38,28 @@ else
     LIBYXOPE_CPPFLAGS += -DNDEBUG
 endif
 
+ifeq ($(BR2_PACKAGE_LIBYXOPE_ADAPTIVE_SYNC)x,yx)
+    LIBYXOPE_CPPFLAGS += -D_ADAPTIVE_SYNC
+endif
+
+ifeq ($(BR2_PACKAGE_LIBYXOPE_LEASE)x,yx)
+    LIBYXOPE_CPPFLAGS += -D_LEASE
+endif
+
+ifeq ($(BR2_PACKAGE_LIBYXOPE_CLIENT)x,yx)
+    LIBYXOPE_CPPFLAGS += -D_CLIENT
+endif
+
+ifeq ($(BR2_PACKAGE_LIBYXOPE_MODE_MATCH)x,yx)
+    LIBYXOPE_CPPFLAGS += -D_MODE_MATCH
+endif
+
+ifeq ($(BR2_PACKAGE_LIBYXOPE_EVENT_THREAD)x,yx)
+    LIBYXOPE_CPPFLAGS += -D_EVENT_THREAD -D_EVENT_THREAD_PRIORITY=$(BR2_PACKAGE_LIBYXOPE_EVENT_THREAD_PRIORITY) -D_EVENT_THREAD_AFFINITY=$(BR2_PACKAGE_LIBYXOPE_EVENT_THREAD_AFFINITY)
+    LIBYXOPE_CXXFLAGS += -pthread
+    LIBYXOPE_LDFLAGS += -pthread
+endif
+
 #LIBYXOPE_CPPFLAGS += -D_FIXEDSIZEDQUEUE
 #LIBYXOPE_CPPFLAGS += -D_ENABLE_BENCHMARK
 #LIBYXOPE_CPPFLAGS += -D_FORCE_CLEANUP
@@ -66,11 +88,13 @@ endef
 define LIBYXOPE_INSTALL_STAGING_CMDS
 $(call LIBYXOPE_INSTALLER,gbm,$(STAGING_DIR))
 $(call LIBYXOPE_INSTALLER,EGL,$(STAGING_DIR))
+$(INSTALL) -D -m 644 $(@D)/yxope.h $(STAGING_DIR)/usr/include/yxope.h
 endef
 
 define LIBYXOPE_INSTALL_TARGET_CMDS
 $(call LIBYXOPE_INSTALLER,gbm,$(TARGET_DIR))
 $(call LIBYXOPE_INSTALLER,EGL,$(TARGET_DIR))
+$(if $(BR2_PACKAGE_LIBYXOPE_LEASE),$(INSTALL) -D -m 755 $(@D)/.bin/yxope-lease-broker $(TARGET_DIR)/usr/bin/yxope-lease-broker)
 endef
 
 $(eval $(generic-package))
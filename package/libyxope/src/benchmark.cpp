@@ -0,0 +1,389 @@
+/*
+Copyright (C) 2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+First attempt. Possibly wrong and / or incomplete, and may contain 'bad' code and / or coding practice.
+*/
+
+// Measures libyxope's overhead on the mock backend, see mock.h, so no display hardware is needed
+// Usage: yxope-benchmark [-n <swaps>] [-t <threads>] [-s <surfaces per thread>] [-r <refresh rate>] [-b <buffers per surface>]
+// Build with 'make benchmark' and run from the build directory, eg, LD_LIBRARY_PATH=.mock .mock/yxope-benchmark
+// The mock renders instantly, and waiting for a flip uses no CPU time, so the swapping thread's CPU time per swap is the interposer's cost
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <gbm.h>
+#include <xf86drm.h>
+
+#include <time.h>
+#include <getopt.h>
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <dlfcn.h>
+#undef _GNU_SOURCE
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "mock.h"
+
+namespace {
+
+// Nanoseconds
+using duration_t = uint64_t;
+
+duration_t Clock (clockid_t id) {
+    struct timespec _now = { 0, 0 };
+
+    /* int */ clock_gettime (id, &_now);
+
+    return static_cast <duration_t> (_now.tv_sec) * 1000000000 + static_cast <duration_t> (_now.tv_nsec);
+}
+
+// Of a run, the calling thread's CPU time only
+struct measurement {
+    uint64_t _count;
+    duration_t _wall;
+    duration_t _cpu;
+};
+
+using measurement_t = struct measurement;
+
+// The implementation underneath libyxope, bypassing it, for reference
+struct direct {
+    EGLBoolean (*_swap) (EGLDisplay, EGLSurface);
+    struct gbm_bo * (*_lock) (struct gbm_surface *);
+    void (*_release) (struct gbm_surface *, struct gbm_bo *);
+};
+
+using direct_t = struct direct;
+
+bool Resolve (direct_t & direct) {
+    // Already loaded as dependencies of libyxope's libraries
+    void * _egl = dlopen ("libRealEGL.so", RTLD_LAZY | RTLD_NOLOAD);
+    void * _gbm = dlopen ("libRealgbm.so", RTLD_LAZY | RTLD_NOLOAD);
+
+    direct._swap = _egl != nullptr ? reinterpret_cast <decltype (direct._swap)> (dlsym (_egl, "eglSwapBuffers")) : nullptr;
+    direct._lock = _gbm != nullptr ? reinterpret_cast <decltype (direct._lock)> (dlsym (_gbm, "gbm_surface_lock_front_buffer")) : nullptr;
+    direct._release = _gbm != nullptr ? reinterpret_cast <decltype (direct._release)> (dlsym (_gbm, "gbm_surface_release_buffer")) : nullptr;
+
+    // The handles only hold a reference
+    if (_egl != nullptr) {
+        /* int */ dlclose (_egl);
+    }
+
+    if (_gbm != nullptr) {
+        /* int */ dlclose (_gbm);
+    }
+
+    return direct._swap != nullptr && direct._lock != nullptr && direct._release != nullptr;
+}
+
+// A gbm surface of the mode's size, through libyxope, and its window surface
+struct window {
+    struct gbm_surface * _native;
+    EGLSurface _surface;
+};
+
+using window_t = struct window;
+
+bool Create (struct gbm_device * device, EGLDisplay dpy, EGLConfig config, window_t & window) {
+    window._native = gbm_surface_create (device, Mock::Width (), Mock::Height (), GBM_FORMAT_XRGB8888, GBM_BO_USE_SCANOUT | GBM_BO_USE_RENDERING);
+
+    window._surface = window._native != nullptr ? eglCreateWindowSurface (dpy, config, reinterpret_cast <EGLNativeWindowType> (window._native), nullptr) : EGL_NO_SURFACE;
+
+    return window._surface != EGL_NO_SURFACE;
+}
+
+void Destroy (EGLDisplay dpy, window_t & window) {
+    if (window._surface != EGL_NO_SURFACE) {
+        /* EGLBoolean */ eglDestroySurface (dpy, window._surface);
+    }
+
+    if (window._native != nullptr) {
+        gbm_surface_destroy (window._native);
+    }
+
+    window = { nullptr, EGL_NO_SURFACE };
+}
+
+// Swaps of the current surface, through libyxope, each scanned out and waited for
+measurement_t Swap (EGLDisplay dpy, EGLSurface surface, uint64_t count) {
+    measurement_t ret = { 0, Clock (CLOCK_MONOTONIC), Clock (CLOCK_THREAD_CPUTIME_ID) };
+
+    for (uint64_t i = 0; i < count && eglSwapBuffers (dpy, surface) != EGL_FALSE; i++) {
+        ++ret._count;
+    }
+
+    ret._wall = Clock (CLOCK_MONOTONIC) - ret._wall;
+    ret._cpu = Clock (CLOCK_THREAD_CPUTIME_ID) - ret._cpu;
+
+    return ret;
+}
+
+// A swap, a lock and a release of the front buffer, of the implementation, and the lock and release optionally through libyxope
+measurement_t Cycle (direct_t const & direct, EGLDisplay dpy, window_t const & window, uint64_t count, bool interposed) {
+    measurement_t ret = { 0, Clock (CLOCK_MONOTONIC), Clock (CLOCK_THREAD_CPUTIME_ID) };
+
+    for (uint64_t i = 0; i < count && direct._swap (dpy, window._surface) != EGL_FALSE; i++) {
+        struct gbm_bo * _bo = interposed != false ? gbm_surface_lock_front_buffer (window._native) : direct._lock (window._native);
+
+        if (_bo == nullptr) {
+            break;
+        }
+
+        if (interposed != false) {
+            gbm_surface_release_buffer (window._native, _bo);
+        }
+        else {
+            direct._release (window._native, _bo);
+        }
+
+        ++ret._count;
+    }
+
+    ret._wall = Clock (CLOCK_MONOTONIC) - ret._wall;
+    ret._cpu = Clock (CLOCK_THREAD_CPUTIME_ID) - ret._cpu;
+
+    return ret;
+}
+
+void Report (std::string const & name, measurement_t const & measurement) {
+    uint64_t const _count = measurement._count > 0 ? measurement._count : 1;
+
+    std::cout << std::left << std::setw (40) << name << std::right
+              << std::setw (8) << measurement._count << " x, "
+              << std::setw (10) << measurement._wall / _count << " [ns] wall, "
+              << std::setw (10) << measurement._cpu / _count << " [ns] cpu"
+              << std::endl;
+}
+
+}
+
+int main (int argc, char* argv [])
+{
+    uint64_t _swaps = 1000;
+    uint32_t _threads = 4;
+    uint32_t _surfaces = 1;
+
+    // Fast enough to complete quickly, the wait for a flip does not count as CPU time anyway
+    std::string _refresh = "1000";
+
+    int _opt = 0;
+
+    while ((_opt = getopt (argc, argv, "n:t:s:r:b:h")) != -1) {
+        switch (_opt) {
+            case 'n'    :   _swaps = std::strtoull (optarg, nullptr, 10); break;
+            case 't'    :   _threads = static_cast <uint32_t> (std::strtoul (optarg, nullptr, 10)); break;
+            case 's'    :   _surfaces = static_cast <uint32_t> (std::strtoul (optarg, nullptr, 10)); break;
+            case 'r'    :   _refresh = optarg; break;
+            case 'b'    :   /* int */ setenv (Mock::BufferCountVariable (), optarg, 1); break;
+            case 'h'    :
+            default     :   std::cout << "Usage: " << argv [0] << " [-n <swaps>] [-t <threads>] [-s <surfaces per thread>] [-r <refresh rate>] [-b <buffers per surface>]" << std::endl;
+                            return _opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    // Read once the device is opened
+    /* int */ setenv (Mock::RefreshVariable (), _refresh.c_str (), 1);
+
+    int _fd = drmOpen ("mock", nullptr);
+
+    struct gbm_device * _device = _fd >= 0 ? gbm_create_device (_fd) : nullptr;
+
+    EGLDisplay _dpy = _device != nullptr ? eglGetDisplay (reinterpret_cast <EGLNativeDisplayType> (_device)) : EGL_NO_DISPLAY;
+
+    EGLConfig _config = nullptr;
+    EGLint _count = 0;
+
+    EGLint const _attribs [] = { EGL_SURFACE_TYPE, EGL_WINDOW_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT, EGL_NONE };
+    EGLint const _context_attribs [] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+
+    bool _ret =    _dpy != EGL_NO_DISPLAY
+                && eglInitialize (_dpy, nullptr, nullptr) != EGL_FALSE
+                && eglBindAPI (EGL_OPENGL_ES_API) != EGL_FALSE
+                && eglChooseConfig (_dpy, &_attribs [0], &_config, 1, &_count) != EGL_FALSE
+                && _count > 0;
+
+    if (_ret != true) {
+        std::cout << "Error: unable to set up the mock device and display, are the libraries of 'make benchmark' used?" << std::endl;
+    }
+
+    direct_t _direct = { nullptr, nullptr, nullptr };
+
+    if (_ret != false) {
+        _ret = Resolve (_direct);
+
+        if (_ret != true) {
+            std::cout << "Error: libRealEGL.so and libRealgbm.so of the mock backend are not loaded" << std::endl;
+        }
+    }
+
+    if (_ret != false) {
+        std::cout << "Mock display " << Mock::Width () << "x" << Mock::Height () << "@" << _refresh << ", "
+                  << Mock::Value (Mock::BufferCountVariable (), Mock::DefaultBufferCount ()) << " buffers per surface" << std::endl;
+
+        EGLContext _context = eglCreateContext (_dpy, _config, EGL_NO_CONTEXT, &_context_attribs [0]);
+
+        window_t _window = { nullptr, EGL_NO_SURFACE };
+
+        _ret =    _context != EGL_NO_CONTEXT
+               && Create (_device, _dpy, _config, _window) != false
+               && eglMakeCurrent (_dpy, _window._surface, _window._surface, _context) != EGL_FALSE;
+
+        if (_ret != false) {
+            // Per swap, including the scan out, and the wait for its flip
+            Report ("Swap, scanned out", Swap (_dpy, _window._surface, _swaps));
+
+            // Per lock and release, without scan out
+            Report ("Lock and release, implementation", Cycle (_direct, _dpy, _window, _swaps, false));
+            Report ("Lock and release, interposed", Cycle (_direct, _dpy, _window, _swaps, true));
+        }
+        else {
+            std::cout << "Error: unable to create a surface" << std::endl;
+        }
+
+        /* EGLBoolean */ eglMakeCurrent (_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        Destroy (_dpy, _window);
+
+        if (_context != EGL_NO_CONTEXT) {
+            /* EGLBoolean */ eglDestroyContext (_dpy, _context);
+        }
+    }
+
+    // Scaling, each thread with a context of its own and swapping its surfaces in turn, all scanned out on the single CRTC
+    for (uint32_t _n = 1; _ret != false && _n <= _threads; _n *= 2) {
+        std::vector <std::thread> _workers;
+
+        std::vector <measurement_t> _results (_n, measurement_t { 0, 0, 0 });
+
+        std::atomic <uint32_t> _ready (0);
+        std::atomic <bool> _failed (false);
+
+        duration_t _start = Clock (CLOCK_MONOTONIC);
+
+        for (uint32_t i = 0; i < _n; i++) {
+            _workers.emplace_back ([&, i] () {
+                EGLContext _context = eglCreateContext (_dpy, _config, EGL_NO_CONTEXT, &_context_attribs [0]);
+
+                std::vector <window_t> _windows (_surfaces, window_t { nullptr, EGL_NO_SURFACE });
+
+                bool _valid = _context != EGL_NO_CONTEXT;
+
+                for (auto & _window : _windows) {
+                    _valid = _valid != false && Create (_device, _dpy, _config, _window) != false;
+                }
+
+                if (_valid != true) {
+                    _failed = true;
+                }
+
+                // Start together
+                ++_ready;
+
+                while (_ready < _n) {
+                    std::this_thread::yield ();
+                }
+
+                if (_valid != false) {
+                    measurement_t & _result = _results [i];
+
+                    _result = { 0, Clock (CLOCK_MONOTONIC), Clock (CLOCK_THREAD_CPUTIME_ID) };
+
+                    for (uint64_t j = 0; j < _swaps; j++) {
+                        window_t const & _window = _windows [j % _windows.size ()];
+
+                        if (   eglMakeCurrent (_dpy, _window._surface, _window._surface, _context) == EGL_FALSE
+                            || eglSwapBuffers (_dpy, _window._surface) == EGL_FALSE
+                           ) {
+                            break;
+                        }
+
+                        ++_result._count;
+                    }
+
+                    _result._wall = Clock (CLOCK_MONOTONIC) - _result._wall;
+                    _result._cpu = Clock (CLOCK_THREAD_CPUTIME_ID) - _result._cpu;
+                }
+
+                /* EGLBoolean */ eglMakeCurrent (_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+                for (auto & _window : _windows) {
+                    Destroy (_dpy, _window);
+                }
+
+                if (_context != EGL_NO_CONTEXT) {
+                    /* EGLBoolean */ eglDestroyContext (_dpy, _context);
+                }
+            });
+        }
+
+        for (auto & _worker : _workers) {
+            _worker.join ();
+        }
+
+        measurement_t _total = { 0, Clock (CLOCK_MONOTONIC) - _start, 0 };
+
+        for (auto const & _result : _results) {
+            _total._count += _result._count;
+            _total._cpu += _result._cpu;
+        }
+
+        if (_failed != false) {
+            std::cout << "Error: unable to create the surfaces of " << _n << " threads" << std::endl;
+        }
+
+        // Wall time per swap of all threads together, its inverse is the achieved swap rate
+        Report (std::to_string (_n) + " threads, " + std::to_string (_surfaces) + " surfaces each", _total);
+    }
+
+    if (_dpy != EGL_NO_DISPLAY) {
+        /* EGLBoolean */ eglTerminate (_dpy);
+    }
+
+    if (_device != nullptr) {
+        gbm_device_destroy (_device);
+    }
+
+    // The device is left open, libyxope restores the initial mode set on it at exit
+
+    return _ret != false ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,192 @@
+/*
+Copyright (C) 2020-2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+First attempt. Possibly wrong and / or incomplete, and may contain 'bad' code and / or coding practice.
+*/
+
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <poll.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+// Data, and an optional file descriptor, over a local socket
+#include "lease.h"
+
+// Buffers handed over to a compositor, for processes that are not DRM master
+// The messages are those of drm-prime-multi, fixed size, tagged, text, with a file descriptor as ancillary data, over a seqpacket socket that keeps their boundaries
+class Client {
+    public :
+
+        // Of a message received from the compositor
+        enum class EVENT : uint8_t { NONE = 0, PRESENTED, RELEASED };
+
+        Client () = delete;
+
+        static constexpr int InvalidFd () { return -1; }
+
+        static constexpr char const * SocketPath () { return "/tmp/yxope-compositor"; }
+
+        // Environment variable to override SocketPath
+        static constexpr char const * SocketVariable () { return "YXOPE_COMPOSITOR_SOCKET"; }
+
+        // Message size, see drm-prime-multi
+        static constexpr size_t Length () { return 255; }
+
+        // A connection to the compositor, registered with the given id, or invalid
+        static int Connect (std::string const & path, uint8_t id) {
+            int ret = InvalidFd ();
+
+            struct sockaddr_un _addr;
+            memset (&_addr, 0, sizeof (_addr));
+
+            _addr.sun_family = AF_UNIX;
+
+            int _sock = path.size () < sizeof (_addr.sun_path) ? socket (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0) : InvalidFd ();
+
+            if (_sock >= 0) {
+                strncpy (_addr.sun_path, path.c_str (), sizeof (_addr.sun_path) - 1);
+
+                if (   connect (_sock, reinterpret_cast <struct sockaddr *> (&_addr), sizeof (_addr)) == 0
+                    && Send (_sock, "ID:" + std::to_string (id) + ";Register", InvalidFd ()) != false
+                   ) {
+                    ret = _sock;
+                }
+                else {
+                    /* int */ close (_sock);
+                }
+            }
+
+            return ret;
+        }
+
+        // A buffer object exported as dma-buf, identified by serial in the compositor's release
+        static bool SendBuffer (int sock, uint8_t id, uint32_t serial, uint32_t width, uint32_t height, uint32_t stride, uint32_t format, uint64_t modifier, int fd) {
+            std::string const _payload =   "ID:" + std::to_string (id)
+                                         + ";Width:" + std::to_string (width)
+                                         + ";Height:" + std::to_string (height)
+                                         + ";Stride:" + std::to_string (stride)
+                                         + ";Format:" + std::to_string (format)
+                                         + ";Modifier:" + std::to_string (modifier)
+                                         + ";Memory:0"
+                                         + ";Serial:" + std::to_string (serial);
+
+            return fd >= 0 && Send (sock, _payload, fd);
+        }
+
+        // Region of the buffer just sent that has changed, GL coordinates, with the fence signaling its completion, if any
+        static bool SendDamage (int sock, uint8_t id, int32_t x, int32_t y, int32_t width, int32_t height, int fence) {
+            std::string const _payload =   "ID:" + std::to_string (id)
+                                         + ";Damage:" + std::to_string (x)
+                                         + "," + std::to_string (y)
+                                         + "," + std::to_string (width)
+                                         + "," + std::to_string (height);
+
+            return Send (sock, _payload, fence);
+        }
+
+        // The next message within timeout milliseconds, a presented frame or a released buffer, NONE on time out or error
+        // Sequence, and timestamp in microseconds, of the vertical blank for PRESENTED, the serial of the buffer for RELEASED
+        // For RELEASED, the fence, a sync_file, to signal before the buffer is written again, or invalid, the caller owns it
+        static EVENT Receive (int sock, int timeout, uint32_t & serial, uint32_t & sequence, uint64_t & timestamp, int & fence) {
+            EVENT ret = EVENT::NONE;
+
+            fence = InvalidFd ();
+
+            struct pollfd _fds = { sock, POLLIN, 0 };
+
+            std::string _msg (Length (), '\0');
+
+            int _fd = InvalidFd ();
+
+            if (   poll (&_fds, 1, timeout) > 0
+                && Lease::Receive (sock, &_msg [0], _msg.size (), _fd) > 0
+               ) {
+                constexpr char _presented_tag [] = ";Presented:";
+                constexpr char _released_tag [] = ";Released:";
+
+                size_t const _presented_p = _msg.find (_presented_tag);
+                size_t const _released_p = _msg.find (_released_tag);
+
+                char * _end = nullptr;
+
+                if (_presented_p != std::string::npos) {
+                    char const * _str = _msg.c_str () + _presented_p + sizeof (_presented_tag) - 1;
+
+                    sequence = static_cast <uint32_t> (std::strtoul (_str, &_end, 10));
+                    timestamp = *_end == ',' ? std::strtoull (_end + 1, nullptr, 10) : 0;
+
+                    ret = EVENT::PRESENTED;
+                }
+                else if (_released_p != std::string::npos) {
+                    serial = static_cast <uint32_t> (std::strtoul (_msg.c_str () + _released_p + sizeof (_released_tag) - 1, nullptr, 10));
+
+                    fence = _fd;
+                    _fd = InvalidFd ();
+
+                    ret = EVENT::RELEASED;
+                }
+
+                if (_fd >= 0) {
+                    // None expected
+                    /* int */ close (_fd);
+                }
+            }
+
+            return ret;
+        }
+
+    private :
+
+        // Fixed size messages, the receiving end reads exactly Length () bytes
+        static bool Send (int sock, std::string const & payload, int fd) {
+            std::string _msg (Length (), '\0');
+
+            bool ret = payload.size () < _msg.size ();
+
+            if (ret != false) {
+                _msg.replace (0, payload.size (), payload);
+
+                ret = Lease::Send (sock, _msg.data (), _msg.size (), fd) == static_cast <ssize_t> (_msg.size ());
+            }
+
+            return ret;
+        }
+};
@@ -0,0 +1,184 @@
+/*
+Copyright (C) 2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+First attempt. Possibly wrong and / or incomplete, and may contain 'bad' code and / or coding practice.
+*/
+
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <cerrno>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <xf86drm.h>
+
+#include <sys/types.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+// Events of a DRM device node handled on a thread of their own instead of on the thread waiting for them
+// Waiting threads poll Fd, readable once events have been handled, and consume it with Clear before checking their state again
+class Events {
+    public :
+
+        Events () = delete;
+        Events (Events const &) = delete;
+        Events & operator = (Events const &) = delete;
+
+        // The context, and the data of its handlers, outlives the object
+        explicit Events (int fd, drmEventContext const & context) : _fd {fd}, _context (context), _wake {eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK)}, _stop {eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK)}, _running {false}, _thread () {
+            if (_fd >= 0 && _wake >= 0 && _stop >= 0) {
+                _running = true;
+
+                _thread = std::thread (&Events::Run, this);
+            }
+        }
+
+        ~Events () {
+            if (_thread.joinable () != false) {
+                uint64_t const _value = 1;
+
+                /* ssize_t */ write (_stop, &_value, sizeof (_value));
+
+                _thread.join ();
+            }
+
+            if (_wake >= 0) {
+                /* int */ close (_wake);
+            }
+
+            if (_stop >= 0) {
+                /* int */ close (_stop);
+            }
+        }
+
+        static constexpr int InvalidFd () { return -1; }
+
+        // The thread runs, otherwise the caller handles the events itself
+        bool Status () const { return _running; }
+
+        int Fd () const { return _wake; }
+
+        void Clear () const {
+            uint64_t _value = 0;
+
+            /* ssize_t */ read (_wake, &_value, sizeof (_value));
+        }
+
+        // SCHED_FIFO at the given priority, 0 keeps the default policy, and the CPUs, a bit per CPU, to run on, 0 for any
+        // Typically requires CAP_SYS_NICE, or a suitable RLIMIT_RTPRIO, for the former
+        bool Schedule (int priority, uint64_t affinity) {
+            bool ret = _thread.joinable ();
+
+            if (ret != false && priority > 0) {
+                struct sched_param _param;
+
+                _param.sched_priority = std::min (std::max (priority, sched_get_priority_min (SCHED_FIFO)), sched_get_priority_max (SCHED_FIFO));
+
+                ret = pthread_setschedparam (_thread.native_handle (), SCHED_FIFO, &_param) == 0;
+            }
+
+            if (ret != false && affinity != 0) {
+                cpu_set_t _set;
+
+                CPU_ZERO (&_set);
+
+                for (int i = 0; i < static_cast <int> (sizeof (affinity) * 8) && i < CPU_SETSIZE; i++) {
+                    if ((affinity & (static_cast <uint64_t> (1) << i)) != 0) {
+                        CPU_SET (i, &_set);
+                    }
+                }
+
+                ret = pthread_setaffinity_np (_thread.native_handle (), sizeof (_set), &_set) == 0;
+            }
+
+            return ret;
+        }
+
+    private :
+
+        void Run () {
+            struct pollfd _fds [2] = { { _fd, POLLIN, 0 }, { _stop, POLLIN, 0 } };
+
+            while (true) {
+                int _err = poll (_fds, 2, -1);
+
+                if (_err < 0) {
+                    if (errno != EINTR) {
+                        // Error; break the loop
+                        break;
+                    }
+                }
+                else if ((_fds [1].revents & POLLIN) != 0) {
+                    break;
+                }
+                else if ((_fds [0].revents & POLLIN) != 0) {
+                    // Node is readable
+                    if (drmHandleEvent (_fd, const_cast <drmEventContext *> (&_context)) != 0) {
+                        // Error; break the loop
+                        break;
+                    }
+
+                    uint64_t const _value = 1;
+
+                    /* ssize_t */ write (_wake, &_value, sizeof (_value));
+                }
+                else if ((_fds [0].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+                    break;
+                }
+            }
+
+            // Waiting threads should not depend on a gone thread, they handle the events themselves again
+            _running = false;
+
+            uint64_t const _value = 1;
+
+            /* ssize_t */ write (_wake, &_value, sizeof (_value));
+        }
+
+        int const _fd;
+
+        drmEventContext const _context;
+
+        int const _wake;
+        int const _stop;
+
+        std::atomic <bool> _running;
+
+        std::thread _thread;
+};
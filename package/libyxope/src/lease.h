@@ -0,0 +1,179 @@
+/*
+Copyright (C) 2020-2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+First attempt. Possibly wrong and / or incomplete, and may contain 'bad' code and / or coding practice.
+*/
+
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+// DRM leases of a broker, see leasebroker.cpp, for processes that are not DRM master
+// One lease per connection over a local seqpacket socket, each receive is one complete message, revoked by the broker once the connection closes
+class Lease {
+    public :
+
+        // Connector 0 for any connected connector
+        struct request {
+            uint32_t _connector;
+        };
+
+        // Status 0, or -errno, the lease file descriptor is passed as ancillary data
+        struct reply {
+            int32_t _status;
+            uint32_t _lessee;
+            uint32_t _connector;
+            uint32_t _crtc;
+            uint32_t _plane;
+        };
+
+        using request_t = struct request;
+        using reply_t = struct reply;
+
+        Lease () = delete;
+
+        static constexpr int InvalidFd () { return -1; }
+
+        static constexpr char const * SocketPath () { return "/tmp/yxope-lease"; }
+
+        // Environment variable to override SocketPath
+        static constexpr char const * SocketVariable () { return "YXOPE_LEASE_SOCKET"; }
+
+        // Data, and an optional file descriptor, a gone peer does not raise SIGPIPE
+        static ssize_t Send (int sock, void const * buf, size_t bufsize, int fd) {
+            struct iovec _iov = { const_cast <void *> (buf), bufsize };
+
+            char _control [CMSG_SPACE (sizeof (int))];
+            memset (_control, 0, sizeof (_control));
+
+            struct msghdr _msg;
+            memset (&_msg, 0, sizeof (_msg));
+
+            _msg.msg_iov = &_iov;
+            _msg.msg_iovlen = 1;
+
+            if (fd >= 0) {
+                _msg.msg_control = _control;
+                _msg.msg_controllen = sizeof (_control);
+
+                struct cmsghdr * _cmsg = CMSG_FIRSTHDR (&_msg);
+
+                _cmsg->cmsg_level = SOL_SOCKET;
+                _cmsg->cmsg_type = SCM_RIGHTS;
+                _cmsg->cmsg_len = CMSG_LEN (sizeof (int));
+
+                memcpy (CMSG_DATA (_cmsg), &fd, sizeof (int));
+            }
+
+            return sendmsg (sock, &_msg, MSG_NOSIGNAL);
+        }
+
+        // Data, and a file descriptor if one has been sent, invalid otherwise, zero if the peer has closed the socket
+        static ssize_t Receive (int sock, void * buf, size_t bufsize, int & fd) {
+            struct iovec _iov = { buf, bufsize };
+
+            char _control [CMSG_SPACE (sizeof (int))];
+            memset (_control, 0, sizeof (_control));
+
+            struct msghdr _msg;
+            memset (&_msg, 0, sizeof (_msg));
+
+            _msg.msg_iov = &_iov;
+            _msg.msg_iovlen = 1;
+            _msg.msg_control = _control;
+            _msg.msg_controllen = sizeof (_control);
+
+            fd = InvalidFd ();
+
+            ssize_t ret = recvmsg (sock, &_msg, MSG_CMSG_CLOEXEC);
+
+            if (ret > 0) {
+                struct cmsghdr * _cmsg = CMSG_FIRSTHDR (&_msg);
+
+                if (_cmsg != nullptr && _cmsg->cmsg_level == SOL_SOCKET && _cmsg->cmsg_type == SCM_RIGHTS && _cmsg->cmsg_len == CMSG_LEN (sizeof (int))) {
+                    memcpy (&fd, CMSG_DATA (_cmsg), sizeof (int));
+                }
+            }
+
+            return ret;
+        }
+
+        // The lease file descriptor, or invalid, sock is kept open for as long as the lease is in use
+        static int Acquire (std::string const & path, uint32_t connector, int & sock, reply_t & reply) {
+            int ret = InvalidFd ();
+
+            reply = { -ENOTCONN, 0, 0, 0, 0 };
+
+            struct sockaddr_un _addr;
+            memset (&_addr, 0, sizeof (_addr));
+
+            _addr.sun_family = AF_UNIX;
+
+            sock = path.size () < sizeof (_addr.sun_path) ? socket (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0) : InvalidFd ();
+
+            if (sock >= 0) {
+                strncpy (_addr.sun_path, path.c_str (), sizeof (_addr.sun_path) - 1);
+
+                request_t const _request = { connector };
+
+                int _fd = InvalidFd ();
+
+                if (   connect (sock, reinterpret_cast <struct sockaddr *> (&_addr), sizeof (_addr)) == 0
+                    && Send (sock, &_request, sizeof (_request), InvalidFd ()) == static_cast <ssize_t> (sizeof (_request))
+                    && Receive (sock, &reply, sizeof (reply), _fd) == static_cast <ssize_t> (sizeof (reply))
+                    && reply._status == 0
+                   ) {
+                    ret = _fd;
+                }
+                else {
+                    if (_fd >= 0) {
+                        /* int */ close (_fd);
+                    }
+
+                    /* int */ close (sock);
+
+                    sock = InvalidFd ();
+                }
+            }
+
+            return ret;
+        }
+};
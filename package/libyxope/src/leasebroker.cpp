@@ -0,0 +1,390 @@
+/*
+Copyright (C) 2020-2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+First attempt. Possibly wrong and / or incomplete, and may contain 'bad' code and / or coding practice.
+*/
+
+// DRM lease broker, holds DRM master and hands out a lease of a connector, its CRTC and the CRTC's primary plane to each client
+// Usage: yxope-lease-broker [-d <device>] [-s <socket>]
+
+#include <string>
+#include <map>
+#include <vector>
+#include <iostream>
+#include <cstdlib>
+#include <csignal>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <getopt.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "lease.h"
+
+namespace {
+
+// Objects of a lease, and its lessee
+struct granted {
+    uint32_t _lessee;
+    uint32_t _connector;
+    uint32_t _crtc;
+    uint32_t _plane;
+};
+
+using granted_t = struct granted;
+
+// Per client connection, a lessee of 0 if nothing has been granted
+using leases_t = std::map <int, granted_t>;
+
+volatile sig_atomic_t _running = 1;
+
+bool Property (int fd, uint32_t object, uint32_t type, char const name [], uint64_t & value) {
+    bool ret = false;
+
+    drmModeObjectPropertiesPtr _props = drmModeObjectGetProperties (fd, object, type);
+
+    if (_props != nullptr) {
+        for (uint32_t i = 0; i < _props->count_props && ret != true; i++) {
+            drmModePropertyPtr _prop = drmModeGetProperty (fd, _props->props [i]);
+
+            if (_prop != nullptr) {
+                if (strcmp (_prop->name, name) == 0) {
+                    value = _props->prop_values [i];
+                    ret = true;
+                }
+
+                drmModeFreeProperty (_prop);
+            }
+        }
+
+        drmModeFreeObjectProperties (_props);
+    }
+
+    return ret;
+}
+
+bool Leased (leases_t const & leases, uint32_t object) {
+    bool ret = false;
+
+    for (auto it = leases.begin (), end = leases.end (); it != end && ret != true; it++) {
+        granted_t const & _granted = it->second;
+
+        ret = _granted._lessee != 0 && (_granted._connector == object || _granted._crtc == object || _granted._plane == object);
+    }
+
+    return ret;
+}
+
+// The primary plane that can be used with the CRTC at index pipe
+uint32_t PrimaryPlane (int fd, uint32_t pipe, leases_t const & leases) {
+    uint32_t ret = 0;
+
+    drmModePlaneResPtr _res = drmModeGetPlaneResources (fd);
+
+    if (_res != nullptr) {
+        for (uint32_t i = 0; i < _res->count_planes && ret == 0; i++) {
+            drmModePlanePtr _plane = drmModeGetPlane (fd, _res->planes [i]);
+
+            if (_plane != nullptr) {
+                uint64_t _type = 0;
+
+                if (   (_plane->possible_crtcs & (1u << pipe)) != 0
+                    && Leased (leases, _plane->plane_id) != true
+                    && Property (fd, _plane->plane_id, DRM_MODE_OBJECT_PLANE, "type", _type) != false
+                    && _type == DRM_PLANE_TYPE_PRIMARY
+                   ) {
+                    ret = _plane->plane_id;
+                }
+
+                drmModeFreePlane (_plane);
+            }
+        }
+
+        drmModeFreePlaneResources (_res);
+    }
+
+    return ret;
+}
+
+// A connected, not yet leased, connector, the requested one if not 0, a CRTC to drive it and a primary plane
+int Grant (int fd, uint32_t connector, leases_t const & leases, granted_t & granted) {
+    int ret = -ENOENT;
+
+    drmModeResPtr _res = drmModeGetResources (fd);
+
+    if (_res != nullptr) {
+        for (int i = 0; i < _res->count_connectors && ret != 0; i++) {
+            uint32_t const _id = _res->connectors [i];
+
+            if ((connector != 0 && connector != _id) || Leased (leases, _id) != false) {
+                continue;
+            }
+
+            // Do not probe
+            drmModeConnectorPtr _con = drmModeGetConnectorCurrent (fd, _id);
+
+            if (_con != nullptr) {
+                if (_con->connection == DRM_MODE_CONNECTED) {
+                    // Possible CRTCs of all encoders, the current one preferred
+                    uint32_t _current = 0, _possible = 0;
+
+                    for (int j = 0; j < _con->count_encoders; j++) {
+                        drmModeEncoderPtr _enc = drmModeGetEncoder (fd, _con->encoders [j]);
+
+                        if (_enc != nullptr) {
+                            if (_enc->encoder_id == _con->encoder_id) {
+                                _current = _enc->crtc_id;
+                            }
+
+                            _possible |= _enc->possible_crtcs;
+
+                            drmModeFreeEncoder (_enc);
+                        }
+                    }
+
+                    // The current CRTC first, then any other possible one, eg, if the current one is already leased
+                    for (uint8_t _pass = 0; _pass < 2 && ret != 0; _pass++) {
+                        for (int k = 0; k < _res->count_crtcs && ret != 0; k++) {
+                            uint32_t const _crtc = _res->crtcs [k];
+
+                            bool const _candidate = _pass == 0 ? _current != 0 && _crtc == _current : _crtc != _current && (_possible & (1u << k)) != 0;
+
+                            if (_candidate != false && Leased (leases, _crtc) != true) {
+                                uint32_t const _plane = PrimaryPlane (fd, static_cast <uint32_t> (k), leases);
+
+                                if (_plane != 0) {
+                                    granted = { 0, _id, _crtc, _plane };
+                                    ret = 0;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                drmModeFreeConnector (_con);
+            }
+        }
+
+        drmModeFreeResources (_res);
+    }
+
+    if (ret == 0) {
+        uint32_t const _objects [] = { granted._connector, granted._crtc, granted._plane };
+
+        ret = drmModeCreateLease (fd, _objects, sizeof (_objects) / sizeof (_objects [0]), O_CLOEXEC, &granted._lessee);
+    }
+
+    // The lease file descriptor, or -errno
+    return ret;
+}
+
+void Revoke (int fd, leases_t & leases, int client) {
+    auto _it = leases.find (client);
+
+    if (_it != leases.end ()) {
+        if (_it->second._lessee != 0 && drmModeRevokeLease (fd, _it->second._lessee) != 0) {
+            std::cout << "Error: unable to revoke lease " << _it->second._lessee << std::endl;
+        }
+
+        /* iterator */ leases.erase (_it);
+    }
+
+    /* int */ close (client);
+}
+
+}
+
+int main (int argc, char* argv [])
+{
+    std::string _device = "/dev/dri/card0";
+
+    char const * _env = getenv (Lease::SocketVariable ());
+
+    std::string _path = _env != nullptr ? _env : Lease::SocketPath ();
+
+    int _opt = 0;
+
+    while ((_opt = getopt (argc, argv, "d:s:h")) != -1) {
+        switch (_opt) {
+            case 'd'    :   _device = optarg; break;
+            case 's'    :   _path = optarg; break;
+            case 'h'    :
+            default     :   std::cout << "Usage: " << argv [0] << " [-d <device>] [-s <socket>]" << std::endl;
+                            return _opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    auto stop = +[] (int) { _running = 0; };
+
+    /* sighandler_t */ signal (SIGINT, stop);
+    /* sighandler_t */ signal (SIGTERM, stop);
+
+    int _fd = open (_device.c_str (), O_RDWR | O_CLOEXEC);
+
+    // Primary planes are only listed for clients aware of universal planes
+    bool _ret = _fd >= 0 && drmIsMaster (_fd) != 0 && drmSetClientCap (_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) == 0;
+
+    if (_ret != true) {
+        std::cout << "Error: " << _device << " unavailable or not DRM master" << std::endl;
+    }
+
+    int _listen = Lease::InvalidFd ();
+
+    if (_ret != false) {
+        struct sockaddr_un _addr;
+        memset (&_addr, 0, sizeof (_addr));
+
+        _addr.sun_family = AF_UNIX;
+
+        _ret = _path.size () < sizeof (_addr.sun_path);
+
+        if (_ret != false) {
+            strncpy (_addr.sun_path, _path.c_str (), sizeof (_addr.sun_path) - 1);
+
+            // A stale socket of a previous run
+            /* int */ unlink (_path.c_str ());
+
+            _listen = socket (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+            _ret =    _listen >= 0
+                   && bind (_listen, reinterpret_cast <struct sockaddr *> (&_addr), sizeof (_addr)) == 0
+                   && listen (_listen, SOMAXCONN) == 0;
+        }
+
+        if (_ret != true) {
+            std::cout << "Error: unable to listen on " << _path << std::endl;
+        }
+    }
+
+    leases_t _leases;
+
+    while (_ret != false && _running != 0) {
+        std::vector <struct pollfd> _fds { { _listen, POLLIN, 0 } };
+
+        for (auto & _lease : _leases) {
+            _fds.push_back ({ _lease.first, POLLIN, 0 });
+        }
+
+        int _err = poll (_fds.data (), _fds.size (), -1);
+
+        if (_err < 0) {
+            // Interrupted, eg, by a signal to stop
+            _ret = errno == EINTR;
+            continue;
+        }
+
+        if ((_fds [0].revents & POLLIN) != 0) {
+            // A client that stalls, or does not read its reply, never blocks the others
+            int _client = accept4 (_listen, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+
+            if (_client >= 0) {
+                _leases [_client] = { 0, 0, 0, 0 };
+            }
+        }
+
+        for (size_t i = 1; i < _fds.size (); i++) {
+            if ((_fds [i].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                continue;
+            }
+
+            int const _client = _fds [i].fd;
+
+            Lease::request_t _request;
+
+            int _unused = Lease::InvalidFd ();
+
+            ssize_t _size = Lease::Receive (_client, &_request, sizeof (_request), _unused);
+
+            if (_unused >= 0) {
+                /* int */ close (_unused);
+            }
+
+            if (_size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Nothing yet, eg, a spurious wake up
+                continue;
+            }
+
+            if (_size != static_cast <ssize_t> (sizeof (_request))) {
+                // Closed, gone, or incomplete, the lease, if any, is no longer in use
+                Revoke (_fd, _leases, _client);
+                continue;
+            }
+
+            granted_t & _granted = _leases [_client];
+
+            Lease::reply_t _reply = { -EBUSY, 0, 0, 0, 0 };
+
+            int _lease = Lease::InvalidFd ();
+
+            if (_granted._lessee == 0) {
+                granted_t _candidate = { 0, 0, 0, 0 };
+
+                _lease = Grant (_fd, _request._connector, _leases, _candidate);
+
+                if (_lease >= 0) {
+                    _granted = _candidate;
+                    _reply = { 0, _granted._lessee, _granted._connector, _granted._crtc, _granted._plane };
+                }
+                else {
+                    _reply._status = _lease;
+                }
+            }
+
+            if (Lease::Send (_client, &_reply, sizeof (_reply), _lease) != static_cast <ssize_t> (sizeof (_reply))) {
+                Revoke (_fd, _leases, _client);
+            }
+
+            if (_lease >= 0) {
+                // The client holds its own
+                /* int */ close (_lease);
+            }
+        }
+    }
+
+    for (auto _it = _leases.begin (); _it != _leases.end (); _it = _leases.begin ()) {
+        Revoke (_fd, _leases, _it->first);
+    }
+
+    if (_listen >= 0) {
+        /* int */ close (_listen);
+        /* int */ unlink (_path.c_str ());
+    }
+
+    if (_fd >= 0) {
+        /* int */ close (_fd);
+    }
+
+    return _ret != false ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,130 @@
+/*
+Copyright (C) 2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+First attempt. Possibly wrong and / or incomplete, and may contain 'bad' code and / or coding practice.
+*/
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+
+// The objects of the mock backend, see stubgbm.cpp, stubegl.cpp and stubdrm.cpp, built with _MOCK only
+// The leading members follow gbmint.h as far as libyxope probes them, see Platform::isGBMdevice and Platform::isGBMsurface
+
+struct gbm_device {
+    // As gbmint.h
+    struct gbm_device * (*dummy) (int);
+
+    int fd;
+};
+
+struct gbm_bo {
+    struct gbm_device * gbm;
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t format;
+    uint64_t modifier;
+
+    // Unique per device, as a GEM handle
+    uint32_t handle;
+
+    void * user_data;
+    void (*destroy_user_data) (struct gbm_bo *, void *);
+};
+
+struct gbm_surface {
+    // As gbmint.h
+    struct gbm_device * gbm;
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t flags;
+
+    // Rendered to by eglSwapBuffers, locked by gbm_surface_lock_front_buffer and freed by gbm_surface_release_buffer
+    enum class STATE : uint8_t { FREE, FRONT, LOCKED };
+
+    std::vector <std::pair <struct gbm_bo *, STATE>> bos;
+
+    std::mutex mutex;
+};
+
+class Mock {
+    public :
+
+        Mock () = delete;
+
+        // Environment variables, and their defaults, to configure the backend
+        static constexpr char const * RefreshVariable () { return "YXOPE_MOCK_REFRESH"; }
+        static constexpr uint32_t DefaultRefresh () { return 60; }
+
+        static constexpr char const * BufferCountVariable () { return "YXOPE_MOCK_BUFFERS"; }
+        static constexpr uint32_t DefaultBufferCount () { return 3; }
+
+        // The single mode of the single connector
+        static constexpr uint32_t Width () { return 1920; }
+        static constexpr uint32_t Height () { return 1080; }
+
+        static uint32_t Value (char const * variable, uint32_t fallback) {
+            char const * _env = getenv (variable);
+
+            unsigned long const _value = _env != nullptr ? strtoul (_env, nullptr, 10) : 0;
+
+            return _value > 0 && _value <= UINT32_MAX ? static_cast <uint32_t> (_value) : fallback;
+        }
+
+        // 'Renders' instantly, a free buffer becomes the front buffer, an unlocked previous front buffer is overwritten
+        // False if all buffers are locked, as with an implementation that has run out of buffers
+        static bool Render (struct gbm_surface * surface) {
+            bool ret = false;
+
+            if (surface != nullptr) {
+                std::lock_guard < decltype (surface->mutex) > _lock (surface->mutex);
+
+                for (auto & _bo : surface->bos) {
+                    if (_bo.second == gbm_surface::STATE::FRONT) {
+                        _bo.second = gbm_surface::STATE::FREE;
+                    }
+                }
+
+                for (auto & _bo : surface->bos) {
+                    if (_bo.second == gbm_surface::STATE::FREE) {
+                        _bo.second = gbm_surface::STATE::FRONT;
+
+                        ret = true;
+
+                        break;
+                    }
+                }
+            }
+
+            return ret;
+        }
+};
@@ -48,11 +48,32 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <limits>
 #include <vector>
 #include <array>
+#include <map>
 #include <cstring>
 #include <atomic>
+#include <algorithm>
+#include <memory>
+
+#ifdef _EVENT_THREAD
+#ifndef _EVENT_THREAD_PRIORITY
+#define _EVENT_THREAD_PRIORITY 0
+#endif
+#ifndef _EVENT_THREAD_AFFINITY
+#define _EVENT_THREAD_AFFINITY 0
+#endif
+#endif
 
 // Our implementation
 #include "queue.h"
+#ifdef _LEASE
+#include "lease.h"
+#endif
+#ifdef _CLIENT
+#include "client.h"
+#endif
+#ifdef _EVENT_THREAD
+#include "events.h"
+#endif
 
 #include <tuple>
 
@@ -68,6 +89,8 @@ extern "C" {
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 
+#include "yxope.h"
+
 #ifndef EGL_PLATFORM_GBM_KHR
 #define EGL_PLATFORM_GBM_KHR 0x31D7
 #endif
@@ -90,6 +113,15 @@ typedef intptr_t EGLAttrib;
 #include <sys/select.h>
 #undef _POSIX_SOURCE
 
+#include <poll.h>
+#include <time.h>
+#include <sys/timerfd.h>
+
+#ifdef _CLIENT
+#include <sys/ioctl.h>
+#include <linux/dma-buf.h>
+#endif
+
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE
 #endif
@@ -116,6 +148,18 @@ extern "C" {
 PROXYEGL_PUBLIC __eglMustCastToProperFunctionPointerType eglGetProcAddress (const char*);
 PROXYEGL_PUBLIC EGLDisplay eglGetPlatformDisplayEXT (EGLenum, void*, const EGLAttrib*);
 PROXYEGL_PUBLIC EGLSurface eglCreatePlatformWindowSurfaceEXT (EGLDisplay, EGLConfig, void*, const EGLAttrib*);
+PROXYEGL_PUBLIC EGLBoolean eglSwapBuffersWithDamageKHR (EGLDisplay, EGLSurface, const EGLint*, EGLint);
+PROXYEGL_PUBLIC EGLBoolean eglSwapBuffersWithDamageEXT (EGLDisplay, EGLSurface, const EGLint*, EGLint);
+PROXYEGL_PUBLIC EGLBoolean eglGetNextFrameIdANDROID (EGLDisplay, EGLSurface, EGLuint64KHR*);
+PROXYEGL_PUBLIC EGLBoolean eglGetFrameTimestampsANDROID (EGLDisplay, EGLSurface, EGLuint64KHR, EGLint, const EGLint*, EGLnsecsANDROID*);
+PROXYEGL_PUBLIC EGLBoolean eglGetFrameTimestampSupportedANDROID (EGLDisplay, EGLSurface, EGLint);
+PROXYEGL_PUBLIC EGLBoolean eglGetCompositorTimingANDROID (EGLDisplay, EGLSurface, EGLint, const EGLint*, EGLnsecsANDROID*);
+PROXYEGL_PUBLIC EGLBoolean eglGetCompositorTimingSupportedANDROID (EGLDisplay, EGLSurface, EGLint);
+PROXYEGL_PUBLIC EGLBoolean eglPresentationTimeANDROID (EGLDisplay, EGLSurface, EGLnsecsANDROID);
+
+// libyxope support, see yxope.h
+PROXYEGL_PUBLIC EGLBoolean yxopeGetFrameTiming (EGLDisplay, EGLSurface, EGLuint64KHR, struct yxope_frame_timing*);
+PROXYEGL_PUBLIC EGLBoolean yxopeGetLatestFrameTiming (EGLDisplay, EGLSurface, struct yxope_frame_timing*);
 
 // EGL 1.4 support
 PROXYEGL_PUBLIC EGLDisplay eglGetDisplay (EGLNativeDisplayType);
@@ -127,14 +171,18 @@ PROXYEGL_PUBLIC EGLSurface eglCreateWindowSurface (EGLDisplay, EGLConfig, EGLNat
 PROXYEGL_PUBLIC EGLBoolean eglDestroySurface (EGLDisplay, EGLSurface);
 
 PROXYEGL_PUBLIC EGLBoolean eglSwapBuffers (EGLDisplay, EGLSurface);
+PROXYEGL_PUBLIC EGLBoolean eglSwapInterval (EGLDisplay, EGLint);
+
+PROXYEGL_PUBLIC const char* eglQueryString (EGLDisplay, EGLint);
+PROXYEGL_PUBLIC EGLBoolean eglSurfaceAttrib (EGLDisplay, EGLSurface, EGLint, EGLint);
+
+PROXYEGL_PUBLIC EGLBoolean eglMakeCurrent (EGLDisplay, EGLSurface, EGLSurface, EGLContext);
 
 #ifdef _MESADEBUG
 PROXYEGL_PUBLIC EGLContext eglCreateContext (EGLDisplay, EGLConfig, EGLContext, const EGLint*);
 PROXYEGL_PUBLIC EGLBoolean eglDestroyContext (EGLDisplay, EGLContext);
 
 PROXYEGL_PUBLIC EGLSurface eglCreatePbufferSurface (EGLDisplay, EGLConfig, const EGLint*);
-
-PROXYEGL_PUBLIC EGLBoolean eglMakeCurrent (EGLDisplay, EGLSurface, EGLSurface, EGLContext);
 #endif
 
 // EGL 1.5 support
@@ -210,7 +258,34 @@ class Platform : public Singleton <Platform> {
 
         _PROXYEGL_PRIVATE bool Remove (EGLDisplay const & display, EGLSurface const & surface);
 
-        _PROXYEGL_PRIVATE bool ScanOut (EGLSurface const & surface) const;
+        // Optional damage, rectangles of x, y, width and height, origin bottom left, none for the entire surface
+        _PROXYEGL_PRIVATE bool ScanOut (EGLSurface const & surface, EGLint const * rects = nullptr, EGLint count = 0) const;
+
+        // Vertical blanks per scan out of the surface, 0 flips as soon as possible, possibly tearing
+        _PROXYEGL_PRIVATE bool SwapInterval (EGLDisplay const & display, EGLSurface const & surface, EGLint interval);
+
+        // EGL_BACK_BUFFER or EGL_SINGLE_BUFFER, as successfully set with eglSurfaceAttrib
+        _PROXYEGL_PRIVATE bool RenderBuffer (EGLDisplay const & display, EGLSurface const & surface, EGLint value);
+
+        // The draw surface bound to the calling thread by a successful eglMakeCurrent
+        _PROXYEGL_PRIVATE bool MakeCurrent (EGLDisplay const & display, EGLSurface const & draw) const;
+
+        _PROXYEGL_PRIVATE bool Tracked (EGLDisplay const & display, EGLSurface const & surface) const;
+
+        // Of the scan outs of a surface, see yxope.h
+        using timing_t = struct yxope_frame_timing;
+
+        // The identifier the next swap of the surface will have
+        _PROXYEGL_PRIVATE bool NextFrameId (EGLDisplay const & display, EGLSurface const & surface, uint64_t & id) const;
+        // Only available for the most recent frames
+        _PROXYEGL_PRIVATE bool FrameTiming (EGLDisplay const & display, EGLSurface const & surface, uint64_t id, timing_t & timing) const;
+        // The next vertical blank, the frame period, and the delay from submission to presentation, in nanoseconds
+        _PROXYEGL_PRIVATE bool CompositorTiming (EGLDisplay const & display, EGLSurface const & surface, uint64_t & deadline, uint64_t & interval, uint64_t & latency) const;
+        // The next swap of the surface is presented at the vertical blank nearest to the given time
+        _PROXYEGL_PRIVATE bool PresentationTime (EGLDisplay const & display, EGLSurface const & surface, uint64_t time);
+
+        // The extensions of the implementation, amended with the emulated ones, for displays of this platform
+        _PROXYEGL_PRIVATE char const * Extensions (EGLDisplay const & display, char const * extensions) const;
 
         // Expected runtime dependencies and their names
         // Also see helpers
@@ -464,12 +539,44 @@ class Platform : public Singleton <Platform> {
 
     private :
 
-        using drm_callback_data_t = struct { int fd; uint32_t fb; gbm_bo_t bo; bool waiting; };
+        // Timestamp, CLOCK_MONOTONIC in nanoseconds, of the completed flip
+        // Sequence, the vertical blank counter of the CRTC at the completed flip
+        // The token identifies the flip, it is the user data of its event, never 0
+        using drm_callback_data_t = struct { int fd; uint32_t fb; gbm_bo_t bo; bool waiting; uint64_t timestamp; uint32_t sequence; uint32_t token; };
+
+        // A plane, and the ids of the properties to place, and scale, a framebuffer on it
+        using plane_t = struct { uint32_t id; uint32_t fb_id; uint32_t crtc_id; uint32_t src_x; uint32_t src_y; uint32_t src_w; uint32_t src_h; uint32_t crtc_x; uint32_t crtc_y; uint32_t crtc_w; uint32_t crtc_h; };
+
+        // As given to eglSwapBuffersWithDamage, four values per rectangle
+        using damage_t = std::vector <EGLint>;
 
         _PROXYEGL_PRIVATE static sync_t _syncobject;
 
+#ifdef _ADAPTIVE_SYNC
+        // Scan outs are presented as they arrive rather than at a fixed vertical blank, guarded by _syncobject
+        _PROXYEGL_PRIVATE static bool _variable_refresh;
+#endif
+
         DeviceSet <EGLDisplay, EGLNativeDisplayType, EGLSurface, EGLNativeWindowType, gbm_bo_t> _set;
 
+        // The most recent frames of a surface, the identifier of the next one, and its presentation time, if any
+        using history_t = struct { uint64_t next; uint64_t presentation; std::map <uint64_t, timing_t> frames; };
+
+        // Of a surface, set up at its creation, everything a swap requires without (EGL) queries or registry lookups
+        // Its display, no display once the surface has been removed, the underlying native surface, the buffers queued for its render buffer, the interval set by eglSwapInterval, and the history updated by scan outs
+        using context_t = struct { EGLDisplay display; gbm_surface_t native; uint8_t buffers; EGLint interval; history_t history; };
+
+        // Shared, a destroyed surface may still be current on some thread
+        mutable std::map <EGLSurface, std::shared_ptr <context_t>> _contexts;
+
+        // The draw surface of the calling thread, and its context, if it is a surface of this platform
+        using current_t = struct { EGLSurface surface; std::shared_ptr <context_t> context; };
+
+        _PROXYEGL_PRIVATE static thread_local current_t _current;
+
+        // Persistent, as returned by eglQueryString
+        mutable std::map <EGLDisplay, std::string> _extensions;
+
         using queue_t = std::tuple <int, uint32_t, gbm_surface_t, gbm_bo_t>;
 
 #ifdef _FIXEDSIZEDQUEUE
@@ -580,14 +687,115 @@ class Platform : public Singleton <Platform> {
             return 1;
         }
 
+        // Queued for a render buffer, EGL_BACK_BUFFER requires one more than EGL_SINGLE_BUFFER
+        _PROXYEGL_PRIVATE static constexpr uint8_t RenderBufferCount (EGLint value) {
+            return value != EGL_BACK_BUFFER ? MinimumBufferCount () : MinimumBufferCount () + 1;
+        }
+
 // TODO; class Surface, also see comment on 'friends'
-        _PROXYEGL_PRIVATE bool ScanOut (gbm_surface_t const & surface, uint8_t buffers = MinimumBufferCount ()) const;
+        _PROXYEGL_PRIVATE bool ScanOut (gbm_surface_t const & surface, uint8_t buffers = MinimumBufferCount (), EGLint interval = DefaultSwapInterval (), damage_t const & damage = damage_t (), timing_t * timing = nullptr) const;
+
+        // Number of frames of a surface whose timing is kept
+        _PROXYEGL_PRIVATE static constexpr size_t FrameTimingCount () {
+            return 8;
+        }
+
+        // Presentation times further ahead are ignored, in nanoseconds
+        _PROXYEGL_PRIVATE static constexpr uint64_t PresentationDelayMax () {
+            return 1000000000;
+        }
+
+        // As specified by EGL for a newly created surface
+        _PROXYEGL_PRIVATE static constexpr EGLint DefaultSwapInterval () {
+            return 1;
+        }
+
+        // Larger intervals are clamped
+        _PROXYEGL_PRIVATE static constexpr EGLint MaximumSwapInterval () {
+            return 4;
+        }
 
-        // Seconds
-        _PROXYEGL_PRIVATE static constexpr time_t FrameDuration () {
+        // Nanoseconds, derived from the current mode of the CRTC, 60 Hz if unknown
+        _PROXYEGL_PRIVATE static uint64_t FrameDuration (int fd, uint32_t crtc);
+
+        // Frame periods past the half frame of slack after the expected flip before its event is considered lost, 1.5 periods in total
+        _PROXYEGL_PRIVATE static constexpr uint8_t FrameLateMax () {
             return 1;
         }
 
+        // CLOCK_MONOTONIC, in nanoseconds
+        _PROXYEGL_PRIVATE static uint64_t Now ();
+
+#ifdef _LEASE
+        // A lease of the broker to scan out on, with the connector and CRTC it grants, or an invalid file descriptor
+        _PROXYEGL_PRIVATE static int Lessee (uint32_t & crtc, uint32_t & connector);
+#endif
+
+#ifdef _CLIENT
+        // A connection to the compositor, registered, or an invalid file descriptor
+        _PROXYEGL_PRIVATE static int Compositor ();
+
+        // Milliseconds to wait for the compositor to present a forwarded frame, it may serve other clients first
+        _PROXYEGL_PRIVATE static constexpr int ForwardTimeout () {
+            return 1000;
+        }
+
+        // Hand over the buffer object as dma-buf, buffer objects given back by the compositor are released, except one of the surface, which is returned
+        _PROXYEGL_PRIVATE gbm_bo_t Forward (int sock, gbm_surface_t const & surface, gbm_bo_t bo, damage_t const & damage, timing_t * timing) const;
+#endif
+
+#ifdef _EVENT_THREAD
+        // SCHED_FIFO priority of the DRM event thread, 0 keeps the default policy
+        _PROXYEGL_PRIVATE static constexpr int EventThreadPriority () {
+            return _EVENT_THREAD_PRIORITY;
+        }
+
+        // A bit per CPU the DRM event thread may run on, 0 for any
+        _PROXYEGL_PRIVATE static constexpr uint64_t EventThreadAffinity () {
+            return _EVENT_THREAD_AFFINITY;
+        }
+#endif
+
+        // The driver reports the capability, eg, DRM_CAP_ASYNC_PAGE_FLIP
+        _PROXYEGL_PRIVATE static bool Capable (int fd, uint64_t capability);
+
+        // Index of the CRTC, as used by the legacy vertical blank interface
+        _PROXYEGL_PRIVATE static uint32_t Pipe (int fd, uint32_t crtc);
+
+        // Look up a property, by name, of a mode object
+        _PROXYEGL_PRIVATE static bool Property (int fd, uint32_t object, uint32_t type, char const name [], uint32_t & id, uint64_t & value);
+
+        // The primary plane currently bound to the CRTC, and its properties, if it accepts damage clips
+        _PROXYEGL_PRIVATE static bool DamagePlane (int fd, uint32_t crtc, uint32_t & plane, uint32_t & fb_id, uint32_t & clips);
+
+        // Atomic flip of the primary plane with the clips attached, 0, -errno, or -ENOTSUP if the driver lacks support
+        _PROXYEGL_PRIVATE static int DamageFlip (int fd, uint32_t crtc, uint32_t fb, std::vector <struct drm_mode_rect> const & clips, void* data);
+
+        // The mode currently set on the CRTC, if any
+        _PROXYEGL_PRIVATE static bool CurrentMode (int fd, uint32_t crtc, drmModeModeInfo & mode);
+
+#ifdef _MODE_MATCH
+        // A mode of the connector of exactly the given size, and refresh rate
+        _PROXYEGL_PRIVATE static bool MatchingMode (int fd, uint32_t connector, uint32_t width, uint32_t height, uint32_t vrefresh, drmModeModeInfo & mode);
+#endif
+
+        // A plane of the given type usable with the CRTC, the primary plane bound to it, or an overlay plane that is not bound to another CRTC
+        _PROXYEGL_PRIVATE static bool ScalingPlane (int fd, uint32_t crtc, uint64_t type, plane_t & plane);
+
+        // Atomic flip with the framebuffer scaled by the display engine to fit the mode, aspect ratio preserved, centered
+        // On the primary plane, or else an overlay plane with the primary plane off, 0, -errno, or -ENOTSUP if the driver lacks support
+        _PROXYEGL_PRIVATE static int ScaledFlip (int fd, uint32_t crtc, uint32_t fb, uint32_t width, uint32_t height, drmModeModeInfo const & mode, void* data);
+
+#ifdef _ADAPTIVE_SYNC
+        // Variable refresh rate, only if the connector reports a capable sink, a flip is then presented as soon as it arrives
+        _PROXYEGL_PRIVATE static bool AdaptiveSync (int fd, uint32_t crtc, uint32_t connector, bool enable);
+#endif
+
+        // Number of flips between reports of the achieved intervals
+        _PROXYEGL_PRIVATE static constexpr uint16_t PacingReportCount () {
+            return 300;
+        }
+
         // Helpers, make the GBM API well-defined within this unit
         // All these are ill-defined for EGL_DEFAULT_DISPLAY
 // TODO: validate signature
@@ -617,6 +825,12 @@ class Platform : public Singleton <Platform> {
 
 /*_PROXYEGL_PRIVATE*/ Platform::sync_t Platform::_syncobject;
 
+#ifdef _ADAPTIVE_SYNC
+/*_PROXYEGL_PRIVATE*/ bool Platform::_variable_refresh = false;
+#endif
+
+/*_PROXYEGL_PRIVATE*/ thread_local Platform::current_t Platform::_current = { EGL_NO_SURFACE, nullptr };
+
 template <typename Func>
 bool Platform::hasGBMproperty (Func func) const {
     bool ret = false;
@@ -890,6 +1104,19 @@ bool Platform::Add (EGLDisplay const & display, EGLSurface const & egl, EGLNativ
 
     bool ret = _set.Has (_device) && _device.Add (_surface) && _set.Emplace (_device);
 
+    if (ret != false) {
+        EGLint _value = EGL_BACK_BUFFER;
+
+        // Once, and not on every swap
+        if (eglQuerySurface (display, egl, EGL_RENDER_BUFFER, &_value) != EGL_TRUE) {
+            LOG (_2CSTR ("Unable to query the render buffer of EGLSurface "), egl, _2CSTR (", assuming a back buffer"));
+
+            _value = EGL_BACK_BUFFER;
+        }
+
+        _contexts [egl] = std::make_shared <context_t> (context_t { display, reinterpret_cast <gbm_surface_t> (native), RenderBufferCount (_value), DefaultSwapInterval (), history_t { 0, 0, std::map <uint64_t, timing_t> () } });
+    }
+
     assert (ret != false);
 
     return ret;
@@ -904,62 +1131,286 @@ bool Platform::Remove (EGLDisplay const & display, EGLSurface const & egl) {
 
     bool ret = _set.Has (_device) && _device.Has (_surface) && _device.Remove (_surface) && _set.Emplace (_device);
 
+    auto _it = _contexts.find (egl);
+
+    if (_it != _contexts.end ()) {
+        // Threads on which the surface is still current do not scan it out anymore
+        _it->second->display = EGL_NO_DISPLAY;
+
+        /* iterator */ _contexts.erase (_it);
+    }
+
+    if (_current.surface == egl) {
+        _current = { EGL_NO_SURFACE, nullptr };
+    }
+
     assert (ret != false);
 
     return ret;
 }
 
-bool Platform::ScanOut (EGLSurface const & surface) const {
-    bool ret = false;
+bool Platform::SwapInterval (EGLDisplay const & display, EGLSurface const & egl, EGLint interval) {
+    std::lock_guard < decltype (Platform::_syncobject) > _lock (_syncobject);
+
+    Device <EGLDisplay, EGLNativeDisplayType, EGLSurface, EGLNativeWindowType, gbm_bo_t> _device (display, EGLNativeDisplayType_DEFAULT () /* act as dummy */);
+
+    Surface <EGLSurface, EGLNativeWindowType, gbm_bo_t> _surface (egl, EGLNativeWindowType_DEFAULT () /* act as dummy*/);
+
+    auto _it = _contexts.find (egl);
+
+    bool ret = _set.Has (_device) && _device.Has (_surface) && _it != _contexts.end ();
+
+    if (ret != false) {
+        // Negative values are silently clamped to 0, as eglSwapInterval does
+        _it->second->interval = std::min (std::max (interval, static_cast <EGLint> (0)), MaximumSwapInterval ());
+    }
+
+    return ret;
+}
 
+bool Platform::RenderBuffer (EGLDisplay const & display, EGLSurface const & egl, EGLint value) {
     std::lock_guard < decltype (Platform::_syncobject) > _lock (_syncobject);
 
-    // Check here and not in every helper
-    EGLDisplay _dpy = eglGetCurrentDisplay ();
+    auto _it = _contexts.find (egl);
+
+    bool ret = Tracked (display, egl) && _it != _contexts.end () && (value == EGL_BACK_BUFFER || value == EGL_SINGLE_BUFFER);
+
+    if (ret != false) {
+        // EGL_KHR_mutable_render_buffer, effective from the next swap
+        _it->second->buffers = RenderBufferCount (value);
+    }
+
+    return ret;
+}
 
-    if (_dpy != EGL_NO_DISPLAY) {
-        Device <EGLDisplay, EGLNativeDisplayType, EGLSurface, EGLNativeWindowType, gbm_bo_t> _device (_dpy, EGL_DEFAULT_DISPLAY /* act as dummy */);
+bool Platform::MakeCurrent (EGLDisplay const & display, EGLSurface const & draw) const {
+    std::lock_guard < decltype (Platform::_syncobject) > _lock (_syncobject);
 
-        Surface <EGLSurface, EGLNativeWindowType, gbm_bo_t> _surface (surface, EGLNativeWindowType_DEFAULT () /* act as dummy*/);
+    auto _it = draw != EGL_NO_SURFACE ? _contexts.find (draw) : _contexts.end ();
 
-        if (_set.Has (_device) != false && _device.Has (_surface) != false)  {
-            DeviceOnion const & _do = static_cast <DeviceOnion const &> (_device);
+    bool ret = _it != _contexts.end () && _it->second->display == display;
 
-            if (_do.NativeType () != EGL_DEFAULT_DISPLAY) {
-                EGLint _value;
+    // Other surfaces, including those of other platforms, are looked up at their swap, if ever
+    _current = { draw, ret != false ? _it->second : nullptr };
 
-                if (eglQuerySurface (_dpy, surface, EGL_RENDER_BUFFER, &_value) != EGL_FALSE) {
-                    SurfaceOnion const & _so = static_cast <SurfaceOnion const &> (_surface);
+    return ret;
+}
 
-                    gbm_surface_t _gbm_surf = reinterpret_cast <gbm_surface_t> (_so.NativeType ());
+bool Platform::Tracked (EGLDisplay const & display, EGLSurface const & egl) const {
+    std::lock_guard < decltype (Platform::_syncobject) > _lock (_syncobject);
 
-#ifdef _FIXEDSIZEDQUEUE
-                    static_assert (MinimumBufferCount () < MaximumBufferCount);
+    Device <EGLDisplay, EGLNativeDisplayType, EGLSurface, EGLNativeWindowType, gbm_bo_t> _device (display, EGLNativeDisplayType_DEFAULT () /* act as dummy */);
+
+    Surface <EGLSurface, EGLNativeWindowType, gbm_bo_t> _surface (egl, EGLNativeWindowType_DEFAULT () /* act as dummy*/);
+
+    return _set.Has (_device) && _device.Has (_surface);
+}
+
+bool Platform::NextFrameId (EGLDisplay const & display, EGLSurface const & egl, uint64_t & id) const {
+    std::lock_guard < decltype (Platform::_syncobject) > _lock (_syncobject);
+
+    bool ret = Tracked (display, egl);
+
+    if (ret != false) {
+        auto _it = _contexts.find (egl);
+
+        id = _it != _contexts.end () ? _it->second->history.next : 0;
+    }
+
+    return ret;
+}
+
+bool Platform::FrameTiming (EGLDisplay const & display, EGLSurface const & egl, uint64_t id, timing_t & timing) const {
+    std::lock_guard < decltype (Platform::_syncobject) > _lock (_syncobject);
+
+    bool ret = Tracked (display, egl);
+
+    if (ret != false) {
+        auto _it = _contexts.find (egl);
+
+        ret = _it != _contexts.end () && _it->second->history.frames.find (id) != _it->second->history.frames.end ();
+
+        if (ret != false) {
+            timing = _it->second->history.frames.at (id);
+        }
+    }
+
+    return ret;
+}
+
+bool Platform::CompositorTiming (EGLDisplay const & display, EGLSurface const & egl, uint64_t & deadline, uint64_t & interval, uint64_t & latency) const {
+    std::lock_guard < decltype (Platform::_syncobject) > _lock (_syncobject);
+
+    bool ret = Tracked (display, egl);
+
+    if (ret != false) {
+        auto _it = _contexts.find (egl);
+
+        // Derived from the most recent presented frame
+        ret = _it != _contexts.end () && _it->second->history.frames.empty () != true && _it->second->history.frames.rbegin ()->second.presented > 0 && _it->second->history.frames.rbegin ()->second.duration > 0;
+
+        if (ret != false) {
+            timing_t const & _timing = _it->second->history.frames.rbegin ()->second;
+
+            uint64_t const _now = Now ();
+
+            interval = _timing.duration;
+
+            deadline = _timing.presented < _now ? _timing.presented + ((_now - _timing.presented) / interval + 1) * interval : _timing.presented + interval;
+
+            // A flip submitted during a frame period completes at its end
+            latency = interval;
+        }
+    }
+
+    return ret;
+}
+
+bool Platform::PresentationTime (EGLDisplay const & display, EGLSurface const & egl, uint64_t time) {
+    std::lock_guard < decltype (Platform::_syncobject) > _lock (_syncobject);
+
+    auto _it = _contexts.find (egl);
+
+    bool ret = Tracked (display, egl) && _it != _contexts.end ();
+
+    if (ret != false) {
+        _it->second->history.presentation = time;
+    }
+
+    return ret;
+}
+
+char const * Platform::Extensions (EGLDisplay const & display, char const * extensions) const {
+    std::lock_guard < decltype (Platform::_syncobject) > _lock (_syncobject);
+
+    char const * ret = extensions;
+
+    Device <EGLDisplay, EGLNativeDisplayType, EGLSurface, EGLNativeWindowType, gbm_bo_t> _device (display, EGLNativeDisplayType_DEFAULT () /* act as dummy */);
+
+    if (extensions != nullptr && _set.Has (_device) != false) {
+        std::string & _string = _extensions [display];
+
+        if (_string.empty () != false) {
+            _string = extensions;
+
+            if (_string.empty () != true && _string.back () != ' ') {
+                _string += ' ';
+            }
+
+            _string += "EGL_ANDROID_get_frame_timestamps EGL_ANDROID_presentation_time";
+        }
+
+        ret = _string.c_str ();
+    }
+
+    return ret;
+}
+
+bool Platform::ScanOut (EGLSurface const & surface, EGLint const * rects, EGLint count) const {
+    bool ret = false;
+
+    uint64_t const _queued = Now ();
+
+    std::unique_lock < decltype (Platform::_syncobject) > _lock (_syncobject);
+
+    auto _lookup = [this, &surface] () -> std::shared_ptr <context_t> {
+        // Swaps are of the current draw surface, other surfaces take the lookup
+        std::shared_ptr <context_t> _context = _current.surface == surface ? _current.context : nullptr;
+
+        // Destroyed while current on this thread, the handle may since have been reused for a new surface
+        if (_context == nullptr || _context->display == EGL_NO_DISPLAY) {
+            auto _it = _contexts.find (surface);
+
+            _context = _it != _contexts.end () ? _it->second : nullptr;
+
+            if (_current.surface == surface) {
+                // The surface that now has the handle, if any
+                _current.context = _context;
+            }
+        }
+
+        return _context;
+    };
+
+    std::shared_ptr <context_t> _context = _lookup ();
+
+    uint64_t _requested = 0;
+
+    if (_context != nullptr && _context->history.presentation > 0) {
+        history_t & _record = _context->history;
+
+        _requested = _record.presentation;
+
+        // Only for a single swap
+        _record.presentation = 0;
+
+        if (_requested > _queued && _requested - _queued <= PresentationDelayMax ()) {
+            // With adaptive sync the flip is presented as it arrives
+            uint64_t _wake = _requested;
+
+#ifdef _ADAPTIVE_SYNC
+            bool const _adaptive = _variable_refresh;
+#else
+            constexpr bool _adaptive = false;
 #endif
-                    ret = ScanOut (_gbm_surf, _value != EGL_BACK_BUFFER ? MinimumBufferCount () : MinimumBufferCount () + 1);
-                }
-                else {
-                    LOG (_2CSTR ("Unable to complete scan out"));
-                }
+
+            // Of the most recent presented frame
+            timing_t const * _previous = _record.frames.empty () != true ? &(_record.frames.rbegin ()->second) : nullptr;
+
+            if (_adaptive != true && _previous != nullptr && _previous->presented > 0 && _previous->duration > 0 && _previous->presented <= _requested) {
+                uint64_t const _duration = _previous->duration;
+
+                // The vertical blank nearest to the requested time, submit halfway the frame period prior to it
+                _wake = _previous->presented + ((_requested - _previous->presented + _duration / 2) / _duration) * _duration - _duration / 2;
             }
-            else {
-                LOG (_2CSTR ("EGL display has wrong type"));
-                assert (false);
+
+            // Other threads, and their EGL and GBM calls, are not blocked while waiting
+            _lock.unlock ();
+
+            struct timespec const _spec = { static_cast <time_t> (_wake / 1000000000), static_cast <long> (_wake % 1000000000) };
+
+            while (_wake > _queued && clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &_spec, nullptr) == EINTR) {
+                // Interrupted, continue
             }
+
+            _lock.lock ();
+
+            // The surface may have been destroyed in the meantime
+            _context = _lookup ();
         }
         else {
-            LOG (_2CSTR ("Untracked EGLSurface"));
-            assert (false);
+            LOG (_2CSTR ("Presentation time ignored, "), _requested, _2CSTR (" [ns] is in the past or too far ahead"));
+        }
+    }
+
+    if (_context != nullptr && _context->display != EGL_NO_DISPLAY) {
+#ifdef _FIXEDSIZEDQUEUE
+        static_assert (MinimumBufferCount () < MaximumBufferCount);
+#endif
+        damage_t const _damage = rects != nullptr && count > 0 ? damage_t (rects, rects + 4 * count) : damage_t ();
+
+        history_t & _record = _context->history;
+
+        timing_t _timing = { _record.next, _requested, _queued, 0, 0, 0, 0 };
+
+        ret = ScanOut (_context->native, _context->buffers, _context->interval, _damage, &_timing);
+
+        // Also failed scan outs, the identifier is that of the swap
+        _record.frames [_record.next++] = _timing;
+
+        if (_record.frames.size () > FrameTimingCount ()) {
+            /* iterator */ _record.frames.erase (_record.frames.begin ());
         }
-    } else {
-        LOG (_2CSTR ("No valid EGL display available for scan out"));
+    }
+    else {
+        LOG (_2CSTR ("Untracked EGLSurface"));
+        assert (false);
     }
 
     return ret;
 }
 
-// Never called directly, hence no guard
-bool Platform::ScanOut (gbm_surface_t const & surface, uint8_t buffers) const {
+bool Platform::ScanOut (gbm_surface_t const & surface, uint8_t buffers, EGLint interval, damage_t const & damage, timing_t * timing) const {
     // Determine current CRTC; currently only considers just a single crtc-encoder-connector path
     auto func = [] (uint32_t fd, uint32_t& crtc, uint32_t& connectors) -> uint32_t {
         uint32_t ret = 0;
@@ -1012,6 +1463,27 @@ bool Platform::ScanOut (gbm_surface_t const & surface, uint8_t buffers) const {
     // Buffer to queue and buffer to release
     std::array <gbm_bo_t, 2> _bo = { nullptr, nullptr };
 
+    // Of the buffer to release, a surface scanned out earlier if surfaces take turns
+    gbm_surface_t _owner = surface;
+
+    // Scanned out, but no buffer is released until a later flip has completed
+    bool _deferring = false;
+
+    // Return a buffer to the surface it has been locked from, unless that surface has been destroyed, together with its buffers
+    auto release = [&surface, this] (gbm_surface_t owner, gbm_bo_t bo) -> void {
+        Surface <EGLSurface, EGLNativeWindowType, gbm_bo_t> _native (EGL_NO_SURFACE /* act as dummy */, owner);
+
+        if (owner != surface && owner != gbm_surface_t_DEFAULT () && static_cast <DeviceSetOnion const &> (_set).HasNative (_native) != true) {
+            LOG (_2CSTR ("Buffer of a destroyed surface not released"));
+        }
+        else if (owner != gbm_surface_t_DEFAULT () && bo != gbm_bo_t_DEFAULT ()) {
+            /*void*/ gbm_surface_release_buffer (owner, bo);
+        }
+        else {
+            LOG (_2CSTR ("Unable to release a buffer"));
+        }
+    };
+
     // Not all used  gbm / drm API here are well defined within this unit
     // This can be an expensive test, thus cache the result
     static bool _loaded = loaded (libGBMname ()) && loaded (libDRMname ());
@@ -1030,6 +1502,25 @@ bool Platform::ScanOut (gbm_surface_t const & surface, uint8_t buffers) const {
         if (_gbm_device != gbm_device_t_DEFAULT ()) {
             int _fd = gbm_device_get_fd (_gbm_device);
 
+#ifdef _LEASE
+            // Once, without control over the device, scan out on a lease, independent of other processes
+            static uint32_t _granted_crtc = 0;
+            static uint32_t _granted_connector = 0;
+
+            static int const _lease = _fd >= 0 && drmAvailable () != 0 && drmIsMaster (_fd) == 0 ? Lessee (_granted_crtc, _granted_connector) : -1;
+
+            bool const _leased = _lease >= 0;
+
+            if (_leased != false) {
+                _fd = _lease;
+            }
+#else
+            constexpr bool _leased = false;
+
+            constexpr uint32_t _granted_crtc = 0;
+            constexpr uint32_t _granted_connector = 0;
+#endif
+
             if (_fd >= 0 && drmAvailable () != 0 && drmIsMaster (_fd) != 0) {
                 auto _element = _bo.back ();
 
@@ -1052,119 +1543,487 @@ bool Platform::ScanOut (gbm_surface_t const & surface, uint8_t buffers) const {
 
                     uint32_t _fb = 0;
 
+                    if (_leased != false) {
+                        // The buffer object belongs to the file description of the device, share it with the one of the lease
+                        int _prime = gbm_bo_get_fd (_element);
+
+                        if (_prime < 0 || drmPrimeFDToHandle (_fd, _prime, &_handle) != 0) {
+                            LOG (_2CSTR ("Unable to share the buffer object with the lease"));
+                            _handle = 0;
+                        }
+
+                        if (_prime >= 0) {
+                            /* int */ close (_prime);
+                        }
+                    }
+
                     // drm_fourcc.c illustrates that DRM_FORMAT_XRGB8888 has depth 24, and DRM_FORMAT_ARGB8888 has depth 32
-                    if (drmModeAddFB (_fd, _width, _height, _format != DRM_FORMAT_ARGB8888 ? _bpp - 8 : _bpp, _bpp, _stride, _handle, &_fb) == 0) {
+                    bool const _added = _handle != 0 && drmModeAddFB (_fd, _width, _height, _format != DRM_FORMAT_ARGB8888 ? _bpp - 8 : _bpp, _bpp, _stride, _handle, &_fb) == 0;
+
+                    if (_leased != false && _handle != 0) {
+                        // The framebuffer, if any, holds its own reference
+                        struct drm_gem_close _close = { _handle, 0 };
+
+                        /* int */ drmIoctl (_fd, DRM_IOCTL_GEM_CLOSE, &_close);
+                    }
+
+                    if (_added != false) {
                         // Expensive operation thus best to cache the result assuming it will not change
-                        static uint32_t _crtc = 0;
-                        static uint32_t _connectors = 0;
-                        static uint32_t _count = func (_fd, _crtc, _connectors);
+                        // A lease only has the connector and CRTC the broker granted, whatever their type
+                        static uint32_t _crtc = _leased != false ? _granted_crtc : 0;
+                        static uint32_t _connectors = _leased != false ? _granted_connector : 0;
+                        static uint32_t _count = _leased != false ? 1 : func (_fd, _crtc, _connectors);
+
+#ifdef _ADAPTIVE_SYNC
+                        // Once, the property is part of the CRTC state
+                        static bool const _adaptive = AdaptiveSync (_fd, _crtc, _connectors, true);
+
+                        // Swaps waiting for a presentation time need to know
+                        _variable_refresh = _adaptive;
+#else
+                        constexpr bool _adaptive = false;
+#endif
 
                         // Enable multi buffering
                         static Platform::Queue _queue (_fd, _crtc, _connectors);
 
-                        auto enqueue = [&buffers, &surface, this] (int fd, uint32_t fb, gbm_bo_t bo) -> gbm_bo_t {
+                        // The oldest queued frame is no longer scanned out, remove its framebuffer, its buffer is returned together with the surface it belongs to
+                        auto retire = [] (gbm_surface_t & owner) -> gbm_bo_t {
                             gbm_bo_t ret = gbm_bo_t_DEFAULT ();
 
-                            /* void */ _queue.push (std::make_tuple(fd, fb, surface, bo));
+                            queue_t _element = _queue.pop ();
 
-                            if ( MinimumBufferCount () ==  buffers || _queue.size () >= buffers) {
-                                queue_t _element = _queue.pop ();
+                            auto _fd = std::get <0> (_element);
+                            auto _fb = std::get <1> (_element);
 
-                                auto _fd = std::get <0> (_element);
-                                auto _fb = std::get <1> (_element);
+                            if (_fd < 0 || _fb == 0 || drmModeRmFB (_fd, _fb) != 0) {
+                                // Always true for the initial frame
+                                LOG (_2CSTR ("Unable to remove 'old' frame buffer"));
+                            }
+                            else {
+                                auto _bo = std::get <3> (_element);
 
-                                if (_fd < 0 || _fb == 0 || drmModeRmFB (_fd, _fb) != 0) {
-                                    // Always true for the initial frame
-                                    LOG (_2CSTR ("Unable to remove 'old' frame buffer"));
-                                }
-                                else {
-                                    auto _bo = std::get <3> (_element);
+                                static_assert (std::is_same <decltype (_bo), decltype (ret)>::value != false);
+                                ret = _bo;
 
-                                    static_assert (std::is_same <decltype (_bo), decltype (ret)>::value != false);
-                                    ret = _bo;
-                                }
+                                owner = std::get <2> (_element);
+                            }
+
+                            return ret;
+                        };
+
+                        auto enqueue = [&buffers, &surface, &_owner, &retire] (int fd, uint32_t fb, gbm_bo_t bo) -> gbm_bo_t {
+                            gbm_bo_t ret = gbm_bo_t_DEFAULT ();
+
+                            /* void */ _queue.push (std::make_tuple(fd, fb, surface, bo));
+
+                            if ( MinimumBufferCount () ==  buffers || _queue.size () >= buffers) {
+                                ret = retire (_owner);
                             }
 
                             return ret;
                         };
 
-                        static Platform::drm_callback_data_t _callback_data = {_fd, _fb, _bo.back (), true};
+                        static Platform::drm_callback_data_t _callback_data = {_fd, _fb, _bo.back (), true, 0, 0, 0};
 
                         // Guardian of the shared data presented one line earlier
                         static Mutex _mutex;
 
-                        _callback_data = {_fd, _fb, _bo.back (), true};
+                        // Completion of the previous flip, the vertical blank the next one aligns to
+                        static uint64_t _vblank = 0;
+
+                        // Vertical blank counter at completion of the previous flip, the base of throttled flips
+                        static uint32_t _sequence = 0;
+
+                        // An asynchronous flip has been submitted but its event has not yet been handled
+                        static bool _outstanding = false;
+
+                        // Frames queued by asynchronous flips without retiring the one they replace, the latter may still be scanned out until the flip completes
+                        static uint8_t _deferred = 0;
+
+                        // A flip has completed, the frames replaced by earlier asynchronous flips are no longer scanned out
+                        auto settle = [&retire, &release] () -> void {
+                            for (; _deferred > 0 && _queue.size () > 1; _deferred--) {
+                                gbm_surface_t _previous = gbm_surface_t_DEFAULT ();
+
+                                gbm_bo_t const _retired = retire (_previous);
+
+                                if (_retired != gbm_bo_t_DEFAULT ()) {
+                                    release (_previous, _retired);
+                                }
+                            }
+                        };
+
+                        // Strictly speaking c++ linkage and not C linkage
+                        // Asynchronous, but never called more than once, waiting in scope
+                        auto handler = +[] (int fd, unsigned int frame, unsigned int sec, unsigned int usec, void* data) {
+                            std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                            if (data == nullptr) {
+                                LOG (_2CSTR ("Invalid callback data"));
+                            }
+                            else if (reinterpret_cast <uintptr_t> (data) == _callback_data.token && _callback_data.waiting != false) {
+                                assert (fd == _callback_data.fd);
+
+                                _callback_data.timestamp = static_cast <uint64_t> (sec) * 1000000000 + static_cast <uint64_t> (usec) * 1000;
+                                _callback_data.sequence = frame;
+
+                                // Encourages the loop to break
+                                _callback_data.waiting = false;
+                            }
+                            else {
+                                // Late event of a flip that has been given up on, any other flip's event still arrives
+                            }
+                        };
+
+                        // Use the magic constant here because the struct is versioned!
+                        drmEventContext _context = { .version = 2, . vblank_handler = nullptr, .page_flip_handler = handler };
+
+#ifdef _EVENT_THREAD
+                        // Completions are handled on a thread of its own, waiting swappers are woken
+                        static Events _events (_fd, _context);
+
+                        static bool const _scheduled = [] () -> bool {
+                            bool _ret = _events.Schedule (EventThreadPriority (), EventThreadAffinity ());
+
+                            if (_ret != true) {
+                                LOG (_2CSTR ("Unable to apply the priority "), EventThreadPriority (), _2CSTR (" and affinity "), EventThreadAffinity (), _2CSTR (" to the DRM event thread"));
+                            }
+
+                            return _ret;
+                        } ();
+
+                        static_cast <void> (_scheduled);
+#endif
+
+                        // Expensive operation thus best to cache the result, a mode switch recomputes it
+                        static uint64_t _duration = FrameDuration (_fd, _crtc);
+
+                        // Deadlines against CLOCK_MONOTONIC, the clock of the event timestamps
+                        static int const _timer = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+
+                        // Handle events until the flip has completed, or until its event is considered lost
+                        auto await = [&_fd, &_context] (uint64_t deadline) -> bool {
+                            uint8_t _late = 0;
+
+                            bool _waiting = true;
+
+                            {
+                                std::lock_guard < decltype (_mutex) > _lock (_mutex);
+                                _waiting = _callback_data.waiting;
+                            }
+
+                            while (_waiting != false) {
+                                struct itimerspec const _spec = { { 0, 0 }, { static_cast <time_t> (deadline / 1000000000), static_cast <long> (deadline % 1000000000) } };
+
+                                if (_timer < 0 || timerfd_settime (_timer, TFD_TIMER_ABSTIME, &_spec, nullptr) != 0) {
+                                    // Error; break the loop
+                                    LOG (_2CSTR ("Unable to arm the flip timer"));
+                                    break;
+                                }
+
+#ifdef _EVENT_THREAD
+                                bool const _delegated = _events.Status ();
+
+                                struct pollfd _fds [2] = { { _delegated != false ? _events.Fd () : _fd, POLLIN, 0 }, { _timer, POLLIN, 0 } };
+#else
+                                struct pollfd _fds [2] = { { _fd, POLLIN, 0 }, { _timer, POLLIN, 0 } };
+#endif
+
+                                int _err = poll (_fds, 2, -1 /* the timer bounds the wait */);
+
+                                if (_err < 0) {
+                                    if (errno != EINTR) {
+                                        // Error; break the loop
+                                        break;
+                                    }
+                                }
+#ifdef _EVENT_THREAD
+                                else if (_delegated != false && (_fds [0].revents & POLLIN) != 0) {
+                                    // Events have been handled, the state is checked below
+                                    _events.Clear ();
+                                }
+#endif
+                                else if ((_fds [0].revents & POLLIN) != 0) {
+                                    // Node is readable
+                                    if (drmHandleEvent (_fd, &_context) != 0) {
+                                        // Error; break the loop
+                                        break;
+                                    }
+                                }
+                                else if ((_fds [1].revents & POLLIN) != 0) {
+                                    uint64_t _expirations = 0;
+
+                                    /* ssize_t */ read (_timer, &_expirations, sizeof (_expirations));
+
+                                    ++_late;
+
+                                    if (_late > FrameLateMax ()) {
+                                        // The event is lost, by now the flip has taken place, or never will, do not stall
+                                        std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                                        LOG (_2CSTR ("Page flip event lost, recovered after "), static_cast <uint32_t> (_late), _2CSTR (" frame periods"));
+
+                                        uint64_t _count = 0;
+                                        uint64_t _ns = 0;
+
+                                        // Realign with the most recent vertical blank
+                                        bool const _known = drmCrtcGetSequence (_fd, _crtc, &_count, &_ns) == 0;
+
+                                        _callback_data.timestamp = _known != false ? _ns : 0;
+                                        _callback_data.sequence = _known != false ? static_cast <uint32_t> (_count) : 0;
+                                        _callback_data.waiting = false;
+                                    }
+                                    else {
+                                        // Possibly one vertical blank later, eg, missed the expected one
+                                        deadline += _duration;
+                                    }
+                                }
+
+                                {
+                                     std::lock_guard < decltype (_mutex) > _lock (_mutex);
+                                    _waiting = _callback_data.waiting;
+                                }
+                            }
+
+                            return _waiting != true;
+                        };
+
+                        if (_outstanding != false) {
+                            // An asynchronous flip completes without a vertical blank, hence almost immediately, the deadline is mainly a safeguard
+                            if (await (Now () + _duration) != false) {
+                                _vblank = _callback_data.timestamp;
+                                _sequence = _callback_data.sequence;
+
+                                settle ();
+                            }
+
+                            _outstanding = false;
+                        }
+
+                        // Once, tearing is an opt-in of the driver
+                        static bool const _async = Capable (_fd, DRM_CAP_ASYNC_PAGE_FLIP);
+
+                        // Once, a flip at a specific vertical blank is an opt-in of the driver
+                        static bool const _target = Capable (_fd, DRM_CAP_PAGE_FLIP_TARGET);
+
+                        // The mode as set, updated once it is changed to match a surface
+                        static drmModeModeInfo _mode = [&_fd] () -> drmModeModeInfo {
+                            drmModeModeInfo _current;
+
+                            return CurrentMode (_fd, _crtc, _current) != false ? _current : drmModeModeInfo ();
+                        } ();
+
+                        // The previous flip has placed the buffer scaled, the planes keep that placement until it is undone
+                        static bool _placed = false;
+
+                        // An unknown mode is assumed to fit
+                        bool const _fits = _mode.hdisplay == 0 || _mode.vdisplay == 0 || (_width == _mode.hdisplay && _height == _mode.vdisplay);
+
+                        // A mode of the size of the buffer
+                        drmModeModeInfo _match = drmModeModeInfo ();
+
+#ifdef _MODE_MATCH
+                        // Policy, a mode of the size of the surface, at the same refresh rate, is preferred over scaling, not from a scaled placement
+                        bool const _switch = _fits != true && _placed != true && MatchingMode (_fd, _connectors, _width, _height, _mode.vrefresh, _match) != false;
+#else
+                        constexpr bool _switch = false;
+#endif
+
+                        // The display engine scales, or undoes the previous scaled placement
+                        bool const _scaled = _switch != true && (_fits != true || _placed != false);
+
+                        uint32_t _flags = DRM_MODE_PAGE_FLIP_EVENT;
+
+                        if (interval == 0 && _async != false && _scaled != true) {
+                            _flags |= DRM_MODE_PAGE_FLIP_ASYNC;
+                        }
+
+                        // Only meaningful if the previous flip completed, or has been recovered from
+                        bool const _throttled = interval > 1 && _vblank > 0;
+
+                        // The vertical blank the flip should complete at, wraps around as the counter does
+                        uint32_t const _at = _sequence + static_cast <uint32_t> (interval);
+
+                        if (_throttled != false && (_target != true || _scaled != false)) {
+                            // Wait for the vertical blank prior to the target, the flip then completes at the target, or soon after if missed
+                            uint32_t const _pipe = Pipe (_fd, _crtc);
+
+                            drmVBlank _vbl;
+
+                            _vbl.request.type = static_cast <drmVBlankSeqType> (DRM_VBLANK_ABSOLUTE | ((_pipe << DRM_VBLANK_HIGH_CRTC_SHIFT) & DRM_VBLANK_HIGH_CRTC_MASK));
+                            _vbl.request.sequence = _at - 1;
+                            _vbl.request.signal = 0;
+
+                            if (drmWaitVBlank (_fd, &_vbl) != 0) {
+                                LOG (_2CSTR ("Unable to wait for vertical blank "), _at - 1);
+                            }
+                        }
+
+                        // Damage in buffer coordinates, origin top left, clamped to the buffer
+                        std::vector <struct drm_mode_rect> _clips;
+
+                        for (size_t i = 0; i + 3 < damage.size (); i += 4) {
+                            int32_t const _w = static_cast <int32_t> (_width);
+                            int32_t const _h = static_cast <int32_t> (_height);
+
+                            struct drm_mode_rect const _clip = {
+                                  std::min (std::max (damage [i], 0), _w)
+                                , std::min (std::max (_h - (damage [i + 1] + damage [i + 3]), 0), _h)
+                                , std::min (std::max (damage [i] + damage [i + 2], 0), _w)
+                                , std::min (std::max (_h - damage [i + 1], 0), _h)
+                            };
+
+                            if (_clip.x1 < _clip.x2 && _clip.y1 < _clip.y2) {
+                                _clips.push_back (_clip);
+                            }
+                        }
+
+                        // Neither asynchronous nor targeted flips are combined with damage, nor is a scaled placement
+                        bool const _damaged = _clips.empty () != true && (_flags & DRM_MODE_PAGE_FLIP_ASYNC) == 0 && (_throttled != true || _target != true) && _scaled != true;
+
+                        // Of this flip, a late event of an earlier one does not match
+                        void * _token = nullptr;
+
+                        {
+                            // Events may be handled on another thread
+                            std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                            uint32_t const _next = _callback_data.token < std::numeric_limits <uint32_t>::max () ? _callback_data.token + 1 : 1;
+
+                            _callback_data = {_fd, _fb, _bo.back (), true, 0, 0, _next};
+
+                            _token = reinterpret_cast <void *> (static_cast <uintptr_t> (_next));
+                        }
+
+                        uint64_t const _submitted = Now ();
+
+                        if (timing != nullptr) {
+                            timing->latched = _submitted;
+                            timing->duration = _duration;
+                        }
+
+                        int _err = -ENOTSUP;
+
+                        if (_switch != false) {
+                            // The mode is set instead, see EINVAL
+                            _err = -EINVAL;
+                        }
+                        else if (_scaled != false) {
+                            _err = ScaledFlip (_fd, _crtc, _fb, _width, _height, _mode, _token);
+
+                            if (_err == 0) {
+                                _placed = _fits != true;
+                            }
+                        }
+                        else if (_damaged != false) {
+                            _err = DamageFlip (_fd, _crtc, _fb, _clips, _token);
+                        }
 
-                        int _err = drmModePageFlip (_fd, _crtc, _fb, DRM_MODE_PAGE_FLIP_EVENT, &_callback_data);
+                        if (_switch != true && (_err == -ENOTSUP || _err == -EINVAL)) {
+                            // The entire buffer, as without damage
+                            _err = _throttled != false && _target != false ? drmModePageFlipTarget (_fd, _crtc, _fb, _flags | DRM_MODE_PAGE_FLIP_TARGET_ABSOLUTE, _token, _at)
+                                                                           : drmModePageFlip (_fd, _crtc, _fb, _flags, _token);
+                        }
+
+                        if (_err == -EINVAL && (_flags & DRM_MODE_PAGE_FLIP_ASYNC) != 0) {
+                            // Not for this buffer, eg, a different layout, fall back to a synchronized flip
+                            _flags &= ~DRM_MODE_PAGE_FLIP_ASYNC;
+
+                            _err = drmModePageFlip (_fd, _crtc, _fb, _flags, _token);
+                        }
+
+                        // Not scanned out, the frame is dropped, its framebuffer is removed and its buffer released, or else the surface runs out of buffers
+                        auto drop = [&_fd, &_fb, &_bo] () {
+                            if (drmModeRmFB (_fd, _fb) != 0) {
+                                LOG (_2CSTR ("Unable to remove frame buffer (id = "), _fb, _2CSTR (")"));
+                            }
+
+                            _bo.front () = _bo.back ();
+                        };
 
                         switch (0 - _err) {
                             case 0      :   {   // No error
-                                                // Strictly speaking c++ linkage and not C linkage
-                                                // Asynchronous, but never called more than once, waiting in scope
-                                                auto handler = +[] (int fd, unsigned int frame, unsigned int sec, unsigned int usec, void* data) {
-                                                    std::lock_guard < decltype (_mutex) > _lock (_mutex);
+                                                if ((_flags & DRM_MODE_PAGE_FLIP_ASYNC) != 0) {
+                                                    // Do not wait, the previous buffer may still be scanned out, tearing is the accepted consequence
+                                                    _outstanding = true;
 
-                                                    if (data != nullptr) {
-                                                        Platform::drm_callback_data_t* _data = reinterpret_cast <Platform::drm_callback_data_t*> (data);
+                                                    if (timing != nullptr) {
+                                                        // Without a vertical blank to wait for
+                                                        timing->presented = _submitted;
+                                                    }
 
-                                                        assert (fd == _data->fd);
+                                                    // The frame it replaces is retired once the event of this flip has been handled
+                                                    /* void */ _queue.push (std::make_tuple (_fd, _fb, surface, _bo.back ()));
 
-                                                        // Encourages the loop to break
-                                                        _data->waiting = false;
-                                                    }
-                                                    else {
-                                                        LOG (_2CSTR ("Invalid callback data"));
-                                                    }
-                                                };
+                                                    ++_deferred;
 
-                                                // Use the magic constant here because the struct is versioned!
-                                                drmEventContext _context = { .version = 2, . vblank_handler = nullptr, .page_flip_handler = handler };
+                                                    _deferring = true;
 
-                                                fd_set _fds;
+                                                    if (gbm_surface_has_free_buffers (surface) <= 0) {
+                                                        // Nothing left to render the next frame to, wait after all, the flip completes without a vertical blank, hence almost immediately
+                                                        if (await (Now () + _duration) != false) {
+                                                            _vblank = _callback_data.timestamp;
+                                                            _sequence = _callback_data.sequence;
 
-                                                struct timespec _timeout = { .tv_sec = Platform::FrameDuration (), .tv_nsec = 0 };
+                                                            _outstanding = false;
 
-                                                bool _waiting = true;
+                                                            settle ();
+                                                        }
+                                                    }
 
-                                                {
-                                                    std::lock_guard < decltype (_mutex) > _lock (_mutex);
-                                                    _waiting = _callback_data.waiting;
+                                                    break;
                                                 }
 
-                                                while (_waiting != false) {
-                                                    FD_ZERO (&_fds);
-                                                    FD_SET( _fd, &_fds);
+                                                // The flip completes at the first vertical blank after its submission, aligned to the previous one, if known
+                                                uint64_t _expected = _submitted + _duration;
 
-                                                    // Race free
-                                                    _err  = pselect(_fd + 1, &_fds, nullptr, nullptr, &_timeout, nullptr);
+                                                // With adaptive sync the refresh starts when the flip arrives, there is no fixed vertical blank to align to
+                                                if (_adaptive != true && _vblank > 0 && _vblank <= _submitted) {
+                                                    _expected = _vblank + ((_submitted - _vblank) / _duration + 1) * _duration;
+                                                }
 
-                                                    if (_err < 0) {
-                                                        // Error; break the loop
-                                                        break;
-                                                    }
-                                                    else {
-                                                        if (_err == 0) {
-                                                            // Timeout; retry
-// TODO: add an additional condition to break the loop to limit the number of retries, but then deal with the asynchronous nature of the callback
-                                                        }
-                                                        else { // ret > 0
-                                                            if (FD_ISSET (_fd, &_fds) != 0) {
-                                                                // Node is readable
-                                                                if (drmHandleEvent (_fd, &_context) != 0) {
-                                                                    // Error; break the loop
-                                                                    break;
-                                                                }
-
-                                                                // Flip probably occured already otherwise it loops again
-                                                                _bo.front () = enqueue (_fd, _fb, _bo.back ());
-                                                            }
+                                                if (_throttled != false) {
+                                                    // Not before the target
+                                                    _expected = std::max (_expected, _vblank + static_cast <uint64_t> (interval) * _duration);
+                                                }
+
+                                                // Half a frame of slack for jitter and a flip submitted just too late for the expected vertical blank
+                                                if (await (_expected + _duration / 2) != false) {
+                                                    // Achieved intervals, with adaptive sync not necessarily a multiple of the frame period
+                                                    static uint64_t _total = 0;
+                                                    static uint64_t _min = 0;
+                                                    static uint64_t _max = 0;
+                                                    static uint16_t _intervals = 0;
+
+                                                    if (_vblank > 0 && _callback_data.timestamp > _vblank) {
+                                                        uint64_t const _interval = _callback_data.timestamp - _vblank;
+
+                                                        _min = _intervals > 0 ? std::min (_min, _interval) : _interval;
+                                                        _max = std::max (_max, _interval);
+                                                        _total += _interval;
+
+                                                        if (++_intervals >= PacingReportCount ()) {
+                                                            LOG (_2CSTR ("Flip interval average "), _total / _intervals, _2CSTR (" [ns], minimum "), _min, _2CSTR (" [ns], maximum "), _max, _2CSTR (" [ns], adaptive sync "), _adaptive != false ? _2CSTR ("on") : _2CSTR ("off"), _2CSTR (", swap interval "), interval);
+
+                                                            _total = 0;
+                                                            _intervals = 0;
+                                                            _max = 0;
                                                         }
                                                     }
 
-                                                    {
-                                                         std::lock_guard < decltype (_mutex) > _lock (_mutex);
-                                                        _waiting = _callback_data.waiting;
+                                                    // Completed, or recovered from
+                                                    _vblank = _callback_data.timestamp;
+                                                    _sequence = _callback_data.sequence;
+
+                                                    if (timing != nullptr) {
+                                                        timing->presented = _vblank;
+                                                        timing->sequence = _sequence;
                                                     }
+
+                                                    settle ();
+
+                                                    _bo.front () = enqueue (_fd, _fb, _bo.back ());
                                                 }
 
                                                 break;
@@ -1174,49 +2033,672 @@ bool Platform::ScanOut (gbm_surface_t const & surface, uint8_t buffers) const {
                                                 drmModeCrtcPtr _ptr = drmModeGetCrtc (_fd, _crtc);
 
                                                 if (_ptr != nullptr) {
-                                                    // Assume the dimensions of the buffer fit within this mode
-                                                    if (drmModeSetCrtc (_fd, _crtc, _fb, _ptr->x, _ptr->y, &_connectors, _count, &_ptr->mode) != 0) {
+                                                    // Assume the dimensions of the buffer fit within this mode, or else, the mode matching the buffer
+                                                    drmModeModeInfo & _set = _switch != false ? _match : _ptr->mode;
+
+                                                    if (drmModeSetCrtc (_fd, _crtc, _fb, _switch != false ? 0 : _ptr->x, _switch != false ? 0 : _ptr->y, &_connectors, _count, &_set) != 0) {
                                                         // Error
                                                         // There is nothing to be done te recover
+                                                        drop ();
                                                     }
                                                     else {
+                                                        if (_switch != false) {
+                                                            LOG (_2CSTR ("Mode switched to "), _match.hdisplay, _2CSTR ("x"), _match.vdisplay, _2CSTR ("@"), _match.vrefresh, _2CSTR (" for a surface of that size"));
+
+                                                            _mode = _match;
+
+                                                            // Pacing follows the new mode
+                                                            _duration = FrameDuration (_fd, _crtc);
+                                                        }
+
+                                                        settle ();
+
                                                         _bo.front () = enqueue (_fd, _fb, _bo.back ());
+
+                                                        if (timing != nullptr) {
+                                                            // The mode set is synchronous
+                                                            timing->presented = Now ();
+                                                        }
                                                     }
 
-                                                    drmModeFreeCrtc (_ptr);
-                                                }
+                                                    drmModeFreeCrtc (_ptr);
+                                                }
+                                                else {
+                                                    drop ();
+                                                }
+
+                                                break;
+                                            }
+                            case EBUSY  :   // Eg, the previous flip, given up on, has not yet completed
+                            default     :   {
+                                            // There is nothing to be done about it
+                                            drop ();
+                                            }
+                        }
+                    }
+                }
+            }
+#ifdef _CLIENT
+            else if (_leased != true && Compositor () >= 0) {
+                // Without control over the device, the compositor scans out
+                _bo.front () = Forward (Compositor (), surface, _bo.back (), damage, timing);
+            }
+#endif
+            else {
+                LOG (_2CSTR ("Unable to complete the scan out due to insufficient privileges"));
+            }
+        }
+
+        if (_deferring != true) {
+            release (_owner, _bo.front ());
+        }
+
+        if (surface != nullptr && gbm_surface_has_free_buffers (surface) <= 0) {
+            LOG (_2CSTR ("Insufficient free buffers left"));
+        }
+    }
+    else {
+        LOG (_2CSTR ( "Unable to complete the scan out due to missing support library"));
+    }
+
+    return _deferring != false || _bo.front () != gbm_bo_t_DEFAULT ();
+}
+
+uint64_t Platform::FrameDuration (int fd, uint32_t crtc) {
+    uint64_t ret = 1000000000 / 60;
+
+    drmModeCrtcPtr _ptr = drmModeGetCrtc (fd, crtc);
+
+    if (_ptr != nullptr) {
+        drmModeModeInfo const & _mode = _ptr->mode;
+
+        if (_ptr->mode_valid != 0 && _mode.clock > 0 && _mode.htotal > 0 && _mode.vtotal > 0) {
+            // Pixel clock in kHz, more precise than the rounded vrefresh
+            ret = (static_cast <uint64_t> (_mode.htotal) * _mode.vtotal * 1000000) / _mode.clock;
+        }
+        else if (_ptr->mode_valid != 0 && _mode.vrefresh > 0) {
+            ret = 1000000000 / _mode.vrefresh;
+        }
+
+        drmModeFreeCrtc (_ptr);
+    }
+
+    return ret;
+}
+
+bool Platform::Property (int fd, uint32_t object, uint32_t type, char const name [], uint32_t & id, uint64_t & value) {
+    bool ret = false;
+
+    drmModeObjectPropertiesPtr _props = drmModeObjectGetProperties (fd, object, type);
+
+    if (_props != nullptr) {
+        for (uint32_t i = 0; i < _props->count_props && ret != true; i++) {
+            drmModePropertyPtr _prop = drmModeGetProperty (fd, _props->props [i]);
+
+            if (_prop != nullptr) {
+                if (strcmp (_prop->name, name) == 0) {
+                    id = _prop->prop_id;
+                    value = _props->prop_values [i];
+                    ret = true;
+                }
+
+                drmModeFreeProperty (_prop);
+            }
+        }
+
+        drmModeFreeObjectProperties (_props);
+    }
+
+    return ret;
+}
+
+#ifdef _ADAPTIVE_SYNC
+bool Platform::AdaptiveSync (int fd, uint32_t crtc, uint32_t connector, bool enable) {
+    uint32_t _capable_id = 0, _enabled_id = 0;
+    uint64_t _capable = 0, _enabled = 0;
+
+    // Both are optional, absent on older kernels and most drivers
+    bool ret =    Property (fd, connector, DRM_MODE_OBJECT_CONNECTOR, "vrr_capable", _capable_id, _capable) != false
+               && Property (fd, crtc, DRM_MODE_OBJECT_CRTC, "VRR_ENABLED", _enabled_id, _enabled) != false
+               && (_capable != 0 || enable != true);
+
+    if (ret != false && (_enabled != 0) != enable) {
+        // Also honored by atomic drivers for a legacy client
+        ret = drmModeObjectSetProperty (fd, crtc, DRM_MODE_OBJECT_CRTC, _enabled_id, enable != false ? 1 : 0) == 0;
+    }
+
+    if (ret != true) {
+        LOG (_2CSTR ("Adaptive sync unavailable for crtc (id = "), crtc, _2CSTR (") and connector (id = "), connector, _2CSTR (")"));
+    }
+
+    return ret != false && enable != false;
+}
+#endif
+
+#ifdef _LEASE
+int Platform::Lessee (uint32_t & crtc, uint32_t & connector) {
+    // Kept open, the broker revokes the lease once it is closed, at the latest at exit
+    static int _sock = Lease::InvalidFd ();
+
+    char const * _env = getenv (Lease::SocketVariable ());
+
+    std::string const _path = _env != nullptr ? _env : Lease::SocketPath ();
+
+    Lease::reply_t _reply;
+
+    int ret = Lease::Acquire (_path, 0 /* any connector */, _sock, _reply);
+
+    if (ret >= 0 && (_reply._crtc == 0 || _reply._connector == 0)) {
+        LOG (_2CSTR ("Lease "), _reply._lessee, _2CSTR (" lacks a connector or crtc"));
+
+        /* int */ close (ret);
+        /* int */ close (_sock);
+
+        ret = Lease::InvalidFd ();
+        _sock = Lease::InvalidFd ();
+    }
+    else if (ret >= 0) {
+        LOG (_2CSTR ("Scan out on lease "), _reply._lessee, _2CSTR (" of connector (id = "), _reply._connector, _2CSTR ("), crtc (id = "), _reply._crtc, _2CSTR (") and plane (id = "), _reply._plane, _2CSTR (")"));
+
+        crtc = _reply._crtc;
+        connector = _reply._connector;
+    }
+    else {
+        LOG (_2CSTR ("Unable to acquire a lease from the broker at "), _path, _2CSTR (", status "), _reply._status);
+    }
+
+    return ret;
+}
+#endif
+
+#ifdef _CLIENT
+int Platform::Compositor () {
+    // Once, kept open, the compositor gives up on this client once it is closed, at the latest at exit
+    static int const _sock = [] () -> int {
+        char const * _env = getenv (Client::SocketVariable ());
+
+        std::string const _path = _env != nullptr ? _env : Client::SocketPath ();
+
+        // 0 identifies the compositor
+        int ret = Client::Connect (_path, static_cast <uint8_t> (1 + getpid () % 255));
+
+        if (ret >= 0) {
+            LOG (_2CSTR ("Scan out by the compositor at "), _path);
+        }
+        else {
+            LOG (_2CSTR ("Unable to register with the compositor at "), _path);
+        }
+
+        return ret;
+    } ();
+
+    return _sock;
+}
+
+Platform::gbm_bo_t Platform::Forward (int sock, gbm_surface_t const & surface, gbm_bo_t bo, damage_t const & damage, timing_t * timing) const {
+    gbm_bo_t ret = gbm_bo_t_DEFAULT ();
+
+    // Buffer objects held by the compositor, by serial, with the surface they are released to
+    static std::map <uint32_t, std::tuple <gbm_surface_t, gbm_bo_t>> _forwarded;
+
+    static uint32_t _serial = 0;
+
+    uint8_t const _id = static_cast <uint8_t> (1 + getpid () % 255);
+
+    uint32_t const _width = gbm_bo_get_width (bo);
+    uint32_t const _height = gbm_bo_get_height (bo);
+
+    // Zero copy, the compositor imports the dma-buf
+    int _prime = gbm_bo_get_fd (bo);
+
+    // The rendering of the frame, as tracked by the kernel, the compositor waits for it before use
+    int _fence = -1;
+
+#ifdef DMA_BUF_IOCTL_EXPORT_SYNC_FILE
+    struct dma_buf_export_sync_file _export = { DMA_BUF_SYNC_WRITE, -1 };
+
+    if (_prime >= 0 && ioctl (_prime, DMA_BUF_IOCTL_EXPORT_SYNC_FILE, &_export) == 0) {
+        _fence = _export.fd;
+    }
+#endif
+
+    // GL coordinates, as the compositor expects, the union of all rectangles, or else, the entire buffer
+    int32_t _x1 = 0, _y1 = 0, _x2 = static_cast <int32_t> (_width), _y2 = static_cast <int32_t> (_height);
+
+    if (damage.size () >= 4) {
+        _x1 = _y1 = std::numeric_limits <int32_t>::max ();
+        _x2 = _y2 = std::numeric_limits <int32_t>::min ();
+
+        for (size_t i = 0; i + 3 < damage.size (); i += 4) {
+            _x1 = std::min (_x1, damage [i]);
+            _y1 = std::min (_y1, damage [i + 1]);
+            _x2 = std::max (_x2, damage [i] + damage [i + 2]);
+            _y2 = std::max (_y2, damage [i + 1] + damage [i + 3]);
+        }
+    }
+
+    bool const _sent =    _prime >= 0
+                       && Client::SendBuffer (sock, _id, ++_serial, _width, _height, gbm_bo_get_stride (bo), gbm_bo_get_format (bo), gbm_bo_get_modifier (bo), _prime) != false
+                       && Client::SendDamage (sock, _id, _x1, _y1, _x2 - _x1, _y2 - _y1, _fence) != false;
+
+    // The compositor holds its own references
+    if (_prime >= 0) {
+        /* int */ close (_prime);
+    }
+
+    if (_fence >= 0) {
+        /* int */ close (_fence);
+    }
+
+    if (timing != nullptr) {
+        timing->latched = Now ();
+    }
+
+    if (_sent != false) {
+        _forwarded [_serial] = std::make_tuple (surface, bo);
+
+        Client::EVENT _event = Client::EVENT::NONE;
+
+        uint32_t _released = 0, _sequence = 0;
+        uint64_t _timestamp = 0;
+
+        int _release = -1;
+
+        // Released buffer objects may precede the presentation of this frame, there is no point in rendering frames that are never shown
+        do {
+            _event = Client::Receive (sock, ForwardTimeout (), _released, _sequence, _timestamp, _release);
+
+            auto _it = _event == Client::EVENT::RELEASED ? _forwarded.find (_released) : _forwarded.end ();
+
+            if (_it != _forwarded.end ()) {
+                gbm_surface_t const _surface = std::get <0> (_it->second);
+                gbm_bo_t const _bo = std::get <1> (_it->second);
+
+                /* iterator */ _forwarded.erase (_it);
+
+                if (_release >= 0) {
+                    bool _imported = false;
+
+#ifdef DMA_BUF_IOCTL_IMPORT_SYNC_FILE
+                    // The compositor reads, the next rendering into it waits, as the kernel tracks it, without blocking here
+                    int const _dmabuf = gbm_bo_get_fd (_bo);
+
+                    struct dma_buf_import_sync_file _import = { DMA_BUF_SYNC_READ, _release };
+
+                    _imported = _dmabuf >= 0 && ioctl (_dmabuf, DMA_BUF_IOCTL_IMPORT_SYNC_FILE, &_import) == 0;
+
+                    if (_dmabuf >= 0) {
+                        /* int */ close (_dmabuf);
+                    }
+#endif
+
+                    if (_imported != true) {
+                        // Wait for the signal, by the time of the release it has, most likely, already been given
+                        struct pollfd _signaled = { _release, POLLIN, 0 };
+
+                        if (poll (&_signaled, 1, ForwardTimeout ()) <= 0) {
+                            LOG (_2CSTR ("The release fence of frame "), _released, _2CSTR (" has not signaled in time"));
+                        }
+                    }
+                }
+
+                if (_surface == surface && ret == gbm_bo_t_DEFAULT ()) {
+                    ret = _bo;
+                }
+                else {
+                    // Superseded frames, and those of other surfaces, are given back here
+                    /* void */ gbm_surface_release_buffer (_surface, _bo);
+                }
+            }
+
+            if (_release >= 0) {
+                /* int */ close (_release);
+            }
+        } while (_event == Client::EVENT::RELEASED);
+
+        if (_event == Client::EVENT::PRESENTED && timing != nullptr) {
+            timing->presented = _timestamp * 1000;
+            timing->sequence = _sequence;
+        }
+        else if (_event == Client::EVENT::NONE) {
+            LOG (_2CSTR ("The compositor has not presented frame "), _serial, _2CSTR (" in time"));
+        }
+    }
+    else {
+        LOG (_2CSTR ("Unable to forward the buffer object to the compositor"));
+    }
+
+    return ret;
+}
+#endif
+
+uint64_t Platform::Now () {
+    struct timespec _now = { 0, 0 };
+
+    /* int */ clock_gettime (CLOCK_MONOTONIC, &_now);
+
+    return static_cast <uint64_t> (_now.tv_sec) * 1000000000 + static_cast <uint64_t> (_now.tv_nsec);
+}
+
+bool Platform::Capable (int fd, uint64_t capability) {
+    uint64_t _value = 0;
+
+    bool ret = drmGetCap (fd, capability, &_value) == 0 && _value != 0;
+
+    if (ret != true) {
+        LOG (_2CSTR ("DRM capability "), capability, _2CSTR (" unavailable"));
+    }
+
+    return ret;
+}
+
+bool Platform::DamagePlane (int fd, uint32_t crtc, uint32_t & plane, uint32_t & fb_id, uint32_t & clips) {
+    bool ret = false;
+
+    drmModePlaneResPtr _res = drmModeGetPlaneResources (fd);
+
+    if (_res != nullptr) {
+        for (uint32_t i = 0; i < _res->count_planes && ret != true; i++) {
+            drmModePlanePtr _plane = drmModeGetPlane (fd, _res->planes [i]);
+
+            if (_plane != nullptr) {
+                uint32_t _id = 0;
+                uint64_t _type = 0, _value = 0;
+
+                // Universal planes are exposed once atomic is enabled, the primary one is then bound to the active CRTC
+                ret =    _plane->crtc_id == crtc
+                      && Property (fd, _plane->plane_id, DRM_MODE_OBJECT_PLANE, "type", _id, _type) != false
+                      && _type == DRM_PLANE_TYPE_PRIMARY
+                      && Property (fd, _plane->plane_id, DRM_MODE_OBJECT_PLANE, "FB_ID", fb_id, _value) != false
+                      && Property (fd, _plane->plane_id, DRM_MODE_OBJECT_PLANE, "FB_DAMAGE_CLIPS", clips, _value) != false;
+
+                if (ret != false) {
+                    plane = _plane->plane_id;
+                }
+
+                drmModeFreePlane (_plane);
+            }
+        }
+
+        drmModeFreePlaneResources (_res);
+    }
+
+    if (ret != true) {
+        LOG (_2CSTR ("No primary plane accepting damage clips for crtc (id = "), crtc, _2CSTR (")"));
+    }
+
+    return ret;
+}
+
+int Platform::DamageFlip (int fd, uint32_t crtc, uint32_t fb, std::vector <struct drm_mode_rect> const & clips, void* data) {
+    using damage_plane_t = struct { bool supported; uint32_t plane; uint32_t fb_id; uint32_t clips_id; };
+
+    // Per device and CRTC, eg, a lease, or a re-opened device, driving a different CRTC
+    static std::map <std::pair <int, uint32_t>, damage_plane_t> _planes;
+
+    auto _it = _planes.find (std::make_pair (fd, crtc));
+
+    damage_plane_t _entry = { false, 0, 0, 0 };
+
+    if (_it == _planes.end ()) {
+        // Only clients that provide damage turn atomic on for the device
+        _entry.supported = drmSetClientCap (fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0 && DamagePlane (fd, crtc, _entry.plane, _entry.fb_id, _entry.clips_id) != false;
+
+        // The plane may not yet be bound to the CRTC, a failed lookup is retried on a next flip
+        if (_entry.supported != false) {
+            _it = _planes.emplace (std::make_pair (fd, crtc), _entry).first;
+        }
+    }
+
+    damage_plane_t const & _found = _it != _planes.end () ? _it->second : _entry;
+
+    bool const _supported = _found.supported;
+    uint32_t const _plane = _found.plane;
+    uint32_t const _fb_id = _found.fb_id;
+    uint32_t const _clips_id = _found.clips_id;
+
+    int ret = -ENOTSUP;
+
+    if (_supported != false && clips.empty () != true) {
+        uint32_t _blob = 0;
+
+        ret = drmModeCreatePropertyBlob (fd, clips.data (), clips.size () * sizeof (struct drm_mode_rect), &_blob);
+
+        if (ret == 0) {
+            drmModeAtomicReqPtr _req = drmModeAtomicAlloc ();
+
+            if (   _req != nullptr
+                && drmModeAtomicAddProperty (_req, _plane, _fb_id, fb) > 0
+                && drmModeAtomicAddProperty (_req, _plane, _clips_id, _blob) > 0
+               ) {
+                // The event is delivered to the page flip handler, as with a legacy page flip
+                ret = drmModeAtomicCommit (fd, _req, DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK, data);
+            }
+            else {
+                ret = -ENOMEM;
+            }
+
+            drmModeAtomicFree (_req);
+
+            // The committed state holds its own reference
+            /* int */ drmModeDestroyPropertyBlob (fd, _blob);
+        }
+    }
+
+    return ret;
+}
+
+bool Platform::CurrentMode (int fd, uint32_t crtc, drmModeModeInfo & mode) {
+    bool ret = false;
+
+    drmModeCrtcPtr _ptr = drmModeGetCrtc (fd, crtc);
+
+    if (_ptr != nullptr) {
+        ret = _ptr->mode_valid != 0;
+
+        if (ret != false) {
+            mode = _ptr->mode;
+        }
+
+        drmModeFreeCrtc (_ptr);
+    }
+
+    return ret;
+}
+
+#ifdef _MODE_MATCH
+bool Platform::MatchingMode (int fd, uint32_t connector, uint32_t width, uint32_t height, uint32_t vrefresh, drmModeModeInfo & mode) {
+    bool ret = false;
+
+    // Do not probe
+    drmModeConnectorPtr _con = drmModeGetConnectorCurrent (fd, connector);
+
+    if (_con != nullptr) {
+        for (int i = 0; i < _con->count_modes && ret != true; i++) {
+            drmModeModeInfo const & _mode = _con->modes [i];
+
+            // Interlaced modes have a different frame rate
+            ret =    _mode.hdisplay == width
+                  && _mode.vdisplay == height
+                  && _mode.vrefresh == vrefresh
+                  && (_mode.flags & DRM_MODE_FLAG_INTERLACE) == 0;
+
+            if (ret != false) {
+                mode = _mode;
+            }
+        }
+
+        drmModeFreeConnector (_con);
+    }
+
+    return ret;
+}
+#endif
+
+bool Platform::ScalingPlane (int fd, uint32_t crtc, uint64_t type, plane_t & plane) {
+    bool ret = false;
+
+    uint32_t const _pipe = Pipe (fd, crtc);
+
+    drmModePlaneResPtr _res = drmModeGetPlaneResources (fd);
+
+    if (_res != nullptr) {
+        for (uint32_t i = 0; i < _res->count_planes && ret != true; i++) {
+            drmModePlanePtr _plane = drmModeGetPlane (fd, _res->planes [i]);
+
+            if (_plane != nullptr) {
+                uint32_t _id = 0;
+                uint64_t _type = 0, _value = 0;
+
+                auto property = [fd, &_plane, &_value] (char const name [], uint32_t & id) -> bool {
+                    return Property (fd, _plane->plane_id, DRM_MODE_OBJECT_PLANE, name, id, _value);
+                };
+
+                ret =    (_plane->possible_crtcs & (1u << _pipe)) != 0
+                      && (_plane->crtc_id == crtc || (type != DRM_PLANE_TYPE_PRIMARY && _plane->crtc_id == 0))
+                      && Property (fd, _plane->plane_id, DRM_MODE_OBJECT_PLANE, "type", _id, _type) != false
+                      && _type == type
+                      && property ("FB_ID", plane.fb_id) != false
+                      && property ("CRTC_ID", plane.crtc_id) != false
+                      && property ("SRC_X", plane.src_x) != false
+                      && property ("SRC_Y", plane.src_y) != false
+                      && property ("SRC_W", plane.src_w) != false
+                      && property ("SRC_H", plane.src_h) != false
+                      && property ("CRTC_X", plane.crtc_x) != false
+                      && property ("CRTC_Y", plane.crtc_y) != false
+                      && property ("CRTC_W", plane.crtc_w) != false
+                      && property ("CRTC_H", plane.crtc_h) != false;
+
+                if (ret != false) {
+                    plane.id = _plane->plane_id;
+                }
+
+                drmModeFreePlane (_plane);
+            }
+        }
+
+        drmModeFreePlaneResources (_res);
+    }
+
+    return ret;
+}
+
+int Platform::ScaledFlip (int fd, uint32_t crtc, uint32_t fb, uint32_t width, uint32_t height, drmModeModeInfo const & mode, void* data) {
+    // The overlay plane shows the buffer, the primary plane is off
+    using scaling_planes_t = struct { bool supported; bool overlayable; bool overlaid; plane_t primary; plane_t overlay; };
+
+    // Per device and CRTC, eg, a lease, or a re-opened device, driving a different CRTC
+    static std::map <std::pair <int, uint32_t>, scaling_planes_t> _planes;
+
+    auto _it = _planes.find (std::make_pair (fd, crtc));
+
+    scaling_planes_t _entry = { false, false, false, plane_t (), plane_t () };
+
+    if (_it == _planes.end ()) {
+        // Only scaled scan outs turn atomic on for the device
+        _entry.supported = drmSetClientCap (fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0 && ScalingPlane (fd, crtc, DRM_PLANE_TYPE_PRIMARY, _entry.primary) != false;
+        _entry.overlayable = _entry.supported != false && ScalingPlane (fd, crtc, DRM_PLANE_TYPE_OVERLAY, _entry.overlay) != false;
+
+        // The primary plane may not yet be bound to the CRTC, a failed lookup is retried on a next flip
+        if (_entry.supported != false) {
+            _it = _planes.emplace (std::make_pair (fd, crtc), _entry).first;
+        }
+    }
+
+    scaling_planes_t & _found = _it != _planes.end () ? _it->second : _entry;
+
+    bool const _supported = _found.supported;
+    bool const _overlayable = _found.overlayable;
+    bool & _overlaid = _found.overlaid;
+
+    plane_t const & _primary = _found.primary;
+    plane_t const & _overlay = _found.overlay;
+
+    int ret = -ENOTSUP;
+
+    if (_supported != false && width > 0 && height > 0 && mode.hdisplay > 0 && mode.vdisplay > 0) {
+        // Fit, the aspect ratio is preserved, centered
+        uint32_t _w = mode.hdisplay;
+        uint32_t _h = mode.vdisplay;
+
+        if (static_cast <uint64_t> (width) * mode.vdisplay <= static_cast <uint64_t> (height) * mode.hdisplay) {
+            _w = static_cast <uint32_t> (static_cast <uint64_t> (width) * mode.vdisplay / height);
+        }
+        else {
+            _h = static_cast <uint32_t> (static_cast <uint64_t> (height) * mode.hdisplay / width);
+        }
+
+        uint32_t const _x = (mode.hdisplay - _w) / 2;
+        uint32_t const _y = (mode.vdisplay - _h) / 2;
+
+        auto place = [crtc, fb, width, height, _x, _y, _w, _h] (drmModeAtomicReqPtr req, plane_t const & plane) -> bool {
+            // Source coordinates are 16.16 fixed point
+            return    drmModeAtomicAddProperty (req, plane.id, plane.fb_id, fb) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.crtc_id, crtc) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.src_x, 0) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.src_y, 0) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.src_w, static_cast <uint64_t> (width) << 16) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.src_h, static_cast <uint64_t> (height) << 16) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.crtc_x, _x) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.crtc_y, _y) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.crtc_w, _w) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.crtc_h, _h) > 0;
+        };
+
+        auto disable = [] (drmModeAtomicReqPtr req, plane_t const & plane) -> bool {
+            return    drmModeAtomicAddProperty (req, plane.id, plane.fb_id, 0) > 0
+                   && drmModeAtomicAddProperty (req, plane.id, plane.crtc_id, 0) > 0;
+        };
 
-                                                break;
-                                            }
-                            case EBUSY  :
-                            default     :   {
-                                            // There is nothing to be done about it
-                                            }
-                        }
-                    }
-                }
+        // Some display engines cannot scale, or place, the primary plane, an overlay plane then takes over
+        for (uint8_t _attempt = 0; _attempt < 2 && (_attempt == 0 || ret == -EINVAL || ret == -ERANGE); _attempt++) {
+            bool const _use_overlay = _attempt > 0;
+
+            if (_use_overlay != false && _overlayable != true) {
+                break;
             }
-            else {
-                LOG (_2CSTR ("Unable to complete the scan out due to insufficient privileges"));
+
+            drmModeAtomicReqPtr _req = drmModeAtomicAlloc ();
+
+            bool const _added =    _req != nullptr
+                                && (_use_overlay != false ? place (_req, _overlay) && disable (_req, _primary)
+                                                          : place (_req, _primary) && (_overlaid != true || disable (_req, _overlay)));
+
+            // The event is delivered to the page flip handler, as with a legacy page flip
+            ret = _added != false ? drmModeAtomicCommit (fd, _req, DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK, data) : -ENOMEM;
+
+            drmModeAtomicFree (_req);
+
+            if (ret == 0) {
+                _overlaid = _use_overlay;
             }
         }
 
-        if (surface != gbm_surface_t_DEFAULT () && _bo.front () != gbm_bo_t_DEFAULT ()) {
-            /*void*/ gbm_surface_release_buffer (surface, _bo.front ());
-        }
-        else {
-            LOG (_2CSTR ("Unable to release a buffer"));
+        if (ret != 0) {
+            LOG (_2CSTR ("Unable to scan out a "), width, _2CSTR ("x"), height, _2CSTR (" buffer scaled to "), _w, _2CSTR ("x"), _h, _2CSTR (", error "), ret);
         }
+    }
 
-        if (surface != nullptr && gbm_surface_has_free_buffers (surface) <= 0) {
-            LOG (_2CSTR ("Insufficient free buffers left"));
+    return ret;
+}
+
+uint32_t Platform::Pipe (int fd, uint32_t crtc) {
+    uint32_t ret = 0;
+
+    drmModeResPtr _res = drmModeGetResources (fd);
+
+    if (_res != nullptr) {
+        for (int i = 0; i < _res->count_crtcs; i++) {
+            if (_res->crtcs [i] == crtc) {
+                ret = static_cast <uint32_t> (i);
+                break;
+            }
         }
-    }
-    else {
-        LOG (_2CSTR ( "Unable to complete the scan out due to missing support library"));
+
+        drmModeFreeResources (_res);
     }
 
-    return _bo.front () != gbm_bo_t_DEFAULT ();
+    return ret;
 }
 
 // Helpers
@@ -1297,6 +2779,66 @@ __eglMustCastToProperFunctionPointerType eglGetProcAddress (const char* procname
 
                 ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglCreatePlatformWindowSurfaceEXT );
             }
+
+            if (std::string (procname).compare ("eglSwapBuffersWithDamageKHR") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglSwapBuffersWithDamageKHR );
+            }
+
+            if (std::string (procname).compare ("eglSwapBuffersWithDamageEXT") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglSwapBuffersWithDamageEXT );
+            }
+
+            if (std::string (procname).compare ("eglGetNextFrameIdANDROID") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglGetNextFrameIdANDROID );
+            }
+
+            if (std::string (procname).compare ("eglGetFrameTimestampsANDROID") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglGetFrameTimestampsANDROID );
+            }
+
+            if (std::string (procname).compare ("eglGetFrameTimestampSupportedANDROID") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglGetFrameTimestampSupportedANDROID );
+            }
+
+            if (std::string (procname).compare ("eglGetCompositorTimingANDROID") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglGetCompositorTimingANDROID );
+            }
+
+            if (std::string (procname).compare ("eglGetCompositorTimingSupportedANDROID") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglGetCompositorTimingSupportedANDROID );
+            }
+
+            if (std::string (procname).compare ("eglPresentationTimeANDROID") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglPresentationTimeANDROID );
+            }
+
+            if (std::string (procname).compare ("eglSwapInterval") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglSwapInterval );
+            }
+
+            if (std::string (procname).compare ("eglMakeCurrent") == 0) {
+                LOG (_2CSTR ("Intercepting eglGetProcAddress and replacing it with a local function"));
+
+                ret = reinterpret_cast <__eglMustCastToProperFunctionPointerType> ( &eglMakeCurrent );
+            }
         }
 
         if (ret == nullptr) {
@@ -1385,6 +2927,162 @@ EGLSurface eglCreatePlatformWindowSurfaceEXT (EGLDisplay dpy, EGLConfig config,
     return ret;
 }
 
+EGLBoolean eglSwapBuffersWithDamageKHR (EGLDisplay dpy, EGLSurface surface, const EGLint* rects, EGLint n_rects) {
+    static void* (*_eglGetProcAddress) (const char*) = nullptr;
+
+    static EGLBoolean (*_eglSwapBuffersWithDamageKHR) (EGLDisplay, EGLSurface, const EGLint*, EGLint) = (lookup ("eglGetProcAddress", reinterpret_cast <uintptr_t&> (_eglGetProcAddress)) != true ? nullptr : reinterpret_cast <EGLBoolean (*) (EGLDisplay, EGLSurface, const EGLint*, EGLint)> ( _eglGetProcAddress("eglSwapBuffersWithDamageKHR") ));
+
+    static bool resolved = _eglSwapBuffersWithDamageKHR != nullptr;
+
+    EGLBoolean ret = EGL_FALSE;
+
+    if (resolved != false) {
+        LOG (_2CSTR ("Calling Real eglSwapBuffersWithDamageKHR"));
+
+        ret = _eglSwapBuffersWithDamageKHR (dpy, surface, rects, n_rects);
+
+        if (ret != EGL_FALSE && Platform::Instance ().ScanOut (surface, rects, n_rects) != false) {
+            // Nothing
+        }
+        else {
+            LOG (_2CSTR ("Not performing a platform enabled scan out"));
+        }
+    }
+    else {
+        LOG (_2CSTR ("Real eglSwapBuffersWithDamageKHR not found"));
+        assert (false);
+    }
+
+    return ret;
+}
+
+EGLBoolean eglSwapBuffersWithDamageEXT (EGLDisplay dpy, EGLSurface surface, const EGLint* rects, EGLint n_rects) {
+    static void* (*_eglGetProcAddress) (const char*) = nullptr;
+
+    static EGLBoolean (*_eglSwapBuffersWithDamageEXT) (EGLDisplay, EGLSurface, const EGLint*, EGLint) = (lookup ("eglGetProcAddress", reinterpret_cast <uintptr_t&> (_eglGetProcAddress)) != true ? nullptr : reinterpret_cast <EGLBoolean (*) (EGLDisplay, EGLSurface, const EGLint*, EGLint)> ( _eglGetProcAddress("eglSwapBuffersWithDamageEXT") ));
+
+    static bool resolved = _eglSwapBuffersWithDamageEXT != nullptr;
+
+    EGLBoolean ret = EGL_FALSE;
+
+    if (resolved != false) {
+        LOG (_2CSTR ("Calling Real eglSwapBuffersWithDamageEXT"));
+
+        ret = _eglSwapBuffersWithDamageEXT (dpy, surface, rects, n_rects);
+
+        if (ret != EGL_FALSE && Platform::Instance ().ScanOut (surface, rects, n_rects) != false) {
+            // Nothing
+        }
+        else {
+            LOG (_2CSTR ("Not performing a platform enabled scan out"));
+        }
+    }
+    else {
+        LOG (_2CSTR ("Real eglSwapBuffersWithDamageEXT not found"));
+        assert (false);
+    }
+
+    return ret;
+}
+
+EGLBoolean eglGetNextFrameIdANDROID (EGLDisplay dpy, EGLSurface surface, EGLuint64KHR* frameId) {
+    uint64_t _id = 0;
+
+    EGLBoolean ret = frameId != nullptr && Platform::Instance ().NextFrameId (dpy, surface, _id) != false ? EGL_TRUE : EGL_FALSE;
+
+    if (ret != EGL_FALSE) {
+        *frameId = _id;
+    }
+
+    return ret;
+}
+
+EGLBoolean eglGetFrameTimestampsANDROID (EGLDisplay dpy, EGLSurface surface, EGLuint64KHR frameId, EGLint numTimestamps, const EGLint* timestamps, EGLnsecsANDROID* values) {
+    Platform::timing_t _timing;
+
+    EGLBoolean ret = timestamps != nullptr && values != nullptr && Platform::Instance ().FrameTiming (dpy, surface, frameId, _timing) != false ? EGL_TRUE : EGL_FALSE;
+
+    // Unknown times are reported invalid, there are no pending ones as a swap returns after the flip
+    auto value = [] (uint64_t time) -> EGLnsecsANDROID {
+        return time > 0 ? static_cast <EGLnsecsANDROID> (time) : EGL_TIMESTAMP_INVALID_ANDROID;
+    };
+
+    for (EGLint i = 0; ret != EGL_FALSE && i < numTimestamps; i++) {
+        switch (timestamps [i]) {
+            case EGL_REQUESTED_PRESENT_TIME_ANDROID :   values [i] = value (_timing.requested > 0 ? _timing.requested : _timing.queued); break;
+            case EGL_COMPOSITION_LATCH_TIME_ANDROID :   values [i] = value (_timing.latched); break;
+            case EGL_DISPLAY_PRESENT_TIME_ANDROID   :   values [i] = value (_timing.presented); break;
+            default                                 :   LOG (_2CSTR ("Unsupported frame timestamp "), timestamps [i]);
+                                                        ret = EGL_FALSE;
+        }
+    }
+
+    return ret;
+}
+
+EGLBoolean eglGetFrameTimestampSupportedANDROID (EGLDisplay dpy, EGLSurface surface, EGLint timestamp) {
+    EGLBoolean ret = EGL_FALSE;
+
+    switch (timestamp) {
+        case EGL_REQUESTED_PRESENT_TIME_ANDROID :
+        case EGL_COMPOSITION_LATCH_TIME_ANDROID :
+        case EGL_DISPLAY_PRESENT_TIME_ANDROID   :   ret = Platform::Instance ().Tracked (dpy, surface) != false ? EGL_TRUE : EGL_FALSE; break;
+        default                                 :   ret = EGL_FALSE;
+    }
+
+    return ret;
+}
+
+EGLBoolean eglGetCompositorTimingANDROID (EGLDisplay dpy, EGLSurface surface, EGLint numTimestamps, const EGLint* names, EGLnsecsANDROID* values) {
+    uint64_t _deadline = 0, _interval = 0, _latency = 0;
+
+    EGLBoolean ret = names != nullptr && values != nullptr && Platform::Instance ().CompositorTiming (dpy, surface, _deadline, _interval, _latency) != false ? EGL_TRUE : EGL_FALSE;
+
+    for (EGLint i = 0; ret != EGL_FALSE && i < numTimestamps; i++) {
+        switch (names [i]) {
+            case EGL_COMPOSITE_DEADLINE_ANDROID             :   values [i] = static_cast <EGLnsecsANDROID> (_deadline); break;
+            case EGL_COMPOSITE_INTERVAL_ANDROID             :   values [i] = static_cast <EGLnsecsANDROID> (_interval); break;
+            case EGL_COMPOSITE_TO_PRESENT_LATENCY_ANDROID   :   values [i] = static_cast <EGLnsecsANDROID> (_latency); break;
+            default                                         :   ret = EGL_FALSE;
+        }
+    }
+
+    return ret;
+}
+
+EGLBoolean eglGetCompositorTimingSupportedANDROID (EGLDisplay dpy, EGLSurface surface, EGLint name) {
+    EGLBoolean ret = EGL_FALSE;
+
+    switch (name) {
+        case EGL_COMPOSITE_DEADLINE_ANDROID             :
+        case EGL_COMPOSITE_INTERVAL_ANDROID             :
+        case EGL_COMPOSITE_TO_PRESENT_LATENCY_ANDROID   :   ret = Platform::Instance ().Tracked (dpy, surface) != false ? EGL_TRUE : EGL_FALSE; break;
+        default                                         :   ret = EGL_FALSE;
+    }
+
+    return ret;
+}
+
+EGLBoolean eglPresentationTimeANDROID (EGLDisplay dpy, EGLSurface surface, EGLnsecsANDROID time) {
+    // Negative values are meaningless for CLOCK_MONOTONIC
+    return time >= 0 && Platform::Instance ().PresentationTime (dpy, surface, static_cast <uint64_t> (time)) != false ? EGL_TRUE : EGL_FALSE;
+}
+
+// libyxope support
+
+EGLBoolean yxopeGetFrameTiming (EGLDisplay dpy, EGLSurface surface, EGLuint64KHR id, struct yxope_frame_timing* timing) {
+    return timing != nullptr && Platform::Instance ().FrameTiming (dpy, surface, id, *timing) != false ? EGL_TRUE : EGL_FALSE;
+}
+
+EGLBoolean yxopeGetLatestFrameTiming (EGLDisplay dpy, EGLSurface surface, struct yxope_frame_timing* timing) {
+    uint64_t _id = 0;
+
+    return    timing != nullptr
+           && Platform::Instance ().NextFrameId (dpy, surface, _id) != false
+           && _id > 0
+           && Platform::Instance ().FrameTiming (dpy, surface, _id - 1, *timing) != false ? EGL_TRUE : EGL_FALSE;
+}
+
 // EGL 1.4 support
 
 EGLDisplay eglGetDisplay (EGLNativeDisplayType display_id) {
@@ -1702,6 +3400,120 @@ EGLBoolean eglSwapBuffers (EGLDisplay dpy, EGLSurface surface) {
     return ret;
 }
 
+EGLBoolean eglSwapInterval (EGLDisplay dpy, EGLint interval) {
+    static EGLBoolean (*_eglSwapInterval) (EGLDisplay, EGLint) = nullptr;
+
+    static bool resolved = lookup ("eglSwapInterval", reinterpret_cast <uintptr_t&> (_eglSwapInterval));
+
+    EGLBoolean ret = EGL_FALSE;
+
+    if (resolved != false) {
+        LOG (_2CSTR ("Calling Real eglSwapInterval"));
+
+        // The implementation does not throttle scan outs of this platform, but keep its (error) state consistent
+        ret = _eglSwapInterval (dpy, interval);
+
+        // Applies to the draw surface bound to the current context
+        EGLSurface _surface = eglGetCurrentSurface (EGL_DRAW);
+
+        if (ret != EGL_FALSE && _surface != EGL_NO_SURFACE) {
+            if (Platform::Instance ().SwapInterval (dpy, _surface, interval) != true) {
+                // Not a surface of this platform
+                LOG (_2CSTR ("Untracked EGLSurface"));
+            }
+        }
+    }
+    else {
+        LOG (_2CSTR ("Real eglSwapInterval not found"));
+        assert (false);
+    }
+
+    return ret;
+}
+
+const char* eglQueryString (EGLDisplay dpy, EGLint name) {
+    static const char* (*_eglQueryString) (EGLDisplay, EGLint) = nullptr;
+
+    static bool resolved = lookup ("eglQueryString", reinterpret_cast <uintptr_t&> (_eglQueryString));
+
+    const char* ret = nullptr;
+
+    if (resolved != false) {
+        LOG (_2CSTR ("Calling Real eglQueryString"));
+
+        ret = _eglQueryString (dpy, name);
+
+        if (ret != nullptr && name == EGL_EXTENSIONS && dpy != EGL_NO_DISPLAY) {
+            // Advertise the emulated extensions
+            ret = Platform::Instance ().Extensions (dpy, ret);
+        }
+    }
+    else {
+        LOG (_2CSTR ("Real eglQueryString not found"));
+        assert (false);
+    }
+
+    return ret;
+}
+
+EGLBoolean eglSurfaceAttrib (EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint value) {
+    static EGLBoolean (*_eglSurfaceAttrib) (EGLDisplay, EGLSurface, EGLint, EGLint) = nullptr;
+
+    static bool resolved = lookup ("eglSurfaceAttrib", reinterpret_cast <uintptr_t&> (_eglSurfaceAttrib));
+
+    EGLBoolean ret = EGL_FALSE;
+
+    if (attribute == EGL_TIMESTAMPS_ANDROID && Platform::Instance ().Tracked (dpy, surface) != false) {
+        // Unknown to the implementation, timing is always collected
+        ret = EGL_TRUE;
+    }
+    else if (resolved != false) {
+        LOG (_2CSTR ("Calling Real eglSurfaceAttrib"));
+
+        ret = _eglSurfaceAttrib (dpy, surface, attribute, value);
+
+        if (ret != EGL_FALSE && attribute == EGL_RENDER_BUFFER) {
+            // Not necessarily a surface of this platform
+            /* bool */ Platform::Instance ().RenderBuffer (dpy, surface, value);
+        }
+    }
+    else {
+        LOG (_2CSTR ("Real eglSurfaceAttrib not found"));
+        assert (false);
+    }
+
+    return ret;
+}
+
+EGLBoolean eglMakeCurrent (EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx) {
+    static EGLBoolean (*_eglMakeCurrent) (EGLDisplay, EGLSurface, EGLSurface, EGLContext) = nullptr;
+
+    static bool resolved = lookup ("eglMakeCurrent", reinterpret_cast <uintptr_t&> (_eglMakeCurrent));
+
+    EGLBoolean ret = EGL_FALSE;
+
+    if (resolved != false) {
+#ifdef _MESADEBUG
+        LOG (_2CSTR ("Calling Real eglMakeCurrent for surface (draw/read) "), draw, _2CSTR (" / "), read, _2CSTR (" on thread "), syscall (SYS_gettid));
+#else
+        LOG (_2CSTR ("Calling Real eglMakeCurrent"));
+#endif
+
+        ret = _eglMakeCurrent (dpy, draw, read, ctx);
+
+        if (ret != EGL_FALSE) {
+            // Swaps of the draw surface on this thread find their context without a lookup
+            /* bool */ Platform::Instance ().MakeCurrent (dpy, draw);
+        }
+    }
+    else {
+        LOG (_2CSTR ("Real eglMakeCurrent not found"));
+        assert (false);
+    }
+
+    return ret;
+}
+
 #ifdef _MESADEBUG
 EGLContext eglCreateContext (EGLDisplay dpy, EGLConfig config, EGLContext share_context, const EGLint* attrib_list) {
     static EGLContext (*_eglCreateContext) (EGLDisplay, EGLConfig, EGLContext, const EGLint*) = nullptr;
@@ -1811,25 +3623,6 @@ EGLSurface eglCreatePbufferSurface (EGLDisplay dpy, EGLConfig config, const EGLi
     return ret;
 }
 
-EGLBoolean eglMakeCurrent (EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx) {
-    static EGLBoolean (*_eglMakeCurrent) (EGLDisplay, EGLSurface, EGLSurface, EGLContext) = nullptr;
-
-    static bool resolved = lookup ("eglMakeCurrent", reinterpret_cast <uintptr_t&> (_eglMakeCurrent));
-
-    EGLBoolean ret = EGL_FALSE;
-
-    if (resolved != false) {
-        LOG (_2CSTR ("Calling Real eglMakeCurrent for surface (draw/read) "), draw, _2CSTR (" / "), read, _2CSTR (" on thread "), syscall (SYS_gettid));
-
-         ret = _eglMakeCurrent (dpy, draw, read, ctx);
-    }
-    else {
-        LOG (_2CSTR ("Real eglMakeCurrent not found"));
-        assert (false);
-    }
-
-    return ret;
-}
 #endif
 
 // EGL 1.5 support
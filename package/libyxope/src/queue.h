@@ -153,7 +153,8 @@ class DynamicSizedQueue : public IQueue <T> {
         T _pop () {
             assert (size () > 0);
 
-            T& _ret = _queue.front ();
+            // A copy, pop destroys the element
+            T _ret = _queue.front ();
 
             /* void */ _queue.pop ();
 
@@ -0,0 +1,634 @@
+/*
+Copyright (C) 2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+With _MOCK, a functional mock of libdrm, see mock.h, otherwise empty
+A single HDMI connector, encoder and CRTC, without planes or atomic mode setting, of which the vertical blanks are the expirations of a timer
+*/
+
+#ifdef _MOCK
+
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "mock.h"
+
+namespace {
+
+    class Display {
+        public :
+
+            static constexpr uint32_t Crtc () { return 31; }
+            static constexpr uint32_t Encoder () { return 32; }
+            static constexpr uint32_t Connector () { return 33; }
+
+            // CEA-861 1080p timings, the pixel clock scaled to the refresh rate
+            static drmModeModeInfo Mode (uint32_t refresh) {
+                drmModeModeInfo ret;
+
+                memset (&ret, 0, sizeof (ret));
+
+                ret.hdisplay = Mock::Width ();
+                ret.hsync_start = 2008;
+                ret.hsync_end = 2052;
+                ret.htotal = 2200;
+                ret.vdisplay = Mock::Height ();
+                ret.vsync_start = 1084;
+                ret.vsync_end = 1089;
+                ret.vtotal = 1125;
+                ret.vrefresh = refresh;
+                ret.clock = static_cast <uint32_t> (static_cast <uint64_t> (ret.htotal) * ret.vtotal * refresh / 1000);
+                ret.type = DRM_MODE_TYPE_PREFERRED;
+
+                snprintf (ret.name, sizeof (ret.name), "%ux%u", ret.hdisplay, ret.vdisplay);
+
+                return ret;
+            }
+
+            // CLOCK_MONOTONIC, in nanoseconds
+            static uint64_t Now () {
+                struct timespec _now = { 0, 0 };
+
+                /* int */ clock_gettime (CLOCK_MONOTONIC, &_now);
+
+                return static_cast <uint64_t> (_now.tv_sec) * 1000000000 + static_cast <uint64_t> (_now.tv_nsec);
+            }
+
+            // The timer is the file descriptor of the device
+            static int Open () {
+                uint32_t const _refresh = Mock::Value (Mock::RefreshVariable (), Mock::DefaultRefresh ());
+
+                uint64_t const _period = 1000000000 / _refresh;
+
+                int ret = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+
+                uint64_t const _start = Now ();
+
+                struct itimerspec const _spec = {   { static_cast <time_t> (_period / 1000000000), static_cast <long> (_period % 1000000000) }
+                                                  , { static_cast <time_t> ((_start + _period) / 1000000000), static_cast <long> ((_start + _period) % 1000000000) }
+                                                };
+
+                if (ret >= 0 && timerfd_settime (ret, TFD_TIMER_ABSTIME, &_spec, nullptr) == 0) {
+                    std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                    _devices [ret] = { _refresh, _start, _period, 0, false, 0, 0, nullptr, false, 0 };
+                }
+                else if (ret >= 0) {
+                    /* int */ close (ret);
+
+                    ret = -1;
+                }
+
+                return ret;
+            }
+
+            static bool Close (int fd) {
+                std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                bool ret = _devices.erase (fd) > 0;
+
+                if (ret != false) {
+                    /* int */ close (fd);
+                }
+
+                return ret;
+            }
+
+            static bool Valid (int fd) {
+                std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                return _devices.find (fd) != _devices.end ();
+            }
+
+            static uint32_t Refresh (int fd) {
+                std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                auto _it = _devices.find (fd);
+
+                return _it != _devices.end () ? _it->second.refresh : 0;
+            }
+
+            // The most recent vertical blank, its sequence and timestamp
+            static bool Sequence (int fd, uint64_t & sequence, uint64_t & ns) {
+                std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                auto _it = _devices.find (fd);
+
+                bool ret = _it != _devices.end ();
+
+                if (ret != false) {
+                    sequence = (Now () - _it->second.start) / _it->second.period;
+                    ns = _it->second.start + sequence * _it->second.period;
+                }
+
+                return ret;
+            }
+
+            // Until the vertical blank of the given sequence
+            static bool Wait (int fd, uint64_t sequence, uint64_t & ns) {
+                uint64_t _start = 0, _period = 0;
+
+                {
+                    std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                    auto _it = _devices.find (fd);
+
+                    if (_it != _devices.end ()) {
+                        _start = _it->second.start;
+                        _period = _it->second.period;
+                    }
+                }
+
+                ns = _start + sequence * _period;
+
+                struct timespec const _deadline = { static_cast <time_t> (ns / 1000000000), static_cast <long> (ns % 1000000000) };
+
+                while (_period > 0 && clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &_deadline, nullptr) == EINTR) {
+                }
+
+                return _period > 0;
+            }
+
+            // The framebuffer scanned out, set by a mode set, updated by a completed flip, 0 before the first mode set
+            static int Set (int fd, uint32_t fb) {
+                std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                auto _it = _devices.find (fd);
+
+                int ret = _it != _devices.end () ? 0 : -ENODEV;
+
+                if (ret == 0) {
+                    _it->second.fb = fb;
+                }
+
+                return ret;
+            }
+
+            // Completes at the first vertical blank after its submission, one flip at a time
+            static int Flip (int fd, uint32_t fb, bool event, void * data) {
+                std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                auto _it = _devices.find (fd);
+
+                int ret = _it == _devices.end () ? -ENODEV : _it->second.fb == 0 ? -EINVAL : _it->second.pending != false ? -EBUSY : 0;
+
+                if (ret == 0) {
+                    _it->second.pending = true;
+                    _it->second.after = (Now () - _it->second.start) / _it->second.period;
+                    _it->second.next = fb;
+                    _it->second.data = data;
+                    _it->second.event = event;
+                }
+
+                return ret;
+            }
+
+            static uint32_t Framebuffer (int fd) {
+                std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                auto _it = _devices.find (fd);
+
+                return _it != _devices.end () ? ++(_it->second.fbs) : 0;
+            }
+
+            // Vertical blanks that have passed complete a pending flip, with an event if requested
+            static int Handle (int fd, drmEventContextPtr context) {
+                uint64_t _expirations = 0;
+
+                ssize_t const _size = read (fd, &_expirations, sizeof (_expirations));
+
+                int ret = _size == static_cast <ssize_t> (sizeof (_expirations)) || errno == EAGAIN ? 0 : -1;
+
+                bool _event = false;
+
+                void * _data = nullptr;
+
+                uint64_t _sequence = 0, _ns = 0;
+
+                if (_size == static_cast <ssize_t> (sizeof (_expirations)) && _expirations > 0 && Sequence (fd, _sequence, _ns) != false) {
+                    std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+                    auto _it = _devices.find (fd);
+
+                    // Expirations not yet read may precede the submission
+                    if (_it != _devices.end () && _it->second.pending != false && _sequence > _it->second.after) {
+                        _it->second.pending = false;
+                        _it->second.fb = _it->second.next;
+
+                        _event = _it->second.event;
+                        _data = _it->second.data;
+                    }
+                }
+
+                // Without holding the lock, the handler may call back
+                if (_event != false && context != nullptr && context->version >= 2 && context->page_flip_handler != nullptr) {
+                    context->page_flip_handler (fd, static_cast <unsigned int> (_sequence), static_cast <unsigned int> (_ns / 1000000000), static_cast <unsigned int> ((_ns % 1000000000) / 1000), _data);
+                }
+
+                return ret;
+            }
+
+        private :
+
+            // Nanoseconds for start, the first vertical blank minus one period, and period
+            // The pending flip, the sequence of the vertical blank preceding its submission, its framebuffer and event data
+            using device_t = struct { uint32_t refresh; uint64_t start; uint64_t period; uint32_t fb; bool pending; uint64_t after; uint32_t next; void * data; bool event; uint32_t fbs; };
+
+            static std::mutex _mutex;
+
+            static std::map <int, device_t> _devices;
+    };
+
+    std::mutex Display::_mutex;
+
+    std::map <int, Display::device_t> Display::_devices;
+
+    template <typename T>
+    T * Allocate (size_t count = 1) {
+        return reinterpret_cast <T *> (calloc (count, sizeof (T)));
+    }
+
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int drmAvailable (void) {
+    return 1;
+}
+
+// Any name, the device is the mock
+int drmOpen (const char * /* name */, const char * /* busid */) {
+    return Display::Open ();
+}
+
+int drmClose (int fd) {
+    return Display::Close (fd) != false ? 0 : -1;
+}
+
+int drmIsMaster (int fd) {
+    return Display::Valid (fd) != false ? 1 : 0;
+}
+
+int drmSetMaster (int fd) {
+    return Display::Valid (fd) != false ? 0 : -1;
+}
+
+int drmDropMaster (int fd) {
+    return Display::Valid (fd) != false ? 0 : -1;
+}
+
+int drmGetCap (int fd, uint64_t capability, uint64_t * value) {
+    int ret = Display::Valid (fd) != false && value != nullptr ? 0 : -EINVAL;
+
+    if (ret == 0) {
+        // Neither asynchronous nor targeted flips
+        *value = capability == DRM_CAP_TIMESTAMP_MONOTONIC || capability == DRM_CAP_DUMB_BUFFER ? 1 : 0;
+    }
+
+    return ret;
+}
+
+int drmSetClientCap (int /* fd */, uint64_t /* capability */, uint64_t /* value */) {
+    // No universal planes, no atomic mode setting
+    errno = EOPNOTSUPP;
+
+    return -1;
+}
+
+int drmIoctl (int fd, unsigned long /* request */, void * /* arg */) {
+    return Display::Valid (fd) != false ? 0 : -1;
+}
+
+int drmPrimeFDToHandle (int /* fd */, int /* prime_fd */, uint32_t * /* handle */) {
+    errno = ENOSYS;
+
+    return -1;
+}
+
+int drmPrimeHandleToFD (int /* fd */, uint32_t /* handle */, uint32_t /* flags */, int * /* prime_fd */) {
+    errno = ENOSYS;
+
+    return -1;
+}
+
+int drmHandleEvent (int fd, drmEventContextPtr evctx) {
+    return Display::Handle (fd, evctx);
+}
+
+int drmWaitVBlank (int fd, drmVBlankPtr vbl) {
+    uint64_t _sequence = 0, _ns = 0;
+
+    // Blocking waits only
+    int ret = vbl != nullptr && (vbl->request.type & DRM_VBLANK_EVENT) == 0 && Display::Sequence (fd, _sequence, _ns) != false ? 0 : -1;
+
+    if (ret == 0) {
+        uint64_t const _target = (vbl->request.type & DRM_VBLANK_RELATIVE) != 0 ? _sequence + vbl->request.sequence : vbl->request.sequence;
+
+        if (_target > _sequence) {
+            /* bool */ Display::Wait (fd, _target, _ns);
+
+            _sequence = _target;
+        }
+
+        vbl->reply.sequence = static_cast <unsigned int> (_sequence);
+        vbl->reply.tval_sec = static_cast <long> (_ns / 1000000000);
+        vbl->reply.tval_usec = static_cast <long> ((_ns % 1000000000) / 1000);
+    }
+    else {
+        errno = EINVAL;
+    }
+
+    return ret;
+}
+
+int drmCrtcGetSequence (int fd, uint32_t crtcId, uint64_t * sequence, uint64_t * ns) {
+    uint64_t _sequence = 0, _ns = 0;
+
+    int ret = crtcId == Display::Crtc () && Display::Sequence (fd, _sequence, _ns) != false ? 0 : -EINVAL;
+
+    if (ret == 0) {
+        if (sequence != nullptr) {
+            *sequence = _sequence;
+        }
+
+        if (ns != nullptr) {
+            *ns = _ns;
+        }
+    }
+
+    return ret;
+}
+
+drmModeResPtr drmModeGetResources (int fd) {
+    drmModeResPtr ret = Display::Valid (fd) != false ? Allocate <drmModeRes> () : nullptr;
+
+    if (ret != nullptr) {
+        ret->count_crtcs = 1;
+        ret->crtcs = Allocate <uint32_t> ();
+        ret->crtcs [0] = Display::Crtc ();
+
+        ret->count_encoders = 1;
+        ret->encoders = Allocate <uint32_t> ();
+        ret->encoders [0] = Display::Encoder ();
+
+        ret->count_connectors = 1;
+        ret->connectors = Allocate <uint32_t> ();
+        ret->connectors [0] = Display::Connector ();
+
+        ret->max_width = Mock::Width ();
+        ret->max_height = Mock::Height ();
+    }
+
+    return ret;
+}
+
+void drmModeFreeResources (drmModeResPtr ptr) {
+    if (ptr != nullptr) {
+        free (ptr->fbs);
+        free (ptr->crtcs);
+        free (ptr->encoders);
+        free (ptr->connectors);
+    }
+
+    free (ptr);
+}
+
+drmModeConnectorPtr drmModeGetConnector (int fd, uint32_t connectorId) {
+    drmModeConnectorPtr ret = connectorId == Display::Connector () && Display::Valid (fd) != false ? Allocate <drmModeConnector> () : nullptr;
+
+    if (ret != nullptr) {
+        ret->connector_id = connectorId;
+        ret->encoder_id = Display::Encoder ();
+        ret->connector_type = DRM_MODE_CONNECTOR_HDMIA;
+        ret->connector_type_id = 1;
+        ret->connection = DRM_MODE_CONNECTED;
+
+        ret->count_modes = 1;
+        ret->modes = Allocate <drmModeModeInfo> ();
+        ret->modes [0] = Display::Mode (Display::Refresh (fd));
+
+        ret->count_encoders = 1;
+        ret->encoders = Allocate <uint32_t> ();
+        ret->encoders [0] = Display::Encoder ();
+    }
+
+    return ret;
+}
+
+drmModeConnectorPtr drmModeGetConnectorCurrent (int fd, uint32_t connector_id) {
+    return drmModeGetConnector (fd, connector_id);
+}
+
+void drmModeFreeConnector (drmModeConnectorPtr ptr) {
+    if (ptr != nullptr) {
+        free (ptr->modes);
+        free (ptr->props);
+        free (ptr->prop_values);
+        free (ptr->encoders);
+    }
+
+    free (ptr);
+}
+
+drmModeEncoderPtr drmModeGetEncoder (int fd, uint32_t encoder_id) {
+    drmModeEncoderPtr ret = encoder_id == Display::Encoder () && Display::Valid (fd) != false ? Allocate <drmModeEncoder> () : nullptr;
+
+    if (ret != nullptr) {
+        ret->encoder_id = encoder_id;
+        ret->crtc_id = Display::Crtc ();
+        ret->possible_crtcs = 1;
+    }
+
+    return ret;
+}
+
+void drmModeFreeEncoder (drmModeEncoderPtr ptr) {
+    free (ptr);
+}
+
+drmModeCrtcPtr drmModeGetCrtc (int fd, uint32_t crtcId) {
+    drmModeCrtcPtr ret = crtcId == Display::Crtc () && Display::Valid (fd) != false ? Allocate <drmModeCrtc> () : nullptr;
+
+    if (ret != nullptr) {
+        // As left by a console, the mode is set
+        ret->crtc_id = crtcId;
+        ret->width = Mock::Width ();
+        ret->height = Mock::Height ();
+        ret->mode_valid = 1;
+        ret->mode = Display::Mode (Display::Refresh (fd));
+    }
+
+    return ret;
+}
+
+void drmModeFreeCrtc (drmModeCrtcPtr ptr) {
+    free (ptr);
+}
+
+int drmModeSetCrtc (int fd, uint32_t crtcId, uint32_t bufferId, uint32_t /* x */, uint32_t /* y */, uint32_t * /* connectors */, int /* count */, drmModeModeInfoPtr /* mode */) {
+    return crtcId == Display::Crtc () ? Display::Set (fd, bufferId) : -EINVAL;
+}
+
+int drmModeAddFB (int fd, uint32_t width, uint32_t height, uint8_t /* depth */, uint8_t /* bpp */, uint32_t /* pitch */, uint32_t bo_handle, uint32_t * buf_id) {
+    uint32_t const _fb = width > 0 && height > 0 && bo_handle != 0 && buf_id != nullptr ? Display::Framebuffer (fd) : 0;
+
+    if (_fb != 0) {
+        *buf_id = _fb;
+    }
+
+    return _fb != 0 ? 0 : -EINVAL;
+}
+
+int drmModeAddFB2 (int fd, uint32_t width, uint32_t height, uint32_t /* pixel_format */, const uint32_t bo_handles [4], const uint32_t pitches [4], const uint32_t /* offsets */ [4], uint32_t * buf_id, uint32_t /* flags */) {
+    return drmModeAddFB (fd, width, height, 24, 32, pitches [0], bo_handles [0], buf_id);
+}
+
+int drmModeRmFB (int fd, uint32_t bufferId) {
+    return bufferId != 0 && Display::Valid (fd) != false ? 0 : -EINVAL;
+}
+
+int drmModePageFlip (int fd, uint32_t crtc_id, uint32_t fb_id, uint32_t flags, void * user_data) {
+    return crtc_id == Display::Crtc () && fb_id != 0 && (flags & DRM_MODE_PAGE_FLIP_ASYNC) == 0 ? Display::Flip (fd, fb_id, (flags & DRM_MODE_PAGE_FLIP_EVENT) != 0, user_data) : -EINVAL;
+}
+
+int drmModePageFlipTarget (int /* fd */, uint32_t /* crtc_id */, uint32_t /* fb_id */, uint32_t /* flags */, void * /* user_data */, uint32_t /* target_vblank */) {
+    // DRM_CAP_PAGE_FLIP_TARGET is not reported
+    return -EINVAL;
+}
+
+// No planes, properties or atomic mode setting, as for a driver without universal planes
+
+drmModePlaneResPtr drmModeGetPlaneResources (int /* fd */) {
+    errno = EINVAL;
+
+    return nullptr;
+}
+
+void drmModeFreePlaneResources (drmModePlaneResPtr ptr) {
+    if (ptr != nullptr) {
+        free (ptr->planes);
+    }
+
+    free (ptr);
+}
+
+drmModePlanePtr drmModeGetPlane (int /* fd */, uint32_t /* plane_id */) {
+    errno = ENOENT;
+
+    return nullptr;
+}
+
+void drmModeFreePlane (drmModePlanePtr ptr) {
+    if (ptr != nullptr) {
+        free (ptr->formats);
+    }
+
+    free (ptr);
+}
+
+drmModeObjectPropertiesPtr drmModeObjectGetProperties (int /* fd */, uint32_t /* object_id */, uint32_t /* object_type */) {
+    errno = ENOENT;
+
+    return nullptr;
+}
+
+void drmModeFreeObjectProperties (drmModeObjectPropertiesPtr ptr) {
+    if (ptr != nullptr) {
+        free (ptr->props);
+        free (ptr->prop_values);
+    }
+
+    free (ptr);
+}
+
+drmModePropertyPtr drmModeGetProperty (int /* fd */, uint32_t /* propertyId */) {
+    errno = ENOENT;
+
+    return nullptr;
+}
+
+void drmModeFreeProperty (drmModePropertyPtr ptr) {
+    if (ptr != nullptr) {
+        free (ptr->values);
+        free (ptr->enums);
+        free (ptr->blob_ids);
+    }
+
+    free (ptr);
+}
+
+int drmModeObjectSetProperty (int /* fd */, uint32_t /* object_id */, uint32_t /* object_type */, uint32_t /* property_id */, uint64_t /* value */) {
+    return -ENOENT;
+}
+
+int drmModeCreatePropertyBlob (int /* fd */, const void * /* data */, size_t /* size */, uint32_t * /* id */) {
+    return -EOPNOTSUPP;
+}
+
+int drmModeDestroyPropertyBlob (int /* fd */, uint32_t /* id */) {
+    return -EOPNOTSUPP;
+}
+
+drmModeAtomicReqPtr drmModeAtomicAlloc (void) {
+    return nullptr;
+}
+
+void drmModeAtomicFree (drmModeAtomicReqPtr /* req */) {
+}
+
+int drmModeAtomicAddProperty (drmModeAtomicReqPtr /* req */, uint32_t /* object_id */, uint32_t /* property_id */, uint64_t /* value */) {
+    return -EINVAL;
+}
+
+int drmModeAtomicCommit (int /* fd */, drmModeAtomicReqPtr /* req */, uint32_t /* flags */, void * /* user_data */) {
+    return -EOPNOTSUPP;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
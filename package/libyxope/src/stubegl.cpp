@@ -23,5 +23,508 @@ THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-Deiberately left empty
+Link stub of libRealEGL.so, or, with _MOCK, a functional mock of libEGL for the gbm platform, see mock.h
+Rendering completes instantly, a swap makes a free buffer of the native surface the front buffer
 */
+
+#ifdef _MOCK
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <gbm.h>
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <dlfcn.h>
+#undef _GNU_SOURCE
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "mock.h"
+
+#ifndef EGL_PLATFORM_GBM_KHR
+#define EGL_PLATFORM_GBM_KHR 0x31D7
+#endif
+
+#ifndef EGL_PLATFORM_GBM_MESA
+#define EGL_PLATFORM_GBM_MESA 0x31D7
+#endif
+
+namespace {
+
+    using display_t = struct { struct gbm_device * native; bool initialized; };
+    using surface_t = struct { EGLDisplay display; struct gbm_surface * native; };
+    using context_t = struct { EGLDisplay display; };
+
+    // Of the calling thread
+    using state_t = struct { EGLint error; EGLenum api; EGLDisplay display; EGLSurface draw; EGLSurface read; EGLContext context; };
+
+    thread_local state_t _state = { EGL_SUCCESS, EGL_OPENGL_ES_API, EGL_NO_DISPLAY, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT };
+
+    std::mutex _mutex;
+
+    // One display per native display, as EGL requires
+    std::map <struct gbm_device *, display_t *> _displays;
+
+    std::set <EGLSurface> _surfaces;
+    std::set <EGLContext> _contexts;
+
+    // The single configuration, XRGB8888 window surfaces for OpenGL ES
+    EGLConfig const _config = reinterpret_cast <EGLConfig> (static_cast <uintptr_t> (1));
+
+    EGLBoolean Result (EGLint error) {
+        _state.error = error;
+
+        return error == EGL_SUCCESS ? EGL_TRUE : EGL_FALSE;
+    }
+
+    // Initialized displays only
+    bool Valid (EGLDisplay dpy) {
+        std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+        bool ret = false;
+
+        for (auto const & _display : _displays) {
+            if (reinterpret_cast <EGLDisplay> (_display.second) == dpy) {
+                ret = _display.second->initialized;
+                break;
+            }
+        }
+
+        return ret;
+    }
+
+    bool Valid (EGLDisplay dpy, EGLSurface surface) {
+        std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+        return _surfaces.find (surface) != _surfaces.end () && reinterpret_cast <surface_t *> (surface)->display == dpy;
+    }
+
+    EGLDisplay Display (struct gbm_device * native) {
+        EGLDisplay ret = EGL_NO_DISPLAY;
+
+        if (native != nullptr) {
+            std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+            display_t * & _display = _displays [native];
+
+            if (_display == nullptr) {
+                _display = new display_t { native, false };
+            }
+
+            ret = reinterpret_cast <EGLDisplay> (_display);
+        }
+
+        _state.error = ret != EGL_NO_DISPLAY ? EGL_SUCCESS : EGL_BAD_PARAMETER;
+
+        return ret;
+    }
+
+    EGLSurface Surface (EGLDisplay dpy, EGLConfig config, void * native) {
+        EGLSurface ret = EGL_NO_SURFACE;
+
+        if (Valid (dpy) != true) {
+            _state.error = EGL_BAD_DISPLAY;
+        }
+        else if (config != _config) {
+            _state.error = EGL_BAD_CONFIG;
+        }
+        else if (native == nullptr) {
+            _state.error = EGL_BAD_NATIVE_WINDOW;
+        }
+        else {
+            std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+            ret = reinterpret_cast <EGLSurface> (new surface_t { dpy, reinterpret_cast <struct gbm_surface *> (native) });
+
+            /* pair */ _surfaces.insert (ret);
+
+            _state.error = EGL_SUCCESS;
+        }
+
+        return ret;
+    }
+
+    EGLBoolean Swap (EGLDisplay dpy, EGLSurface surface) {
+        EGLint _error = EGL_SUCCESS;
+
+        if (Valid (dpy) != true) {
+            _error = EGL_BAD_DISPLAY;
+        }
+        else if (Valid (dpy, surface) != true) {
+            _error = EGL_BAD_SURFACE;
+        }
+        else if (Mock::Render (reinterpret_cast <surface_t *> (surface)->native) != true) {
+            // All buffers are locked
+            _error = EGL_BAD_ALLOC;
+        }
+
+        return Result (_error);
+    }
+
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+EGLint eglGetError (void) {
+    EGLint ret = _state.error;
+
+    _state.error = EGL_SUCCESS;
+
+    return ret;
+}
+
+EGLDisplay eglGetDisplay (EGLNativeDisplayType display_id) {
+    return Display (reinterpret_cast <struct gbm_device *> (display_id));
+}
+
+EGLDisplay eglGetPlatformDisplay (EGLenum platform, void * native_display, const EGLAttrib * /* attrib_list */) {
+    return platform == EGL_PLATFORM_GBM_KHR || platform == EGL_PLATFORM_GBM_MESA ? Display (reinterpret_cast <struct gbm_device *> (native_display)) : EGL_NO_DISPLAY;
+}
+
+EGLDisplay eglGetPlatformDisplayEXT (EGLenum platform, void * native_display, const EGLint * /* attrib_list */) {
+    return eglGetPlatformDisplay (platform, native_display, nullptr);
+}
+
+EGLBoolean eglInitialize (EGLDisplay dpy, EGLint * major, EGLint * minor) {
+    std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+    EGLint _error = EGL_BAD_DISPLAY;
+
+    for (auto & _display : _displays) {
+        if (reinterpret_cast <EGLDisplay> (_display.second) == dpy) {
+            _display.second->initialized = true;
+
+            _error = EGL_SUCCESS;
+
+            break;
+        }
+    }
+
+    if (_error == EGL_SUCCESS && major != nullptr) {
+        *major = 1;
+    }
+
+    if (_error == EGL_SUCCESS && minor != nullptr) {
+        *minor = 5;
+    }
+
+    return Result (_error);
+}
+
+EGLBoolean eglTerminate (EGLDisplay dpy) {
+    std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+    EGLint _error = EGL_BAD_DISPLAY;
+
+    for (auto & _display : _displays) {
+        if (reinterpret_cast <EGLDisplay> (_display.second) == dpy) {
+            // The display handle remains valid
+            _display.second->initialized = false;
+
+            _error = EGL_SUCCESS;
+
+            break;
+        }
+    }
+
+    return Result (_error);
+}
+
+const char * eglQueryString (EGLDisplay dpy, EGLint name) {
+    const char * ret = nullptr;
+
+    if (dpy == EGL_NO_DISPLAY && name == EGL_EXTENSIONS) {
+        // Client extensions
+        ret = "EGL_EXT_client_extensions EGL_EXT_platform_base EGL_KHR_platform_gbm EGL_MESA_platform_gbm";
+    }
+    else if (Valid (dpy) != false) {
+        switch (name) {
+            case EGL_VENDOR         :   ret = "libyxope mock"; break;
+            case EGL_VERSION        :   ret = "1.5 mock"; break;
+            case EGL_CLIENT_APIS    :   ret = "OpenGL_ES"; break;
+            case EGL_EXTENSIONS     :   ret = "EGL_KHR_swap_buffers_with_damage EGL_EXT_swap_buffers_with_damage EGL_KHR_surfaceless_context"; break;
+            default                 :   ;
+        }
+    }
+
+    _state.error = ret != nullptr ? EGL_SUCCESS : dpy == EGL_NO_DISPLAY || Valid (dpy) != true ? EGL_BAD_DISPLAY : EGL_BAD_PARAMETER;
+
+    return ret;
+}
+
+EGLBoolean eglGetConfigs (EGLDisplay dpy, EGLConfig * configs, EGLint config_size, EGLint * num_config) {
+    EGLint _error = Valid (dpy) != false ? num_config != nullptr ? EGL_SUCCESS : EGL_BAD_PARAMETER : EGL_BAD_DISPLAY;
+
+    if (_error == EGL_SUCCESS) {
+        *num_config = configs != nullptr && config_size < 1 ? 0 : 1;
+
+        if (configs != nullptr && config_size > 0) {
+            configs [0] = _config;
+        }
+    }
+
+    return Result (_error);
+}
+
+EGLBoolean eglChooseConfig (EGLDisplay dpy, const EGLint * /* attrib_list */, EGLConfig * configs, EGLint config_size, EGLint * num_config) {
+    // Any attribute matches
+    return eglGetConfigs (dpy, configs, config_size, num_config);
+}
+
+EGLBoolean eglGetConfigAttrib (EGLDisplay dpy, EGLConfig config, EGLint attribute, EGLint * value) {
+    EGLint _error = Valid (dpy) != false ? config == _config ? value != nullptr ? EGL_SUCCESS : EGL_BAD_PARAMETER : EGL_BAD_CONFIG : EGL_BAD_DISPLAY;
+
+    if (_error == EGL_SUCCESS) {
+        switch (attribute) {
+            case EGL_CONFIG_ID          :   *value = 1; break;
+            case EGL_NATIVE_VISUAL_ID   :   *value = GBM_FORMAT_XRGB8888; break;
+            case EGL_BUFFER_SIZE        :   *value = 32; break;
+            case EGL_RED_SIZE           :
+            case EGL_GREEN_SIZE         :
+            case EGL_BLUE_SIZE          :   *value = 8; break;
+            case EGL_ALPHA_SIZE         :
+            case EGL_DEPTH_SIZE         :
+            case EGL_STENCIL_SIZE       :
+            case EGL_SAMPLES            :
+            case EGL_SAMPLE_BUFFERS     :   *value = 0; break;
+            case EGL_SURFACE_TYPE       :   *value = EGL_WINDOW_BIT; break;
+            case EGL_RENDERABLE_TYPE    :
+            case EGL_CONFORMANT         :   *value = EGL_OPENGL_ES2_BIT; break;
+            case EGL_COLOR_BUFFER_TYPE  :   *value = EGL_RGB_BUFFER; break;
+            case EGL_MIN_SWAP_INTERVAL  :   *value = 0; break;
+            case EGL_MAX_SWAP_INTERVAL  :   *value = 1; break;
+            default                     :   _error = EGL_BAD_ATTRIBUTE;
+        }
+    }
+
+    return Result (_error);
+}
+
+EGLSurface eglCreateWindowSurface (EGLDisplay dpy, EGLConfig config, EGLNativeWindowType win, const EGLint * /* attrib_list */) {
+    return Surface (dpy, config, reinterpret_cast <void *> (win));
+}
+
+EGLSurface eglCreatePlatformWindowSurface (EGLDisplay dpy, EGLConfig config, void * native_window, const EGLAttrib * /* attrib_list */) {
+    return Surface (dpy, config, native_window);
+}
+
+EGLSurface eglCreatePlatformWindowSurfaceEXT (EGLDisplay dpy, EGLConfig config, void * native_window, const EGLint * /* attrib_list */) {
+    return Surface (dpy, config, native_window);
+}
+
+EGLSurface eglCreatePbufferSurface (EGLDisplay /* dpy */, EGLConfig /* config */, const EGLint * /* attrib_list */) {
+    // Window surfaces only
+    _state.error = EGL_BAD_MATCH;
+
+    return EGL_NO_SURFACE;
+}
+
+EGLBoolean eglDestroySurface (EGLDisplay dpy, EGLSurface surface) {
+    EGLint _error = Valid (dpy) != false ? Valid (dpy, surface) != false ? EGL_SUCCESS : EGL_BAD_SURFACE : EGL_BAD_DISPLAY;
+
+    if (_error == EGL_SUCCESS) {
+        std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+        /* size_t */ _surfaces.erase (surface);
+
+        delete reinterpret_cast <surface_t *> (surface);
+    }
+
+    return Result (_error);
+}
+
+EGLBoolean eglQuerySurface (EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint * value) {
+    EGLint _error = Valid (dpy) != false ? Valid (dpy, surface) != false ? value != nullptr ? EGL_SUCCESS : EGL_BAD_PARAMETER : EGL_BAD_SURFACE : EGL_BAD_DISPLAY;
+
+    if (_error == EGL_SUCCESS) {
+        struct gbm_surface const * _native = reinterpret_cast <surface_t *> (surface)->native;
+
+        switch (attribute) {
+            case EGL_CONFIG_ID          :   *value = 1; break;
+            case EGL_WIDTH              :   *value = static_cast <EGLint> (_native->width); break;
+            case EGL_HEIGHT             :   *value = static_cast <EGLint> (_native->height); break;
+            case EGL_RENDER_BUFFER      :   *value = EGL_BACK_BUFFER; break;
+            case EGL_SWAP_BEHAVIOR      :   *value = EGL_BUFFER_DESTROYED; break;
+            default                     :   _error = EGL_BAD_ATTRIBUTE;
+        }
+    }
+
+    return Result (_error);
+}
+
+EGLBoolean eglSurfaceAttrib (EGLDisplay dpy, EGLSurface surface, EGLint /* attribute */, EGLint /* value */) {
+    // Accepted, and ignored
+    return Result (Valid (dpy) != false ? Valid (dpy, surface) != false ? EGL_SUCCESS : EGL_BAD_SURFACE : EGL_BAD_DISPLAY);
+}
+
+EGLBoolean eglBindAPI (EGLenum api) {
+    EGLint _error = api == EGL_OPENGL_ES_API ? EGL_SUCCESS : EGL_BAD_PARAMETER;
+
+    if (_error == EGL_SUCCESS) {
+        _state.api = api;
+    }
+
+    return Result (_error);
+}
+
+EGLenum eglQueryAPI (void) {
+    return _state.api;
+}
+
+EGLContext eglCreateContext (EGLDisplay dpy, EGLConfig config, EGLContext /* share_context */, const EGLint * /* attrib_list */) {
+    EGLContext ret = EGL_NO_CONTEXT;
+
+    if (Valid (dpy) != true) {
+        _state.error = EGL_BAD_DISPLAY;
+    }
+    else if (config != _config && config != EGL_NO_CONFIG_KHR) {
+        _state.error = EGL_BAD_CONFIG;
+    }
+    else {
+        std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+        ret = reinterpret_cast <EGLContext> (new context_t { dpy });
+
+        /* pair */ _contexts.insert (ret);
+
+        _state.error = EGL_SUCCESS;
+    }
+
+    return ret;
+}
+
+EGLBoolean eglDestroyContext (EGLDisplay dpy, EGLContext ctx) {
+    std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+    EGLint _error = _contexts.find (ctx) != _contexts.end () && reinterpret_cast <context_t *> (ctx)->display == dpy ? EGL_SUCCESS : EGL_BAD_CONTEXT;
+
+    if (_error == EGL_SUCCESS) {
+        /* size_t */ _contexts.erase (ctx);
+
+        delete reinterpret_cast <context_t *> (ctx);
+    }
+
+    return Result (_error);
+}
+
+EGLBoolean eglQueryContext (EGLDisplay dpy, EGLContext ctx, EGLint attribute, EGLint * value) {
+    EGLint _error = Valid (dpy) != false ? value != nullptr ? EGL_SUCCESS : EGL_BAD_PARAMETER : EGL_BAD_DISPLAY;
+
+    if (_error == EGL_SUCCESS) {
+        std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+        _error = _contexts.find (ctx) != _contexts.end () ? EGL_SUCCESS : EGL_BAD_CONTEXT;
+    }
+
+    if (_error == EGL_SUCCESS) {
+        switch (attribute) {
+            case EGL_CONFIG_ID              :   *value = 1; break;
+            case EGL_CONTEXT_CLIENT_TYPE    :   *value = EGL_OPENGL_ES_API; break;
+            case EGL_CONTEXT_CLIENT_VERSION :   *value = 2; break;
+            case EGL_RENDER_BUFFER          :   *value = _state.context == ctx ? EGL_BACK_BUFFER : EGL_NONE; break;
+            default                         :   _error = EGL_BAD_ATTRIBUTE;
+        }
+    }
+
+    return Result (_error);
+}
+
+EGLBoolean eglMakeCurrent (EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx) {
+    EGLint _error = EGL_SUCCESS;
+
+    if (dpy == EGL_NO_DISPLAY && ctx == EGL_NO_CONTEXT && draw == EGL_NO_SURFACE && read == EGL_NO_SURFACE) {
+        // Release only
+    }
+    else if (Valid (dpy) != true) {
+        _error = EGL_BAD_DISPLAY;
+    }
+    else if ((draw != EGL_NO_SURFACE && Valid (dpy, draw) != true) || (read != EGL_NO_SURFACE && Valid (dpy, read) != true)) {
+        _error = EGL_BAD_SURFACE;
+    }
+    else {
+        std::lock_guard < decltype (_mutex) > _lock (_mutex);
+
+        _error = ctx == EGL_NO_CONTEXT || _contexts.find (ctx) != _contexts.end () ? EGL_SUCCESS : EGL_BAD_CONTEXT;
+    }
+
+    if (_error == EGL_SUCCESS) {
+        _state.display = ctx != EGL_NO_CONTEXT ? dpy : EGL_NO_DISPLAY;
+        _state.draw = ctx != EGL_NO_CONTEXT ? draw : EGL_NO_SURFACE;
+        _state.read = ctx != EGL_NO_CONTEXT ? read : EGL_NO_SURFACE;
+        _state.context = ctx;
+    }
+
+    return Result (_error);
+}
+
+EGLContext eglGetCurrentContext (void) {
+    return _state.context;
+}
+
+EGLDisplay eglGetCurrentDisplay (void) {
+    return _state.display;
+}
+
+EGLSurface eglGetCurrentSurface (EGLint readdraw) {
+    return readdraw == EGL_DRAW ? _state.draw : readdraw == EGL_READ ? _state.read : EGL_NO_SURFACE;
+}
+
+EGLBoolean eglSwapBuffers (EGLDisplay dpy, EGLSurface surface) {
+    return Swap (dpy, surface);
+}
+
+// Damage does not matter to an instant renderer
+EGLBoolean eglSwapBuffersWithDamageKHR (EGLDisplay dpy, EGLSurface surface, const EGLint * /* rects */, EGLint /* n_rects */) {
+    return Swap (dpy, surface);
+}
+
+EGLBoolean eglSwapBuffersWithDamageEXT (EGLDisplay dpy, EGLSurface surface, const EGLint * /* rects */, EGLint /* n_rects */) {
+    return Swap (dpy, surface);
+}
+
+EGLBoolean eglSwapInterval (EGLDisplay dpy, EGLint /* interval */) {
+    return Result (Valid (dpy) != false ? _state.context != EGL_NO_CONTEXT ? EGL_SUCCESS : EGL_BAD_CONTEXT : EGL_BAD_DISPLAY);
+}
+
+EGLBoolean eglWaitClient (void) {
+    return Result (EGL_SUCCESS);
+}
+
+EGLBoolean eglWaitGL (void) {
+    return Result (EGL_SUCCESS);
+}
+
+EGLBoolean eglWaitNative (EGLint /* engine */) {
+    return Result (EGL_SUCCESS);
+}
+
+EGLBoolean eglReleaseThread (void) {
+    return eglMakeCurrent (EGL_NO_DISPLAY, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+__eglMustCastToProperFunctionPointerType eglGetProcAddress (const char * procname) {
+    // Anything, core or extension, available in the process, possibly interposed
+    return procname != nullptr ? reinterpret_cast <__eglMustCastToProperFunctionPointerType> (dlsym (RTLD_DEFAULT, procname)) : nullptr;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,5 +23,259 @@ THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-Deiberately left empty
+Link stub of libRealgbm.so, or, with _MOCK, a functional mock of libgbm, see mock.h
 */
+
+#ifdef _MOCK
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <gbm.h>
+#include <drm_fourcc.h>
+
+#include <errno.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "mock.h"
+
+namespace {
+
+    uint32_t Bpp (uint32_t format) {
+        uint32_t ret = 32;
+
+        switch (format) {
+            case GBM_FORMAT_RGB565  :
+            case GBM_FORMAT_BGR565  :   ret = 16; break;
+            case GBM_FORMAT_R8      :   ret = 8; break;
+            default                 :   ;
+        }
+
+        return ret;
+    }
+
+    struct gbm_bo * Create (struct gbm_device * gbm, uint32_t width, uint32_t height, uint32_t format, uint64_t modifier) {
+        static std::atomic <uint32_t> _handle (0);
+
+        struct gbm_bo * ret = gbm != nullptr && width > 0 && height > 0 ? new gbm_bo () : nullptr;
+
+        if (ret != nullptr) {
+            // Linear, without padding
+            *ret = { gbm, width, height, width * Bpp (format) / 8, format, modifier, ++_handle, nullptr, nullptr };
+        }
+
+        return ret;
+    }
+
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct gbm_device * gbm_create_device (int fd) {
+    struct gbm_device * ret = fd >= 0 ? new gbm_device () : nullptr;
+
+    if (ret != nullptr) {
+        // Resolves to the interposed symbol, as for the implementation
+        *ret = { &gbm_create_device, fd };
+    }
+
+    return ret;
+}
+
+void gbm_device_destroy (struct gbm_device * gbm) {
+    delete gbm;
+}
+
+int gbm_device_get_fd (struct gbm_device * gbm) {
+    return gbm != nullptr ? gbm->fd : -1;
+}
+
+const char * gbm_device_get_backend_name (struct gbm_device * /* gbm */) {
+    return "mock";
+}
+
+int gbm_device_is_format_supported (struct gbm_device * gbm, uint32_t format, uint32_t /* usage */) {
+    return gbm != nullptr && (format == GBM_FORMAT_XRGB8888 || format == GBM_FORMAT_ARGB8888) ? 1 : 0;
+}
+
+struct gbm_bo * gbm_bo_create (struct gbm_device * gbm, uint32_t width, uint32_t height, uint32_t format, uint32_t /* flags */) {
+    return Create (gbm, width, height, format, DRM_FORMAT_MOD_LINEAR);
+}
+
+struct gbm_bo * gbm_bo_create_with_modifiers (struct gbm_device * gbm, uint32_t width, uint32_t height, uint32_t format, const uint64_t * /* modifiers */, const unsigned int /* count */) {
+    return Create (gbm, width, height, format, DRM_FORMAT_MOD_LINEAR);
+}
+
+void gbm_bo_destroy (struct gbm_bo * bo) {
+    if (bo != nullptr && bo->destroy_user_data != nullptr) {
+        bo->destroy_user_data (bo, bo->user_data);
+    }
+
+    delete bo;
+}
+
+uint32_t gbm_bo_get_width (struct gbm_bo * bo) {
+    return bo->width;
+}
+
+uint32_t gbm_bo_get_height (struct gbm_bo * bo) {
+    return bo->height;
+}
+
+uint32_t gbm_bo_get_stride (struct gbm_bo * bo) {
+    return bo->stride;
+}
+
+uint32_t gbm_bo_get_stride_for_plane (struct gbm_bo * bo, int plane) {
+    return plane == 0 ? bo->stride : 0;
+}
+
+uint32_t gbm_bo_get_format (struct gbm_bo * bo) {
+    return bo->format;
+}
+
+uint32_t gbm_bo_get_bpp (struct gbm_bo * bo) {
+    return Bpp (bo->format);
+}
+
+uint32_t gbm_bo_get_offset (struct gbm_bo * /* bo */, int /* plane */) {
+    return 0;
+}
+
+uint64_t gbm_bo_get_modifier (struct gbm_bo * bo) {
+    return bo->modifier;
+}
+
+int gbm_bo_get_plane_count (struct gbm_bo * /* bo */) {
+    return 1;
+}
+
+struct gbm_device * gbm_bo_get_device (struct gbm_bo * bo) {
+    return bo->gbm;
+}
+
+union gbm_bo_handle gbm_bo_get_handle (struct gbm_bo * bo) {
+    union gbm_bo_handle ret;
+
+    ret.u64 = 0;
+    ret.u32 = bo->handle;
+
+    return ret;
+}
+
+union gbm_bo_handle gbm_bo_get_handle_for_plane (struct gbm_bo * bo, int plane) {
+    union gbm_bo_handle ret;
+
+    ret.u64 = 0;
+    ret.u32 = plane == 0 ? bo->handle : 0;
+
+    return ret;
+}
+
+int gbm_bo_get_fd (struct gbm_bo * /* bo */) {
+    // There is no memory to share
+    errno = ENOSYS;
+
+    return -1;
+}
+
+int gbm_bo_get_fd_for_plane (struct gbm_bo * bo, int /* plane */) {
+    return gbm_bo_get_fd (bo);
+}
+
+void gbm_bo_set_user_data (struct gbm_bo * bo, void * data, void (*destroy_user_data) (struct gbm_bo *, void *)) {
+    bo->user_data = data;
+    bo->destroy_user_data = destroy_user_data;
+}
+
+void * gbm_bo_get_user_data (struct gbm_bo * bo) {
+    return bo->user_data;
+}
+
+struct gbm_surface * gbm_surface_create (struct gbm_device * gbm, uint32_t width, uint32_t height, uint32_t format, uint32_t flags) {
+    struct gbm_surface * ret = gbm != nullptr && width > 0 && height > 0 ? new gbm_surface () : nullptr;
+
+    if (ret != nullptr) {
+        ret->gbm = gbm;
+        ret->width = width;
+        ret->height = height;
+        ret->format = format;
+        ret->flags = flags;
+
+        for (uint32_t i = Mock::Value (Mock::BufferCountVariable (), Mock::DefaultBufferCount ()); i > 0; i--) {
+            ret->bos.push_back (std::make_pair (Create (gbm, width, height, format, DRM_FORMAT_MOD_LINEAR), gbm_surface::STATE::FREE));
+        }
+    }
+
+    return ret;
+}
+
+struct gbm_surface * gbm_surface_create_with_modifiers (struct gbm_device * gbm, uint32_t width, uint32_t height, uint32_t format, const uint64_t * /* modifiers */, const unsigned int /* count */) {
+    return gbm_surface_create (gbm, width, height, format, GBM_BO_USE_SCANOUT | GBM_BO_USE_RENDERING);
+}
+
+void gbm_surface_destroy (struct gbm_surface * surface) {
+    if (surface != nullptr) {
+        for (auto & _bo : surface->bos) {
+            gbm_bo_destroy (_bo.first);
+        }
+    }
+
+    delete surface;
+}
+
+struct gbm_bo * gbm_surface_lock_front_buffer (struct gbm_surface * surface) {
+    struct gbm_bo * ret = nullptr;
+
+    std::lock_guard < decltype (surface->mutex) > _lock (surface->mutex);
+
+    for (auto & _bo : surface->bos) {
+        if (_bo.second == gbm_surface::STATE::FRONT) {
+            _bo.second = gbm_surface::STATE::LOCKED;
+
+            ret = _bo.first;
+
+            break;
+        }
+    }
+
+    return ret;
+}
+
+void gbm_surface_release_buffer (struct gbm_surface * surface, struct gbm_bo * bo) {
+    std::lock_guard < decltype (surface->mutex) > _lock (surface->mutex);
+
+    for (auto & _bo : surface->bos) {
+        if (_bo.first == bo && _bo.second == gbm_surface::STATE::LOCKED) {
+            _bo.second = gbm_surface::STATE::FREE;
+        }
+    }
+}
+
+int gbm_surface_has_free_buffers (struct gbm_surface * surface) {
+    int ret = 0;
+
+    std::lock_guard < decltype (surface->mutex) > _lock (surface->mutex);
+
+    for (auto & _bo : surface->bos) {
+        ret += _bo.second == gbm_surface::STATE::FREE ? 1 : 0;
+    }
+
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,73 @@
+/*
+Copyright (C) 2020-2021 Metrological
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Scan out timing of frames of EGL window surfaces, as observed by the page flips of libyxope.
+The same data is available with EGL_ANDROID_get_frame_timestamps, and a frame can be scheduled with EGL_ANDROID_presentation_time.
+As with EGL in general on this platform, include gbm.h prior to this header.
+*/
+
+#ifndef _YXOPE_H
+#define _YXOPE_H
+
+#include <stdint.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// CLOCK_MONOTONIC, in nanoseconds, 0 if unknown
+struct yxope_frame_timing {
+    // As returned by eglGetNextFrameIdANDROID prior to the swap
+    EGLuint64KHR id;
+    // Given with eglPresentationTimeANDROID, if any
+    uint64_t requested;
+    // Buffers have been swapped
+    uint64_t queued;
+    // The flip has been submitted
+    uint64_t latched;
+    // The flip has completed, the frame is scanned out
+    uint64_t presented;
+    // Vertical blank counter of the CRTC at presentation
+    uint32_t sequence;
+    // Frame period of the mode
+    uint64_t duration;
+};
+
+// Of a recent frame, only a limited number is kept
+EGLBoolean yxopeGetFrameTiming (EGLDisplay dpy, EGLSurface surface, EGLuint64KHR id, struct yxope_frame_timing* timing);
+
+// Of the most recent frame
+EGLBoolean yxopeGetLatestFrameTiming (EGLDisplay dpy, EGLSurface surface, struct yxope_frame_timing* timing);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif